@@ -1,16 +1,36 @@
 ﻿#include <print>
+#include <algorithm> // std::ranges::count, std::max, std::equal
+#include <filesystem> // std::filesystem::directory_iterator
+#include <format> // std::format
+#include <thread> // std::thread::hardware_concurrency
+#include <utility> // std::pair
 #include "MyLib/Common.hpp"
 #include "MyLib/Utility.hpp"
 #include "MyLib/Point.hpp"
+#include "MyLib/Rect.hpp"
 #include "MyLib/FileSystem.hpp"
 #include "MyLib/Timer.hpp"
 #include "MyLib/BinaryFileWriter.hpp"
 #include "MyLib/BinaryFileReader.hpp"
 #include "MyLib/TextFileWriter.hpp"
 #include "MyLib/TextFileReader.hpp"
+#include "MyLib/LineIndex.hpp"
 #include "MyLib/Color.hpp"
 #include "MyLib/Image.hpp"
+#include "MyLib/PlanarImage.hpp"
+#include "MyLib/Resize.hpp"
+#include "MyLib/Convolution.hpp"
+#include "MyLib/Blend.hpp"
+#include "MyLib/Hash.hpp"
 #include "MyLib/BMP.hpp"
+#include "MyLib/PNG.hpp"
+#include "MyLib/ImageCodec.hpp"
+#include "MyLib/ImagePipeline.hpp"
+#include "MyLib/ImagePyramid.hpp"
+#include "MyLib/CPU.hpp"
+#include "MyLib/PixelConversion.hpp"
+#include "MyLib/ColorConversion.hpp"
+#include "MyLib/ThreadPool.hpp"
 
 using namespace seccamp;
 
@@ -138,6 +158,9 @@ int main()
 		std::println("reader.isOpen(): {}", reader.isOpen());
 		std::println("reader.fullPath(): {}", reader.fullPath());
 		std::println("reader.size(): {}", reader.size());
+		std::println("reader.isMapped(): {}", reader.isMapped());
+		std::println("reader.view().size(): {}", reader.view().size());
+		std::println("reader.view(8, 15).size(): {}", reader.view(8, 15).size());
 
 		uint64 length;
 		reader.read(length);
@@ -157,6 +180,16 @@ int main()
 		std::println("a: {}", a);
 		std::println("b: {}", b);
 		std::println("p: {}", p);
+		std::println("reader.position(): {}", reader.position());
+
+		// 読み込み位置を変えずに、指定した位置から読み込む
+		std::string str2(length, '\0');
+		reader.readAt(sizeof(uint64), str2.data(), str2.size());
+		std::println("str2: {}", str2);
+
+		reader.seek(sizeof(uint64));
+		reader.skip(7);
+		std::println("reader.position(): {}", reader.position());
 	}
 
 	std::println("---- TextFileWriter.hpp ----");
@@ -182,6 +215,47 @@ int main()
 		{
 			std::println("> {}", line);
 		}
+
+		// メモリ確保をせずに 1 行ずつ読み込む
+		reader.open("test.txt");
+
+		std::string_view view;
+		while (reader.readLine(view))
+		{
+			std::println(">> {}", view);
+		}
+	}
+
+	std::println("---- LineIndex.hpp ----");
+	{
+		{
+			TextFileWriter writer{ "lines.txt" };
+
+			for (int32 i = 0; i < 1'000'000; ++i)
+			{
+				writer.writeln("line {}", i);
+			}
+		}
+
+		LineIndex index{ "lines.txt" };
+		std::println("index.isOpen(): {}", index.isOpen());
+		std::println("index.numLines(): {}", index.numLines());
+		std::println("index.line(0): {}", index.line(0));
+		std::println("index.line(123456): {}", index.line(123456));
+		std::println("index.buildThroughputGBps(): {:.2f} GB/s", index.buildThroughputGBps());
+
+		// 行の範囲を分割してワーカースレッドに割り当てる
+		for (const auto& range : index.split(4))
+		{
+			std::println("[{}, {}): {} ...", range.beginLine, range.endLine, index.line(range.beginLine));
+		}
+
+		// インデックスファイルを保存し、次回からは読み込む
+		index.save();
+
+		LineIndex index2;
+		std::println("index2.load(\"lines.txt\"): {}", index2.load("lines.txt"));
+		std::println("index2.line(999999): {}", index2.line(999999));
 	}
 
 	std::println("---- Color.hpp ----");
@@ -227,6 +301,63 @@ int main()
 			image.save("image2.bmp");
 		}
 
+		{
+			const Image image{ "image2.bmp" };
+
+			// 32 ビット、8 ビット（パレット）、上から下への格納で保存し、読み込み直す
+			SaveBMP(image, "image2_32.bmp", BMPFormat::BGRA32);
+			SaveBMP(image, "image2_8.bmp", BMPFormat::Palette8);
+			SaveBMP(image, "image2_topdown.bmp", BMPFormat::BGR24, true);
+
+			std::println("BGRA32: {}", (Image{ "image2_32.bmp" } == image));
+			std::println("Palette8: {}", (Image{ "image2_8.bmp" } == image));
+			std::println("TopDown: {}", (Image{ "image2_topdown.bmp" } == image));
+		}
+
+		{
+			// 一部の領域だけを読み込む
+			const Rect region{ 30, 10, 40, 20 };
+			const Image part = LoadBMPRegion("image2.bmp", region);
+			std::println("LoadBMPRegion{}: {}x{}", region, part.width(), part.height());
+
+			// 1 行ずつ読み込み、白いピクセルの数を数える
+			BMPRowReader rowReader{ "image2.bmp" };
+			size_t numWhitePixels = 0;
+
+			rowReader.readRows([&](int32, std::span<const Color> row)
+				{
+					numWhitePixels += std::ranges::count(row, Palette::White);
+				});
+
+			std::println("BMPRowReader: {} white pixels", numWhitePixels);
+		}
+
+		{
+			Image image{ "image2.bmp" };
+
+			// コピーせずに一部の領域を処理し、保存する
+			const ImageView view = image.view(Rect{ 100, 100, 200, 100 });
+			view.invert();
+			std::println("view: {}x{} (stride {}, contiguous {})", view.width(), view.height(), view.stride(), view.isContiguous());
+
+			SaveBMP(view, "image2_view.bmp");
+			std::println("SaveBMP(view): {}", (Image{ "image2_view.bmp" } == Image{ view }));
+
+			// 画像をタイルに分けて処理する
+			for (int32 y = 0; y < image.height(); y += 64)
+			{
+				for (int32 x = 0; x < image.width(); x += 64)
+				{
+					if (IsEven((x + y) / 64))
+					{
+						image.view(Rect{ x, y, 64, 64 }).grayscale();
+					}
+				}
+			}
+
+			image.save("image2_tiles.bmp");
+		}
+
 		//{
 		//	Image image{ "seccamp.bmp" };
 
@@ -238,4 +369,782 @@ int main()
 		//	image.save("seccamp_gray.bmp");
 		//}
 	}
+
+	std::println("---- Benchmark: TextFileWriter ----");
+	{
+		constexpr int32 NumLines = 2'000'000;
+
+		TextFileWriter writer{ "bench.txt" };
+
+		Timer timer;
+
+		for (int32 i = 0; i < NumLines; ++i)
+		{
+			writer.writeln("{},{},{:.3f}", i, (i * 7), (i * 0.5));
+		}
+
+		writer.close();
+
+		std::println("{} lines, {:.1f} Mlines/s", NumLines, (NumLines / timer.sF() / 1e6));
+
+		// I/O スレッドにファイルへの書き込みを任せる
+		TextFileWriter asyncWriter{ "bench_async.txt", WriteMode::Async };
+
+		Timer asyncTimer;
+
+		for (int32 i = 0; i < NumLines; ++i)
+		{
+			asyncWriter.writeln("{},{},{:.3f}", i, (i * 7), (i * 0.5));
+		}
+
+		asyncWriter.close();
+
+		std::println("{} lines, {:.1f} Mlines/s (WriteMode::Async)", NumLines, (NumLines / asyncTimer.sF() / 1e6));
+	}
+
+	std::println("---- Benchmark: PixelConversion ----");
+	{
+		std::println("SECCAMP_CPU_NAME: {}", SECCAMP_CPU_NAME);
+		std::println("CPU::HasSSSE3(): {}", CPU::HasSSSE3());
+		std::println("CPU::HasAVX2(): {}", CPU::HasAVX2());
+		std::println("CPU::HasNEON(): {}", CPU::HasNEON());
+
+		// 8K × 8K の画像
+		const Image image{ 8192, 8192, Color{ 11, 22, 33 } };
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		std::vector<uint8> bgr(image.numPixels() * 3);
+		Image image2{ image.size() };
+
+		{
+			Timer timer;
+			ConvertRGBAToBGR(image.data(), bgr.data(), image.numPixels());
+			std::println("ConvertRGBAToBGR: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Timer timer;
+			ConvertBGRToRGBA(bgr.data(), image2.data(), image2.numPixels());
+			std::println("ConvertBGRToRGBA: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Timer timer;
+			image.save("bench.bmp");
+			std::println("SaveBMP: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Timer timer;
+			const Image loaded{ "bench.bmp" };
+			std::println("LoadBMP: {:.1f} MB/s", (imageMB / timer.sF()));
+			std::println("loaded == image: {}", (loaded == image));
+		}
+	}
+
+	std::println("---- Benchmark: ColorConversion ----");
+	{
+		// 8K × 8K の画像
+		Image image{ 8192, 8192 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x + y) };
+			}
+		}
+
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		{
+			Timer timer;
+			const std::vector<uint8> gray = image.grayscaleUint8();
+			std::println("grayscaleUint8: {:.1f} MB/s", (imageMB / timer.sF()));
+
+			// Color::grayscaleUint8() との差が ±1 以内であることを確認
+			bool ok = true;
+
+			for (size_t i = 0; i < image.numPixels(); ++i)
+			{
+				const int32 diff = (gray[i] - image.data()[i].grayscaleUint8());
+				ok &= ((-1 <= diff) && (diff <= 1));
+			}
+
+			std::println("grayscaleUint8 within ±1: {}", ok);
+		}
+
+		{
+			Timer timer;
+			const std::vector<uint8> green = image.channel(1);
+			std::println("channel: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Image image2 = image;
+			Timer timer;
+			image2.grayscale();
+			std::println("grayscale: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Image image2 = image;
+			Timer timer;
+			image2.invert();
+			std::println("invert: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Image image2 = image;
+			Timer timer;
+			image2.adjustBrightnessContrast(20, 1.5);
+			std::println("adjustBrightnessContrast: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			// 比較用: Color::grayscaleUint8() を使ったスカラーのループ
+			Image image2 = image;
+			Timer timer;
+
+			for (auto& pixel : image2)
+			{
+				pixel = Color{ pixel.grayscaleUint8() };
+			}
+
+			std::println("grayscale (scalar loop): {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+	}
+
+	std::println("---- Benchmark: PlanarImage ----");
+	{
+		// 4K の画像
+		Image image{ 3840, 2160 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x + y) };
+			}
+		}
+
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		{
+			Timer timer;
+			PlanarImage8 planar{ image };
+			std::println("PlanarImage8 (deinterleave): {:.1f} MB/s", (imageMB / timer.sF()));
+
+			// 各成分が連続しているので、1 つの成分だけを処理するループは SIMD 命令に変換されやすい
+			uint8* pR = planar.plane(0);
+
+			for (size_t i = 0; i < planar.numPixels(); ++i)
+			{
+				pR[i] = static_cast<uint8>(pR[i] / 2);
+			}
+
+			Timer timer2;
+			const Image image2 = planar.toImage();
+			std::println("PlanarImage8::toImage (interleave): {:.1f} MB/s", (imageMB / timer2.sF()));
+			std::println("R halved: {}", (image2[100][201].r == (image[100][201].r / 2)));
+		}
+
+		{
+			Timer timer;
+			const PlanarImageF planar{ image };
+			std::println("PlanarImageF (deinterleave): {:.1f} MB/s", (imageMB / timer.sF()));
+
+			Timer timer2;
+			const Image image2 = planar.toImage();
+			std::println("PlanarImageF::toImage (interleave): {:.1f} MB/s", (imageMB / timer2.sF()));
+			std::println("PlanarImageF round trip: {}", (image2 == image));
+		}
+
+		{
+			// 1 成分のマスクは Image の 4 分の 1 のメモリで済む
+			const PlanarImage8 mask{ image, 1 };
+			std::println("mask: {} channel, {} bytes per pixel", mask.numChannels(), (mask.numChannels() * sizeof(PlanarImage8::value_type)));
+		}
+	}
+
+	std::println("---- Benchmark: Resize ----");
+	{
+		// 4K の画像を 1080p に縮小する
+		Image image{ 3840, 2160 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x ^ y) };
+			}
+		}
+
+		const double srcMpix = (image.numPixels() / 1'000'000.0);
+		const Size dstSize{ 1920, 1080 };
+
+		const std::pair<ResizeFilter, const char*> filters[] = {
+			{ ResizeFilter::Nearest, "Nearest" },
+			{ ResizeFilter::Bilinear, "Bilinear" },
+			{ ResizeFilter::Box, "Box" },
+			{ ResizeFilter::Bicubic, "Bicubic" },
+			{ ResizeFilter::Lanczos3, "Lanczos3" },
+		};
+
+		for (const auto& [filter, name] : filters)
+		{
+			Timer timer;
+			const Image resized = Resize(image, dstSize, filter);
+			std::println("Resize ({}): {:.1f} Mpix/s", name, (srcMpix / timer.sF()));
+		}
+
+		{
+			Timer timer;
+			const Image half = Downscale2x(image);
+			std::println("Downscale2x: {:.1f} Mpix/s", (srcMpix / timer.sF()));
+		}
+	}
+
+	std::println("---- Benchmark: Convolution ----");
+	{
+		// 4K の画像
+		Image image{ 3840, 2160 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x ^ y) };
+			}
+		}
+
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		for (const double sigma : { 3.0, 30.0 })
+		{
+			// 正確なカーネルの計算量は半径に比例する
+			const ConvolutionKernel kernel = ConvolutionKernel::Gaussian(sigma);
+
+			Timer timer;
+			const Image convolved = Convolve(image, kernel, kernel);
+			std::println("Convolve (Gaussian, sigma = {}, {} taps): {:.1f} MB/s", sigma, kernel.size(), (imageMB / timer.sF()));
+
+			// ボックスブラー 3 回の近似の計算量は sigma によらない
+			Timer timer2;
+			const Image blurred = GaussianBlur(image, sigma);
+			std::println("GaussianBlur (sigma = {}): {:.1f} MB/s", sigma, (imageMB / timer2.sF()));
+		}
+
+		for (const int32 radius : { 2, 50 })
+		{
+			Timer timer;
+			const Image blurred = BoxBlur(image, radius);
+			std::println("BoxBlur (radius = {}): {:.1f} MB/s", radius, (imageMB / timer.sF()));
+		}
+	}
+
+	std::println("---- Benchmark: Blend ----");
+	{
+		// 4K の画像
+		Image background{ 3840, 2160 };
+		Image foreground{ 3840, 2160 };
+
+		for (int32 y = 0; y < background.height(); ++y)
+		{
+			for (int32 x = 0; x < background.width(); ++x)
+			{
+				background[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x + y), 255 };
+
+				// 半透明のピクセルが多い画像（不透明や透明の部分による速い経路を使わない）
+				foreground[y][x] = Color{ static_cast<uint8>(y), static_cast<uint8>(x ^ y), static_cast<uint8>(x), static_cast<uint8>(1 + (x % 254)) };
+			}
+		}
+
+		const double imageMB = (background.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		Image premultiplied = foreground;
+		PremultiplyAlpha(premultiplied);
+
+		const std::pair<BlendMode, const char*> modes[] = {
+			{ BlendMode::SourceOver, "SourceOver" },
+			{ BlendMode::Add, "Add" },
+			{ BlendMode::Multiply, "Multiply" },
+			{ BlendMode::Screen, "Screen" },
+		};
+
+		for (const auto& [mode, name] : modes)
+		{
+			{
+				Image image = background;
+				Timer timer;
+				Blend(foreground, image, mode, AlphaMode::Straight);
+				std::println("Blend ({}, Straight): {:.1f} MB/s", name, (imageMB / timer.sF()));
+			}
+
+			{
+				// アルファ乗算済みの場合は、変換の計算を省ける
+				Image image = background;
+				Timer timer;
+				Blend(premultiplied, image, mode, AlphaMode::Premultiplied);
+				std::println("Blend ({}, Premultiplied): {:.1f} MB/s", name, (imageMB / timer.sF()));
+			}
+		}
+
+		{
+			Image image = foreground;
+			Timer timer;
+			PremultiplyAlpha(image);
+			std::println("PremultiplyAlpha: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+
+		{
+			Image image = premultiplied;
+			Timer timer;
+			UnpremultiplyAlpha(image);
+			std::println("UnpremultiplyAlpha: {:.1f} MB/s", (imageMB / timer.sF()));
+		}
+	}
+
+	std::println("---- Benchmark: Hash ----");
+	{
+		// 4K の画像
+		Image image{ 3840, 2160 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x ^ y) };
+			}
+		}
+
+		const Image image2 = image;
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		{
+			// 比較用: Color::operator == を使った要素ごとの比較
+			Timer timer;
+			const bool equal = std::equal(image.begin(), image.end(), image2.begin());
+			std::println("std::equal: {:.1f} MB/s ({})", (imageMB / timer.sF()), equal);
+		}
+
+		{
+			Timer timer;
+			const bool equal = (image == image2);
+			std::println("operator ==: {:.1f} MB/s ({})", (imageMB / timer.sF()), equal);
+		}
+
+		{
+			Timer timer;
+			const uint64 hash = Hash64(image.data(), (image.numPixels() * sizeof(Color)));
+			std::println("Hash64 (1 thread): {:.1f} MB/s ({:016x})", (imageMB / timer.sF()), hash);
+		}
+
+		{
+			Timer timer;
+			const uint64 hash = image.hash();
+			std::println("Image::hash: {:.1f} MB/s ({:016x})", (imageMB / timer.sF()), hash);
+		}
+	}
+
+	std::println("---- Benchmark: Copy-on-write ----");
+	{
+		// 4K の画像
+		Image image{ 3840, 2160, Color{ 10, 20, 30 } };
+
+		constexpr int32 NumCopies = 100;
+
+		{
+			Timer timer;
+
+			for (int32 i = 0; i < NumCopies; ++i)
+			{
+				const Image copy = image;
+			}
+
+			std::println("Copy (deep): {:.2f} ms", (timer.sF() * 1000.0 / NumCopies));
+		}
+
+		image.setCopyOnWrite(true);
+
+		{
+			Timer timer;
+
+			for (int32 i = 0; i < NumCopies; ++i)
+			{
+				const Image copy = image;
+			}
+
+			std::println("Copy (copy-on-write): {:.4f} ms", (timer.sF() * 1000.0 / NumCopies));
+		}
+
+		{
+			// 最初の書き込みで、ピクセルがコピーされる
+			Image copy = image;
+			Timer timer;
+			copy[0][0] = Palette::Black;
+			std::println("First write after copy-on-write: {:.2f} ms", (timer.sF() * 1000.0));
+		}
+	}
+
+	std::println("---- Benchmark: PNG ----");
+	{
+		// png_corpus ディレクトリ内のすべての PNG ファイルを読み込む
+		const std::filesystem::path corpusPath{ "png_corpus" };
+
+		if (not std::filesystem::is_directory(corpusPath))
+		{
+			std::println("png_corpus/ not found (skipped)");
+		}
+		else
+		{
+			int32 numFiles = 0, numFailed = 0;
+			double fileMB = 0.0, imageMB = 0.0, seconds = 0.0;
+
+			for (const auto& entry : std::filesystem::directory_iterator{ corpusPath })
+			{
+				if (FileSystem::Extension(entry.path().string()) != ".png")
+				{
+					continue;
+				}
+
+				Timer timer;
+				const Image image = LoadPNG(entry.path().string());
+				seconds += timer.sF();
+
+				++numFiles;
+
+				if (not image)
+				{
+					++numFailed;
+					continue;
+				}
+
+				fileMB += (entry.file_size() / (1024.0 * 1024.0));
+				imageMB += (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+			}
+
+			std::println("LoadPNG: {} files ({} failed), {:.1f} MB/s (file), {:.1f} MB/s (RGBA)", numFiles, numFailed, (fileMB / seconds), (imageMB / seconds));
+		}
+	}
+
+	std::println("---- Benchmark: PNG encode ----");
+	{
+		// Full HD の画像（グラデーションに小さなノイズを加える）
+		Image image{ 1920, 1080 };
+		uint32 state = 12345;
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				state = (state * 1664525u + 1013904223u);
+				const uint8 noise = static_cast<uint8>(state >> 29);
+				image[y][x] = Color{ static_cast<uint8>(x + noise), static_cast<uint8>(y + noise), static_cast<uint8>((x + y) / 4) };
+			}
+		}
+
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		{
+			// 比較用: BMP 形式での保存
+			Timer timer;
+			SaveBMP(image, "bench_encode.bmp");
+			std::println("SaveBMP: {:.1f} MB/s, {} bytes", (imageMB / timer.sF()), std::filesystem::file_size("bench_encode.bmp"));
+		}
+
+		constexpr std::pair<CompressionLevel, const char*> Levels[] =
+		{
+			{ CompressionLevel::Fastest, "Fastest" },
+			{ CompressionLevel::Fast, "Fast" },
+			{ CompressionLevel::Default, "Default" },
+			{ CompressionLevel::Best, "Best" },
+		};
+
+		for (const auto& [level, name] : Levels)
+		{
+			Timer timer;
+			const std::vector<std::byte> data = EncodePNG(image, level, PNGFormat::RGB24);
+			const double seconds = timer.sF();
+			const bool roundTrip = (DecodePNG(data) == image);
+			std::println("EncodePNG ({}, RGB24): {:.1f} MB/s, {} bytes ({})", name, (imageMB / seconds), data.size(), roundTrip);
+		}
+
+		{
+			Timer timer;
+			SavePNG(image, "bench_encode.png");
+			std::println("SavePNG (Default, RGBA32): {:.1f} MB/s, {} bytes", (imageMB / timer.sF()), std::filesystem::file_size("bench_encode.png"));
+		}
+	}
+
+	std::println("---- Benchmark: ImageCodec ----");
+	{
+		Image image{ 640, 480 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x ^ y) };
+			}
+		}
+
+		// 拡張子に応じた形式で保存し、ファイルの先頭のデータから形式を判定して読み込む
+		for (const std::string_view path : { "codec.png", "codec.PNG", "codec.bmp", "codec.dat" })
+		{
+			const bool saved = image.save(path);
+			const auto codec = ImageCodec::FromFile(path);
+			std::println("{}: saved {}, detected {}, round trip {}", path, saved, (codec ? codec->name() : "none"), (Image{ path } == image));
+		}
+
+		// png_corpus ディレクトリ内のすべてのファイルの形式を判定する
+		const std::filesystem::path corpusPath{ "png_corpus" };
+
+		if (std::filesystem::is_directory(corpusPath))
+		{
+			std::vector<std::string> paths;
+
+			for (const auto& entry : std::filesystem::directory_iterator{ corpusPath })
+			{
+				paths.push_back(entry.path().string());
+			}
+
+			int32 numDetected = 0;
+			Timer timer;
+
+			for (const auto& path : paths)
+			{
+				numDetected += (ImageCodec::FromFile(path) != nullptr);
+			}
+
+			std::println("ImageCodec::FromFile: {} / {} files detected, {:.1f} us/file", numDetected, paths.size(), (timer.sF() * 1e6 / paths.size()));
+		}
+	}
+
+	std::println("---- Benchmark: ImagePipeline ----");
+	{
+		// 512 × 512 の画像を 64 枚用意する
+		std::filesystem::create_directories("pipeline");
+
+		std::vector<ImagePipeline::Job> jobs;
+
+		for (int32 i = 0; i < 64; ++i)
+		{
+			Image image{ 512, 512, Color{ static_cast<uint8>(i * 4), 128, 200 } };
+			image.save(std::format("pipeline/input{}.bmp", i));
+			jobs.push_back({ std::format("pipeline/input{}.bmp", i), std::format("pipeline/output{}.bmp", i) });
+		}
+
+		const auto Transform = [](Image& image)
+		{
+			image.grayscale().invert();
+		};
+
+		{
+			// 比較用: 1 枚ずつ順番に処理する
+			Timer timer;
+
+			for (const auto& job : jobs)
+			{
+				Image image = LoadBMP(job.inputPath);
+				Transform(image);
+				SaveBMP(image, job.outputPath);
+			}
+
+			std::println("Sequential: {:.1f} images/s", (jobs.size() / timer.sF()));
+		}
+
+		for (const bool preserveOrder : { false, true })
+		{
+			ImagePipeline pipeline{ ImagePipeline::Options{ .preserveOrder = preserveOrder } };
+			const ImagePipeline::Stats stats = pipeline.run(jobs, Transform);
+
+			std::println("ImagePipeline (preserveOrder {}): {:.1f} images/s, {} succeeded, {} failed (decode {:.3f} s, transform {:.3f} s, encode {:.3f} s, total {:.3f} s)",
+				preserveOrder, stats.imagesPerSecond(), stats.numSucceeded, stats.failedJobs.size(),
+				stats.decodeSeconds, stats.transformSeconds, stats.encodeSeconds, stats.totalSeconds);
+		}
+
+		{
+			// 変換せずに、BMP から PNG に形式を変換する
+			for (auto& job : jobs)
+			{
+				job.outputPath = (job.outputPath.substr(0, (job.outputPath.size() - 4)) + ".png");
+			}
+
+			const ImagePipeline::Stats stats = ImagePipeline{}.run(jobs);
+			std::println("ImagePipeline (BMP to PNG): {:.1f} images/s, {} succeeded", stats.imagesPerSecond(), stats.numSucceeded);
+		}
+	}
+
+	std::println("---- Benchmark: ImagePyramid ----");
+	{
+		// 4K の画像
+		Image image{ 3840, 2160 };
+
+		for (int32 y = 0; y < image.height(); ++y)
+		{
+			for (int32 x = 0; x < image.width(); ++x)
+			{
+				image[y][x] = Color{ static_cast<uint8>(x), static_cast<uint8>(y), static_cast<uint8>(x ^ y) };
+			}
+		}
+
+		{
+			// 比較用: Downscale2x() を段ごとに繰り返す
+			Timer timer;
+			Image level = Downscale2x(image);
+
+			while ((1 < level.width()) || (1 < level.height()))
+			{
+				level = Downscale2x(level);
+			}
+
+			std::println("Downscale2x (repeated): {:.2f} ms", (timer.sF() * 1000.0));
+		}
+
+		{
+			Timer timer;
+			const ImagePyramid pyramid{ image };
+			std::println("ImagePyramid: {:.2f} ms ({} levels, fit(256, 256) = {}x{})", (timer.sF() * 1000.0),
+				pyramid.numLevels(), pyramid.fit(Size{ 256, 256 }).width(), pyramid.fit(Size{ 256, 256 }).height());
+		}
+
+		{
+			// 1 回目はキャッシュファイルを作成し、2 回目はキャッシュファイルから読み込む
+			image.save("pyramid.bmp");
+			std::filesystem::remove(ImagePyramid::DefaultCachePath("pyramid.bmp"));
+
+			for (const char* label : { "build", "cached" })
+			{
+				Timer timer;
+				ImagePyramid pyramid;
+				const bool result = pyramid.loadOrBuild("pyramid.bmp");
+				std::println("ImagePyramid::loadOrBuild ({}): {:.2f} ms ({})", label, (timer.sF() * 1000.0), result);
+			}
+		}
+	}
+
+	std::println("---- Benchmark: ThreadPool ----");
+	{
+		// 8K × 8K の画像
+		Image image{ 8192, 8192 };
+		const double imageMB = (image.numPixels() * sizeof(Color) / (1024.0 * 1024.0));
+
+		const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+		// 1 スレッドの場合の時間
+		double baseFill = 0.0, baseGrayscale = 0.0, baseLoadBMP = 0.0;
+
+		image.fill(Color{ 11, 22, 33 });
+		image.save("bench.bmp");
+
+		// 1, 2, 4, ... と CPU の論理コア数で計測する
+		std::vector<size_t> threadCounts;
+
+		for (size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+		{
+			threadCounts.push_back(numThreads);
+		}
+
+		threadCounts.push_back(maxThreads);
+
+		for (const size_t numThreads : threadCounts)
+		{
+			ThreadPool::Default().resize(numThreads);
+
+			double fillTime, grayscaleTime, loadBMPTime;
+
+			{
+				Timer timer;
+				image.fill(Color{ 11, 22, 33 });
+				fillTime = timer.sF();
+			}
+
+			{
+				Timer timer;
+				image.grayscale();
+				grayscaleTime = timer.sF();
+			}
+
+			{
+				Timer timer;
+				const Image loaded{ "bench.bmp" };
+				loadBMPTime = timer.sF();
+			}
+
+			if (numThreads == 1)
+			{
+				baseFill = fillTime;
+				baseGrayscale = grayscaleTime;
+				baseLoadBMP = loadBMPTime;
+			}
+
+			std::println("{:2} threads: fill {:.1f} MB/s (x{:.2f}), grayscale {:.1f} MB/s (x{:.2f}), LoadBMP {:.1f} MB/s (x{:.2f})", numThreads,
+				(imageMB / fillTime), (baseFill / fillTime),
+				(imageMB / grayscaleTime), (baseGrayscale / grayscaleTime),
+				(imageMB / loadBMPTime), (baseLoadBMP / loadBMPTime));
+		}
+
+		// 共有のスレッドプールを既定のスレッド数に戻す
+		ThreadPool::Default().resize(0);
+	}
+
+	std::println("---- Benchmark: PixelBufferPool ----");
+	{
+		// 同じ大きさの画像を繰り返し作成・破棄する。新しく確保したメモリは、最初の書き込み時にページフォルトが発生する
+		const auto Benchmark = []()
+		{
+			Timer timer;
+
+			for (int32 i = 0; i < 100; ++i)
+			{
+				Image image{ 3840, 2160, Uninitialized };
+				image.fill(Palette::Black);
+			}
+
+			return timer.ms();
+		};
+
+		std::println("PixelAllocator: {} ms", Benchmark());
+
+		const auto pool = std::make_shared<PixelBufferPool>();
+		PixelAllocator::SetDefault(pool);
+
+		const int64 poolTime = Benchmark();
+		std::println("PixelBufferPool: {} ms (reused {} times)", poolTime, pool->numReused());
+
+		PixelAllocator::SetDefault(nullptr);
+	}
+
+	std::println("---- Benchmark: BinaryFileWriter ----");
+	{
+		// 小さなレコードを大量に書き込む
+		constexpr int32 NumRecords = 4'000'000;
+
+		const auto Benchmark = [](const size_t bufferSize)
+		{
+			BinaryFileWriter writer{ "bench.bin" };
+			writer.reserve(bufferSize);
+
+			Timer timer;
+
+			for (int32 i = 0; i < NumRecords; ++i)
+			{
+				const uint16 tag = static_cast<uint16>(i);
+				const uint32 value = static_cast<uint32>(i * 3);
+
+				// 2 つの領域をまとめて書き込む
+				writer.write({ std::as_bytes(std::span{ &tag, 1 }), std::as_bytes(std::span{ &value, 1 }) });
+			}
+
+			writer.close();
+
+			const double mb = (NumRecords * (sizeof(uint16) + sizeof(uint32)) / (1024.0 * 1024.0));
+			std::println("bufferSize: {:>8} bytes, {:.1f} MB/s", bufferSize, (mb / timer.sF()));
+		};
+
+		Benchmark(0); // バッファリングなし
+		Benchmark(BinaryFileWriter::DefaultBufferSize);
+		Benchmark(16 * 1024 * 1024);
+	}
 }
@@ -1,7 +1,14 @@
-﻿#include "BMP.hpp"
+﻿#include <algorithm> // std::min, std::max, std::ranges::all_of
+#include <array> // std::array
+#include <limits> // std::numeric_limits
+#include <vector> // std::vector
+#include <unordered_map> // std::unordered_map
+#include "BMP.hpp"
 #include "Image.hpp"
 #include "BinaryFileWriter.hpp"
 #include "BinaryFileReader.hpp"
+#include "PixelConversion.hpp"
+#include "ThreadPool.hpp"
 
 namespace seccamp
 {
@@ -31,29 +38,33 @@ namespace seccamp
 
 		/// @brief BMP ヘッダを作成します。
 		/// @param width 画像の幅（ピクセル）
-		/// @param height 画像の高さ（ピクセル）
+		/// @param height 画像の高さ（ピクセル）。負の場合は上の行から順に格納されていることを表す
+		/// @param bitCount 1 ピクセルあたりのビット数
+		/// @param numPaletteColors パレットの色数
 		/// @param size_bytes 画像データのサイズ（バイト）
 		/// @return BMP ヘッダ
 		[[nodiscard]]
-		static constexpr BMPHeader Make(int32 width, int32 height, uint32 size_bytes) noexcept
+		static constexpr BMPHeader Make(int32 width, int32 height, uint16 bitCount, uint32 numPaletteColors, uint32 size_bytes) noexcept
 		{
+			const uint32 offBits = static_cast<uint32>(sizeof(BMPHeader) + (numPaletteColors * 4));
+
 			return
 			{
 				.bfType				= 0x4d42,
-				.bfSize				= static_cast<uint32>(sizeof(BMPHeader) + size_bytes),
+				.bfSize				= (offBits + size_bytes),
 				.bfReserved1		= 0,
 				.bfReserved2		= 0,
-				.bfOffBits			= sizeof(BMPHeader),
+				.bfOffBits			= offBits,
 				.biSize				= 40,
 				.biWidth			= width,
 				.biHeight			= height,
 				.biPlanes			= 1,
-				.biBitCount			= 24,
+				.biBitCount			= bitCount,
 				.biCompression		= 0,
 				.biSizeImage		= size_bytes,
 				.biXPelsPerMeter	= 0,
 				.biYPelsPerMeter	= 0,
-				.biClrUsed			= 0,
+				.biClrUsed			= numPaletteColors,
 				.biClrImportant		= 0
 			};
 		}
@@ -65,7 +76,287 @@ namespace seccamp
 // パッキングをデフォルトに戻す
 #pragma pack(pop)
 
-	bool SaveBMP(const Image& image, const std::string_view path)
+	namespace
+	{
+		/// @brief 一度に変換・読み書きするデータの、1 スレッドあたりのおおよそのサイズ（バイト）
+		constexpr size_t BlockSizeBytes = (1 << 20);
+
+		/// @brief 並列に変換するとき、1 回の呼び出しで変換するデータのおおよそのサイズ（バイト）
+		constexpr size_t TaskSizeBytes = (1 << 18);
+
+		/// @brief 並列に変換するとき、1 回の呼び出しで変換する行数を返します。
+		/// @param strideBytes 1 行分のデータのサイズ（バイト）
+		/// @return 1 回の呼び出しで変換する行数
+		[[nodiscard]]
+		constexpr size_t GetRowsPerTask(const size_t strideBytes) noexcept
+		{
+			return std::max<size_t>(1, (TaskSizeBytes / strideBytes));
+		}
+
+		/// @brief 非圧縮
+		constexpr uint32 CompressionRGB = 0;
+
+		/// @brief ビットフィールド（32 ビットの場合は各成分の位置がマスクで指定される）
+		constexpr uint32 CompressionBitFields = 3;
+
+		/// @brief パレットの最大の色数
+		constexpr size_t MaxPaletteColors = 256;
+
+		/// @brief 1 行分のデータのサイズ（バイト）を返します。
+		/// @param width 画像の幅（ピクセル）
+		/// @param bitCount 1 ピクセルあたりのビット数
+		/// @return 1 行分のデータのサイズ（バイト）。BMP の 1 行は 4 の倍数バイトにアラインメントされる
+		[[nodiscard]]
+		constexpr size_t GetStrideBytes(const int32 width, const int32 bitCount) noexcept
+		{
+			return (((static_cast<size_t>(width) * bitCount) + 31) / 32 * 4);
+		}
+
+		/// @brief 色の RGB 成分を 1 つの整数にまとめます。
+		/// @param color 色
+		/// @return RGB 成分をまとめた整数
+		[[nodiscard]]
+		constexpr uint32 ToRGBKey(const Color& color) noexcept
+		{
+			return (color.r | (color.g << 8) | (color.b << 16));
+		}
+
+		/// @brief 画像に含まれる色からパレットを作成します。
+		/// @param image 画像
+		/// @param colorToIndex RGB 成分からパレットの番号への対応の格納先
+		/// @param palette BMP 形式のパレット（1 色 4 バイト）の格納先
+		/// @return 画像の色が 256 色以下の場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool MakePalette(const ConstImageView& image, std::unordered_map<uint32, uint8>& colorToIndex, std::vector<uint8>& palette)
+		{
+			// 同じ色が続くことが多いので、直前の色と同じ場合は探索を省略する
+			uint32 lastKey = ~ToRGBKey(image[0][0]);
+
+			for (int32 y = 0; y < image.height(); ++y)
+			{
+				const Color* pSrc = image[y];
+
+				for (int32 x = 0; x < image.width(); ++x)
+				{
+					const Color& color = pSrc[x];
+					const uint32 key = ToRGBKey(color);
+
+					if (key == lastKey)
+					{
+						continue;
+					}
+
+					lastKey = key;
+
+					if (colorToIndex.contains(key))
+					{
+						continue;
+					}
+
+					if (colorToIndex.size() == MaxPaletteColors)
+					{
+						return false;
+					}
+
+					colorToIndex.emplace(key, static_cast<uint8>(colorToIndex.size()));
+
+					palette.insert(palette.end(), { color.b, color.g, color.r, 0 });
+				}
+			}
+
+			return true;
+		}
+
+		/// @brief 読み込みに必要な BMP ファイルの情報
+		struct BMPInfo
+		{
+			/// @brief 画像の幅（ピクセル）
+			int32 width = 0;
+
+			/// @brief 画像の高さ（ピクセル）
+			int32 height = 0;
+
+			/// @brief 1 ピクセルあたりのビット数
+			int32 depth = 0;
+
+			/// @brief 下から上方向に格納されているか
+			bool reverse = false;
+
+			/// @brief 1 行分のデータのサイズ（バイト）
+			size_t strideBytes = 0;
+
+			/// @brief 画像データの位置（バイト）
+			int64 pixelOffset = 0;
+
+			/// @brief パレット（8 ビットの場合）
+			std::array<Color, MaxPaletteColors> palette;
+
+			/// @brief ファイル上の行と画像上の行を相互に変換します。
+			/// @param i ファイル上の行、または画像上の行
+			/// @return 画像上の行、またはファイル上の行
+			[[nodiscard]]
+			int32 flipY(const int32 i) const noexcept
+			{
+				return (reverse ? (height - 1 - i) : i);
+			}
+
+			/// @brief ファイル上で i 番目の行の、x 番目のピクセルの位置を返します。
+			/// @param i ファイル上の行
+			/// @param x 列
+			/// @return ファイル上の位置（バイト）
+			[[nodiscard]]
+			int64 pixelPosition(const int32 i, const int32 x) const noexcept
+			{
+				return (pixelOffset + static_cast<int64>(strideBytes * i) + (static_cast<int64>(x) * depth / 8));
+			}
+		};
+
+		/// @brief BMP ファイルのヘッダとパレットを読み込みます。
+		/// @param reader BMP ファイル
+		/// @param info 読み込んだ情報の格納先
+		/// @return 対応している形式の BMP ファイルである場合 true, それ以外の場合は false
+		/// @remark ファイルの読み込み位置は変更しません。
+		[[nodiscard]]
+		bool ReadBMPInfo(const BinaryFileReader& reader, BMPInfo& info)
+		{
+			// BMP ファイルヘッダの読み込み
+			BMPHeader header;
+			if (reader.readAt(0, header) != sizeof(BMPHeader))
+			{
+				return false;
+			}
+
+			// BMP ファイルでない
+			if ((header.bfType != 0x4d42) || (header.biSize < 40))
+			{
+				return false;
+			}
+
+			// 上下を反転した高さが int32 に収まらない
+			if (header.biHeight == std::numeric_limits<int32>::min())
+			{
+				return false;
+			}
+
+			// 下から上方向に格納？
+			info.reverse	= (header.biHeight > 0); // BMP は下から上に書き込まれる。biHeight が負の場合は上から下に書き込まれている
+
+			// 画像の幅（ピクセル）
+			info.width		= header.biWidth;
+
+			// 画像の高さ（ピクセル）
+			info.height		= (info.reverse ? header.biHeight : -header.biHeight);
+
+			// 1 ピクセルあたりのビット数
+			info.depth		= header.biBitCount;
+
+			// 8, 24, 32 ビットに対応
+			if ((info.depth != 8) && (info.depth != 24) && (info.depth != 32))
+			{
+				return false;
+			}
+
+			// 不正なサイズ
+			if ((info.width <= 0) || (info.height <= 0))
+			{
+				return false;
+			}
+
+			// 非圧縮のみ対応。32 ビットのビットフィールドは、BGRA の順に並んでいる場合のみ対応
+			if (header.biCompression == CompressionBitFields)
+			{
+				// R, G, B のマスクは情報ヘッダの直後（V4 以降のヘッダでは情報ヘッダ内の同じ位置）にある
+				uint32 masks[3] = {};
+
+				if ((info.depth != 32)
+					|| (reader.readAt(sizeof(BMPHeader), masks) != sizeof(masks))
+					|| (masks[0] != 0x00FF0000) || (masks[1] != 0x0000FF00) || (masks[2] != 0x000000FF))
+				{
+					return false;
+				}
+			}
+			else if (header.biCompression != CompressionRGB)
+			{
+				return false;
+			}
+
+			// パレットの読み込み
+			info.palette.fill(Palette::Black);
+
+			if (info.depth == 8)
+			{
+				const size_t numColors = ((header.biClrUsed == 0) ? MaxPaletteColors : std::min<size_t>(header.biClrUsed, MaxPaletteColors));
+
+				// パレットは情報ヘッダの直後にある
+				uint8 entries[MaxPaletteColors * 4];
+
+				const size_t paletteBytes = (numColors * 4);
+
+				if (reader.readAt((14 + header.biSize), entries, paletteBytes) != static_cast<int64>(paletteBytes))
+				{
+					return false;
+				}
+
+				for (size_t i = 0; i < numColors; ++i)
+				{
+					info.palette[i] = Color{ entries[i * 4 + 2], entries[i * 4 + 1], entries[i * 4 + 0] };
+				}
+			}
+
+			info.strideBytes = GetStrideBytes(info.width, info.depth);
+
+			info.pixelOffset = header.bfOffBits;
+
+			return true;
+		}
+
+		/// @brief ファイル上の連続するピクセルを変換します。
+		/// @param info BMP ファイルの情報
+		/// @param pSrc ファイル上のピクセルのデータ
+		/// @param pDst 変換後のピクセルの格納先
+		/// @param numPixels ピクセル数
+		/// @remark 32 ビットの場合は pSrc と pDst が同じ位置を指してもかまいません。
+		void ConvertPixels(const BMPInfo& info, const uint8* pSrc, Color* pDst, const size_t numPixels) noexcept
+		{
+			switch (info.depth)
+			{
+			case 8:
+				for (size_t x = 0; x < numPixels; ++x)
+				{
+					pDst[x] = info.palette[pSrc[x]];
+				}
+				break;
+			case 24:
+				ConvertBGRToRGBA(pSrc, pDst, numPixels);
+				break;
+			case 32:
+				ConvertBGRAToRGBA(pSrc, pDst, numPixels);
+				break;
+			}
+		}
+
+		/// @brief 32 ビットでアルファ成分がすべて 0 の場合は、アルファ成分を使わないファイルとみなして不透明にします。
+		/// @param info BMP ファイルの情報
+		/// @param image 読み込んだ画像
+		void FixAlpha(const BMPInfo& info, Image& image)
+		{
+			if ((info.depth == 32) && std::ranges::all_of(image, [](const Color& c) { return (c.a == 0); }))
+			{
+				for (Color& pixel : image)
+				{
+					pixel.a = 255;
+				}
+			}
+		}
+	}
+
+
+	bool SaveBMP(const Image& image, const std::string_view path, const BMPFormat format, const bool topDown)
+	{
+		return SaveBMP(image.view(), path, format, topDown);
+	}
+
+	bool SaveBMP(const ConstImageView& image, const std::string_view path, const BMPFormat format, const bool topDown)
 	{
 		if (image.isEmpty())
 		{
@@ -74,10 +365,28 @@ namespace seccamp
 
 		const int32 width			= image.width();
 		const int32 height			= image.height();
-		const uint32 strideBytes	= (width * 3 + width % 4); // BMP の 1 行は 4 の倍数バイトにアラインメントされる
-		const uint32 sizeBytes		= (strideBytes * height);
-		
-		BinaryFileWriter writer{ path };
+		const uint16 bitCount		= ((format == BMPFormat::BGR24) ? 24 : (format == BMPFormat::BGRA32) ? 32 : 8);
+		const size_t strideBytes	= GetStrideBytes(width, bitCount);
+		const uint32 sizeBytes		= static_cast<uint32>(strideBytes * height);
+
+		// 8 ビットの場合は、ファイルを作成する前にパレットを作成できるかを確認する
+		std::unordered_map<uint32, uint8> colorToIndex;
+		std::vector<uint8> palette;
+
+		if ((format == BMPFormat::Palette8) && (not MakePalette(image, colorToIndex, palette)))
+		{
+			return false;
+		}
+
+		// 複数行ずつまとめて変換し、書き込む
+		const size_t numThreads = ThreadPool::Default().numThreads();
+		const int32 blockRows = std::max<int32>(1, static_cast<int32>((BlockSizeBytes * numThreads) / strideBytes));
+
+		// 複数のブロックに分かれる場合は、画素の変換とファイルへの書き込みを並行して行う。
+		// 1 つのブロックに収まる小さな画像では重ねる処理が無いので、I/O スレッドとバッファを作らずに書き込む
+		const WriteMode writeMode = ((blockRows < height) ? WriteMode::Async : WriteMode::Sync);
+
+		BinaryFileWriter writer{ path, writeMode };
 
 		if (not writer.isOpen())
 		{
@@ -86,41 +395,82 @@ namespace seccamp
 
 		// BMP ファイルヘッダの書き込み
 		{
-			const BMPHeader header = BMPHeader::Make(width, height, sizeBytes);
+			const uint32 numPaletteColors = static_cast<uint32>(palette.size() / 4);
+			const BMPHeader header = BMPHeader::Make(width, (topDown ? -height : height), bitCount, numPaletteColors, sizeBytes);
 			writer.write(header);
 		}
 
-		// 各行の書き込み
+		// パレットの書き込み
+		if (not palette.empty())
 		{
-			// 1 行分のデータを格納するバッファ
-			std::vector<uint8> line(strideBytes);
-
-			// 現在見ている image の行の先頭ポインタ
-			const Color* pSrcLine = image[height - 1]; // BMP は下から上に書き込む
+			writer.write(palette.data(), palette.size());
+		}
 
-			for (int32 y = 0; y < height; ++y)
+		// 連続するピクセルを変換する
+		const auto ConvertPixels = [&](const Color* pSrc, uint8* pDst, const size_t numPixels)
+		{
+			switch (format)
 			{
-				// バッファの先頭ポインタ
-				uint8* pDst = line.data();
+			case BMPFormat::BGR24:
+				ConvertRGBAToBGR(pSrc, pDst, numPixels);
+				break;
+			case BMPFormat::BGRA32:
+				ConvertRGBAToBGRA(pSrc, pDst, numPixels);
+				break;
+			case BMPFormat::Palette8:
+				{
+					uint32 lastKey = ~ToRGBKey(pSrc[0]);
+					uint8 lastIndex = 0;
 
-				// 現在見ているピクセルのポインタ
-				const Color* pSrc = pSrcLine;
+					for (size_t x = 0; x < numPixels; ++x)
+					{
+						const uint32 key = ToRGBKey(pSrc[x]);
 
-				for (int32 x = 0; x < width; ++x)
-				{
-					*pDst++ = pSrc->b;
-					*pDst++ = pSrc->g;
-					*pDst++ = pSrc->r;
+						if (key != lastKey)
+						{
+							lastKey = key;
+							lastIndex = colorToIndex.find(key)->second;
+						}
 
-					// 次のピクセルへ
-					++pSrc;
+						pDst[x] = lastIndex;
+					}
 				}
+				break;
+			}
+		};
 
-				// 1 行分のデータを書き込む
-				writer.write(line.data(), strideBytes);
+		// 変換は複数のスレッドで並列に行う
+		{
+			const size_t rowsPerTask = GetRowsPerTask(strideBytes);
 
-				// image を見ているポインタを 1 行上に移動
-				pSrcLine -= width;
+			// 上から順に格納し、画像の行間と行末のパディングが無い場合は、複数行を 1 回で変換できる
+			const bool contiguous = (topDown && image.isContiguous() && (strideBytes == (static_cast<size_t>(width) * bitCount / 8)));
+
+			// blockRows 行分のデータを格納するバッファ（各行末のパディングは 0 のまま）
+			std::vector<uint8> block(strideBytes * blockRows);
+
+			for (int32 y = 0; y < height; y += blockRows)
+			{
+				const int32 rows = std::min(blockRows, (height - y));
+
+				ParallelFor(0, rows, [&](const size_t beginRow, const size_t endRow)
+					{
+						if (contiguous)
+						{
+							ConvertPixels(image[y + beginRow], (block.data() + strideBytes * beginRow), (static_cast<size_t>(width) * (endRow - beginRow)));
+							return;
+						}
+
+						for (size_t i = beginRow; i < endRow; ++i)
+						{
+							// BMP の標準では下から上に書き込む
+							const int32 srcY = (topDown ? (y + static_cast<int32>(i)) : (height - 1 - (y + static_cast<int32>(i))));
+
+							ConvertPixels(image[srcY], (block.data() + strideBytes * i), width);
+						}
+					}, rowsPerTask);
+
+				writer.write(block.data(), (strideBytes * rows));
 			}
 		}
 
@@ -136,68 +486,359 @@ namespace seccamp
 			return{};
 		}
 
-		// BMP ファイルヘッダの読み込み
-		BMPHeader header;
-		if (reader.read(&header, sizeof(BMPHeader)) != sizeof(BMPHeader))
+		BMPInfo info;
+
+		if (not ReadBMPInfo(reader, info))
 		{
 			return{};
 		}
 
-		// 下から上方向に格納？
-		const bool reverse	= (header.biHeight > 0); // BMP は下から上に書き込まれる。biHeight が負の場合は上から下に書き込まれている
-		
-		// 画像の幅（ピクセル）
-		const int32 width	= header.biWidth;
-		
-		// 画像の高さ（ピクセル）
-		const int32 height	= (reverse ? header.biHeight : -header.biHeight);
+		const int32 width			= info.width;
+		const int32 height			= info.height;
+		const size_t strideBytes	= info.strideBytes;
+
+		// すべてのピクセルを上書きするので、初期化しない
+		Image image{ width, height, Uninitialized };
+
+		if (reader.isMapped())
+		{
+			// メモリマップされている場合は、ファイルのデータをコピーせずに直接変換する
+			const std::span<const std::byte> view = reader.view(info.pixelOffset, (static_cast<int64>(strideBytes) * height));
+
+			if (view.size() != (strideBytes * height))
+			{
+				return{};
+			}
 
-		// 1 ピクセルあたりのビット数
-		const int32 depth = header.biBitCount;
+			const uint8* pSrc = reinterpret_cast<const uint8*>(view.data());
 
-		// とりあえず 24 ビットのみ対応
-		if (depth != 24)
+			image.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						ConvertPixels(info, (pSrc + strideBytes * info.flipY(y)), image[y], width);
+					}
+				}, static_cast<int32>(GetRowsPerTask(strideBytes)));
+		}
+		else if (not reader.seek(info.pixelOffset))
 		{
 			return{};
 		}
+		else if (info.depth == 32)
+		{
+			// 32 ビットの 1 行は Color の並びと同じ大きさなので、画像のメモリに直接読み込んでから変換する
+			if (info.reverse)
+			{
+				for (int32 i = 0; i < height; ++i)
+				{
+					if (reader.read(image[info.flipY(i)], strideBytes) != static_cast<int64>(strideBytes))
+					{
+						return{};
+					}
+				}
+			}
+			else
+			{
+				const int64 sizeBytes = static_cast<int64>(strideBytes * height);
+
+				if (reader.read(image.data(), sizeBytes) != sizeBytes)
+				{
+					return{};
+				}
+			}
 
-		// 1 行分のデータのサイズ（バイト）
-		const size_t strideBytes = (width * 3 + width % 4);
+			image.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					ConvertPixels(info, reinterpret_cast<const uint8*>(image[beginY]), image[beginY], (static_cast<size_t>(endY - beginY) * width));
+				}, static_cast<int32>(GetRowsPerTask(strideBytes)));
+		}
+		else
+		{
+			// 複数行ずつまとめて読み込み、複数のスレッドで並列に変換する
+			const size_t numThreads = ThreadPool::Default().numThreads();
+			const int32 blockRows = std::max<int32>(1, static_cast<int32>((BlockSizeBytes * numThreads) / strideBytes));
+			const size_t rowsPerTask = GetRowsPerTask(strideBytes);
 
-		// 次の行へのオフセット
-		const int32 lineStep = (reverse ? -width : width);
+			std::vector<uint8> block(strideBytes * blockRows);
+
+			for (int32 y = 0; y < height; y += blockRows)
+			{
+				const int32 rows = std::min(blockRows, (height - y));
+				const int64 blockBytes = static_cast<int64>(strideBytes * rows);
 
-		Image image{ width, height };
+				if (reader.read(block.data(), blockBytes) != blockBytes)
+				{
+					return{};
+				}
+
+				ParallelFor(0, rows, [&](const size_t beginRow, const size_t endRow)
+					{
+						for (size_t i = beginRow; i < endRow; ++i)
+						{
+							ConvertPixels(info, (block.data() + strideBytes * i), image[info.flipY(y + static_cast<int32>(i))], width);
+						}
+					}, rowsPerTask);
+			}
+		}
+
+		FixAlpha(info, image);
+
+		return image;
+	}
+
+	Image LoadBMPRegion(const std::string_view path, const Rect& region)
+	{
+		BinaryFileReader reader{ path };
+
+		if (not reader.isOpen())
+		{
+			return{};
+		}
+
+		BMPInfo info;
+
+		if (not ReadBMPInfo(reader, info))
+		{
+			return{};
+		}
+
+		// 画像の範囲内に制限する
+		const Rect rect = region.intersection(Rect{ info.width, info.height });
+
+		if (rect.isEmpty())
+		{
+			return{};
+		}
 
-		// 書き込み先の行の先頭ポインタ
-		Color* pDstLine = image[reverse ? height - 1 : 0];
+		Image image{ rect.w, rect.h, Uninitialized };
 
-		std::vector<uint8> line(strideBytes);
+		// 1 行のうち、領域に含まれる部分のデータのサイズ（バイト）
+		const size_t lineBytes = (static_cast<size_t>(rect.w) * info.depth / 8);
 
-		for (int32 y = 0; y < height; ++y)
+		if (reader.isMapped())
 		{
-			// 1 行分のデータを読み込む
-			if (reader.read(line.data(), strideBytes) != strideBytes)
+			// メモリマップされている場合は、必要な部分だけを直接変換する
+			const std::span<const std::byte> view = reader.view();
+
+			// 領域の最後の行の終端がファイルに含まれていることを確認する
+			const int64 firstPos = info.pixelPosition(info.flipY(rect.y), rect.x);
+			const int64 lastPos = info.pixelPosition(info.flipY(rect.y + rect.h - 1), rect.x);
+
+			if (static_cast<int64>(view.size()) < static_cast<int64>(std::max(firstPos, lastPos) + lineBytes))
 			{
 				return{};
 			}
 
-			Color* pDst = pDstLine;
-			const uint8* pSrc = line.data();
+			image.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						const int64 pos = info.pixelPosition(info.flipY(rect.y + y), rect.x);
+
+						ConvertPixels(info, reinterpret_cast<const uint8*>(view.data() + pos), image[y], rect.w);
+					}
+				});
+		}
+		else
+		{
+			// 領域に含まれる部分だけを 1 行ずつ読み込む。32 ビットの場合は画像のメモリに直接読み込む
+			std::vector<uint8> line((info.depth == 32) ? 0 : lineBytes);
 
-			for (int32 x = 0; x < width; ++x)
+			for (int32 y = 0; y < rect.h; ++y)
 			{
-				pDst->b = *pSrc++;
-				pDst->g = *pSrc++;
-				pDst->r = *pSrc++;
+				const int64 pos = info.pixelPosition(info.flipY(rect.y + y), rect.x);
 
-				++pDst;
-			}
+				uint8* pLine = ((info.depth == 32) ? reinterpret_cast<uint8*>(image[y]) : line.data());
+
+				if (reader.readAt(pos, pLine, lineBytes) != static_cast<int64>(lineBytes))
+				{
+					return{};
+				}
 
-			// 書き込み先の行を次の行へ移動
-			pDstLine += lineStep;
+				ConvertPixels(info, pLine, image[y], rect.w);
+			}
 		}
 
+		FixAlpha(info, image);
+
 		return image;
 	}
+
+	class BMPRowReader::Impl
+	{
+	public:
+
+		[[nodiscard]]
+		bool isOpen() const noexcept
+		{
+			return m_reader.isOpen();
+		}
+
+		bool open(const std::string_view path)
+		{
+			close();
+
+			if (not m_reader.open(path))
+			{
+				return false;
+			}
+
+			if (not ReadBMPInfo(m_reader, m_info))
+			{
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void close()
+		{
+			m_reader.close();
+			m_info = BMPInfo{};
+			m_line.clear();
+			m_line.shrink_to_fit();
+			m_currentRow = 0;
+		}
+
+		[[nodiscard]]
+		int32 width() const noexcept
+		{
+			return m_info.width;
+		}
+
+		[[nodiscard]]
+		int32 height() const noexcept
+		{
+			return m_info.height;
+		}
+
+		bool readRow(Color* row, int32& y)
+		{
+			if ((not isOpen()) || (m_info.height <= m_currentRow))
+			{
+				return false;
+			}
+
+			const int64 pos = m_info.pixelPosition(m_currentRow, 0);
+			const size_t lineBytes = (static_cast<size_t>(m_info.width) * m_info.depth / 8);
+
+			if (m_reader.isMapped())
+			{
+				// メモリマップされている場合は、ファイルのデータをコピーせずに直接変換する
+				const std::span<const std::byte> view = m_reader.view(pos, lineBytes);
+
+				if (view.size() != lineBytes)
+				{
+					return false;
+				}
+
+				ConvertPixels(m_info, reinterpret_cast<const uint8*>(view.data()), row, m_info.width);
+			}
+			else
+			{
+				// 32 ビットの場合は行のバッファに直接読み込む
+				uint8* pLine = reinterpret_cast<uint8*>(row);
+
+				if (m_info.depth != 32)
+				{
+					m_line.resize(lineBytes);
+					pLine = m_line.data();
+				}
+
+				if (m_reader.readAt(pos, pLine, lineBytes) != static_cast<int64>(lineBytes))
+				{
+					return false;
+				}
+
+				ConvertPixels(m_info, pLine, row, m_info.width);
+			}
+
+			y = m_info.flipY(m_currentRow++);
+
+			return true;
+		}
+
+		void rewind() noexcept
+		{
+			m_currentRow = 0;
+		}
+
+		[[nodiscard]]
+		bool isComplete() const noexcept
+		{
+			return (isOpen() && (m_info.height <= m_currentRow));
+		}
+
+	private:
+
+		BinaryFileReader m_reader;
+
+		BMPInfo m_info;
+
+		// 8, 24 ビットの場合に、変換前の 1 行分のデータを格納するバッファ
+		std::vector<uint8> m_line;
+
+		// 次に読み込むファイル上の行
+		int32 m_currentRow = 0;
+	};
+
+	BMPRowReader::BMPRowReader()
+		: m_pImpl{ std::make_shared<Impl>() } {}
+
+	BMPRowReader::BMPRowReader(const std::string_view path)
+		: BMPRowReader{}
+	{
+		m_pImpl->open(path);
+	}
+
+	bool BMPRowReader::isOpen() const noexcept
+	{
+		return m_pImpl->isOpen();
+	}
+
+	BMPRowReader::operator bool() const noexcept
+	{
+		return m_pImpl->isOpen();
+	}
+
+	bool BMPRowReader::open(const std::string_view path)
+	{
+		return m_pImpl->open(path);
+	}
+
+	void BMPRowReader::close()
+	{
+		m_pImpl->close();
+	}
+
+	int32 BMPRowReader::width() const noexcept
+	{
+		return m_pImpl->width();
+	}
+
+	int32 BMPRowReader::height() const noexcept
+	{
+		return m_pImpl->height();
+	}
+
+	Size BMPRowReader::size() const noexcept
+	{
+		return{ m_pImpl->width(), m_pImpl->height() };
+	}
+
+	bool BMPRowReader::readRow(Color* row, int32& y)
+	{
+		return m_pImpl->readRow(row, y);
+	}
+
+	void BMPRowReader::rewind() noexcept
+	{
+		m_pImpl->rewind();
+	}
+
+	bool BMPRowReader::isComplete() const noexcept
+	{
+		return m_pImpl->isComplete();
+	}
 }
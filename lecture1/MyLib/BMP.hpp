@@ -1,20 +1,154 @@
 ﻿#pragma once
+#include <memory> // std::shared_ptr
 #include <string_view> // std::string_view
+#include <span> // std::span
+#include <vector> // std::vector
+#include <concepts> // std::invocable
 #include "Common.hpp"
+#include "Color.hpp"
+#include "Point.hpp"
+#include "Rect.hpp"
+#include "ImageView.hpp"
 
 namespace seccamp
 {
 	class Image; // 前方宣言
 
+	/// @brief BMP ファイルのピクセル形式
+	enum class BMPFormat : uint8
+	{
+		/// @brief 24 ビット（BGR）
+		BGR24,
+
+		/// @brief 32 ビット（BGRA）
+		BGRA32,
+
+		/// @brief 8 ビット（パレット）
+		Palette8,
+	};
+
 	/// @brief 画像を BMP 形式で保存します。
 	/// @param image 保存する画像
 	/// @param path 保存先のパス
+	/// @param format ピクセル形式
+	/// @param topDown 上の行から順に格納する場合 true, BMP の標準である下の行から順に格納する場合は false
+	/// @return 保存に成功した場合 true、それ以外の場合は false
+	/// @remark BMPFormat::Palette8 では、RGB 成分が 256 色以下の画像のみ保存できます。アルファ成分は保存されません。
+	bool SaveBMP(const Image& image, std::string_view path, BMPFormat format = BMPFormat::BGR24, bool topDown = false);
+
+	/// @brief ビューが参照する画像を BMP 形式で保存します。
+	/// @param image 保存する画像のビュー
+	/// @param path 保存先のパス
+	/// @param format ピクセル形式
+	/// @param topDown 上の行から順に格納する場合 true, BMP の標準である下の行から順に格納する場合は false
 	/// @return 保存に成功した場合 true、それ以外の場合は false
-	bool SaveBMP(const Image& image, std::string_view path);
+	/// @remark 画像の一部の領域を、コピーせずにそのまま保存できます。
+	bool SaveBMP(const ConstImageView& image, std::string_view path, BMPFormat format = BMPFormat::BGR24, bool topDown = false);
 
 	/// @brief BMP 形式の画像を読み込みます。
 	/// @param path 読み込む画像のパス
 	/// @return 読み込んだ画像。読み込みに失敗した場合は空の画像
+	/// @remark 非圧縮の 8 ビット（パレット）、24 ビット、32 ビットの画像に対応しています。
 	[[nodiscard]]
 	Image LoadBMP(std::string_view path);
+
+	/// @brief BMP 形式の画像の一部の領域を読み込みます。
+	/// @param path 読み込む画像のパス
+	/// @param region 読み込む領域。画像の範囲外の部分は無視されます
+	/// @return 読み込んだ画像。読み込みに失敗した場合や、領域が画像と重ならない場合は空の画像
+	/// @remark 領域に含まれる行と列のデータだけをファイルから読み込みます。
+	[[nodiscard]]
+	Image LoadBMPRegion(std::string_view path, const Rect& region);
+
+	/// @brief BMP 形式の画像を 1 行ずつ読み込むクラス
+	/// @remark 画像全体のメモリを確保せずに、1 行分のメモリで画像を処理できます。
+	class BMPRowReader
+	{
+	public:
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		BMPRowReader();
+
+		/// @brief BMP ファイルをオープンします。
+		/// @param path ファイルパス
+		[[nodiscard]]
+		explicit BMPRowReader(std::string_view path);
+
+		/// @brief ファイルがオープンされているかを返します。
+		/// @return オープンされている場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isOpen() const noexcept;
+
+		/// @brief ファイルがオープンされているかを返します。
+		/// @return オープンされている場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief BMP ファイルをオープンします。すでにオープンされている場合はクローズしてから再オープンします。
+		/// @param path ファイルパス
+		/// @return オープンに成功し、対応している形式のヘッダを読み込めた場合 true, それ以外の場合は false
+		bool open(std::string_view path);
+
+		/// @brief ファイルをクローズします。
+		void close();
+
+		/// @brief 画像の幅（ピクセル）を返します。
+		/// @return 画像の幅（ピクセル）。ファイルがオープンされていない場合は 0
+		[[nodiscard]]
+		int32 width() const noexcept;
+
+		/// @brief 画像の高さ（ピクセル）を返します。
+		/// @return 画像の高さ（ピクセル）。ファイルがオープンされていない場合は 0
+		[[nodiscard]]
+		int32 height() const noexcept;
+
+		/// @brief 画像の幅と高さ（ピクセル）を返します。
+		/// @return 画像の幅と高さ（ピクセル）。ファイルがオープンされていない場合は (0, 0)
+		[[nodiscard]]
+		Size size() const noexcept;
+
+		/// @brief 次の行を読み込みます。
+		/// @param row 読み込んだ行を格納するバッファ（width() ピクセル分）
+		/// @param y 読み込んだ行の画像上の位置（行）の格納先
+		/// @return 行を読み込んだ場合 true, すべての行を読み込み終えた場合や、読み込みに失敗した場合は false
+		/// @remark 行はファイルに格納されている順に読み込まれます。通常の BMP ファイルでは下の行から順になります。
+		/// @remark 32 ビットの画像のアルファ成分は、ファイルに格納されている値をそのまま返します。
+		bool readRow(Color* row, int32& y);
+
+		/// @brief 読み込み位置を最初の行に戻します。
+		void rewind() noexcept;
+
+		/// @brief 残りのすべての行を 1 行ずつ読み込み、関数に渡します。
+		/// @param callback 各行に対して呼ばれる関数。引数は行の画像上の位置（行）と、その行のピクセル
+		/// @return すべての行を読み込んだ場合 true, 読み込みに失敗した場合は false
+		/// @remark 関数に渡されるピクセルは、次の行を読み込むまで有効です。
+		bool readRows(std::invocable<int32, std::span<const Color>> auto callback)
+		{
+			if (not isOpen())
+			{
+				return false;
+			}
+
+			std::vector<Color> row(width());
+
+			for (int32 y = 0; readRow(row.data(), y);)
+			{
+				callback(y, std::span<const Color>{ row });
+			}
+
+			return isComplete();
+		}
+
+		/// @brief すべての行を読み込み終えたかを返します。
+		/// @return すべての行を読み込み終えた場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isComplete() const noexcept;
+
+	private:
+
+		class Impl;
+
+		std::shared_ptr<Impl> m_pImpl;
+	};
 }
@@ -1,7 +1,23 @@
 ﻿#include <fstream> // std::ifstream
+#include <cstring> // std::memcpy
+#include <algorithm> // std::min, std::max, std::clamp
+#include <mutex> // std::mutex, std::lock_guard
 #include "BinaryFileReader.hpp"
 #include "FileSystem.hpp"
 
+#if SECCAMP_PLATFORM(WINDOWS)
+	#define NOMINMAX
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h> // CreateFileW, CreateFileMappingW, MapViewOfFile, UnmapViewOfFile, GetFileType, ReadFile, CloseHandle
+	#include <filesystem> // std::filesystem::path
+#else
+	#include <cerrno> // errno, EINTR
+	#include <fcntl.h> // ::open
+	#include <unistd.h> // ::close, ::pread
+	#include <sys/mman.h> // ::mmap, ::munmap, ::madvise
+	#include <sys/stat.h> // ::fstat
+#endif
+
 namespace seccamp
 {
 	namespace
@@ -14,6 +30,13 @@ namespace seccamp
 		{
 			const int64 currentPos = file.tellg();
 
+			// パイプなどシークできないファイルの場合はサイズ不明として 0 を返す
+			if (currentPos < 0)
+			{
+				file.clear();
+				return 0;
+			}
+
 			file.seekg(0, std::ios::end);
 
 			const int64 size = file.tellg();
@@ -22,6 +45,337 @@ namespace seccamp
 
 			return size;
 		}
+
+		/// @brief 読み込み専用でメモリマップされたファイル
+		class MappedFile
+		{
+		public:
+
+			MappedFile() = default;
+
+			MappedFile(const MappedFile&) = delete;
+
+			MappedFile& operator =(const MappedFile&) = delete;
+
+			~MappedFile()
+			{
+				close();
+			}
+
+			/// @brief ファイルをメモリマップします。
+			/// @param path ファイルパス
+			/// @return メモリマップに成功した場合 true, それ以外の場合は false
+			bool open(const std::string_view path)
+			{
+				close();
+
+			#if SECCAMP_PLATFORM(WINDOWS)
+
+				const HANDLE file = ::CreateFileW(std::filesystem::path{ path }.c_str(), GENERIC_READ, FILE_SHARE_READ,
+					nullptr, OPEN_EXISTING, (FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN), nullptr);
+
+				if (file == INVALID_HANDLE_VALUE)
+				{
+					return false;
+				}
+
+				LARGE_INTEGER fileSize;
+
+				if (not ::GetFileSizeEx(file, &fileSize))
+				{
+					::CloseHandle(file);
+					return false;
+				}
+
+				// 空のファイルはマップできないので、マップせずに成功とする
+				if (fileSize.QuadPart == 0)
+				{
+					::CloseHandle(file);
+					m_isOpen = true;
+					return true;
+				}
+
+				const HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+				// マッピングオブジェクトがビューを保持するので、ファイルハンドルは不要
+				::CloseHandle(file);
+
+				if (mapping == nullptr)
+				{
+					return false;
+				}
+
+				void* pData = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+				// ビューがマッピングオブジェクトを保持するので、マッピングハンドルは不要
+				::CloseHandle(mapping);
+
+				if (pData == nullptr)
+				{
+					return false;
+				}
+
+				m_pData = static_cast<const std::byte*>(pData);
+				m_size = fileSize.QuadPart;
+
+			#else
+
+				const int fd = ::open(std::string{ path }.c_str(), O_RDONLY);
+
+				if (fd == -1)
+				{
+					return false;
+				}
+
+				struct stat st;
+
+				// 通常のファイル以外（パイプなど）はマップできない
+				if ((::fstat(fd, &st) != 0) || (not S_ISREG(st.st_mode)))
+				{
+					::close(fd);
+					return false;
+				}
+
+				// 空のファイルはマップできないので、マップせずに成功とする
+				if (st.st_size == 0)
+				{
+					::close(fd);
+					m_isOpen = true;
+					return true;
+				}
+
+				void* pData = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+				// マッピングがファイルを参照し続けるので、ファイルディスクリプタは不要
+				::close(fd);
+
+				if (pData == MAP_FAILED)
+				{
+					return false;
+				}
+
+				// 先頭から順に読まれることが多いので、先読みを促す
+				::madvise(pData, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+				m_pData = static_cast<const std::byte*>(pData);
+				m_size = st.st_size;
+
+			#endif
+
+				m_isOpen = true;
+				return true;
+			}
+
+			/// @brief メモリマップを解除します。
+			void close()
+			{
+				if (m_pData)
+				{
+				#if SECCAMP_PLATFORM(WINDOWS)
+					::UnmapViewOfFile(m_pData);
+				#else
+					::munmap(const_cast<std::byte*>(m_pData), static_cast<size_t>(m_size));
+				#endif
+				}
+
+				m_pData = nullptr;
+				m_size = 0;
+				m_isOpen = false;
+			}
+
+			[[nodiscard]]
+			bool isOpen() const noexcept
+			{
+				return m_isOpen;
+			}
+
+			[[nodiscard]]
+			const std::byte* data() const noexcept
+			{
+				return m_pData;
+			}
+
+			[[nodiscard]]
+			int64 size() const noexcept
+			{
+				return m_size;
+			}
+
+		private:
+
+			const std::byte* m_pData = nullptr;
+
+			int64 m_size = 0;
+
+			bool m_isOpen = false;
+		};
+
+		/// @brief 読み込み位置を持たずに、指定した位置から読み込むためのファイル
+		/// @remark ストリームとは別にファイルを開くので、ストリームの読み込み位置に影響せず、複数のスレッドから同時に読み込めます。
+		class PositionalFile
+		{
+		public:
+
+			PositionalFile() = default;
+
+			PositionalFile(const PositionalFile&) = delete;
+
+			PositionalFile& operator =(const PositionalFile&) = delete;
+
+			~PositionalFile()
+			{
+				close();
+			}
+
+			/// @brief ファイルを開きます。
+			/// @param path ファイルパス
+			/// @return 開くことに成功した場合 true, それ以外の場合は false
+			bool open(const std::string_view path)
+			{
+				close();
+
+			#if SECCAMP_PLATFORM(WINDOWS)
+
+				const HANDLE file = ::CreateFileW(std::filesystem::path{ path }.c_str(), GENERIC_READ, FILE_SHARE_READ,
+					nullptr, OPEN_EXISTING, (FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS), nullptr);
+
+				if (file == INVALID_HANDLE_VALUE)
+				{
+					return false;
+				}
+
+				// 通常のファイル以外（パイプなど）は位置を指定して読み込めない
+				if (::GetFileType(file) != FILE_TYPE_DISK)
+				{
+					::CloseHandle(file);
+					return false;
+				}
+
+				m_file = file;
+
+			#else
+
+				// パイプを開くときに書き込み側を待たないよう、O_NONBLOCK を指定する（通常のファイルの読み込みには影響しない）
+				const int fd = ::open(std::string{ path }.c_str(), (O_RDONLY | O_NONBLOCK));
+
+				if (fd == -1)
+				{
+					return false;
+				}
+
+				struct stat st;
+
+				// 通常のファイル以外（パイプなど）は位置を指定して読み込めない
+				if ((::fstat(fd, &st) != 0) || (not S_ISREG(st.st_mode)))
+				{
+					::close(fd);
+					return false;
+				}
+
+				m_fd = fd;
+
+			#endif
+
+				return true;
+			}
+
+			/// @brief ファイルを閉じます。
+			void close()
+			{
+			#if SECCAMP_PLATFORM(WINDOWS)
+
+				if (m_file != INVALID_HANDLE_VALUE)
+				{
+					::CloseHandle(m_file);
+					m_file = INVALID_HANDLE_VALUE;
+				}
+
+			#else
+
+				if (m_fd != -1)
+				{
+					::close(m_fd);
+					m_fd = -1;
+				}
+
+			#endif
+			}
+
+			/// @brief ファイルの指定した位置からデータを読み込みます。
+			/// @param offset 読み込みを開始する位置（バイト）
+			/// @param data 読み込んだデータを格納するバッファ
+			/// @param size データのサイズ（バイト）
+			/// @return 読み込んだバイト数
+			[[nodiscard]]
+			int64 readAt(const int64 offset, void* data, const size_t size) const noexcept
+			{
+				std::byte* pDst = static_cast<std::byte*>(data);
+				size_t readBytes = 0;
+
+				// 1 回の呼び出しで全体が読み込まれるとは限らないので、終端に達するまで繰り返す
+				while (readBytes < size)
+				{
+				#if SECCAMP_PLATFORM(WINDOWS)
+
+					OVERLAPPED overlapped{};
+					const uint64 pos = static_cast<uint64>(offset + static_cast<int64>(readBytes));
+					overlapped.Offset = static_cast<DWORD>(pos);
+					overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+
+					const DWORD chunkSize = static_cast<DWORD>(std::min<size_t>((size - readBytes), 0x40000000));
+					DWORD chunkReadBytes = 0;
+
+					if ((not ::ReadFile(m_file, (pDst + readBytes), chunkSize, &chunkReadBytes, &overlapped))
+						|| (chunkReadBytes == 0))
+					{
+						break;
+					}
+
+				#else
+
+					const ssize_t chunkReadBytes = ::pread(m_fd, (pDst + readBytes), (size - readBytes), static_cast<off_t>(offset + static_cast<int64>(readBytes)));
+
+					if (chunkReadBytes < 0)
+					{
+						if (errno == EINTR)
+						{
+							continue;
+						}
+
+						break;
+					}
+
+					if (chunkReadBytes == 0)
+					{
+						break;
+					}
+
+				#endif
+
+					readBytes += static_cast<size_t>(chunkReadBytes);
+				}
+
+				return static_cast<int64>(readBytes);
+			}
+
+			[[nodiscard]]
+			bool isOpen() const noexcept
+			{
+			#if SECCAMP_PLATFORM(WINDOWS)
+				return (m_file != INVALID_HANDLE_VALUE);
+			#else
+				return (m_fd != -1);
+			#endif
+			}
+
+		private:
+
+		#if SECCAMP_PLATFORM(WINDOWS)
+			HANDLE m_file = INVALID_HANDLE_VALUE;
+		#else
+			int m_fd = -1;
+		#endif
+		};
 	}
 
 	class BinaryFileReader::Impl
@@ -38,16 +392,26 @@ namespace seccamp
 		[[nodiscard]]
 		bool isOpen() const noexcept
 		{
-			return m_file.is_open();
+			return (m_mappedFile.isOpen() || m_file.is_open());
 		}
 
 		bool open(const std::string_view path)
 		{
-			if (m_file.is_open())
+			if (isOpen())
 			{
 				close();
 			}
 
+			// まずメモリマップを試み、失敗した場合は通常のファイル読み込みにフォールバックする
+			if (m_mappedFile.open(path))
+			{
+				m_fullPath = FileSystem::FullPath(path);
+
+				m_size = m_mappedFile.size();
+
+				return true;
+			}
+
 			m_file.open(std::string{ path }, std::ios::binary);
 
 			if (m_file.is_open())
@@ -56,6 +420,9 @@ namespace seccamp
 				
 				m_size = GetFileSize(m_file);
 
+				// readAt() がストリームの読み込み位置を使わないよう、別にファイルを開いておく。パイプなどでは失敗する
+				m_positionalFile.open(path);
+
 				return true;
 			}
 			else
@@ -66,13 +433,40 @@ namespace seccamp
 
 		void close()
 		{
+			m_mappedFile.close();
+
 			m_file.close();
 
+			m_positionalFile.close();
+
 			m_size = 0;
 
+			m_pos = 0;
+
 			m_fullPath.clear();
 		}
 
+		[[nodiscard]]
+		bool isMapped() const noexcept
+		{
+			return m_mappedFile.isOpen();
+		}
+
+		[[nodiscard]]
+		std::span<const std::byte> view() const noexcept
+		{
+			return{ m_mappedFile.data(), static_cast<size_t>(m_mappedFile.size()) };
+		}
+
+		[[nodiscard]]
+		std::span<const std::byte> view(const int64 offset, const int64 size) const noexcept
+		{
+			const int64 fileSize = m_mappedFile.size();
+			const int64 first = std::clamp<int64>(offset, 0, fileSize);
+			const int64 length = std::min<int64>(std::max<int64>(size, 0), (fileSize - first));
+			return view().subspan(static_cast<size_t>(first), static_cast<size_t>(length));
+		}
+
 		[[nodiscard]]
 		int64 size() const noexcept
 		{
@@ -82,11 +476,90 @@ namespace seccamp
 		[[nodiscard]]
 		int64 read(void* data, const size_t size)
 		{
+			if (m_mappedFile.isOpen())
+			{
+				const int64 readBytes = readAt(m_pos, data, size);
+
+				m_pos += readBytes;
+
+				return readBytes;
+			}
+
+			std::lock_guard lock{ m_streamMutex };
+
 			m_file.read(static_cast<char*>(data), size);
 
 			return m_file.gcount();
 		}
 
+		[[nodiscard]]
+		int64 readAt(const int64 offset, void* data, const size_t size)
+		{
+			if (m_mappedFile.isOpen())
+			{
+				// マップされた領域から直接コピーする。読み込み位置を使わないので、複数のスレッドから同時に呼び出せる
+				if ((offset < 0) || (m_size <= offset))
+				{
+					return 0;
+				}
+
+				const int64 readBytes = std::min<int64>(size, (m_size - offset));
+
+				std::memcpy(data, (m_mappedFile.data() + offset), static_cast<size_t>(readBytes));
+
+				return readBytes;
+			}
+
+			// 別に開いたファイルから読み込む。ストリームの読み込み位置を使わないので、複数のスレッドから同時に呼び出せる
+			if ((not m_positionalFile.isOpen()) || (offset < 0))
+			{
+				return 0;
+			}
+
+			return m_positionalFile.readAt(offset, data, size);
+		}
+
+		bool seek(const int64 pos)
+		{
+			if ((pos < 0) || (m_size < pos))
+			{
+				return false;
+			}
+
+			if (m_mappedFile.isOpen())
+			{
+				m_pos = pos;
+				return true;
+			}
+
+			std::lock_guard lock{ m_streamMutex };
+
+			m_file.clear();
+
+			return static_cast<bool>(m_file.seekg(pos));
+		}
+
+		[[nodiscard]]
+		int64 position()
+		{
+			if (m_mappedFile.isOpen())
+			{
+				return m_pos;
+			}
+
+			if (not m_file.is_open())
+			{
+				return 0;
+			}
+
+			std::lock_guard lock{ m_streamMutex };
+
+			// EOF に達した後でも位置を取得できるように、状態をクリアする
+			m_file.clear();
+
+			return static_cast<int64>(m_file.tellg());
+		}
+
 		[[nodiscard]]
 		const std::string& fullPath() const noexcept
 		{
@@ -95,10 +568,21 @@ namespace seccamp
 
 	private:
 
+		MappedFile m_mappedFile;
+
 		std::ifstream m_file;
 
+		// メモリマップされていない場合に、readAt() で使うファイル
+		PositionalFile m_positionalFile;
+
 		int64 m_size = 0;
 
+		// メモリマップ時の読み込み位置（バイト）
+		int64 m_pos = 0;
+
+		// メモリマップされていない場合に、ストリームの読み込み位置を保護する
+		std::mutex m_streamMutex;
+
 		std::string m_fullPath;
 	};
 
@@ -141,6 +625,41 @@ namespace seccamp
 		return m_pImpl->read(data, size);
 	}
 
+	int64 BinaryFileReader::readAt(const int64 offset, void* data, const size_t size) const
+	{
+		return m_pImpl->readAt(offset, data, size);
+	}
+
+	bool BinaryFileReader::seek(const int64 pos)
+	{
+		return m_pImpl->seek(pos);
+	}
+
+	bool BinaryFileReader::skip(const int64 offset)
+	{
+		return m_pImpl->seek(m_pImpl->position() + offset);
+	}
+
+	int64 BinaryFileReader::position() const
+	{
+		return m_pImpl->position();
+	}
+
+	bool BinaryFileReader::isMapped() const noexcept
+	{
+		return m_pImpl->isMapped();
+	}
+
+	std::span<const std::byte> BinaryFileReader::view() const noexcept
+	{
+		return m_pImpl->view();
+	}
+
+	std::span<const std::byte> BinaryFileReader::view(const int64 offset, const int64 size) const noexcept
+	{
+		return m_pImpl->view(offset, size);
+	}
+
 	const std::string& BinaryFileReader::fullPath() const noexcept
 	{
 		return m_pImpl->fullPath();
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include <memory> // std::shared_ptr, std::addressof
+#include <span> // std::span
+#include <cstddef> // std::byte
 #include <string_view> // std::string_view
 #include <string> // std::string
 #include <type_traits> // std::is_trivially_copyable_v
@@ -48,6 +50,7 @@ namespace seccamp
 		/// @param data 読み込んだデータを格納するバッファ
 		/// @param size データのサイズ（バイト）
 		/// @return 読み込んだバイト数
+		/// @remark 読み込み位置はコピー間で共有されるため、複数のスレッドから読み込む場合は readAt() を使ってください。
 		int64 read(void* data, size_t size);
 
 		/// @brief ファイルからデータを読み込みます。
@@ -61,6 +64,62 @@ namespace seccamp
 			return read(std::addressof(data), sizeof(T));
 		}
 
+		/// @brief ファイルの指定した位置からデータを読み込みます。
+		/// @param offset 読み込みを開始する位置（バイト）
+		/// @param data 読み込んだデータを格納するバッファ
+		/// @param size データのサイズ（バイト）
+		/// @return 読み込んだバイト数
+		/// @remark 読み込み位置は変更されません。同じ BinaryFileReader（およびそのコピー）に対して複数のスレッドから同時に呼び出すことができます。
+		int64 readAt(int64 offset, void* data, size_t size) const;
+
+		/// @brief ファイルの指定した位置からデータを読み込みます。
+		/// @tparam T 読み込むデータの型
+		/// @param offset 読み込みを開始する位置（バイト）
+		/// @param data 読み込んだデータを格納する変数
+		/// @return 読み込んだバイト数
+		/// @remark 読み込み位置は変更されません。同じ BinaryFileReader（およびそのコピー）に対して複数のスレッドから同時に呼び出すことができます。
+		template <class T>
+			requires std::is_trivially_copyable_v<T>
+		int64 readAt(int64 offset, T& data) const
+		{
+			return readAt(offset, std::addressof(data), sizeof(T));
+		}
+
+		/// @brief 読み込み位置を変更します。
+		/// @param pos 新しい読み込み位置（ファイルの先頭からのバイト数）
+		/// @return 成功した場合 true, それ以外の場合は false
+		bool seek(int64 pos);
+
+		/// @brief 読み込み位置を進めます。
+		/// @param offset 読み込み位置を進めるバイト数。負の場合は戻します
+		/// @return 成功した場合 true, それ以外の場合は false
+		bool skip(int64 offset);
+
+		/// @brief 現在の読み込み位置を返します。
+		/// @return 現在の読み込み位置（ファイルの先頭からのバイト数）
+		[[nodiscard]]
+		int64 position() const;
+
+		/// @brief ファイルがメモリマップされているかを返します。
+		/// @return メモリマップされている場合 true, それ以外の場合は false
+		/// @remark メモリマップに失敗した場合は通常のファイル読み込みにフォールバックします。
+		[[nodiscard]]
+		bool isMapped() const noexcept;
+
+		/// @brief ファイル全体のデータをコピーせずに参照するビューを返します。
+		/// @return ファイル全体のデータへのビュー。ファイルがメモリマップされていない場合は空のビュー
+		/// @remark ビューはファイルがクローズされるまで有効です。
+		[[nodiscard]]
+		std::span<const std::byte> view() const noexcept;
+
+		/// @brief ファイルの指定した範囲のデータをコピーせずに参照するビューを返します。
+		/// @param offset 範囲の先頭位置（バイト）
+		/// @param size 範囲のサイズ（バイト）
+		/// @return 指定した範囲のデータへのビュー。ファイルの終端を超える部分は含まれません。ファイルがメモリマップされていない場合は空のビュー
+		/// @remark ビューはファイルがクローズされるまで有効です。
+		[[nodiscard]]
+		std::span<const std::byte> view(int64 offset, int64 size) const noexcept;
+
 		/// @brief ファイルの絶対パスを返します。
 		/// @return ファイルの絶対パス。ファイルがオープンされていない場合は空文字列
 		[[nodiscard]]
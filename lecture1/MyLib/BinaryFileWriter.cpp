@@ -1,4 +1,10 @@
 ﻿#include <fstream> // std::ofstream
+#include <vector> // std::vector
+#include <cstring> // std::memcpy
+#include <algorithm> // std::min
+#include <thread> // std::thread
+#include <mutex> // std::mutex, std::unique_lock
+#include <condition_variable> // std::condition_variable
 #include "BinaryFileWriter.hpp"
 #include "FileSystem.hpp"
 
@@ -21,18 +27,26 @@ namespace seccamp
 			return m_file.is_open();
 		}
 
-		bool open(const std::string_view path)
+		bool open(const std::string_view path, const WriteMode mode)
 		{
 			if (m_file.is_open())
 			{
 				close();
 			}
 
+			// 前のファイルのデータが新しいファイルに書き込まれないようにする
+			m_bufferedBytes = 0;
+
 			m_file.open(std::string{ path }, std::ios::binary);
 
 			if (m_file.is_open())
 			{
 				m_fullPath = FileSystem::FullPath(path);
+
+				if (mode == WriteMode::Async)
+				{
+					startIOThread();
+				}
 				
 				return true;
 			}
@@ -44,14 +58,106 @@ namespace seccamp
 
 		void close()
 		{
+			flushBuffer();
+
+			stopIOThread();
+
 			m_file.close();
 
 			m_fullPath.clear();
 		}
 
-		void write(const void* data, const size_t size)
+		int64 write(const void* data, const size_t size)
 		{
+			// オープンされていない場合はバッファにも格納せず、次にオープンしたファイルに書き込まれないようにする
+			if (not m_file.is_open())
+			{
+				return 0;
+			}
+
+			if (m_ioThread.joinable())
+			{
+				writeAsync(static_cast<const char*>(data), size);
+				return static_cast<int64>(size);
+			}
+
+			// バッファに収まる場合はバッファにまとめる
+			if (size < m_buffer.size())
+			{
+				if ((m_buffer.size() - m_bufferedBytes) < size)
+				{
+					flushBuffer();
+				}
+
+				std::memcpy((m_buffer.data() + m_bufferedBytes), data, size);
+
+				m_bufferedBytes += size;
+
+				return static_cast<int64>(size);
+			}
+
+			// バッファより大きいデータは、先にバッファを書き出してから直接書き込む
+			flushBuffer();
+
 			m_file.write(static_cast<const char*>(data), size);
+
+			return static_cast<int64>(size);
+		}
+
+		bool flush()
+		{
+			waitForCompletion();
+
+			m_file.flush();
+
+			// 書き込みに失敗するとストリームの状態に残るので、I/O スレッドでの失敗もここで分かる
+			return (m_file.is_open() && m_file.good());
+		}
+
+		void waitForCompletion()
+		{
+			flushBuffer();
+
+			if (m_ioThread.joinable())
+			{
+				std::unique_lock lock{ m_mutex };
+
+				m_condition.wait(lock, [this]() { return (m_pendingBytes == 0); });
+			}
+		}
+
+		void reserve(size_t bufferSize)
+		{
+			waitForCompletion();
+
+			// 非同期書き込みではバッファを交互に使うので、バッファリングなしにはできない
+			if (m_ioThread.joinable() && (bufferSize == 0))
+			{
+				bufferSize = DefaultBufferSize;
+			}
+
+			m_buffer.resize(bufferSize);
+
+			m_buffer.shrink_to_fit();
+
+			if (m_ioThread.joinable())
+			{
+				m_pendingBuffer.resize(bufferSize);
+
+				m_pendingBuffer.shrink_to_fit();
+			}
+		}
+
+		[[nodiscard]]
+		size_t bufferSize() const noexcept
+		{
+			return m_buffer.size();
+		}
+
+		[[nodiscard]]
+		WriteMode writeMode() const noexcept
+		{
+			return (m_ioThread.joinable() ? WriteMode::Async : WriteMode::Sync);
 		}
 
 		[[nodiscard]]
@@ -62,18 +168,168 @@ namespace seccamp
 
 	private:
 
+		/// @brief バッファに格納されているデータをファイルに書き込みます。
+		/// @remark 非同期書き込みの場合は I/O スレッドにバッファを渡します。
+		void flushBuffer()
+		{
+			if (m_bufferedBytes == 0)
+			{
+				return;
+			}
+
+			if (m_ioThread.joinable())
+			{
+				submitBuffer();
+				return;
+			}
+
+			m_file.write(m_buffer.data(), m_bufferedBytes);
+
+			m_bufferedBytes = 0;
+		}
+
+		/// @brief データをバッファに書き込み、バッファがいっぱいになったら I/O スレッドに渡します。
+		/// @param data 書き込むデータ
+		/// @param size データのサイズ（バイト）
+		void writeAsync(const char* data, size_t size)
+		{
+			while (size != 0)
+			{
+				const size_t copyBytes = std::min(size, (m_buffer.size() - m_bufferedBytes));
+
+				std::memcpy((m_buffer.data() + m_bufferedBytes), data, copyBytes);
+
+				m_bufferedBytes += copyBytes;
+				data += copyBytes;
+				size -= copyBytes;
+
+				if (m_bufferedBytes == m_buffer.size())
+				{
+					submitBuffer();
+				}
+			}
+		}
+
+		/// @brief 書き込み中のバッファと書き込み待ちのバッファを交換し、I/O スレッドに書き込みを依頼します。
+		/// @remark I/O スレッドが前のバッファを書き込み中の場合は、完了するまで待機します。
+		void submitBuffer()
+		{
+			std::unique_lock lock{ m_mutex };
+
+			// 両方のバッファが使用中の場合は待機する
+			m_condition.wait(lock, [this]() { return (m_pendingBytes == 0); });
+
+			m_buffer.swap(m_pendingBuffer);
+
+			m_pendingBytes = m_bufferedBytes;
+
+			m_bufferedBytes = 0;
+
+			m_condition.notify_all();
+		}
+
+		/// @brief I/O スレッドを開始します。
+		void startIOThread()
+		{
+			if (m_buffer.empty())
+			{
+				m_buffer.resize(DefaultBufferSize);
+			}
+
+			m_pendingBuffer.resize(m_buffer.size());
+
+			m_stopRequested = false;
+
+			m_ioThread = std::thread{ [this]() { ioThreadMain(); } };
+		}
+
+		/// @brief I/O スレッドを終了します。
+		void stopIOThread()
+		{
+			if (not m_ioThread.joinable())
+			{
+				return;
+			}
+
+			{
+				std::lock_guard lock{ m_mutex };
+
+				m_stopRequested = true;
+
+				m_condition.notify_all();
+			}
+
+			m_ioThread.join();
+
+			m_pendingBuffer.clear();
+
+			m_pendingBuffer.shrink_to_fit();
+		}
+
+		/// @brief I/O スレッドの処理
+		void ioThreadMain()
+		{
+			std::unique_lock lock{ m_mutex };
+
+			for (;;)
+			{
+				m_condition.wait(lock, [this]() { return ((m_pendingBytes != 0) || m_stopRequested); });
+
+				if (m_pendingBytes != 0)
+				{
+					const size_t pendingBytes = m_pendingBytes;
+
+					// ファイルへの書き込み中は、呼び出し元のスレッドが m_buffer に書き込めるようにロックを解除する
+					lock.unlock();
+
+					m_file.write(m_pendingBuffer.data(), pendingBytes);
+
+					lock.lock();
+
+					m_pendingBytes = 0;
+
+					m_condition.notify_all();
+				}
+				else
+				{
+					return;
+				}
+			}
+		}
+
 		std::ofstream m_file;
 
+		// 書き込み待ちのデータを格納するバッファ
+		std::vector<char> m_buffer = std::vector<char>(DefaultBufferSize);
+
+		// バッファに格納されているデータのサイズ（バイト）
+		size_t m_bufferedBytes = 0;
+
 		std::string m_fullPath;
+
+		// 非同期書き込みで I/O スレッドがファイルに書き込むバッファ
+		std::vector<char> m_pendingBuffer;
+
+		// I/O スレッドが書き込むデータのサイズ（バイト）。0 の場合は I/O スレッドは待機中
+		size_t m_pendingBytes = 0;
+
+		// I/O スレッドに終了を要求するフラグ
+		bool m_stopRequested = false;
+
+		std::mutex m_mutex;
+
+		std::condition_variable m_condition;
+
+		std::thread m_ioThread;
 	};
 
 	BinaryFileWriter::BinaryFileWriter()
 		: m_pImpl{ std::make_shared<Impl>() } {}
 
-	BinaryFileWriter::BinaryFileWriter(const std::string_view path)
+	BinaryFileWriter::BinaryFileWriter(const std::string_view path, const WriteMode mode)
 		: BinaryFileWriter{} // 移譲コンストラクタ
 	{
-		m_pImpl->open(path);
+		m_pImpl->open(path, mode);
 	}
 
 	bool BinaryFileWriter::isOpen() const noexcept
@@ -86,9 +342,9 @@ namespace seccamp
 		return m_pImpl->isOpen();
 	}
 
-	bool BinaryFileWriter::open(const std::string_view path)
+	bool BinaryFileWriter::open(const std::string_view path, const WriteMode mode)
 	{
-		return m_pImpl->open(path);
+		return m_pImpl->open(path, mode);
 	}
 
 	void BinaryFileWriter::close()
@@ -101,8 +357,50 @@ namespace seccamp
 		return m_pImpl->fullPath();
 	}
 
-	void BinaryFileWriter::write(const void* data, const size_t size)
+	int64 BinaryFileWriter::write(const void* data, const size_t size)
+	{
+		return m_pImpl->write(data, size);
+	}
+
+	int64 BinaryFileWriter::write(const std::initializer_list<std::span<const std::byte>> buffers)
+	{
+		return write(std::span{ buffers.begin(), buffers.end() });
+	}
+
+	int64 BinaryFileWriter::write(const std::span<const std::span<const std::byte>> buffers)
+	{
+		int64 writtenBytes = 0;
+
+		for (const auto& buffer : buffers)
+		{
+			writtenBytes += m_pImpl->write(buffer.data(), buffer.size());
+		}
+
+		return writtenBytes;
+	}
+
+	bool BinaryFileWriter::flush()
+	{
+		return m_pImpl->flush();
+	}
+
+	void BinaryFileWriter::waitForCompletion()
+	{
+		m_pImpl->waitForCompletion();
+	}
+
+	WriteMode BinaryFileWriter::writeMode() const noexcept
+	{
+		return m_pImpl->writeMode();
+	}
+
+	void BinaryFileWriter::reserve(const size_t bufferSize)
+	{
+		m_pImpl->reserve(bufferSize);
+	}
+
+	size_t BinaryFileWriter::bufferSize() const noexcept
 	{
-		m_pImpl->write(data, size);
+		return m_pImpl->bufferSize();
 	}
 }
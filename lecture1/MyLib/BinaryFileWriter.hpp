@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include <memory> // std::shared_ptr, std::addressof
+#include <span> // std::span
+#include <cstddef> // std::byte
+#include <initializer_list> // std::initializer_list
 #include <string_view> // std::string_view
 #include <string> // std::string
 #include <type_traits> // std::is_trivially_copyable_v
@@ -7,19 +10,33 @@
 
 namespace seccamp
 {
+	/// @brief ファイルへの書き込み方法
+	enum class WriteMode : uint8
+	{
+		/// @brief 呼び出し元のスレッドでファイルに書き込みます。
+		Sync,
+
+		/// @brief 2 つのバッファを交互に使い、一方を専用の I/O スレッドがファイルに書き込んでいる間に、もう一方に書き込みます。
+		Async,
+	};
+
 	/// @brief バイナリファイルを書き出すクラス
 	class BinaryFileWriter
 	{
 	public:
 
+		/// @brief 内部バッファのデフォルトのサイズ（バイト）
+		static constexpr size_t DefaultBufferSize = (1 << 20);
+
 		/// @brief デフォルトコンストラクタ
 		[[nodiscard]]
 		BinaryFileWriter();
 		
 		/// @brief ファイルを作成してオープンします。
 		/// @param path ファイルパス
+		/// @param mode 書き込み方法
 		[[nodiscard]]
-		explicit BinaryFileWriter(std::string_view path);
+		explicit BinaryFileWriter(std::string_view path, WriteMode mode = WriteMode::Sync);
 
 		/// @brief ファイルがオープンされているかを返します。
 		/// @return オープンされている場合 true, それ以外の場合は false
@@ -33,27 +50,66 @@ namespace seccamp
 
 		/// @brief ファイルをオープンします。すでにオープンされている場合はクローズしてから再オープンします。
 		/// @param path ファイルパス
+		/// @param mode 書き込み方法
 		/// @return オープンに成功した場合 true, それ以外の場合は false
-		bool open(std::string_view path);
+		bool open(std::string_view path, WriteMode mode = WriteMode::Sync);
 
 		/// @brief ファイルをクローズします。
+		/// @remark 内部バッファに残っているデータはクローズ前に書き出されます。
 		void close();
 
 		/// @brief ファイルにデータを書き込みます。
 		/// @param data 書き込むデータ
 		/// @param size データのサイズ（バイト）
-		void write(const void* data, size_t size);
+		/// @return 書き込んだバイト数。ファイルがオープンされていない場合は 0
+		/// @remark 内部バッファのサイズより小さいデータはバッファにまとめられ、バッファがいっぱいになったときに書き出されます。
+		int64 write(const void* data, size_t size);
+
+		/// @brief 複数の領域のデータを順番にファイルに書き込みます。
+		/// @param buffers 書き込むデータの領域の一覧
+		/// @return 書き込んだバイト数の合計。ファイルがオープンされていない場合は 0
+		int64 write(std::initializer_list<std::span<const std::byte>> buffers);
+
+		/// @brief 複数の領域のデータを順番にファイルに書き込みます。
+		/// @param buffers 書き込むデータの領域の一覧
+		/// @return 書き込んだバイト数の合計。ファイルがオープンされていない場合は 0
+		int64 write(std::span<const std::span<const std::byte>> buffers);
 
 		/// @brief ファイルにデータを書き込みます。
 		/// @tparam T 書き込むデータの型
 		/// @param data 書き込むデータ
+		/// @return 書き込んだバイト数。ファイルがオープンされていない場合は 0
 		template <class T>
 			requires std::is_trivially_copyable_v<T>
-		void write(const T& data)
+		int64 write(const T& data)
 		{
-			write(std::addressof(data), sizeof(T));
+			return write(std::addressof(data), sizeof(T));
 		}
 
+		/// @brief 内部バッファのデータをファイルに書き出します。
+		/// @return それまでに書き込んだデータをすべてファイルに書き出せた場合 true, ディスクの空きが無いなどで書き出しに失敗していた場合や、ファイルがオープンされていない場合は false
+		/// @remark WriteMode::Async の場合は、書き込みが完了するまで待機します。
+		bool flush();
+
+		/// @brief それまでに書き込んだデータがすべてファイルに渡されるまで待機します。
+		/// @remark WriteMode::Sync の場合は、内部バッファのデータを書き出します。
+		void waitForCompletion();
+
+		/// @brief 書き込み方法を返します。
+		/// @return 書き込み方法
+		[[nodiscard]]
+		WriteMode writeMode() const noexcept;
+
+		/// @brief 内部バッファのサイズを変更します。
+		/// @param bufferSize 新しい内部バッファのサイズ（バイト）。0 の場合はバッファリングを行いません
+		/// @remark 内部バッファに残っているデータは変更前に書き出されます。WriteMode::Async の場合、0 は DefaultBufferSize として扱われます。
+		void reserve(size_t bufferSize);
+
+		/// @brief 内部バッファのサイズ（バイト）を返します。
+		/// @return 内部バッファのサイズ（バイト）
+		[[nodiscard]]
+		size_t bufferSize() const noexcept;
+
 		/// @brief ファイルの絶対パスを返します。
 		/// @return ファイルの絶対パス。ファイルがオープンされていない場合は空文字列
 		[[nodiscard]]
@@ -0,0 +1,892 @@
+﻿#include <algorithm> // std::min
+#include <array> // std::array
+#include "Blend.hpp"
+#include "CPU.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_mullo_epi16, _mm_div_ps, _mm256_mullo_epi16, _mm256_div_ps
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vld4q_u8, vst4q_u8, vmull_u8, vraddhn_u16, vdivq_f32
+#endif
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 一度に合成するピクセル数（単色の合成で使う作業用のバッファの大きさ）
+		constexpr size_t ColorChunkPixels = 64;
+
+		using BlendFunction = void(*)(const Color*, Color*, size_t);
+
+		using AlphaFunction = void(*)(const Color*, Color*, size_t);
+
+		/// @brief x × y / 255 を正確に四捨五入して求めます。
+		/// @param x 値 [0, 255]
+		/// @param y 値 [0, 255]
+		/// @return x × y / 255 を四捨五入した値
+		/// @remark t = x × y + 128 とすると、(t + (t >> 8)) >> 8 は t / 255 の切り捨てと一致します。
+		[[nodiscard]]
+		constexpr uint32 MulDiv255(const uint32 x, const uint32 y) noexcept
+		{
+			const uint32 t = (x * y + 128);
+			return ((t + (t >> 8)) >> 8);
+		}
+
+		[[nodiscard]]
+		constexpr Color Premultiply(const Color& c) noexcept
+		{
+			return Color{ static_cast<uint8>(MulDiv255(c.r, c.a)), static_cast<uint8>(MulDiv255(c.g, c.a)), static_cast<uint8>(MulDiv255(c.b, c.a)), c.a };
+		}
+
+		/// @brief c × 255 / a を四捨五入します。
+		[[nodiscard]]
+		constexpr uint8 DivideByAlpha(const uint32 c, const uint32 a) noexcept
+		{
+			return static_cast<uint8>(std::min<uint32>((((c * 255 * 2) + a) / (a * 2)), 255));
+		}
+
+		[[nodiscard]]
+		constexpr Color Unpremultiply(const Color& c) noexcept
+		{
+			if (c.a == 0)
+			{
+				return Color{ 0, 0, 0, 0 };
+			}
+
+			return Color{ DivideByAlpha(c.r, c.a), DivideByAlpha(c.g, c.a), DivideByAlpha(c.b, c.a), c.a };
+		}
+
+		/// @brief アルファ乗算済みの 1 成分を合成します。
+		/// @param s 上に重ねる成分
+		/// @param d 下の成分
+		/// @param sa 上に重ねる色のアルファ成分
+		/// @param da 下の色のアルファ成分
+		/// @return 合成した成分
+		template <BlendMode Mode>
+		[[nodiscard]]
+		constexpr uint8 BlendChannel(const uint32 s, const uint32 d, const uint32 sa, const uint32 da) noexcept
+		{
+			if constexpr (Mode == BlendMode::SourceOver)
+			{
+				return static_cast<uint8>(std::min<uint32>((s + MulDiv255(d, (255 - sa))), 255));
+			}
+			else if constexpr (Mode == BlendMode::Add)
+			{
+				return static_cast<uint8>(std::min<uint32>((s + d), 255));
+			}
+			else if constexpr (Mode == BlendMode::Multiply)
+			{
+				return static_cast<uint8>(std::min<uint32>((MulDiv255(s, d) + MulDiv255(s, (255 - da)) + MulDiv255(d, (255 - sa))), 255));
+			}
+			else
+			{
+				return static_cast<uint8>(s + d - MulDiv255(s, d));
+			}
+		}
+
+		template <BlendMode Mode, AlphaMode Alpha>
+		[[nodiscard]]
+		constexpr Color BlendPixel(Color s, Color d) noexcept
+		{
+			if constexpr (Alpha == AlphaMode::Straight)
+			{
+				if (s.a == 0)
+				{
+					return d;
+				}
+
+				s = Premultiply(s);
+				d = Premultiply(d);
+			}
+
+			const Color result{ BlendChannel<Mode>(s.r, d.r, s.a, d.a), BlendChannel<Mode>(s.g, d.g, s.a, d.a),
+				BlendChannel<Mode>(s.b, d.b, s.a, d.a), BlendChannel<Mode>(s.a, d.a, s.a, d.a) };
+
+			if constexpr (Alpha == AlphaMode::Straight)
+			{
+				return Unpremultiply(result);
+			}
+			else
+			{
+				return result;
+			}
+		}
+
+		template <BlendMode Mode, AlphaMode Alpha>
+		void Blend_Scalar(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = BlendPixel<Mode, Alpha>(src[i], dst[i]);
+			}
+		}
+
+		void Premultiply_Scalar(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = Premultiply(src[i]);
+			}
+		}
+
+		void Unpremultiply_Scalar(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = Unpremultiply(src[i]);
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		/// @brief 16 ビットの各要素について、x × y / 255 を正確に四捨五入して求めます。
+		[[nodiscard]]
+		inline __m128i MulDiv255_SSE2(const __m128i x, const __m128i y) noexcept
+		{
+			const __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+
+		/// @brief 16 ビットに展開した 2 ピクセルの、各ピクセルのアルファ成分を 4 つの要素に複製します。
+		[[nodiscard]]
+		inline __m128i BroadcastAlpha_SSE2(const __m128i v) noexcept
+		{
+			return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		/// @brief 16 ビットに展開した 2 ピクセルの RGB 成分にアルファ成分を掛けます。
+		[[nodiscard]]
+		inline __m128i Premultiply_SSE2(const __m128i v) noexcept
+		{
+			// アルファ成分には 255 を掛けて、値を変えない
+			const __m128i alphaLane = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+			return MulDiv255_SSE2(v, _mm_or_si128(BroadcastAlpha_SSE2(v), alphaLane));
+		}
+
+		/// @brief 1 ピクセル（32 ビット × 4）の RGB 成分をアルファ成分で割ります。
+		[[nodiscard]]
+		inline __m128i Unpremultiply32_SSE2(const __m128i v) noexcept
+		{
+			const __m128i alpha = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+			// c × 255 は float で正確に表せ、除算は正しく丸められるので、+0.5 して切り捨てた結果は整数の四捨五入と一致する
+			const __m128 q = _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(255.0f)), _mm_cvtepi32_ps(alpha));
+			const __m128i result = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(q, _mm_set1_ps(0.5f)), _mm_set1_ps(255.0f)));
+
+			// アルファ成分は元の値に戻し、アルファ成分が 0 のピクセルは 0 にする
+			const __m128i alphaLane = _mm_setr_epi32(0, 0, 0, -1);
+			const __m128i merged = _mm_or_si128(_mm_andnot_si128(alphaLane, result), _mm_and_si128(alphaLane, v));
+			return _mm_andnot_si128(_mm_cmpeq_epi32(alpha, _mm_setzero_si128()), merged);
+		}
+
+		/// @brief 16 ビットに展開した 2 ピクセルの RGB 成分をアルファ成分で割ります。
+		[[nodiscard]]
+		inline __m128i Unpremultiply_SSE2(const __m128i v) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i lo = Unpremultiply32_SSE2(_mm_unpacklo_epi16(v, zero));
+			const __m128i hi = Unpremultiply32_SSE2(_mm_unpackhi_epi16(v, zero));
+			return _mm_packs_epi32(lo, hi);
+		}
+
+		/// @brief 16 ビットに展開した、アルファ乗算済みの 2 ピクセルを合成します。
+		template <BlendMode Mode>
+		[[nodiscard]]
+		inline __m128i BlendPremultiplied_SSE2(const __m128i s, const __m128i d) noexcept
+		{
+			const __m128i c255 = _mm_set1_epi16(255);
+
+			if constexpr (Mode == BlendMode::SourceOver)
+			{
+				return _mm_add_epi16(s, MulDiv255_SSE2(d, _mm_sub_epi16(c255, BroadcastAlpha_SSE2(s))));
+			}
+			else if constexpr (Mode == BlendMode::Add)
+			{
+				return _mm_add_epi16(s, d);
+			}
+			else if constexpr (Mode == BlendMode::Multiply)
+			{
+				const __m128i sd = MulDiv255_SSE2(s, d);
+				const __m128i sInvDa = MulDiv255_SSE2(s, _mm_sub_epi16(c255, BroadcastAlpha_SSE2(d)));
+				const __m128i dInvSa = MulDiv255_SSE2(d, _mm_sub_epi16(c255, BroadcastAlpha_SSE2(s)));
+				return _mm_add_epi16(_mm_add_epi16(sd, sInvDa), dInvSa);
+			}
+			else
+			{
+				return _mm_sub_epi16(_mm_add_epi16(s, d), MulDiv255_SSE2(s, d));
+			}
+		}
+
+		/// @brief 4 ピクセルを合成します。
+		template <BlendMode Mode, AlphaMode Alpha>
+		[[nodiscard]]
+		inline __m128i Blend4_SSE2(const __m128i s, const __m128i d) noexcept
+		{
+			if constexpr ((Mode == BlendMode::Add) && (Alpha == AlphaMode::Premultiplied))
+			{
+				return _mm_adds_epu8(s, d);
+			}
+			else
+			{
+				const __m128i zero = _mm_setzero_si128();
+				__m128i sLo = _mm_unpacklo_epi8(s, zero);
+				__m128i sHi = _mm_unpackhi_epi8(s, zero);
+				__m128i dLo = _mm_unpacklo_epi8(d, zero);
+				__m128i dHi = _mm_unpackhi_epi8(d, zero);
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					sLo = Premultiply_SSE2(sLo);
+					sHi = Premultiply_SSE2(sHi);
+					dLo = Premultiply_SSE2(dLo);
+					dHi = Premultiply_SSE2(dHi);
+				}
+
+				__m128i lo = BlendPremultiplied_SSE2<Mode>(sLo, dLo);
+				__m128i hi = BlendPremultiplied_SSE2<Mode>(sHi, dHi);
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					const __m128i c255 = _mm_set1_epi16(255);
+					lo = Unpremultiply_SSE2(_mm_min_epi16(lo, c255));
+					hi = Unpremultiply_SSE2(_mm_min_epi16(hi, c255));
+
+					// src のアルファ成分が 0 のピクセルでは dst を変更しない
+					const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(s, _mm_set1_epi32(static_cast<int32>(0xFF000000))), zero);
+					return _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, _mm_packus_epi16(lo, hi)));
+				}
+				else
+				{
+					return _mm_packus_epi16(lo, hi);
+				}
+			}
+		}
+
+		template <BlendMode Mode, AlphaMode Alpha>
+		void Blend_SSE2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i alphaMask = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i alpha = _mm_and_si128(s, alphaMask);
+
+				// 上に重ねる 4 ピクセルがすべて透明な場合は、dst は変わらない
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF)
+					{
+						continue;
+					}
+				}
+				else
+				{
+					if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF)
+					{
+						continue;
+					}
+				}
+
+				// 上に重ねる 4 ピクセルがすべて不透明な場合は、src-over の結果は src と一致する
+				if constexpr (Mode == BlendMode::SourceOver)
+				{
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF)
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+						continue;
+					}
+				}
+
+				const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Blend4_SSE2<Mode, Alpha>(s, d));
+			}
+
+			Blend_Scalar<Mode, Alpha>((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Premultiply_SSE2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i lo = Premultiply_SSE2(_mm_unpacklo_epi8(v, zero));
+				const __m128i hi = Premultiply_SSE2(_mm_unpackhi_epi8(v, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+			}
+
+			Premultiply_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Unpremultiply_SSE2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i lo = Unpremultiply_SSE2(_mm_unpacklo_epi8(v, zero));
+				const __m128i hi = Unpremultiply_SSE2(_mm_unpackhi_epi8(v, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+			}
+
+			Unpremultiply_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i MulDiv255_AVX2(const __m256i x, const __m256i y) noexcept
+		{
+			const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+		}
+
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i BroadcastAlpha_AVX2(const __m256i v) noexcept
+		{
+			return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i Premultiply_AVX2(const __m256i v) noexcept
+		{
+			const __m256i alphaLane = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+			return MulDiv255_AVX2(v, _mm256_or_si256(BroadcastAlpha_AVX2(v), alphaLane));
+		}
+
+		/// @brief 2 ピクセル（32 ビット × 8）の RGB 成分をアルファ成分で割ります。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i Unpremultiply32_AVX2(const __m256i v) noexcept
+		{
+			const __m256i alpha = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+			const __m256 q = _mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(255.0f)), _mm256_cvtepi32_ps(alpha));
+			const __m256i result = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_add_ps(q, _mm256_set1_ps(0.5f)), _mm256_set1_ps(255.0f)));
+			const __m256i merged = _mm256_blend_epi32(result, v, 0b1000'1000);
+			return _mm256_andnot_si256(_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()), merged);
+		}
+
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i Unpremultiply_AVX2(const __m256i v) noexcept
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i lo = Unpremultiply32_AVX2(_mm256_unpacklo_epi16(v, zero));
+			const __m256i hi = Unpremultiply32_AVX2(_mm256_unpackhi_epi16(v, zero));
+			return _mm256_packs_epi32(lo, hi);
+		}
+
+		template <BlendMode Mode>
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i BlendPremultiplied_AVX2(const __m256i s, const __m256i d) noexcept
+		{
+			const __m256i c255 = _mm256_set1_epi16(255);
+
+			if constexpr (Mode == BlendMode::SourceOver)
+			{
+				return _mm256_add_epi16(s, MulDiv255_AVX2(d, _mm256_sub_epi16(c255, BroadcastAlpha_AVX2(s))));
+			}
+			else if constexpr (Mode == BlendMode::Add)
+			{
+				return _mm256_add_epi16(s, d);
+			}
+			else if constexpr (Mode == BlendMode::Multiply)
+			{
+				const __m256i sd = MulDiv255_AVX2(s, d);
+				const __m256i sInvDa = MulDiv255_AVX2(s, _mm256_sub_epi16(c255, BroadcastAlpha_AVX2(d)));
+				const __m256i dInvSa = MulDiv255_AVX2(d, _mm256_sub_epi16(c255, BroadcastAlpha_AVX2(s)));
+				return _mm256_add_epi16(_mm256_add_epi16(sd, sInvDa), dInvSa);
+			}
+			else
+			{
+				return _mm256_sub_epi16(_mm256_add_epi16(s, d), MulDiv255_AVX2(s, d));
+			}
+		}
+
+		/// @brief 8 ピクセルを合成します。
+		/// @remark 展開と圧縮はどちらも 128 ビットレーンごとに働くので、ピクセルの並びは元に戻る
+		template <BlendMode Mode, AlphaMode Alpha>
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i Blend8_AVX2(const __m256i s, const __m256i d) noexcept
+		{
+			if constexpr ((Mode == BlendMode::Add) && (Alpha == AlphaMode::Premultiplied))
+			{
+				return _mm256_adds_epu8(s, d);
+			}
+			else
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				__m256i sLo = _mm256_unpacklo_epi8(s, zero);
+				__m256i sHi = _mm256_unpackhi_epi8(s, zero);
+				__m256i dLo = _mm256_unpacklo_epi8(d, zero);
+				__m256i dHi = _mm256_unpackhi_epi8(d, zero);
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					sLo = Premultiply_AVX2(sLo);
+					sHi = Premultiply_AVX2(sHi);
+					dLo = Premultiply_AVX2(dLo);
+					dHi = Premultiply_AVX2(dHi);
+				}
+
+				__m256i lo = BlendPremultiplied_AVX2<Mode>(sLo, dLo);
+				__m256i hi = BlendPremultiplied_AVX2<Mode>(sHi, dHi);
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					const __m256i c255 = _mm256_set1_epi16(255);
+					lo = Unpremultiply_AVX2(_mm256_min_epi16(lo, c255));
+					hi = Unpremultiply_AVX2(_mm256_min_epi16(hi, c255));
+
+					const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, _mm256_set1_epi32(static_cast<int32>(0xFF000000))), zero);
+					return _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), d, transparent);
+				}
+				else
+				{
+					return _mm256_packus_epi16(lo, hi);
+				}
+			}
+		}
+
+		template <BlendMode Mode, AlphaMode Alpha>
+		SECCAMP_TARGET_AVX2
+		void Blend_AVX2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m256i alphaMask = _mm256_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i alpha = _mm256_and_si256(s, alphaMask);
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					if (_mm256_testz_si256(alpha, alpha))
+					{
+						continue;
+					}
+				}
+				else
+				{
+					if (_mm256_testz_si256(s, s))
+					{
+						continue;
+					}
+				}
+
+				if constexpr (Mode == BlendMode::SourceOver)
+				{
+					if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alphaMask)) == -1)
+					{
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+						continue;
+					}
+				}
+
+				const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Blend8_AVX2<Mode, Alpha>(s, d));
+			}
+
+			Blend_SSE2<Mode, Alpha>((src + i), (dst + i), (numPixels - i));
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		/// @brief 各要素について、x × y / 255 を正確に四捨五入して求めます。
+		/// @remark vraddhn_u16(t, (t + 128) >> 8) は (t + ((t + 128) >> 8) + 128) >> 8 を求める
+		[[nodiscard]]
+		inline uint8x16_t MulDiv255_NEON(const uint8x16_t x, const uint8x16_t y) noexcept
+		{
+			const uint16x8_t lo = vmull_u8(vget_low_u8(x), vget_low_u8(y));
+			const uint16x8_t hi = vmull_u8(vget_high_u8(x), vget_high_u8(y));
+			return vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+		}
+
+		/// @brief 3 つの値の和を 255 で飽和させます。
+		[[nodiscard]]
+		inline uint8x16_t AddSaturate3_NEON(const uint8x16_t a, const uint8x16_t b, const uint8x16_t c) noexcept
+		{
+			const uint16x8_t lo = vaddw_u8(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vget_low_u8(c));
+			const uint16x8_t hi = vaddw_u8(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vget_high_u8(c));
+			return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+		}
+
+		/// @brief 4 つの要素の c × 255 / a を四捨五入します。
+		[[nodiscard]]
+		inline uint32x4_t DivideByAlpha_NEON(const uint16x4_t c, const uint16x4_t a) noexcept
+		{
+			const float32x4_t q = vdivq_f32(vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(c)), 255.0f), vcvtq_f32_u32(vmovl_u16(a)));
+			return vcvtq_u32_f32(vminq_f32(vaddq_f32(q, vdupq_n_f32(0.5f)), vdupq_n_f32(255.0f)));
+		}
+
+		/// @brief 16 個の成分をアルファ成分で割ります。アルファ成分が 0 の要素は 0 にします。
+		[[nodiscard]]
+		inline uint8x16_t Unpremultiply_NEON(const uint8x16_t c, const uint8x16_t a) noexcept
+		{
+			const uint16x8_t cLo = vmovl_u8(vget_low_u8(c)), cHi = vmovl_u8(vget_high_u8(c));
+			const uint16x8_t aLo = vmovl_u8(vget_low_u8(a)), aHi = vmovl_u8(vget_high_u8(a));
+
+			const uint16x8_t lo = vcombine_u16(vmovn_u32(DivideByAlpha_NEON(vget_low_u16(cLo), vget_low_u16(aLo))), vmovn_u32(DivideByAlpha_NEON(vget_high_u16(cLo), vget_high_u16(aLo))));
+			const uint16x8_t hi = vcombine_u16(vmovn_u32(DivideByAlpha_NEON(vget_low_u16(cHi), vget_low_u16(aHi))), vmovn_u32(DivideByAlpha_NEON(vget_high_u16(cHi), vget_high_u16(aHi))));
+
+			return vbicq_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)), vceqq_u8(a, vdupq_n_u8(0)));
+		}
+
+		/// @brief アルファ乗算済みの 1 成分（16 ピクセル分）を合成します。
+		template <BlendMode Mode>
+		[[nodiscard]]
+		inline uint8x16_t BlendPremultiplied_NEON(const uint8x16_t s, const uint8x16_t d, const uint8x16_t sa, const uint8x16_t da) noexcept
+		{
+			if constexpr (Mode == BlendMode::SourceOver)
+			{
+				return vqaddq_u8(s, MulDiv255_NEON(d, vmvnq_u8(sa)));
+			}
+			else if constexpr (Mode == BlendMode::Add)
+			{
+				return vqaddq_u8(s, d);
+			}
+			else if constexpr (Mode == BlendMode::Multiply)
+			{
+				return AddSaturate3_NEON(MulDiv255_NEON(s, d), MulDiv255_NEON(s, vmvnq_u8(da)), MulDiv255_NEON(d, vmvnq_u8(sa)));
+			}
+			else
+			{
+				const uint8x16_t sd = MulDiv255_NEON(s, d);
+				const uint16x8_t lo = vsubw_u8(vaddl_u8(vget_low_u8(s), vget_low_u8(d)), vget_low_u8(sd));
+				const uint16x8_t hi = vsubw_u8(vaddl_u8(vget_high_u8(s), vget_high_u8(d)), vget_high_u8(sd));
+				return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+			}
+		}
+
+		template <BlendMode Mode, AlphaMode Alpha>
+		void Blend_NEON(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			// 16 ピクセルを成分ごとに分けて読み込む
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t s = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					if (vmaxvq_u8(s.val[3]) == 0)
+					{
+						continue;
+					}
+				}
+				else
+				{
+					if (vmaxvq_u8(vorrq_u8(vorrq_u8(s.val[0], s.val[1]), vorrq_u8(s.val[2], s.val[3]))) == 0)
+					{
+						continue;
+					}
+				}
+
+				if constexpr (Mode == BlendMode::SourceOver)
+				{
+					if (vminvq_u8(s.val[3]) == 255)
+					{
+						vst4q_u8(reinterpret_cast<uint8*>(dst + i), s);
+						continue;
+					}
+				}
+
+				const uint8x16x4_t original = vld4q_u8(reinterpret_cast<const uint8*>(dst + i));
+				uint8x16x4_t d = original;
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					for (size_t c = 0; c < 3; ++c)
+					{
+						s.val[c] = MulDiv255_NEON(s.val[c], s.val[3]);
+						d.val[c] = MulDiv255_NEON(d.val[c], d.val[3]);
+					}
+				}
+
+				uint8x16x4_t result;
+
+				for (size_t c = 0; c < 4; ++c)
+				{
+					result.val[c] = BlendPremultiplied_NEON<Mode>(s.val[c], d.val[c], s.val[3], d.val[3]);
+				}
+
+				if constexpr (Alpha == AlphaMode::Straight)
+				{
+					// src のアルファ成分が 0 のピクセルでは dst を変更しない
+					const uint8x16_t transparent = vceqq_u8(s.val[3], vdupq_n_u8(0));
+
+					for (size_t c = 0; c < 3; ++c)
+					{
+						result.val[c] = Unpremultiply_NEON(result.val[c], result.val[3]);
+					}
+
+					for (size_t c = 0; c < 4; ++c)
+					{
+						result.val[c] = vbslq_u8(transparent, original.val[c], result.val[c]);
+					}
+				}
+
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), result);
+			}
+
+			Blend_Scalar<Mode, Alpha>((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Premultiply_NEON(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t v = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+
+				for (size_t c = 0; c < 3; ++c)
+				{
+					v.val[c] = MulDiv255_NEON(v.val[c], v.val[3]);
+				}
+
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), v);
+			}
+
+			Premultiply_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Unpremultiply_NEON(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t v = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+
+				for (size_t c = 0; c < 3; ++c)
+				{
+					v.val[c] = Unpremultiply_NEON(v.val[c], v.val[3]);
+				}
+
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), v);
+			}
+
+			Unpremultiply_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+	#endif
+
+		/// @brief 合成の関数を選びます。
+		/// @return AlphaMode と BlendMode の組み合わせごとの関数。要素の番号は GetBlendIndex() で求めます
+		[[nodiscard]]
+		std::array<BlendFunction, 8> SelectBlend() noexcept
+		{
+			using enum BlendMode;
+			using enum AlphaMode;
+
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return{
+					Blend_AVX2<SourceOver, Straight>, Blend_AVX2<Add, Straight>, Blend_AVX2<Multiply, Straight>, Blend_AVX2<Screen, Straight>,
+					Blend_AVX2<SourceOver, Premultiplied>, Blend_AVX2<Add, Premultiplied>, Blend_AVX2<Multiply, Premultiplied>, Blend_AVX2<Screen, Premultiplied> };
+			}
+
+			return{
+				Blend_SSE2<SourceOver, Straight>, Blend_SSE2<Add, Straight>, Blend_SSE2<Multiply, Straight>, Blend_SSE2<Screen, Straight>,
+				Blend_SSE2<SourceOver, Premultiplied>, Blend_SSE2<Add, Premultiplied>, Blend_SSE2<Multiply, Premultiplied>, Blend_SSE2<Screen, Premultiplied> };
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return{
+				Blend_NEON<SourceOver, Straight>, Blend_NEON<Add, Straight>, Blend_NEON<Multiply, Straight>, Blend_NEON<Screen, Straight>,
+				Blend_NEON<SourceOver, Premultiplied>, Blend_NEON<Add, Premultiplied>, Blend_NEON<Multiply, Premultiplied>, Blend_NEON<Screen, Premultiplied> };
+
+		#else
+
+			return{
+				Blend_Scalar<SourceOver, Straight>, Blend_Scalar<Add, Straight>, Blend_Scalar<Multiply, Straight>, Blend_Scalar<Screen, Straight>,
+				Blend_Scalar<SourceOver, Premultiplied>, Blend_Scalar<Add, Premultiplied>, Blend_Scalar<Multiply, Premultiplied>, Blend_Scalar<Screen, Premultiplied> };
+
+		#endif
+		}
+
+		[[nodiscard]]
+		constexpr size_t GetBlendIndex(const BlendMode mode, const AlphaMode alphaMode) noexcept
+		{
+			return ((static_cast<size_t>(alphaMode) * 4) + static_cast<size_t>(mode));
+		}
+
+		[[nodiscard]]
+		AlphaFunction SelectPremultiply() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return Premultiply_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Premultiply_NEON;
+
+		#else
+
+			return Premultiply_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		AlphaFunction SelectUnpremultiply() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return Unpremultiply_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Unpremultiply_NEON;
+
+		#else
+
+			return Unpremultiply_Scalar;
+
+		#endif
+		}
+
+		/// @brief ビューの各行、または連続している場合は複数の行をまとめて、並列に関数を実行します。
+		/// @param image ビュー
+		/// @param func 引数は行の先頭ポインタとピクセル数
+		template <class Fty>
+		void ParallelForSpans(const ImageView& image, Fty func)
+		{
+			const bool contiguous = image.isContiguous();
+
+			image.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					if (contiguous)
+					{
+						func(image[beginY], (static_cast<size_t>(endY - beginY) * image.width()));
+						return;
+					}
+
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						func(image[y], static_cast<size_t>(image.width()));
+					}
+				});
+		}
+	}
+
+	void BlendPixels(const Color* src, Color* dst, const size_t numPixels, const BlendMode mode, const AlphaMode alphaMode) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const std::array<BlendFunction, 8> functions = SelectBlend();
+
+		functions[GetBlendIndex(mode, alphaMode)](src, dst, numPixels);
+	}
+
+	void BlendColor(const Color& color, Color* dst, const size_t numPixels, const BlendMode mode, const AlphaMode alphaMode) noexcept
+	{
+		if ((alphaMode == AlphaMode::Straight) && (color.a == 0))
+		{
+			return;
+		}
+
+		// 単色を並べた作業用のバッファを、ピクセル列の合成に使う
+		std::array<Color, ColorChunkPixels> colors;
+		colors.fill(color);
+
+		for (size_t i = 0; i < numPixels; i += ColorChunkPixels)
+		{
+			BlendPixels(colors.data(), (dst + i), std::min(ColorChunkPixels, (numPixels - i)), mode, alphaMode);
+		}
+	}
+
+	void PremultiplyAlpha(const Color* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const AlphaFunction function = SelectPremultiply();
+
+		function(src, dst, numPixels);
+	}
+
+	void UnpremultiplyAlpha(const Color* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const AlphaFunction function = SelectUnpremultiply();
+
+		function(src, dst, numPixels);
+	}
+
+	void Blend(const ConstImageView& src, const ImageView& dst, const Point& pos, const BlendMode mode, const AlphaMode alphaMode)
+	{
+		// dst からはみ出す部分を除く
+		const ImageView target = dst.subView(Rect{ pos, src.size() });
+
+		if (target.isEmpty())
+		{
+			return;
+		}
+
+		const ConstImageView source = src.subView(Rect{ std::max(-pos.x, 0), std::max(-pos.y, 0), target.width(), target.height() });
+
+		// 両方が連続している場合は、複数の行をまとめて処理できる
+		const bool contiguous = (source.isContiguous() && target.isContiguous());
+
+		target.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				if (contiguous)
+				{
+					BlendPixels(source[beginY], target[beginY], (static_cast<size_t>(endY - beginY) * target.width()), mode, alphaMode);
+					return;
+				}
+
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					BlendPixels(source[y], target[y], target.width(), mode, alphaMode);
+				}
+			});
+	}
+
+	void Blend(const ConstImageView& src, const ImageView& dst, const BlendMode mode, const AlphaMode alphaMode)
+	{
+		Blend(src, dst, Point{ 0, 0 }, mode, alphaMode);
+	}
+
+	void Blend(const Color& color, const ImageView& dst, const BlendMode mode, const AlphaMode alphaMode)
+	{
+		ParallelForSpans(dst, [&](Color* pDst, const size_t numPixels)
+			{
+				BlendColor(color, pDst, numPixels, mode, alphaMode);
+			});
+	}
+
+	void PremultiplyAlpha(const ImageView& image)
+	{
+		ParallelForSpans(image, [](Color* pDst, const size_t numPixels)
+			{
+				PremultiplyAlpha(pDst, pDst, numPixels);
+			});
+	}
+
+	void UnpremultiplyAlpha(const ImageView& image)
+	{
+		ParallelForSpans(image, [](Color* pDst, const size_t numPixels)
+			{
+				UnpremultiplyAlpha(pDst, pDst, numPixels);
+			});
+	}
+}
@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <cstddef> // size_t
+#include "Common.hpp"
+#include "Color.hpp"
+#include "Point.hpp"
+#include "ImageView.hpp"
+
+namespace seccamp
+{
+	/// @brief 合成の方法
+	/// @remark 各式の値は [0, 1] に正規化したアルファ乗算済みの値で、s は上に重ねる色、d は下の色、as と ad はそれぞれのアルファ成分です。アルファ成分自体にも同じ式を適用します。
+	enum class BlendMode : uint8
+	{
+		/// @brief 通常の重ね合わせ（src-over）: s + d × (1 - as)
+		SourceOver,
+
+		/// @brief 加算: min(1, s + d)
+		Add,
+
+		/// @brief 乗算: s × d + s × (1 - ad) + d × (1 - as)
+		Multiply,
+
+		/// @brief スクリーン: s + d - s × d
+		Screen,
+	};
+
+	/// @brief 色のアルファ成分の扱い
+	enum class AlphaMode : uint8
+	{
+		/// @brief RGB 成分はアルファ成分を掛けていない値（Color の通常の扱い）
+		Straight,
+
+		/// @brief RGB 成分はアルファ成分を掛けた値（アルファ乗算済み）
+		Premultiplied,
+	};
+
+	/// @brief ピクセル列に、別のピクセル列を合成します。
+	/// @param src 上に重ねるピクセル列
+	/// @param dst 合成先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @param mode 合成の方法
+	/// @param alphaMode src と dst のアルファ成分の扱い
+	/// @remark 255 による除算は、すべて正確に四捨五入した整数で計算します。
+	/// AlphaMode::Straight の場合は、アルファ乗算済みに変換して合成し、元に戻します。src のアルファ成分が 0 のピクセルでは dst を変更しません。
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void BlendPixels(const Color* src, Color* dst, size_t numPixels, BlendMode mode = BlendMode::SourceOver, AlphaMode alphaMode = AlphaMode::Straight) noexcept;
+
+	/// @brief ピクセル列に、単色を合成します。
+	/// @param color 上に重ねる色
+	/// @param dst 合成先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @param mode 合成の方法
+	/// @param alphaMode color と dst のアルファ成分の扱い
+	void BlendColor(const Color& color, Color* dst, size_t numPixels, BlendMode mode = BlendMode::SourceOver, AlphaMode alphaMode = AlphaMode::Straight) noexcept;
+
+	/// @brief ピクセル列の RGB 成分にアルファ成分を掛けます。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	void PremultiplyAlpha(const Color* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief アルファ乗算済みのピクセル列の RGB 成分を、アルファ成分で割ります。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @remark アルファ成分が 0 のピクセルは (0, 0, 0, 0) になります。
+	void UnpremultiplyAlpha(const Color* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief 画像に、別の画像を合成します。
+	/// @param src 上に重ねる画像
+	/// @param dst 合成先のビュー。src と重なってはいけません
+	/// @param pos src の左上を置く dst 上の位置。dst からはみ出す部分は無視します
+	/// @param mode 合成の方法
+	/// @param alphaMode src と dst のアルファ成分の扱い
+	void Blend(const ConstImageView& src, const ImageView& dst, const Point& pos, BlendMode mode = BlendMode::SourceOver, AlphaMode alphaMode = AlphaMode::Straight);
+
+	/// @brief 画像に、別の画像を左上をそろえて合成します。
+	/// @param src 上に重ねる画像
+	/// @param dst 合成先のビュー。src と重なってはいけません
+	/// @param mode 合成の方法
+	/// @param alphaMode src と dst のアルファ成分の扱い
+	void Blend(const ConstImageView& src, const ImageView& dst, BlendMode mode = BlendMode::SourceOver, AlphaMode alphaMode = AlphaMode::Straight);
+
+	/// @brief 画像に、単色を合成します。
+	/// @param color 上に重ねる色
+	/// @param dst 合成先のビュー
+	/// @param mode 合成の方法
+	/// @param alphaMode color と dst のアルファ成分の扱い
+	void Blend(const Color& color, const ImageView& dst, BlendMode mode = BlendMode::SourceOver, AlphaMode alphaMode = AlphaMode::Straight);
+
+	/// @brief 画像の RGB 成分にアルファ成分を掛けます。
+	/// @param image 画像
+	/// @remark 多くの画像を重ねる場合は、あらかじめアルファ乗算済みにして AlphaMode::Premultiplied で合成すると、変換の計算を省けます。
+	void PremultiplyAlpha(const ImageView& image);
+
+	/// @brief アルファ乗算済みの画像の RGB 成分を、アルファ成分で割ります。
+	/// @param image 画像
+	void UnpremultiplyAlpha(const ImageView& image);
+}
@@ -0,0 +1,105 @@
+﻿#include "CPU.hpp"
+
+#if SECCAMP_CPU(X86_64) && SECCAMP_COMPILER(MSVC)
+	#include <intrin.h> // __cpuid, __cpuidex
+	#include <immintrin.h> // _xgetbv
+#endif
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief CPU の対応する命令セット
+		struct Features
+		{
+			bool ssse3 = false;
+
+			bool sse41 = false;
+
+			bool avx2 = false;
+
+			bool neon = false;
+		};
+
+		/// @brief CPU の対応する命令セットを調べます。
+		/// @return CPU の対応する命令セット
+		[[nodiscard]]
+		Features DetectFeatures() noexcept
+		{
+			Features features;
+
+		#if SECCAMP_CPU(X86_64)
+
+			#if SECCAMP_COMPILER(MSVC)
+
+				int info[4] = {};
+				__cpuid(info, 0);
+				const int maxLeaf = info[0];
+
+				__cpuid(info, 1);
+				features.ssse3 = ((info[2] & (1 << 9)) != 0);
+				features.sse41 = ((info[2] & (1 << 19)) != 0);
+
+				// AVX2 は OS が YMM レジスタの保存に対応している必要がある
+				const bool osxsave = ((info[2] & (1 << 27)) != 0);
+				const bool avx = ((info[2] & (1 << 28)) != 0);
+
+				if ((7 <= maxLeaf) && osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6))
+				{
+					__cpuidex(info, 7, 0);
+					features.avx2 = ((info[1] & (1 << 5)) != 0);
+				}
+
+			#else
+
+				// OS の対応も含めて確認される
+				features.ssse3 = __builtin_cpu_supports("ssse3");
+				features.sse41 = __builtin_cpu_supports("sse4.1");
+				features.avx2 = __builtin_cpu_supports("avx2");
+
+			#endif
+
+		#elif SECCAMP_CPU(ARM64)
+
+			// ARM64 では NEON は必須
+			features.neon = true;
+
+		#endif
+
+			return features;
+		}
+
+		/// @brief CPU の対応する命令セットを返します。
+		/// @return CPU の対応する命令セット
+		[[nodiscard]]
+		const Features& GetFeatures() noexcept
+		{
+			static const Features features = DetectFeatures();
+
+			return features;
+		}
+	}
+
+	namespace CPU
+	{
+		bool HasSSSE3() noexcept
+		{
+			return GetFeatures().ssse3;
+		}
+
+		bool HasSSE41() noexcept
+		{
+			return GetFeatures().sse41;
+		}
+
+		bool HasAVX2() noexcept
+		{
+			return GetFeatures().avx2;
+		}
+
+		bool HasNEON() noexcept
+		{
+			return GetFeatures().neon;
+		}
+	}
+}
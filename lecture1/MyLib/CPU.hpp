@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "Common.hpp"
+
+//////////////////////////////////////////////////
+//
+//	関数単位で命令セットを有効にするためのマクロ
+//
+//	SECCAMP_TARGET_SSSE3
+//	SECCAMP_TARGET_SSE41
+//	SECCAMP_TARGET_AVX2
+// 
+//	MSVC ではコンパイラオプションなしで組み込み関数を使えるため空になります。
+//	実行時に CPU::HasAVX2() などで対応を確認してから呼び出してください。
+// 
+//////////////////////////////////////////////////
+
+#if SECCAMP_CPU(X86_64) && (not SECCAMP_COMPILER(MSVC))
+
+	#define SECCAMP_TARGET_SSSE3	__attribute__((target("ssse3")))
+	#define SECCAMP_TARGET_SSE41	__attribute__((target("sse4.1")))
+	#define SECCAMP_TARGET_AVX2		__attribute__((target("avx2")))
+
+#else
+
+	#define SECCAMP_TARGET_SSSE3
+	#define SECCAMP_TARGET_SSE41
+	#define SECCAMP_TARGET_AVX2
+
+#endif
+
+namespace seccamp
+{
+	namespace CPU
+	{
+		/// @brief 実行中の CPU が SSSE3 に対応しているかを返します。
+		/// @return 対応している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool HasSSSE3() noexcept;
+
+		/// @brief 実行中の CPU が SSE4.1 に対応しているかを返します。
+		/// @return 対応している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool HasSSE41() noexcept;
+
+		/// @brief 実行中の CPU と OS が AVX2 に対応しているかを返します。
+		/// @return 対応している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool HasAVX2() noexcept;
+
+		/// @brief 実行中の CPU が NEON に対応しているかを返します。
+		/// @return 対応している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool HasNEON() noexcept;
+	}
+}
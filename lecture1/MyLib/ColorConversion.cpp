@@ -0,0 +1,863 @@
+﻿#include <algorithm> // std::clamp
+#include <cmath> // std::round
+#include "ColorConversion.hpp"
+#include "Color.hpp"
+#include "CPU.hpp"
+#include "FixedPointWeights.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_madd_epi16, _mm_mulhrs_epi16, _mm_sra_epi32, _mm256_madd_epi16, _mm256_mulhrs_epi16
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vld4q_u8, vst4q_u8, vmull_u8, vqrdmulhq_s16, vmlal_n_s16
+#endif
+
+namespace seccamp
+{
+	// Color をバイト列として扱うため、RGBA の順に 4 バイトで並んでいることを確認
+	static_assert(sizeof(Color) == 4);
+
+	namespace
+	{
+		/// @brief グレースケールの R, G, B の重み（合計 256 の固定小数点数）
+		constexpr uint32 GrayR = 77;
+		constexpr uint32 GrayG = 150;
+		constexpr uint32 GrayB = 29;
+
+		static_assert((GrayR + GrayG + GrayB) == 256);
+
+		/// @brief 固定小数点数でグレースケール値を求めます。
+		/// @param c 色
+		/// @return グレースケール値
+		[[nodiscard]]
+		constexpr uint8 GrayscaleFixed(const Color& c) noexcept
+		{
+			return static_cast<uint8>(((GrayR * c.r) + (GrayG * c.g) + (GrayB * c.b)) >> 8);
+		}
+
+		/// @brief 明るさとコントラストの調整に使うパラメータ
+		struct BrightnessContrast
+		{
+			/// @brief コントラストの倍率（1/256 単位）
+			int16 contrast;
+
+			/// @brief 128 + 明るさの調整量
+			int16 offset;
+
+			/// @brief 1 つの成分を変換します。
+			/// @param x 成分
+			/// @return 変換後の成分
+			/// @remark SIMD 実装の丸め（(a * b + 2^14) >> 15, a = (x - 128) << 7）と同じ結果になります。
+			[[nodiscard]]
+			constexpr uint8 apply(const int32 x) const noexcept
+			{
+				return static_cast<uint8>(std::clamp((((((x - 128) * contrast) + 128) >> 8) + offset), 0, 255));
+			}
+
+			[[nodiscard]]
+			static BrightnessContrast Make(const int32 brightness, const double contrast) noexcept
+			{
+				return{
+					.contrast	= static_cast<int16>(std::clamp(std::round(contrast * 256.0), 0.0, 32767.0)),
+					.offset		= static_cast<int16>(128 + std::clamp(brightness, -255, 255))
+				};
+			}
+		};
+
+		using GrayscaleFunction = void(*)(const Color*, Color*, size_t);
+
+		using GrayscaleUint8Function = void(*)(const Color*, uint8*, size_t);
+
+		using ExtractChannelFunction = void(*)(const Color*, uint8*, size_t, size_t);
+
+		using InvertFunction = void(*)(const Color*, Color*, size_t);
+
+		using BrightnessContrastFunction = void(*)(const Color*, Color*, size_t, BrightnessContrast);
+
+		using WeightedSumFunction = void(*)(const Color*, size_t, const int16*, size_t, int32, Color*, size_t);
+
+		/// @brief 重み付き和を右シフトで四捨五入するために、あらかじめ足しておく値を返します。
+		/// @param fractionBits 重みの小数部のビット数
+		/// @return 足しておく値
+		[[nodiscard]]
+		constexpr int32 WeightedSumRounding(const int32 fractionBits) noexcept
+		{
+			return ((0 < fractionBits) ? (1 << (fractionBits - 1)) : 0);
+		}
+
+		void Grayscale_Scalar(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const uint8 gray = GrayscaleFixed(src[i]);
+				dst[i] = Color{ gray, gray, gray, src[i].a };
+			}
+		}
+
+		void GrayscaleUint8_Scalar(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = GrayscaleFixed(src[i]);
+			}
+		}
+
+		void ExtractChannel_Scalar(const Color* src, uint8* dst, const size_t numPixels, const size_t channel) noexcept
+		{
+			const uint8* pSrc = (reinterpret_cast<const uint8*>(src) + channel);
+
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = pSrc[i * 4];
+			}
+		}
+
+		void Invert_Scalar(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const Color c = src[i];
+				dst[i] = Color{ static_cast<uint8>(255 - c.r), static_cast<uint8>(255 - c.g), static_cast<uint8>(255 - c.b), c.a };
+			}
+		}
+
+		void BrightnessContrast_Scalar(const Color* src, Color* dst, const size_t numPixels, const BrightnessContrast bc) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const Color c = src[i];
+				dst[i] = Color{ bc.apply(c.r), bc.apply(c.g), bc.apply(c.b), c.a };
+			}
+		}
+
+		void WeightedSum_Scalar(const Color* src, const size_t stride, const int16* weights, const size_t count, const int32 fractionBits, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint8* pSrc = reinterpret_cast<const uint8*>(src);
+			uint8* pDst = reinterpret_cast<uint8*>(dst);
+			const size_t strideBytes = (stride * sizeof(Color));
+			const int32 rounding = WeightedSumRounding(fractionBits);
+
+			for (size_t i = 0; i < (numPixels * sizeof(Color)); ++i)
+			{
+				int32 sum = rounding;
+
+				for (size_t k = 0; k < count; ++k)
+				{
+					sum += (pSrc[strideBytes * k + i] * weights[k]);
+				}
+
+				pDst[i] = static_cast<uint8>(std::clamp((sum >> fractionBits), 0, 255));
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		/// @brief 4 ピクセルのグレースケール値を 32 ビット整数で求めます。
+		[[nodiscard]]
+		inline __m128i Grayscale4_SSE2(const __m128i v) noexcept
+		{
+			const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+
+			// 16 ビットごとに (R, B) と (G, A) に分け、積和で R * wr + B * wb と G * wg を求める
+			const __m128i rb = _mm_and_si128(v, mask);
+			const __m128i ga = _mm_and_si128(_mm_srli_epi32(v, 8), mask);
+			const __m128i sum = _mm_add_epi32(_mm_madd_epi16(rb, _mm_set1_epi32(GrayR | (GrayB << 16))), _mm_madd_epi16(ga, _mm_set1_epi32(GrayG)));
+
+			return _mm_srli_epi32(sum, 8);
+		}
+
+		/// @brief 32 ビット整数 × 16（0 以上 255 以下）を 16 バイトに詰めます。
+		[[nodiscard]]
+		inline __m128i PackUint32x16_SSE2(const __m128i a, const __m128i b, const __m128i c, const __m128i d) noexcept
+		{
+			return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		}
+
+		/// @brief グレースケール値 × 4 を、指定したアルファ成分を持つ色にします。
+		[[nodiscard]]
+		inline __m128i GrayToColor_SSE2(const __m128i gray, const __m128i v) noexcept
+		{
+			const __m128i gg = _mm_or_si128(gray, _mm_slli_epi32(gray, 8));
+			const __m128i ggg = _mm_or_si128(gg, _mm_slli_epi32(gray, 16));
+			return _mm_or_si128(ggg, _mm_and_si128(v, _mm_set1_epi32(static_cast<int32>(0xFF000000))));
+		}
+
+		void Grayscale_SSE2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), GrayToColor_SSE2(Grayscale4_SSE2(v), v));
+			}
+
+			Grayscale_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void GrayscaleUint8_SSE2(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + i);
+				const __m128i g0 = Grayscale4_SSE2(_mm_loadu_si128(pSrc + 0));
+				const __m128i g1 = Grayscale4_SSE2(_mm_loadu_si128(pSrc + 1));
+				const __m128i g2 = Grayscale4_SSE2(_mm_loadu_si128(pSrc + 2));
+				const __m128i g3 = Grayscale4_SSE2(_mm_loadu_si128(pSrc + 3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), PackUint32x16_SSE2(g0, g1, g2, g3));
+			}
+
+			GrayscaleUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void ExtractChannel_SSE2(const Color* src, uint8* dst, const size_t numPixels, const size_t channel) noexcept
+		{
+			const __m128i shift = _mm_cvtsi32_si128(static_cast<int32>(channel * 8));
+			const __m128i mask = _mm_set1_epi32(0xFF);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + i);
+				const __m128i c0 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(pSrc + 0), shift), mask);
+				const __m128i c1 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(pSrc + 1), shift), mask);
+				const __m128i c2 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(pSrc + 2), shift), mask);
+				const __m128i c3 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(pSrc + 3), shift), mask);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), PackUint32x16_SSE2(c0, c1, c2, c3));
+			}
+
+			ExtractChannel_Scalar((src + i), (dst + i), (numPixels - i), channel);
+		}
+
+		void Invert_SSE2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, mask));
+			}
+
+			Invert_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 16 ビットに広げた成分 x を ((x - 128) * contrast) / 256 + offset に変換します。
+		[[nodiscard]]
+		SECCAMP_TARGET_SSSE3
+		inline __m128i AdjustBrightnessContrast_SSSE3(const __m128i x, const __m128i contrast, const __m128i offset) noexcept
+		{
+			const __m128i t = _mm_slli_epi16(_mm_sub_epi16(x, _mm_set1_epi16(128)), 7);
+			return _mm_add_epi16(_mm_mulhrs_epi16(t, contrast), offset);
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void BrightnessContrast_SSSE3(const Color* src, Color* dst, const size_t numPixels, const BrightnessContrast bc) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i contrast = _mm_set1_epi16(bc.contrast);
+			const __m128i offset = _mm_set1_epi16(bc.offset);
+			const __m128i alphaMask = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i lo = AdjustBrightnessContrast_SSSE3(_mm_unpacklo_epi8(v, zero), contrast, offset);
+				const __m128i hi = AdjustBrightnessContrast_SSSE3(_mm_unpackhi_epi8(v, zero), contrast, offset);
+
+				// 0 以上 255 以下に飽和させて詰め、アルファ成分を元に戻す
+				const __m128i result = _mm_packus_epi16(lo, hi);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, v)));
+			}
+
+			BrightnessContrast_Scalar((src + i), (dst + i), (numPixels - i), bc);
+		}
+
+		void WeightedSum_SSE2(const Color* src, const size_t stride, const int16* weights, const size_t count, const int32 fractionBits, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint8* pSrc = reinterpret_cast<const uint8*>(src);
+			uint8* pDst = reinterpret_cast<uint8*>(dst);
+			const size_t strideBytes = (stride * sizeof(Color));
+			const size_t sizeBytes = (numPixels * sizeof(Color));
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i shift = _mm_cvtsi32_si128(fractionBits);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= sizeBytes; i += 16)
+			{
+				__m128i s0 = _mm_set1_epi32(WeightedSumRounding(fractionBits));
+				__m128i s1 = s0, s2 = s0, s3 = s0;
+
+				size_t k = 0;
+
+				// 2 列ずつ、同じ位置のバイトを (a, b) の組に並べて、重みの組 (w0, w1) と積和を取る
+				for (; (k + 2) <= count; k += 2)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + strideBytes * k + i));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + strideBytes * (k + 1) + i));
+					const __m128i w = _mm_set1_epi32(MakeWeightPair(weights[k], weights[k + 1]));
+					const __m128i lo = _mm_unpacklo_epi8(a, b);
+					const __m128i hi = _mm_unpackhi_epi8(a, b);
+
+					s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+					s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+					s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+					s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+				}
+
+				if (k < count)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + strideBytes * k + i));
+					const __m128i w = _mm_set1_epi32(MakeWeightPair(weights[k], 0));
+					const __m128i lo = _mm_unpacklo_epi8(a, zero);
+					const __m128i hi = _mm_unpackhi_epi8(a, zero);
+
+					s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+					s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+					s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+					s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+				}
+
+				const __m128i lo = _mm_packs_epi32(_mm_sra_epi32(s0, shift), _mm_sra_epi32(s1, shift));
+				const __m128i hi = _mm_packs_epi32(_mm_sra_epi32(s2, shift), _mm_sra_epi32(s3, shift));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(lo, hi));
+			}
+
+			// 残りの 4 ピクセル未満
+			WeightedSum_Scalar(reinterpret_cast<const Color*>(pSrc + i), stride, weights, count, fractionBits, reinterpret_cast<Color*>(pDst + i), ((sizeBytes - i) / sizeof(Color)));
+		}
+
+		/// @brief 8 ピクセルのグレースケール値を 32 ビット整数で求めます。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i Grayscale8_AVX2(const __m256i v) noexcept
+		{
+			const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+
+			const __m256i rb = _mm256_and_si256(v, mask);
+			const __m256i ga = _mm256_and_si256(_mm256_srli_epi32(v, 8), mask);
+			const __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rb, _mm256_set1_epi32(GrayR | (GrayB << 16))), _mm256_madd_epi16(ga, _mm256_set1_epi32(GrayG)));
+
+			return _mm256_srli_epi32(sum, 8);
+		}
+
+		/// @brief 32 ビット整数 × 32（0 以上 255 以下）を 32 バイトに詰めます。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i PackUint32x32_AVX2(const __m256i a, const __m256i b, const __m256i c, const __m256i d) noexcept
+		{
+			// パックは 128 ビットレーンごとに行われるので、最後に 4 バイト単位で並べ直す
+			const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+			return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Grayscale_AVX2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m256i alphaMask = _mm256_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i gray = Grayscale8_AVX2(v);
+
+				// グレースケール値を R, G, B に複製し、アルファ成分を元に戻す
+				const __m256i ggg = _mm256_mullo_epi32(gray, _mm256_set1_epi32(0x010101));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(ggg, _mm256_and_si256(v, alphaMask)));
+			}
+
+			Grayscale_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void GrayscaleUint8_AVX2(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i* pSrc = reinterpret_cast<const __m256i*>(src + i);
+				const __m256i g0 = Grayscale8_AVX2(_mm256_loadu_si256(pSrc + 0));
+				const __m256i g1 = Grayscale8_AVX2(_mm256_loadu_si256(pSrc + 1));
+				const __m256i g2 = Grayscale8_AVX2(_mm256_loadu_si256(pSrc + 2));
+				const __m256i g3 = Grayscale8_AVX2(_mm256_loadu_si256(pSrc + 3));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), PackUint32x32_AVX2(g0, g1, g2, g3));
+			}
+
+			GrayscaleUint8_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void ExtractChannel_AVX2(const Color* src, uint8* dst, const size_t numPixels, const size_t channel) noexcept
+		{
+			const __m128i shift = _mm_cvtsi32_si128(static_cast<int32>(channel * 8));
+			const __m256i mask = _mm256_set1_epi32(0xFF);
+
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i* pSrc = reinterpret_cast<const __m256i*>(src + i);
+				const __m256i c0 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256(pSrc + 0), shift), mask);
+				const __m256i c1 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256(pSrc + 1), shift), mask);
+				const __m256i c2 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256(pSrc + 2), shift), mask);
+				const __m256i c3 = _mm256_and_si256(_mm256_srl_epi32(_mm256_loadu_si256(pSrc + 3), shift), mask);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), PackUint32x32_AVX2(c0, c1, c2, c3));
+			}
+
+			ExtractChannel_SSE2((src + i), (dst + i), (numPixels - i), channel);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Invert_AVX2(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m256i mask = _mm256_set1_epi32(0x00FFFFFF);
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, mask));
+			}
+
+			Invert_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 16 ビットに広げた成分 x を ((x - 128) * contrast) / 256 + offset に変換します。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i AdjustBrightnessContrast_AVX2(const __m256i x, const __m256i contrast, const __m256i offset) noexcept
+		{
+			const __m256i t = _mm256_slli_epi16(_mm256_sub_epi16(x, _mm256_set1_epi16(128)), 7);
+			return _mm256_add_epi16(_mm256_mulhrs_epi16(t, contrast), offset);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void BrightnessContrast_AVX2(const Color* src, Color* dst, const size_t numPixels, const BrightnessContrast bc) noexcept
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i contrast = _mm256_set1_epi16(bc.contrast);
+			const __m256i offset = _mm256_set1_epi16(bc.offset);
+			const __m256i alphaMask = _mm256_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// アンパックとパックはどちらも 128 ビットレーンごとに行われるので、並べ直す必要はない
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i lo = AdjustBrightnessContrast_AVX2(_mm256_unpacklo_epi8(v, zero), contrast, offset);
+				const __m256i hi = AdjustBrightnessContrast_AVX2(_mm256_unpackhi_epi8(v, zero), contrast, offset);
+
+				const __m256i result = _mm256_packus_epi16(lo, hi);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(_mm256_andnot_si256(alphaMask, result), _mm256_and_si256(alphaMask, v)));
+			}
+
+			BrightnessContrast_SSSE3((src + i), (dst + i), (numPixels - i), bc);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void WeightedSum_AVX2(const Color* src, const size_t stride, const int16* weights, const size_t count, const int32 fractionBits, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint8* pSrc = reinterpret_cast<const uint8*>(src);
+			uint8* pDst = reinterpret_cast<uint8*>(dst);
+			const size_t strideBytes = (stride * sizeof(Color));
+			const size_t sizeBytes = (numPixels * sizeof(Color));
+			const __m256i zero = _mm256_setzero_si256();
+			const __m128i shift = _mm_cvtsi32_si128(fractionBits);
+
+			size_t i = 0;
+
+			// 各命令は 128 ビットレーンごとに働くが、展開と圧縮の順序が対応しているので結果の並びは元に戻る
+			for (; (i + 32) <= sizeBytes; i += 32)
+			{
+				__m256i s0 = _mm256_set1_epi32(WeightedSumRounding(fractionBits));
+				__m256i s1 = s0, s2 = s0, s3 = s0;
+
+				size_t k = 0;
+
+				for (; (k + 2) <= count; k += 2)
+				{
+					const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + strideBytes * k + i));
+					const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + strideBytes * (k + 1) + i));
+					const __m256i w = _mm256_set1_epi32(MakeWeightPair(weights[k], weights[k + 1]));
+					const __m256i lo = _mm256_unpacklo_epi8(a, b);
+					const __m256i hi = _mm256_unpackhi_epi8(a, b);
+
+					s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+					s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+					s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+					s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+				}
+
+				if (k < count)
+				{
+					const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + strideBytes * k + i));
+					const __m256i w = _mm256_set1_epi32(MakeWeightPair(weights[k], 0));
+					const __m256i lo = _mm256_unpacklo_epi8(a, zero);
+					const __m256i hi = _mm256_unpackhi_epi8(a, zero);
+
+					s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+					s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+					s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+					s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+				}
+
+				const __m256i lo = _mm256_packs_epi32(_mm256_sra_epi32(s0, shift), _mm256_sra_epi32(s1, shift));
+				const __m256i hi = _mm256_packs_epi32(_mm256_sra_epi32(s2, shift), _mm256_sra_epi32(s3, shift));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), _mm256_packus_epi16(lo, hi));
+			}
+
+			WeightedSum_SSE2(reinterpret_cast<const Color*>(pSrc + i), stride, weights, count, fractionBits, reinterpret_cast<Color*>(pDst + i), ((sizeBytes - i) / sizeof(Color)));
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		/// @brief 16 ピクセルのグレースケール値を求めます。
+		[[nodiscard]]
+		inline uint8x16_t Grayscale16_NEON(const uint8x16x4_t& rgba) noexcept
+		{
+			const uint8x8_t wr = vdup_n_u8(GrayR);
+			const uint8x8_t wg = vdup_n_u8(GrayG);
+			const uint8x8_t wb = vdup_n_u8(GrayB);
+
+			uint16x8_t lo = vmull_u8(vget_low_u8(rgba.val[0]), wr);
+			lo = vmlal_u8(lo, vget_low_u8(rgba.val[1]), wg);
+			lo = vmlal_u8(lo, vget_low_u8(rgba.val[2]), wb);
+
+			uint16x8_t hi = vmull_u8(vget_high_u8(rgba.val[0]), wr);
+			hi = vmlal_u8(hi, vget_high_u8(rgba.val[1]), wg);
+			hi = vmlal_u8(hi, vget_high_u8(rgba.val[2]), wb);
+
+			return vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+		}
+
+		void Grayscale_NEON(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				const uint8x16_t gray = Grayscale16_NEON(rgba);
+				rgba.val[0] = gray;
+				rgba.val[1] = gray;
+				rgba.val[2] = gray;
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			Grayscale_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void GrayscaleUint8_NEON(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				vst1q_u8((dst + i), Grayscale16_NEON(rgba));
+			}
+
+			GrayscaleUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void ExtractChannel_NEON(const Color* src, uint8* dst, const size_t numPixels, const size_t channel) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				vst1q_u8((dst + i), rgba.val[channel]);
+			}
+
+			ExtractChannel_Scalar((src + i), (dst + i), (numPixels - i), channel);
+		}
+
+		void Invert_NEON(const Color* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint32x4_t mask = vdupq_n_u32(0x00FFFFFF);
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const uint32x4_t v = vld1q_u32(reinterpret_cast<const uint32*>(src + i));
+				vst1q_u32(reinterpret_cast<uint32*>(dst + i), veorq_u32(v, mask));
+			}
+
+			Invert_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void BrightnessContrast_NEON(const Color* src, Color* dst, const size_t numPixels, const BrightnessContrast bc) noexcept
+		{
+			const int16x8_t k128 = vdupq_n_s16(128);
+			const int16x8_t contrast = vdupq_n_s16(bc.contrast);
+			const int16x8_t offset = vdupq_n_s16(bc.offset);
+
+			// vqrdmulhq_s16 は (2 * a * b + 2^15) >> 16 なので、SSSE3 の _mm_mulhrs_epi16 と同じ結果になる
+			const auto Adjust = [&](const uint8x8_t x)
+			{
+				const int16x8_t t = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(x)), k128), 7);
+				return vaddq_s16(vqrdmulhq_s16(t, contrast), offset);
+			};
+
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+
+				for (size_t c = 0; c < 3; ++c)
+				{
+					rgba.val[c] = vcombine_u8(vqmovun_s16(Adjust(vget_low_u8(rgba.val[c]))), vqmovun_s16(Adjust(vget_high_u8(rgba.val[c]))));
+				}
+
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			BrightnessContrast_Scalar((src + i), (dst + i), (numPixels - i), bc);
+		}
+
+		void WeightedSum_NEON(const Color* src, const size_t stride, const int16* weights, const size_t count, const int32 fractionBits, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint8* pSrc = reinterpret_cast<const uint8*>(src);
+			uint8* pDst = reinterpret_cast<uint8*>(dst);
+			const size_t strideBytes = (stride * sizeof(Color));
+			const size_t sizeBytes = (numPixels * sizeof(Color));
+
+			// vshlq_s32 に負の値を与えると算術右シフトになる
+			const int32x4_t shift = vdupq_n_s32(-fractionBits);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= sizeBytes; i += 16)
+			{
+				int32x4_t s0 = vdupq_n_s32(WeightedSumRounding(fractionBits));
+				int32x4_t s1 = s0, s2 = s0, s3 = s0;
+
+				for (size_t k = 0; k < count; ++k)
+				{
+					const uint8x16_t v = vld1q_u8(pSrc + strideBytes * k + i);
+					const int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v)));
+					const int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v)));
+
+					s0 = vmlal_n_s16(s0, vget_low_s16(lo), weights[k]);
+					s1 = vmlal_n_s16(s1, vget_high_s16(lo), weights[k]);
+					s2 = vmlal_n_s16(s2, vget_low_s16(hi), weights[k]);
+					s3 = vmlal_n_s16(s3, vget_high_s16(hi), weights[k]);
+				}
+
+				const int16x8_t lo = vcombine_s16(vqmovn_s32(vshlq_s32(s0, shift)), vqmovn_s32(vshlq_s32(s1, shift)));
+				const int16x8_t hi = vcombine_s16(vqmovn_s32(vshlq_s32(s2, shift)), vqmovn_s32(vshlq_s32(s3, shift)));
+				vst1q_u8((pDst + i), vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+			}
+
+			WeightedSum_Scalar(reinterpret_cast<const Color*>(pSrc + i), stride, weights, count, fractionBits, reinterpret_cast<Color*>(pDst + i), ((sizeBytes - i) / sizeof(Color)));
+		}
+
+	#endif
+
+		[[nodiscard]]
+		GrayscaleFunction SelectGrayscale() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Grayscale_AVX2;
+			}
+
+			return Grayscale_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Grayscale_NEON;
+
+		#else
+
+			return Grayscale_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		GrayscaleUint8Function SelectGrayscaleUint8() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return GrayscaleUint8_AVX2;
+			}
+
+			return GrayscaleUint8_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return GrayscaleUint8_NEON;
+
+		#else
+
+			return GrayscaleUint8_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		ExtractChannelFunction SelectExtractChannel() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return ExtractChannel_AVX2;
+			}
+
+			return ExtractChannel_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return ExtractChannel_NEON;
+
+		#else
+
+			return ExtractChannel_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		InvertFunction SelectInvert() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Invert_AVX2;
+			}
+
+			return Invert_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Invert_NEON;
+
+		#else
+
+			return Invert_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		BrightnessContrastFunction SelectBrightnessContrast() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return BrightnessContrast_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return BrightnessContrast_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return BrightnessContrast_NEON;
+
+		#endif
+
+			return BrightnessContrast_Scalar;
+		}
+
+		[[nodiscard]]
+		WeightedSumFunction SelectWeightedSum() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return WeightedSum_AVX2;
+			}
+
+			return WeightedSum_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return WeightedSum_NEON;
+
+		#else
+
+			return WeightedSum_Scalar;
+
+		#endif
+		}
+	}
+
+	void ConvertToGrayscale(const Color* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const GrayscaleFunction function = SelectGrayscale();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertToGrayscaleUint8(const Color* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const GrayscaleUint8Function function = SelectGrayscaleUint8();
+
+		function(src, dst, numPixels);
+	}
+
+	void ExtractChannel(const Color* src, uint8* dst, const size_t numPixels, const size_t channel) noexcept
+	{
+		if (3 < channel)
+		{
+			return;
+		}
+
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const ExtractChannelFunction function = SelectExtractChannel();
+
+		function(src, dst, numPixels, channel);
+	}
+
+	void InvertColor(const Color* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const InvertFunction function = SelectInvert();
+
+		function(src, dst, numPixels);
+	}
+
+	void AdjustBrightnessContrast(const Color* src, Color* dst, const size_t numPixels, const int32 brightness, const double contrast) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const BrightnessContrastFunction function = SelectBrightnessContrast();
+
+		function(src, dst, numPixels, BrightnessContrast::Make(brightness, contrast));
+	}
+
+	void WeightedSum(const Color* src, const size_t stride, const int16* weights, const size_t count, const int32 fractionBits, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const WeightedSumFunction function = SelectWeightedSum();
+
+		function(src, stride, weights, count, fractionBits, dst, numPixels);
+	}
+}
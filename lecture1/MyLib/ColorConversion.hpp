@@ -0,0 +1,61 @@
+﻿#pragma once
+#include <cstddef> // size_t
+#include "Common.hpp"
+
+namespace seccamp
+{
+	struct Color; // 前方宣言
+
+	/// @brief ピクセル列をグレースケールに変換します。アルファ成分は変更しません。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @remark 固定小数点数で計算するため、結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertToGrayscale(const Color* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief ピクセル列の各ピクセルのグレースケール値を求めます。
+	/// @param src 変換元のピクセル列
+	/// @param dst グレースケール値の格納先（numPixels バイト以上）
+	/// @param numPixels ピクセル数
+	/// @remark 固定小数点数で計算するため、結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertToGrayscaleUint8(const Color* src, uint8* dst, size_t numPixels) noexcept;
+
+	/// @brief ピクセル列から 1 つの成分を取り出します。
+	/// @param src 変換元のピクセル列
+	/// @param dst 取り出した成分の格納先（numPixels バイト以上）
+	/// @param numPixels ピクセル数
+	/// @param channel 取り出す成分（0: R, 1: G, 2: B, 3: A）
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ExtractChannel(const Color* src, uint8* dst, size_t numPixels, size_t channel) noexcept;
+
+	/// @brief ピクセル列の色を反転します。アルファ成分は変更しません。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void InvertColor(const Color* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief ピクセル列の明るさとコントラストを調整します。アルファ成分は変更しません。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @param brightness 明るさの調整量 [-255, 255]
+	/// @param contrast コントラストの倍率 [0.0, 127.0]。1.0 で変化なし
+	/// @remark 各成分 x は (x - 128) * contrast + 128 + brightness に変換されます。contrast は 1/256 単位の固定小数点数に丸めて計算します。
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void AdjustBrightnessContrast(const Color* src, Color* dst, size_t numPixels, int32 brightness, double contrast) noexcept;
+
+	/// @brief 一定の間隔で並ぶ複数のピクセル列の、重み付き和を求めます。
+	/// @param src 最初のピクセル列。k 番目のピクセル列は src + stride * k から始まります
+	/// @param stride ピクセル列の先頭どうしの間隔（ピクセル）。1 にすると、1 行の中での畳み込みになります
+	/// @param weights 各ピクセル列の重み（count 個）。実際の重みは weights[k] / 2^fractionBits です
+	/// @param count ピクセル列の数
+	/// @param fractionBits 重みの小数部のビット数 [0, 14]
+	/// @param dst 書き込み先のピクセル列。src のどのピクセル列とも重なってはいけません
+	/// @param numPixels 各ピクセル列のピクセル数
+	/// @remark 各成分ごとに Σ src * weights[k] を 32 ビット整数で求め、四捨五入して [0, 255] に収めます。255 × Σ|weights[k]| が int32 の範囲に収まる必要があります。
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void WeightedSum(const Color* src, size_t stride, const int16* weights, size_t count, int32 fractionBits, Color* dst, size_t numPixels) noexcept;
+}
@@ -100,6 +100,38 @@ namespace seccamp
 
 #endif
 
+//////////////////////////////////////////////////
+//
+//	CPU アーキテクチャ判定用のマクロ
+//
+//	SECCAMP_CPU_NAME
+//	SECCAMP_CPU(X86_64)
+//	SECCAMP_CPU(ARM64)
+// 
+//////////////////////////////////////////////////
+
+#define SECCAMP_CPU(X) SECCAMP_CPU_PRIVATE_DEFINITION_##X()
+#define SECCAMP_CPU_PRIVATE_DEFINITION_X86_64()	0
+#define SECCAMP_CPU_PRIVATE_DEFINITION_ARM64()	0
+
+#if (defined(_M_X64) || defined(__x86_64__)) // x86-64
+
+	#define SECCAMP_CPU_NAME	"x86-64"
+	#undef	SECCAMP_CPU_PRIVATE_DEFINITION_X86_64
+	#define SECCAMP_CPU_PRIVATE_DEFINITION_X86_64()	1
+
+#elif (defined(_M_ARM64) || defined(__aarch64__)) // ARM64
+
+	#define SECCAMP_CPU_NAME	"ARM64"
+	#undef	SECCAMP_CPU_PRIVATE_DEFINITION_ARM64
+	#define SECCAMP_CPU_PRIVATE_DEFINITION_ARM64()	1
+
+#else
+
+	#define SECCAMP_CPU_NAME	"Other"
+
+#endif
+
 //////////////////////////////////////////////////
 //
 //	コンパイラ判定用のマクロ
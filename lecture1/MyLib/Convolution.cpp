@@ -0,0 +1,772 @@
+﻿#include <algorithm> // std::min, std::max, std::clamp, std::fill_n, std::copy_n
+#include <array> // std::array
+#include <cmath> // std::exp, std::sqrt, std::ceil, std::floor, std::lround
+#include <functional> // std::less
+#include <utility> // std::pair, std::move
+#include "Convolution.hpp"
+#include "ColorConversion.hpp"
+#include "CPU.hpp"
+#include "FixedPointWeights.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_cvtepi32_ps, _mm_cvttps_epi32, _mm256_cvtepu8_epi32
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vcvtq_f32_s32, vcvtq_s32_f32, vsubl_u8
+#endif
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 縦方向の処理で一度に扱う列数（ピクセル）。参照する複数の行の該当部分が L1 / L2 キャッシュに収まるようにする
+		constexpr int32 TileWidth = 256;
+
+		/// @brief ボックスブラーの縦方向の処理で一度に扱う行数の最小値
+		constexpr int32 TileHeight = 256;
+
+		/// @brief ボックスブラーの半径の最大値。累積和が int32 に収まるようにする
+		constexpr int32 MaxBoxRadius = (1 << 20);
+
+		/// @brief ガウスぼかしをボックスブラーで近似する標準偏差の最小値。これより小さい場合はボックスブラーの半径が小さすぎて近似の誤差が大きいため、ガウス関数のカーネルで畳み込む
+		constexpr double MinBoxGaussianSigma = 2.0;
+
+		/// @brief int16 の最大値
+		constexpr int32 MaxWeight = 32767;
+
+		/// @brief 重みの絶対値の合計の最大値。255 × 合計が int32 に収まるようにする
+		constexpr double MaxTotalWeight = (1 << 23);
+
+		/// @brief 2 つのビューの範囲が重なっているかを返します。
+		[[nodiscard]]
+		bool Overlaps(const ConstImageView& a, const ConstImageView& b) noexcept
+		{
+			if (a.isEmpty() || b.isEmpty())
+			{
+				return false;
+			}
+
+			const Color* aEnd = (a[a.height() - 1] + a.width());
+			const Color* bEnd = (b[b.height() - 1] + b.width());
+
+			// 異なる配列を指すポインタどうしも比較できるように std::less を使う
+			return (std::less<const Color*>{}(a.data(), bEnd) && std::less<const Color*>{}(b.data(), aEnd));
+		}
+
+		/// @brief 画像の外側を参照する重みを、端のピクセルの重みにまとめます。
+		/// @param position 注目しているピクセルの位置
+		/// @param size 画像の幅または高さ
+		/// @param kernel カーネル
+		/// @param weights まとめた重みの格納先（kernel.size() 個以上）
+		/// @return 参照する最初のピクセルの位置と、参照するピクセル数
+		[[nodiscard]]
+		std::pair<int32, size_t> ClampTaps(const int32 position, const int32 size, const ConvolutionKernel& kernel, int16* weights) noexcept
+		{
+			const int32 radius = kernel.radius();
+			const int32 first = std::max((position - radius), 0);
+			const int32 last = std::min((position + radius), (size - 1));
+			const std::span<const int16> src = kernel.weights();
+
+			std::fill_n(weights, (last - first + 1), int16{ 0 });
+
+			for (int32 k = 0; k < static_cast<int32>(src.size()); ++k)
+			{
+				const int32 index = (std::clamp((position - radius + k), 0, (size - 1)) - first);
+				weights[index] = static_cast<int16>(std::clamp((weights[index] + src[k]), -MaxWeight, MaxWeight));
+			}
+
+			return{ first, static_cast<size_t>(last - first + 1) };
+		}
+
+		/// @brief 各行を横方向に畳み込みます。
+		/// @param src 元の画像
+		/// @param dst 書き込み先のビュー（src と同じ大きさ）。src と同じビューでもかまいません
+		/// @param kernel カーネル
+		void ConvolveHorizontal(const ConstImageView& src, const ImageView& dst, const ConvolutionKernel& kernel)
+		{
+			const int32 width = src.width();
+			const int32 radius = kernel.radius();
+
+			dst.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					// 両端を端のピクセルで埋めた行。1 ピクセル間隔の重み付き和として畳み込める
+					std::vector<Color> padded(width + (radius * 2));
+
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						const Color* pSrc = src[y];
+						std::fill_n(padded.begin(), radius, pSrc[0]);
+						std::copy_n(pSrc, width, (padded.begin() + radius));
+						std::fill_n((padded.begin() + radius + width), radius, pSrc[width - 1]);
+
+						WeightedSum(padded.data(), 1, kernel.weights().data(), kernel.size(), kernel.fractionBits(), dst[y], width);
+					}
+				});
+		}
+
+		/// @brief 縦方向に畳み込みます。
+		/// @param src 元の画像
+		/// @param dst 書き込み先のビュー（src と同じ大きさ）。src と重なってはいけません
+		/// @param kernel カーネル
+		void ConvolveVertical(const ConstImageView& src, const ImageView& dst, const ConvolutionKernel& kernel)
+		{
+			const int32 width = src.width();
+			const int32 height = src.height();
+
+			dst.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					std::vector<int16> weights(kernel.size());
+
+					// 列を TileWidth ごとに区切り、参照する行の同じ部分を続けて使うことでキャッシュに載せたままにする
+					for (int32 x = 0; x < width; x += TileWidth)
+					{
+						const int32 n = std::min(TileWidth, (width - x));
+
+						for (int32 y = beginY; y < endY; ++y)
+						{
+							const auto [first, count] = ClampTaps(y, height, kernel, weights.data());
+							WeightedSum((src[first] + x), src.stride(), weights.data(), count, kernel.fractionBits(), (dst[y] + x), n);
+						}
+					}
+				});
+		}
+
+		using BoxBlurRowFunction = void(*)(const Color*, Color*, int32, int32);
+
+		using BoxBlurStepFunction = void(*)(int32*, const uint8*, const uint8*, uint8*, size_t, float);
+
+		/// @brief 画像の外側を端のピクセルで埋めたときの、行の先頭のピクセルを中心とする窓の各成分の和を求めます。
+		/// @param src 行
+		/// @param width 幅（ピクセル）
+		/// @param radius 窓の半径（ピクセル）
+		/// @return 各成分の和
+		[[nodiscard]]
+		std::array<int32, 4> InitialRowSum(const Color* src, const int32 width, const int32 radius) noexcept
+		{
+			std::array<int32, 4> sum{};
+
+			const auto Add = [&](const Color& color, const int32 n)
+			{
+				sum[0] += (color.r * n);
+				sum[1] += (color.g * n);
+				sum[2] += (color.b * n);
+				sum[3] += (color.a * n);
+			};
+
+			const int32 last = std::min(radius, (width - 1));
+
+			Add(src[0], (radius + 1));
+
+			for (int32 x = 1; x <= last; ++x)
+			{
+				Add(src[x], 1);
+			}
+
+			Add(src[width - 1], (radius - last));
+
+			return sum;
+		}
+
+		/// @brief 窓の和から平均を求めます。
+		[[nodiscard]]
+		inline uint8 BoxAverage(const int32 sum, const float scale) noexcept
+		{
+			return static_cast<uint8>(static_cast<int32>(static_cast<float>(sum) * scale + 0.5f));
+		}
+
+		void BoxBlurStep_Scalar(int32* sums, const uint8* in, const uint8* out, uint8* dst, const size_t n, const float scale) noexcept
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				dst[i] = BoxAverage(sums[i], scale);
+				sums[i] += (in[i] - out[i]);
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		/// @brief 1 ピクセルを読み込み、各成分を int32 にします。
+		[[nodiscard]]
+		inline __m128i LoadPixel_SSE2(const Color* p) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_loadu_si32(p), zero), zero);
+		}
+
+		/// @brief 各成分の窓の和から平均を求めます。
+		[[nodiscard]]
+		inline __m128i BoxAverage_SSE2(const __m128i sum, const __m128 scale) noexcept
+		{
+			return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale), _mm_set1_ps(0.5f)));
+		}
+
+		void BoxBlurRow_SSE2(const Color* src, Color* dst, const int32 width, const int32 radius) noexcept
+		{
+			const __m128 scale = _mm_set1_ps(1.0f / ((radius * 2) + 1));
+			const std::array<int32, 4> initial = InitialRowSum(src, width, radius);
+
+			// RGBA の 4 成分の和を 1 つのレジスタで更新する
+			__m128i sum = _mm_setr_epi32(initial[0], initial[1], initial[2], initial[3]);
+
+			for (int32 x = 0; x < width; ++x)
+			{
+				const __m128i v = _mm_packs_epi32(BoxAverage_SSE2(sum, scale), _mm_setzero_si128());
+				_mm_storeu_si32((dst + x), _mm_packus_epi16(v, v));
+
+				const __m128i in = LoadPixel_SSE2(src + std::min((x + radius + 1), (width - 1)));
+				const __m128i out = LoadPixel_SSE2(src + std::max((x - radius), 0));
+				sum = _mm_add_epi32(sum, _mm_sub_epi32(in, out));
+			}
+		}
+
+		void BoxBlurStep_SSE2(int32* sums, const uint8* in, const uint8* out, uint8* dst, const size_t n, const float scale) noexcept
+		{
+			const __m128 vScale = _mm_set1_ps(scale);
+			const __m128i zero = _mm_setzero_si128();
+
+			size_t i = 0;
+
+			for (; (i + 16) <= n; i += 16)
+			{
+				__m128i* pSums = reinterpret_cast<__m128i*>(sums + i);
+				const __m128i s0 = _mm_loadu_si128(pSums + 0);
+				const __m128i s1 = _mm_loadu_si128(pSums + 1);
+				const __m128i s2 = _mm_loadu_si128(pSums + 2);
+				const __m128i s3 = _mm_loadu_si128(pSums + 3);
+
+				const __m128i lo = _mm_packs_epi32(BoxAverage_SSE2(s0, vScale), BoxAverage_SSE2(s1, vScale));
+				const __m128i hi = _mm_packs_epi32(BoxAverage_SSE2(s2, vScale), BoxAverage_SSE2(s3, vScale));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+
+				// 入る行と出る行の差（-255 以上 255 以下）を 16 ビットで求め、符号拡張して和に加える
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i));
+				const __m128i dLo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				const __m128i dHi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+				_mm_storeu_si128((pSums + 0), _mm_add_epi32(s0, _mm_srai_epi32(_mm_unpacklo_epi16(dLo, dLo), 16)));
+				_mm_storeu_si128((pSums + 1), _mm_add_epi32(s1, _mm_srai_epi32(_mm_unpackhi_epi16(dLo, dLo), 16)));
+				_mm_storeu_si128((pSums + 2), _mm_add_epi32(s2, _mm_srai_epi32(_mm_unpacklo_epi16(dHi, dHi), 16)));
+				_mm_storeu_si128((pSums + 3), _mm_add_epi32(s3, _mm_srai_epi32(_mm_unpackhi_epi16(dHi, dHi), 16)));
+			}
+
+			BoxBlurStep_Scalar((sums + i), (in + i), (out + i), (dst + i), (n - i), scale);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void BoxBlurStep_AVX2(int32* sums, const uint8* in, const uint8* out, uint8* dst, const size_t n, const float scale) noexcept
+		{
+			const __m256 vScale = _mm256_set1_ps(scale);
+			const __m256 half = _mm256_set1_ps(0.5f);
+
+			// 128 ビットレーンごとに圧縮した結果を、元の並びに戻すための順序
+			const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+			size_t i = 0;
+
+			for (; (i + 32) <= n; i += 32)
+			{
+				__m256i s[4];
+				__m256i average[4];
+
+				for (size_t k = 0; k < 4; ++k)
+				{
+					s[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + i + k * 8));
+					average[k] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(s[k]), vScale), half));
+				}
+
+				const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(average[0], average[1]), _mm256_packs_epi32(average[2], average[3]));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+
+				for (size_t k = 0; k < 4; ++k)
+				{
+					const __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i + k * 8)));
+					const __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(out + i + k * 8)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + i + k * 8), _mm256_add_epi32(s[k], _mm256_sub_epi32(a, b)));
+				}
+			}
+
+			BoxBlurStep_SSE2((sums + i), (in + i), (out + i), (dst + i), (n - i), scale);
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		/// @brief 各成分の窓の和から平均を求めます。
+		[[nodiscard]]
+		inline int32x4_t BoxAverage_NEON(const int32x4_t sum, const float32x4_t scale) noexcept
+		{
+			return vcvtq_s32_f32(vaddq_f32(vmulq_f32(vcvtq_f32_s32(sum), scale), vdupq_n_f32(0.5f)));
+		}
+
+		void BoxBlurRow_NEON(const Color* src, Color* dst, const int32 width, const int32 radius) noexcept
+		{
+			const float32x4_t scale = vdupq_n_f32(1.0f / ((radius * 2) + 1));
+			const std::array<int32, 4> initial = InitialRowSum(src, width, radius);
+
+			// RGBA の 4 成分の和を 1 つのレジスタで更新する
+			int32x4_t sum = vld1q_s32(initial.data());
+
+			for (int32 x = 0; x < width; ++x)
+			{
+				const int16x4_t v = vqmovn_s32(BoxAverage_NEON(sum, scale));
+				const uint8x8_t packed = vqmovun_s16(vcombine_s16(v, v));
+				vst1_lane_u32(reinterpret_cast<uint32_t*>(dst + x), vreinterpret_u32_u8(packed), 0);
+
+				const uint32x2_t in = vld1_lane_u32(reinterpret_cast<const uint32_t*>(src + std::min((x + radius + 1), (width - 1))), vdup_n_u32(0), 0);
+				const uint32x2_t out = vld1_lane_u32(reinterpret_cast<const uint32_t*>(src + std::max((x - radius), 0)), vdup_n_u32(0), 0);
+				const int16x8_t diff = vreinterpretq_s16_u16(vsubl_u8(vreinterpret_u8_u32(in), vreinterpret_u8_u32(out)));
+				sum = vaddw_s16(sum, vget_low_s16(diff));
+			}
+		}
+
+		void BoxBlurStep_NEON(int32* sums, const uint8* in, const uint8* out, uint8* dst, const size_t n, const float scale) noexcept
+		{
+			const float32x4_t vScale = vdupq_n_f32(scale);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= n; i += 16)
+			{
+				const int32x4_t s0 = vld1q_s32(sums + i);
+				const int32x4_t s1 = vld1q_s32(sums + i + 4);
+				const int32x4_t s2 = vld1q_s32(sums + i + 8);
+				const int32x4_t s3 = vld1q_s32(sums + i + 12);
+
+				const int16x8_t lo = vcombine_s16(vqmovn_s32(BoxAverage_NEON(s0, vScale)), vqmovn_s32(BoxAverage_NEON(s1, vScale)));
+				const int16x8_t hi = vcombine_s16(vqmovn_s32(BoxAverage_NEON(s2, vScale)), vqmovn_s32(BoxAverage_NEON(s3, vScale)));
+				vst1q_u8((dst + i), vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+
+				// 入る行と出る行の差（-255 以上 255 以下）は、符号なしの差を符号付きとして読めばよい
+				const uint8x16_t a = vld1q_u8(in + i);
+				const uint8x16_t b = vld1q_u8(out + i);
+				const int16x8_t dLo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(a), vget_low_u8(b)));
+				const int16x8_t dHi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(a), vget_high_u8(b)));
+
+				vst1q_s32((sums + i), vaddw_s16(s0, vget_low_s16(dLo)));
+				vst1q_s32((sums + i + 4), vaddw_s16(s1, vget_high_s16(dLo)));
+				vst1q_s32((sums + i + 8), vaddw_s16(s2, vget_low_s16(dHi)));
+				vst1q_s32((sums + i + 12), vaddw_s16(s3, vget_high_s16(dHi)));
+			}
+
+			BoxBlurStep_Scalar((sums + i), (in + i), (out + i), (dst + i), (n - i), scale);
+		}
+
+	#else
+
+		// SSE2 と NEON の実装は端数の処理にスカラー実装を使わないので、ほかの CPU の場合だけ定義する
+		void BoxBlurRow_Scalar(const Color* src, Color* dst, const int32 width, const int32 radius) noexcept
+		{
+			const float scale = (1.0f / ((radius * 2) + 1));
+			std::array<int32, 4> sum = InitialRowSum(src, width, radius);
+
+			for (int32 x = 0; x < width; ++x)
+			{
+				dst[x] = Color{ BoxAverage(sum[0], scale), BoxAverage(sum[1], scale), BoxAverage(sum[2], scale), BoxAverage(sum[3], scale) };
+
+				// 窓を 1 ピクセル右に動かす
+				const Color& in = src[std::min((x + radius + 1), (width - 1))];
+				const Color& out = src[std::max((x - radius), 0)];
+				sum[0] += (in.r - out.r);
+				sum[1] += (in.g - out.g);
+				sum[2] += (in.b - out.b);
+				sum[3] += (in.a - out.a);
+			}
+		}
+
+	#endif
+
+		[[nodiscard]]
+		BoxBlurRowFunction SelectBoxBlurRow() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return BoxBlurRow_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return BoxBlurRow_NEON;
+
+		#else
+
+			return BoxBlurRow_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		BoxBlurStepFunction SelectBoxBlurStep() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return BoxBlurStep_AVX2;
+			}
+
+			return BoxBlurStep_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return BoxBlurStep_NEON;
+
+		#else
+
+			return BoxBlurStep_Scalar;
+
+		#endif
+		}
+
+		/// @brief 各行に横方向のボックスブラーをかけます。
+		/// @param src 元の画像
+		/// @param dst 書き込み先のビュー（src と同じ大きさ）。src と重なってはいけません
+		/// @param radius 半径（ピクセル）
+		void BoxBlurHorizontal(const ConstImageView& src, const ImageView& dst, const int32 radius)
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const BoxBlurRowFunction function = SelectBoxBlurRow();
+
+			dst.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						function(src[y], dst[y], src.width(), radius);
+					}
+				});
+		}
+
+		/// @brief 縦方向のボックスブラーをかけます。
+		/// @param src 元の画像
+		/// @param dst 書き込み先のビュー（src と同じ大きさ）。src と重なってはいけません
+		/// @param radius 半径（ピクセル）
+		void BoxBlurVertical(const ConstImageView& src, const ImageView& dst, const int32 radius)
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const BoxBlurStepFunction function = SelectBoxBlurStep();
+
+			const int32 width = src.width();
+			const int32 height = src.height();
+			const float scale = (1.0f / ((radius * 2) + 1));
+
+			// 画像を TileWidth 列 × bandRows 行のタイルに分け、タイルごとに列の和を更新しながら下に進む。
+			// タイルの最初の行では窓全体の和を求め直すので、その分のコストが小さくなるように bandRows を決める
+			const int32 bandRows = std::max(TileHeight, (((radius * 2) + 1) * 4));
+			const size_t numStrips = ((width + (TileWidth - 1)) / TileWidth);
+			const size_t numBands = ((height + (bandRows - 1)) / bandRows);
+
+			ParallelFor(0, (numStrips * numBands), [&](const size_t beginTile, const size_t endTile)
+				{
+					std::vector<int32> sums(TileWidth * sizeof(Color));
+
+					for (size_t tile = beginTile; tile < endTile; ++tile)
+					{
+						const int32 x = static_cast<int32>((tile % numStrips) * TileWidth);
+						const int32 n = (std::min(TileWidth, (width - x)) * static_cast<int32>(sizeof(Color)));
+						const int32 beginY = static_cast<int32>((tile / numStrips) * bandRows);
+						const int32 endY = std::min((beginY + bandRows), height);
+
+						const auto Row = [&](const int32 y)
+						{
+							return reinterpret_cast<const uint8*>(src[std::clamp(y, 0, (height - 1))] + x);
+						};
+
+						// beginY を中心とする窓の和。画像の外側の行は端の行の繰り返しとして数える
+						const auto AddRow = [&](const int32 y, const int32 count)
+						{
+							const uint8* pSrc = Row(y);
+
+							for (int32 i = 0; i < n; ++i)
+							{
+								sums[i] += (pSrc[i] * count);
+							}
+						};
+
+						std::fill_n(sums.begin(), n, 0);
+
+						const int32 top = (beginY - radius);
+						const int32 bottom = (beginY + radius);
+
+						AddRow(0, std::max(-top, 0));
+
+						for (int32 y = std::max(top, 0); y <= std::min(bottom, (height - 1)); ++y)
+						{
+							AddRow(y, 1);
+						}
+
+						AddRow((height - 1), std::max((bottom - (height - 1)), 0));
+
+						for (int32 y = beginY; y < endY; ++y)
+						{
+							function(sums.data(), Row(y + radius + 1), Row(y - radius), reinterpret_cast<uint8*>(dst[y] + x), n, scale);
+						}
+					}
+				});
+		}
+
+		/// @brief 3 回のボックスブラーで、標準偏差 sigma のガウスぼかしを近似するための半径を求めます。
+		/// @param sigma 標準偏差（ピクセル）
+		/// @return 各回の半径
+		/// @remark 幅 w のボックスブラーの分散は (w^2 - 1) / 12 なので、3 回の分散の和が sigma^2 に最も近くなるように、連続する 2 つの奇数の幅を組み合わせる。
+		[[nodiscard]]
+		std::array<int32, 3> GetGaussianBoxRadii(const double sigma) noexcept
+		{
+			constexpr int32 n = 3;
+			const double variance = (sigma * sigma);
+
+			// sigma が非常に大きい場合に int32 への変換が範囲外にならないよう、変換する前に最大の半径の幅に制限する
+			const double idealWidth = std::floor(std::sqrt((12.0 * variance / n) + 1.0));
+			int32 wl = static_cast<int32>(std::min(idealWidth, static_cast<double>(MaxBoxRadius * 2 + 1)));
+
+			if ((wl % 2) == 0)
+			{
+				--wl;
+			}
+
+			const int32 wu = (wl + 2);
+			const double w = wl;
+			const double mIdeal = ((12.0 * variance - (n * w * w) - (4.0 * n * w) - (3.0 * n)) / ((-4.0 * w) - 4.0));
+			const int32 m = static_cast<int32>(std::lround(std::clamp(mIdeal, 0.0, static_cast<double>(n))));
+
+			std::array<int32, 3> radii{};
+
+			for (int32 i = 0; i < n; ++i)
+			{
+				radii[i] = std::min((((i < m) ? wl : wu) / 2), MaxBoxRadius);
+			}
+
+			return radii;
+		}
+	}
+
+	ConvolutionKernel::ConvolutionKernel(std::vector<int16> weights, const int32 fractionBits)
+		: m_weights{ std::move(weights) }
+		, m_fractionBits{ std::clamp(fractionBits, 0, MaxFractionBits) }
+	{
+		// 中央の重みが決まるように、重みの数を奇数にする
+		if ((m_weights.size() % 2) == 0)
+		{
+			if (not m_weights.empty())
+			{
+				m_weights.push_back(0);
+			}
+		}
+	}
+
+	ConvolutionKernel ConvolutionKernel::FromWeights(const std::span<const double> weights)
+	{
+		if (weights.empty())
+		{
+			return{};
+		}
+
+		double sum = 0.0, maxAbs = 0.0, totalAbs = 0.0;
+
+		for (const double weight : weights)
+		{
+			sum += weight;
+			maxAbs = std::max(maxAbs, std::abs(weight));
+			totalAbs += std::abs(weight);
+		}
+
+		// 重みが int16 に収まり、積和が int32 に収まる範囲で、小数部のビット数を最大にする
+		int32 fractionBits = MaxFractionBits;
+
+		while ((0 < fractionBits) && ((MaxWeight < (maxAbs * (1 << fractionBits))) || (MaxTotalWeight < (totalAbs * (1 << fractionBits)))))
+		{
+			--fractionBits;
+		}
+
+		// 丸め誤差を最大剰余法で各重みに配り、重みの合計を保つ
+		const double scale = (1 << fractionBits);
+		std::vector<int16> result(weights.size());
+		QuantizeWeights(weights, scale, static_cast<int32>(std::lround(sum * scale)), result);
+
+		return ConvolutionKernel{ std::move(result), fractionBits };
+	}
+
+	ConvolutionKernel ConvolutionKernel::Gaussian(const double sigma)
+	{
+		if (not (0.0 < sigma))
+		{
+			return{};
+		}
+
+		const int32 radius = std::max(static_cast<int32>(std::ceil(sigma * 3.0)), 1);
+		std::vector<double> weights((radius * 2) + 1);
+		double total = 0.0;
+
+		for (int32 i = -radius; i <= radius; ++i)
+		{
+			const double weight = std::exp(-(i * i) / (2.0 * sigma * sigma));
+			weights[i + radius] = weight;
+			total += weight;
+		}
+
+		for (double& weight : weights)
+		{
+			weight /= total;
+		}
+
+		return FromWeights(weights);
+	}
+
+	ConvolutionKernel ConvolutionKernel::Box(const int32 radius)
+	{
+		if (radius <= 0)
+		{
+			return{};
+		}
+
+		const std::vector<double> weights(((radius * 2) + 1), (1.0 / ((radius * 2) + 1)));
+		return FromWeights(weights);
+	}
+
+	void Convolve(const ConstImageView& src, const ImageView& dst, const ConvolutionKernel& horizontal, const ConvolutionKernel& vertical)
+	{
+		const ConstImageView source = src.subView(Rect{ dst.width(), dst.height() });
+		const ImageView target = dst.subView(Rect{ src.width(), src.height() });
+
+		if (source.isEmpty() || target.isEmpty())
+		{
+			return;
+		}
+
+		if (vertical.isEmpty())
+		{
+			if (horizontal.isEmpty())
+			{
+				if (source.data() != target.data())
+				{
+					target.copyFrom(source);
+				}
+			}
+			else
+			{
+				// 各行を作業用の行にコピーしてから畳み込むので、src と dst が同じでもよい
+				ConvolveHorizontal(source, target, horizontal);
+			}
+
+			return;
+		}
+
+		if (horizontal.isEmpty())
+		{
+			if (Overlaps(source, target))
+			{
+				const Image copy{ source };
+				ConvolveVertical(copy, target, vertical);
+			}
+			else
+			{
+				ConvolveVertical(source, target, vertical);
+			}
+
+			return;
+		}
+
+		Image buffer{ source.size(), Uninitialized };
+		ConvolveHorizontal(source, buffer, horizontal);
+		ConvolveVertical(buffer, target, vertical);
+	}
+
+	Image Convolve(const ConstImageView& src, const ConvolutionKernel& horizontal, const ConvolutionKernel& vertical)
+	{
+		if (src.isEmpty())
+		{
+			return{};
+		}
+
+		Image image{ src.size(), Uninitialized };
+		Convolve(src, image, horizontal, vertical);
+		return image;
+	}
+
+	void BoxBlur(const ConstImageView& src, const ImageView& dst, int32 radius)
+	{
+		const ConstImageView source = src.subView(Rect{ dst.width(), dst.height() });
+		const ImageView target = dst.subView(Rect{ src.width(), src.height() });
+
+		if (source.isEmpty() || target.isEmpty())
+		{
+			return;
+		}
+
+		if (radius <= 0)
+		{
+			if (source.data() != target.data())
+			{
+				target.copyFrom(source);
+			}
+
+			return;
+		}
+
+		radius = std::min(radius, MaxBoxRadius);
+
+		Image buffer{ source.size(), Uninitialized };
+		BoxBlurHorizontal(source, buffer, radius);
+		BoxBlurVertical(buffer, target, radius);
+	}
+
+	Image BoxBlur(const ConstImageView& src, const int32 radius)
+	{
+		if (src.isEmpty())
+		{
+			return{};
+		}
+
+		Image image{ src.size(), Uninitialized };
+		BoxBlur(src, image, radius);
+		return image;
+	}
+
+	void GaussianBlur(const ConstImageView& src, const ImageView& dst, const double sigma)
+	{
+		const ConstImageView source = src.subView(Rect{ dst.width(), dst.height() });
+		const ImageView target = dst.subView(Rect{ src.width(), src.height() });
+
+		if (source.isEmpty() || target.isEmpty())
+		{
+			return;
+		}
+
+		if (not (0.0 < sigma))
+		{
+			if (source.data() != target.data())
+			{
+				target.copyFrom(source);
+			}
+
+			return;
+		}
+
+		if (sigma < MinBoxGaussianSigma)
+		{
+			const ConvolutionKernel kernel = ConvolutionKernel::Gaussian(sigma);
+			Convolve(source, target, kernel, kernel);
+			return;
+		}
+
+		const std::array<int32, 3> radii = GetGaussianBoxRadii(sigma);
+
+		// ボックスブラーは順序を入れ替えても結果が同じなので、横方向を 3 回かけてから縦方向を 3 回かける。
+		// 作業用の画像と dst を交互に使い、src は最初の 1 回だけ読む
+		Image buffer{ source.size(), Uninitialized };
+		BoxBlurHorizontal(source, buffer, radii[0]);
+		BoxBlurHorizontal(buffer, target, radii[1]);
+		BoxBlurHorizontal(target, buffer, radii[2]);
+		BoxBlurVertical(buffer, target, radii[0]);
+		BoxBlurVertical(target, buffer, radii[1]);
+		BoxBlurVertical(buffer, target, radii[2]);
+	}
+
+	Image GaussianBlur(const ConstImageView& src, const double sigma)
+	{
+		if (src.isEmpty())
+		{
+			return{};
+		}
+
+		Image image{ src.size(), Uninitialized };
+		GaussianBlur(src, image, sigma);
+		return image;
+	}
+}
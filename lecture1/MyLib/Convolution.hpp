@@ -0,0 +1,142 @@
+﻿#pragma once
+#include <span> // std::span
+#include <vector> // std::vector
+#include "Common.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+
+namespace seccamp
+{
+	/// @brief 1 次元の畳み込みのカーネル（固定小数点数の重み）
+	/// @remark 重みの数は奇数で、中央の重みが注目しているピクセルに対応します。
+	class ConvolutionKernel
+	{
+	public:
+
+		/// @brief 重みの小数部のビット数の最大値
+		static constexpr int32 MaxFractionBits = 14;
+
+		/// @brief デフォルトコンストラクタ。空のカーネル（何もしない）を作成します。
+		[[nodiscard]]
+		ConvolutionKernel() = default;
+
+		/// @brief 整数の重みからカーネルを作成します。
+		/// @param weights 重み。実際の重みは weights[i] / 2^fractionBits です。数が偶数の場合は、末尾に 0 を追加します
+		/// @param fractionBits 重みの小数部のビット数 [0, MaxFractionBits]。範囲外の場合は範囲内に収めます
+		/// @remark 例えば ConvolutionKernel{ { 1, 4, 6, 4, 1 }, 4 } は、合計が 16 = 2^4 の二項分布のカーネルです。
+		[[nodiscard]]
+		ConvolutionKernel(std::vector<int16> weights, int32 fractionBits);
+
+		/// @brief 実数の重みからカーネルを作成します。
+		/// @param weights 重み。数が偶数の場合は、末尾に 0 を追加します
+		/// @return カーネル。重みが int16 に収まる範囲で、小数部のビット数を最大にします。各重みを切り捨て、合計の不足分を端数の大きい重みから 1 ずつ配って（最大剰余法）合計を保ちます。各重みの丸め誤差は 1 以下です
+		[[nodiscard]]
+		static ConvolutionKernel FromWeights(std::span<const double> weights);
+
+		/// @brief 合計が 1 になるように正規化したガウス関数のカーネルを作成します。
+		/// @param sigma 標準偏差（ピクセル）
+		/// @return 半径 ceil(3 * sigma) のカーネル。sigma が 0 以下の場合は空のカーネル
+		[[nodiscard]]
+		static ConvolutionKernel Gaussian(double sigma);
+
+		/// @brief すべての重みが等しいカーネル（移動平均）を作成します。
+		/// @param radius 半径（ピクセル）
+		/// @return 重みが 2 * radius + 1 個のカーネル。radius が 0 以下の場合は空のカーネル
+		/// @remark 半径が大きい場合は、計算量が半径によらない BoxBlur() を使ってください。
+		[[nodiscard]]
+		static ConvolutionKernel Box(int32 radius);
+
+		/// @brief 重みの数を返します。
+		/// @return 重みの数
+		[[nodiscard]]
+		size_t size() const noexcept
+		{
+			return m_weights.size();
+		}
+
+		/// @brief カーネルの半径を返します。
+		/// @return 中央の重みから端の重みまでの距離（ピクセル）
+		[[nodiscard]]
+		int32 radius() const noexcept
+		{
+			return static_cast<int32>(m_weights.size() / 2);
+		}
+
+		/// @brief カーネルが空であるかを返します。
+		/// @return カーネルが空である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept
+		{
+			return m_weights.empty();
+		}
+
+		/// @brief 重みを返します。
+		/// @return 重み。実際の重みは weights()[i] / 2^fractionBits() です
+		[[nodiscard]]
+		std::span<const int16> weights() const noexcept
+		{
+			return m_weights;
+		}
+
+		/// @brief 重みの小数部のビット数を返します。
+		/// @return 重みの小数部のビット数
+		[[nodiscard]]
+		int32 fractionBits() const noexcept
+		{
+			return m_fractionBits;
+		}
+
+	private:
+
+		std::vector<int16> m_weights;
+
+		int32 m_fractionBits = 0;
+	};
+
+	/// @brief 横方向と縦方向のカーネルで、画像を畳み込みます（分離可能フィルタ）。
+	/// @param src 元の画像
+	/// @param dst 書き込み先のビュー。src と同じビューを指定することもできます（部分的に重なってはいけません）
+	/// @param horizontal 横方向のカーネル。空の場合は横方向に畳み込みません
+	/// @param vertical 縦方向のカーネル。空の場合は縦方向に畳み込みません
+	/// @remark 画像の外側は、端のピクセルが続いているものとして扱います。大きさが異なる場合は、重なる左上の部分だけを使います。
+	/// @remark 横方向の結果は一度 [0, 255] の整数に丸めてから、縦方向に畳み込みます。
+	void Convolve(const ConstImageView& src, const ImageView& dst, const ConvolutionKernel& horizontal, const ConvolutionKernel& vertical);
+
+	/// @brief 横方向と縦方向のカーネルで、画像を畳み込んだ画像を返します（分離可能フィルタ）。
+	/// @param src 元の画像
+	/// @param horizontal 横方向のカーネル。空の場合は横方向に畳み込みません
+	/// @param vertical 縦方向のカーネル。空の場合は縦方向に畳み込みません
+	/// @return 畳み込んだ画像
+	/// @remark 画像の外側は、端のピクセルが続いているものとして扱います。
+	[[nodiscard]]
+	Image Convolve(const ConstImageView& src, const ConvolutionKernel& horizontal, const ConvolutionKernel& vertical);
+
+	/// @brief 画像にボックスブラー（移動平均）をかけます。
+	/// @param src 元の画像
+	/// @param dst 書き込み先のビュー。src と同じビューを指定することもできます（部分的に重なってはいけません）
+	/// @param radius 半径（ピクセル）。0 以下の場合はコピーします
+	/// @remark 累積和を更新しながら計算するため、計算量は半径によらず一定です。画像の外側は、端のピクセルが続いているものとして扱います。
+	void BoxBlur(const ConstImageView& src, const ImageView& dst, int32 radius);
+
+	/// @brief 画像にボックスブラー（移動平均）をかけた画像を返します。
+	/// @param src 元の画像
+	/// @param radius 半径（ピクセル）。0 以下の場合はコピーします
+	/// @return ボックスブラーをかけた画像
+	[[nodiscard]]
+	Image BoxBlur(const ConstImageView& src, int32 radius);
+
+	/// @brief 画像にガウスぼかしをかけます。
+	/// @param src 元の画像
+	/// @param dst 書き込み先のビュー。src と同じビューを指定することもできます（部分的に重なってはいけません）
+	/// @param sigma 標準偏差（ピクセル）。0 以下の場合はコピーします
+	/// @remark 標準偏差が sigma に近くなるように半径を選んだボックスブラーを 3 回かけて近似します。計算量は sigma によらず一定です。
+	/// sigma が 2.0 未満の場合は、ConvolutionKernel::Gaussian() のカーネルで畳み込みます。
+	void GaussianBlur(const ConstImageView& src, const ImageView& dst, double sigma);
+
+	/// @brief 画像にガウスぼかしをかけた画像を返します。
+	/// @param src 元の画像
+	/// @param sigma 標準偏差（ピクセル）。0 以下の場合はコピーします
+	/// @return ガウスぼかしをかけた画像
+	[[nodiscard]]
+	Image GaussianBlur(const ConstImageView& src, double sigma);
+}
@@ -0,0 +1,1732 @@
+﻿#include <algorithm> // std::fill_n, std::copy_n, std::max, std::min, std::sort, std::ranges::all_of
+#include <array> // std::array
+#include <bit> // std::endian, std::byteswap, std::bit_width, std::countr_zero
+#include <cstring> // std::memcpy, std::memset
+#include <limits> // std::numeric_limits
+#include <utility> // std::pair
+#include "Deflate.hpp"
+#include "ThreadPool.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief ハフマン符号の最大の長さ（ビット）
+		constexpr int32 MaxCodeLength = 15;
+
+		/// @brief リテラル・長さの表を 1 段目で引くビット数
+		constexpr int32 LiteralTableBits = 10;
+
+		/// @brief 距離の表を 1 段目で引くビット数
+		constexpr int32 DistanceTableBits = 8;
+
+		/// @brief 符号長の表を引くビット数（符号長の符号は最大 7 ビット）
+		constexpr int32 CodeLengthTableBits = 7;
+
+		constexpr size_t NumLiteralSymbols = 288;
+
+		constexpr size_t NumDistanceSymbols = 32;
+
+		constexpr size_t NumCodeLengthSymbols = 19;
+
+		/// @brief 1 段目の表と、1 段目に収まらない長い符号のための 2 段目の表の合計の最大の大きさ
+		/// @remark 2 段目の表は、長い符号を持つ記号 1 つにつき最大 1 つ作られる
+		constexpr size_t LiteralTableSize = ((size_t{ 1 } << LiteralTableBits) + NumLiteralSymbols * (size_t{ 1 } << (MaxCodeLength - LiteralTableBits)));
+
+		constexpr size_t DistanceTableSize = ((size_t{ 1 } << DistanceTableBits) + NumDistanceSymbols * (size_t{ 1 } << (MaxCodeLength - DistanceTableBits)));
+
+		constexpr size_t CodeLengthTableSize = (size_t{ 1 } << CodeLengthTableBits);
+
+		/// @brief 一致の長さの最大値
+		constexpr size_t MaxMatchLength = 258;
+
+		constexpr std::array<uint16, 29> LengthBase = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+
+		constexpr std::array<uint8, 29> LengthExtraBits = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+		constexpr std::array<uint16, 30> DistanceBase = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+
+		constexpr std::array<uint8, 30> DistanceExtraBits = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		/// @brief 符号長の記号 16, 17, 18 の追加ビット数
+		constexpr std::array<uint8, NumCodeLengthSymbols> CodeLengthExtraBits = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7 };
+
+		/// @brief 符号長の符号長が格納される順番
+		constexpr std::array<uint8, NumCodeLengthSymbols> CodeLengthOrder = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		/// @brief 表の要素の種類
+		enum class EntryKind : uint32
+		{
+			/// @brief リテラル、距離、符号長などの値
+			Value,
+
+			/// @brief 一致の長さ
+			Length,
+
+			/// @brief ブロックの終端
+			EndOfBlock,
+
+			/// @brief 2 段目の表への参照
+			Subtable,
+
+			/// @brief 使われていない符号
+			Invalid,
+		};
+
+		/// @brief 表の要素を作成します。
+		/// @param kind 要素の種類
+		/// @param value 値、長さや距離の基準値、または 2 段目の表の位置
+		/// @param extraBits 追加で読むビット数、または 2 段目の表を引くビット数
+		/// @param codeLength この要素で消費するビット数
+		/// @return 表の要素。ビット 16-31 が値、8-15 が追加のビット数、4-7 が種類、0-3 が消費するビット数
+		[[nodiscard]]
+		constexpr uint32 MakeEntry(const EntryKind kind, const uint32 value, const uint32 extraBits, const uint32 codeLength = 0) noexcept
+		{
+			return ((value << 16) | (extraBits << 8) | (static_cast<uint32>(kind) << 4) | codeLength);
+		}
+
+		constexpr uint32 InvalidEntry = MakeEntry(EntryKind::Invalid, 0, 0);
+
+		[[nodiscard]]
+		constexpr EntryKind GetKind(const uint32 entry) noexcept
+		{
+			return static_cast<EntryKind>((entry >> 4) & 0xF);
+		}
+
+		[[nodiscard]]
+		constexpr uint32 GetValue(const uint32 entry) noexcept
+		{
+			return (entry >> 16);
+		}
+
+		[[nodiscard]]
+		constexpr uint32 GetExtraBits(const uint32 entry) noexcept
+		{
+			return ((entry >> 8) & 0xFF);
+		}
+
+		[[nodiscard]]
+		constexpr uint32 GetCodeLength(const uint32 entry) noexcept
+		{
+			return (entry & 0xF);
+		}
+
+		[[nodiscard]]
+		constexpr uint32 ReverseBits(uint32 code, const int32 length) noexcept
+		{
+			uint32 result = 0;
+
+			for (int32 i = 0; i < length; ++i)
+			{
+				result = ((result << 1) | (code & 1));
+				code >>= 1;
+			}
+
+			return result;
+		}
+
+		[[nodiscard]]
+		constexpr uint32 MakeLiteralEntry(const size_t symbol) noexcept
+		{
+			if (symbol < 256)
+			{
+				return MakeEntry(EntryKind::Value, static_cast<uint32>(symbol), 0);
+			}
+			else if (symbol == 256)
+			{
+				return MakeEntry(EntryKind::EndOfBlock, 0, 0);
+			}
+			else if (symbol < (257 + LengthBase.size()))
+			{
+				return MakeEntry(EntryKind::Length, LengthBase[symbol - 257], LengthExtraBits[symbol - 257]);
+			}
+
+			return InvalidEntry;
+		}
+
+		[[nodiscard]]
+		constexpr uint32 MakeDistanceEntry(const size_t symbol) noexcept
+		{
+			if (symbol < DistanceBase.size())
+			{
+				return MakeEntry(EntryKind::Value, DistanceBase[symbol], DistanceExtraBits[symbol]);
+			}
+
+			return InvalidEntry;
+		}
+
+		[[nodiscard]]
+		constexpr uint32 MakeCodeLengthEntry(const size_t symbol) noexcept
+		{
+			return MakeEntry(EntryKind::Value, static_cast<uint32>(symbol), 0);
+		}
+
+		/// @brief 符号長から、ハフマン符号を復号する表を作成します。
+		/// @param lengths 各記号の符号長。0 の記号は使われません
+		/// @param tableBits 1 段目の表を引くビット数
+		/// @param table 表の格納先
+		/// @param makeEntry 記号から表の要素を作る関数
+		/// @return 表を作成できた場合 true, 符号長が不正な場合は false
+		/// @remark 符号はビット列の下位から順に格納されるので、ビットを反転した符号の位置に要素を置きます。
+		/// 1 段目に収まらない長い符号は、1 段目の要素が指す 2 段目の表に置きます。
+		template <class Fty>
+		[[nodiscard]]
+		bool BuildTable(const std::span<const uint8> lengths, const int32 tableBits, const std::span<uint32> table, Fty makeEntry) noexcept
+		{
+			std::array<uint32, (MaxCodeLength + 1)> counts{};
+
+			for (const uint8 length : lengths)
+			{
+				++counts[length];
+			}
+
+			counts[0] = 0;
+
+			// 符号の数が多すぎないかを確認する（符号が足りない場合は、使われない符号を不正な要素にする）
+			int32 left = 1;
+			int32 maxLength = 0;
+
+			for (int32 length = 1; length <= MaxCodeLength; ++length)
+			{
+				left = ((left << 1) - static_cast<int32>(counts[length]));
+
+				if (left < 0)
+				{
+					return false;
+				}
+
+				if (counts[length])
+				{
+					maxLength = length;
+				}
+			}
+
+			// 各符号長の最初の符号（標準ハフマン符号）
+			std::array<uint32, (MaxCodeLength + 1)> nextCode{};
+
+			for (int32 length = 1; length <= MaxCodeLength; ++length)
+			{
+				nextCode[length] = ((nextCode[length - 1] + counts[length - 1]) << 1);
+			}
+
+			const size_t primarySize = (size_t{ 1 } << tableBits);
+			const uint32 subtableBits = static_cast<uint32>(std::max((maxLength - tableBits), 0));
+			const size_t subtableSize = (size_t{ 1 } << subtableBits);
+			size_t nextSubtable = primarySize;
+
+			std::fill_n(table.begin(), primarySize, InvalidEntry);
+
+			for (size_t symbol = 0; symbol < lengths.size(); ++symbol)
+			{
+				const int32 length = lengths[symbol];
+
+				if (length == 0)
+				{
+					continue;
+				}
+
+				const uint32 code = ReverseBits(nextCode[length]++, length);
+				const uint32 entry = makeEntry(symbol);
+
+				if (length <= tableBits)
+				{
+					for (size_t i = code; i < primarySize; i += (size_t{ 1 } << length))
+					{
+						table[i] = (entry | static_cast<uint32>(length));
+					}
+
+					continue;
+				}
+
+				// 下位 tableBits ビットが同じ符号は、同じ 2 段目の表を使う
+				uint32& primary = table[code & (primarySize - 1)];
+
+				if (GetKind(primary) != EntryKind::Subtable)
+				{
+					if (table.size() < (nextSubtable + subtableSize))
+					{
+						return false;
+					}
+
+					primary = MakeEntry(EntryKind::Subtable, static_cast<uint32>(nextSubtable), subtableBits, static_cast<uint32>(tableBits));
+					std::fill_n((table.begin() + nextSubtable), subtableSize, InvalidEntry);
+					nextSubtable += subtableSize;
+				}
+
+				const size_t subtable = GetValue(primary);
+				const int32 subLength = (length - tableBits);
+
+				for (size_t i = (code >> tableBits); i < subtableSize; i += (size_t{ 1 } << subLength))
+				{
+					table[subtable + i] = (entry | static_cast<uint32>(subLength));
+				}
+			}
+
+			return true;
+		}
+
+		/// @brief 固定ハフマン符号の表
+		struct FixedTables
+		{
+			std::array<uint32, LiteralTableSize> literal;
+
+			std::array<uint32, DistanceTableSize> distance;
+
+			FixedTables() noexcept
+			{
+				std::array<uint8, NumLiteralSymbols> literalLengths;
+				std::fill_n(literalLengths.begin(), 144, uint8{ 8 });
+				std::fill_n((literalLengths.begin() + 144), 112, uint8{ 9 });
+				std::fill_n((literalLengths.begin() + 256), 24, uint8{ 7 });
+				std::fill_n((literalLengths.begin() + 280), 8, uint8{ 8 });
+
+				std::array<uint8, NumDistanceSymbols> distanceLengths;
+				distanceLengths.fill(5);
+
+				(void)BuildTable(literalLengths, LiteralTableBits, literal, MakeLiteralEntry);
+				(void)BuildTable(distanceLengths, DistanceTableBits, distance, MakeDistanceEntry);
+			}
+		};
+
+		[[nodiscard]]
+		uint64 LoadLE64(const uint8* p) noexcept
+		{
+			uint64 value;
+			std::memcpy(&value, p, sizeof(value));
+
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				value = std::byteswap(value);
+			}
+
+			return value;
+		}
+
+		/// @brief Deflate 形式のデータを展開するクラス
+		class Inflater
+		{
+		public:
+
+			Inflater(const std::span<const uint8> src, const std::span<uint8> dst) noexcept
+				: m_in{ src.data() }
+				, m_inEnd{ src.data() + src.size() }
+				, m_outBegin{ dst.data() }
+				, m_out{ dst.data() }
+				, m_outEnd{ dst.data() + dst.size() } {}
+
+			/// @brief すべてのブロックを展開します。
+			/// @return 展開したデータのサイズ（バイト）。失敗した場合は -1
+			[[nodiscard]]
+			int64 run() noexcept
+			{
+				static const FixedTables fixedTables;
+
+				for (bool isFinal = false; not isFinal;)
+				{
+					refill();
+
+					isFinal = (readBits(1) != 0);
+
+					const uint32 type = readBits(2);
+
+					bool result = false;
+
+					if (type == 0)
+					{
+						result = decodeStored();
+					}
+					else if (type == 1)
+					{
+						result = decodeHuffman(fixedTables.literal.data(), fixedTables.distance.data());
+					}
+					else if (type == 2)
+					{
+						result = (readDynamicTables() && decodeHuffman(m_literalTable.data(), m_distanceTable.data()));
+					}
+
+					// 入力の終端を越えて読んだ場合は、データが途中で切れている
+					if ((not result) || ((m_overrun * 8) > static_cast<size_t>(m_numBits)))
+					{
+						return -1;
+					}
+				}
+
+				return (m_out - m_outBegin);
+			}
+
+		private:
+
+			const uint8* m_in;
+
+			const uint8* m_inEnd;
+
+			uint8* m_outBegin;
+
+			uint8* m_out;
+
+			uint8* m_outEnd;
+
+			// 読み込んだが、まだ消費していないビット（下位から順に使う）
+			uint64 m_bits = 0;
+
+			int32 m_numBits = 0;
+
+			// 入力の終端を越えて、0 として補ったバイト数
+			size_t m_overrun = 0;
+
+			std::array<uint32, LiteralTableSize> m_literalTable;
+
+			std::array<uint32, DistanceTableSize> m_distanceTable;
+
+			/// @brief ビットを補充し、56 ビット以上にします。
+			void refill() noexcept
+			{
+				if (8 <= (m_inEnd - m_in))
+				{
+					// 8 バイトまとめて読み込み、収まった分だけ読み込み位置を進める
+					m_bits |= (LoadLE64(m_in) << m_numBits);
+					m_in += ((63 - m_numBits) >> 3);
+					m_numBits |= 56;
+					return;
+				}
+
+				// 入力の終端付近では 1 バイトずつ読み込み、終端を越えた分は 0 で補う
+				while (m_numBits <= 56)
+				{
+					uint64 byte = 0;
+
+					if (m_in < m_inEnd)
+					{
+						byte = *m_in++;
+					}
+					else
+					{
+						++m_overrun;
+					}
+
+					m_bits |= (byte << m_numBits);
+					m_numBits += 8;
+				}
+			}
+
+			[[nodiscard]]
+			uint32 readBits(const uint32 n) noexcept
+			{
+				const uint32 value = static_cast<uint32>(m_bits & ((uint64{ 1 } << n) - 1));
+				m_bits >>= n;
+				m_numBits -= n;
+				return value;
+			}
+
+			/// @brief 表を引いて 1 つの記号を復号します。
+			/// @remark 15 ビット以上が補充されている必要があります。
+			[[nodiscard]]
+			uint32 decodeSymbol(const uint32* table, const int32 tableBits) noexcept
+			{
+				uint32 entry = table[m_bits & ((uint64{ 1 } << tableBits) - 1)];
+
+				if (GetKind(entry) == EntryKind::Subtable)
+				{
+					m_bits >>= tableBits;
+					m_numBits -= tableBits;
+					entry = table[GetValue(entry) + (m_bits & ((uint64{ 1 } << GetExtraBits(entry)) - 1))];
+				}
+
+				const uint32 length = GetCodeLength(entry);
+				m_bits >>= length;
+				m_numBits -= length;
+				return entry;
+			}
+
+			[[nodiscard]]
+			bool decodeStored() noexcept
+			{
+				// バイト境界にそろえ、読み込み済みで未使用のバイトを入力に戻す
+				m_bits >>= (m_numBits & 7);
+				m_numBits &= ~7;
+
+				const size_t bufferedBytes = (m_numBits >> 3);
+
+				if (bufferedBytes < m_overrun)
+				{
+					return false;
+				}
+
+				m_in -= (bufferedBytes - m_overrun);
+				m_bits = 0;
+				m_numBits = 0;
+				m_overrun = 0;
+
+				if ((m_inEnd - m_in) < 4)
+				{
+					return false;
+				}
+
+				const uint32 length = (m_in[0] | (m_in[1] << 8));
+				const uint32 lengthComplement = (m_in[2] | (m_in[3] << 8));
+				m_in += 4;
+
+				if (((length ^ 0xFFFF) != lengthComplement)
+					|| (static_cast<size_t>(m_inEnd - m_in) < length)
+					|| (static_cast<size_t>(m_outEnd - m_out) < length))
+				{
+					return false;
+				}
+
+				if (length)
+				{
+					std::memcpy(m_out, m_in, length);
+				}
+
+				m_in += length;
+				m_out += length;
+				return true;
+			}
+
+			[[nodiscard]]
+			bool readDynamicTables() noexcept
+			{
+				const size_t numLiterals = (readBits(5) + 257);
+				const size_t numDistances = (readBits(5) + 1);
+				const size_t numCodeLengths = (readBits(4) + 4);
+
+				if ((286 < numLiterals) || (30 < numDistances))
+				{
+					return false;
+				}
+
+				std::array<uint8, NumCodeLengthSymbols> codeLengthLengths{};
+
+				for (size_t i = 0; i < numCodeLengths; ++i)
+				{
+					if (m_numBits < 3)
+					{
+						refill();
+					}
+
+					codeLengthLengths[CodeLengthOrder[i]] = static_cast<uint8>(readBits(3));
+				}
+
+				std::array<uint32, CodeLengthTableSize> codeLengthTable;
+
+				if (not BuildTable(codeLengthLengths, CodeLengthTableBits, codeLengthTable, MakeCodeLengthEntry))
+				{
+					return false;
+				}
+
+				// リテラル・長さと距離の符号長は、続けて 1 つの列として格納される
+				std::array<uint8, (NumLiteralSymbols + NumDistanceSymbols)> lengths{};
+				const size_t numLengths = (numLiterals + numDistances);
+
+				for (size_t i = 0; i < numLengths;)
+				{
+					refill();
+
+					const uint32 entry = decodeSymbol(codeLengthTable.data(), CodeLengthTableBits);
+
+					if (GetKind(entry) != EntryKind::Value)
+					{
+						return false;
+					}
+
+					const uint32 symbol = GetValue(entry);
+
+					if (symbol < 16)
+					{
+						lengths[i++] = static_cast<uint8>(symbol);
+						continue;
+					}
+
+					uint8 value = 0;
+					size_t count;
+
+					if (symbol == 16)
+					{
+						// 直前の符号長を 3-6 回繰り返す
+						if (i == 0)
+						{
+							return false;
+						}
+
+						value = lengths[i - 1];
+						count = (3 + readBits(2));
+					}
+					else if (symbol == 17)
+					{
+						count = (3 + readBits(3));
+					}
+					else
+					{
+						count = (11 + readBits(7));
+					}
+
+					if ((numLengths - i) < count)
+					{
+						return false;
+					}
+
+					std::fill_n((lengths.begin() + i), count, value);
+					i += count;
+				}
+
+				// ブロックの終端の符号がない場合は、ブロックを終了できない
+				if (lengths[256] == 0)
+				{
+					return false;
+				}
+
+				return (BuildTable(std::span{ lengths.data(), numLiterals }, LiteralTableBits, m_literalTable, MakeLiteralEntry)
+					&& BuildTable(std::span{ (lengths.data() + numLiterals), numDistances }, DistanceTableBits, m_distanceTable, MakeDistanceEntry));
+			}
+
+			/// @brief 一致した範囲をコピーします。
+			void copyMatch(const size_t length, const size_t distance) noexcept
+			{
+				uint8* pDst = m_out;
+				const uint8* pSrc = (m_out - distance);
+				uint8* const pEnd = (m_out + length);
+
+				if ((8 <= distance) && ((length + 8) <= static_cast<size_t>(m_outEnd - m_out)))
+				{
+					// 8 バイト単位でコピーする。コピー元は常にコピー先より 8 バイト以上前にある
+					do
+					{
+						std::memcpy(pDst, pSrc, 8);
+						pDst += 8;
+						pSrc += 8;
+					} while (pDst < pEnd);
+				}
+				else if (distance == 1)
+				{
+					// 同じバイトの繰り返し
+					std::memset(pDst, *pSrc, length);
+				}
+				else
+				{
+					while (pDst < pEnd)
+					{
+						*pDst++ = *pSrc++;
+					}
+				}
+
+				m_out = pEnd;
+			}
+
+			[[nodiscard]]
+			bool decodeHuffman(const uint32* literalTable, const uint32* distanceTable) noexcept
+			{
+				for (;;)
+				{
+					refill();
+
+					uint32 entry = decodeSymbol(literalTable, LiteralTableBits);
+
+					// リテラルが続く間は、残りのビットが足りる限り補充せずに復号する
+					while (GetKind(entry) == EntryKind::Value)
+					{
+						if (m_out == m_outEnd)
+						{
+							return false;
+						}
+
+						*m_out++ = static_cast<uint8>(GetValue(entry));
+
+						if (m_numBits < MaxCodeLength)
+						{
+							refill();
+						}
+
+						entry = decodeSymbol(literalTable, LiteralTableBits);
+					}
+
+					const EntryKind kind = GetKind(entry);
+
+					if (kind == EntryKind::EndOfBlock)
+					{
+						return true;
+					}
+					else if (kind != EntryKind::Length)
+					{
+						return false;
+					}
+
+					// 長さの追加ビット（最大 5）、距離の符号（最大 15）と追加ビット（最大 13）の分を補充する
+					if (m_numBits < (5 + MaxCodeLength + 13))
+					{
+						refill();
+					}
+
+					const size_t length = (GetValue(entry) + readBits(GetExtraBits(entry)));
+					const uint32 distanceEntry = decodeSymbol(distanceTable, DistanceTableBits);
+
+					if (GetKind(distanceEntry) != EntryKind::Value)
+					{
+						return false;
+					}
+
+					const size_t distance = (GetValue(distanceEntry) + readBits(GetExtraBits(distanceEntry)));
+
+					if ((static_cast<size_t>(m_out - m_outBegin) < distance)
+						|| (static_cast<size_t>(m_outEnd - m_out) < length))
+					{
+						return false;
+					}
+
+					copyMatch(length, distance);
+				}
+			}
+		};
+
+		static_assert(MaxMatchLength == LengthBase.back());
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	圧縮
+		//
+		////////////////////////////////////////////////////////////////
+
+		/// @brief 一致を参照できる最大の距離（バイト）
+		constexpr size_t WindowSize = (1 << 15);
+
+		constexpr size_t WindowMask = (WindowSize - 1);
+
+		/// @brief 一致の候補を探すハッシュ表のビット数
+		constexpr int32 HashBits = 15;
+
+		/// @brief 出力する一致の最小の長さ
+		/// @remark 先頭の 4 バイトのハッシュ値で候補を探すので、Deflate の最小（3）ではなく 4 にします。
+		constexpr size_t MinMatchLength = 4;
+
+		/// @brief 1 つのブロックに含める記号の最大数
+		constexpr size_t MaxBlockSymbols = (1 << 15);
+
+		/// @brief 非圧縮ブロック 1 つに格納できる最大のサイズ（バイト）
+		constexpr size_t MaxStoredBlockSize = 65535;
+
+		/// @brief 並列に圧縮するとき、1 つのタスクで圧縮するデータのサイズ（バイト）
+		constexpr size_t SegmentSize = (1 << 18);
+
+		/// @brief 圧縮レベルごとの一致の検索方法
+		struct LevelParameters
+		{
+			/// @brief 1 つの位置で調べる候補の最大数
+			uint32 maxChainLength;
+
+			/// @brief この長さ以上の一致が見つかったら、検索を打ち切る
+			uint32 niceLength;
+
+			/// @brief 遅延一致で、この長さ以上の一致がすでにある場合は、調べる候補の数を 1/4 にする
+			uint32 goodLength;
+
+			/// @brief この長さより短い一致の場合だけ、次の位置でより長い一致を探す（0 の場合は遅延一致を使わない）
+			uint32 lazyLength;
+
+			/// @brief 一致した範囲の内側の位置もハッシュ表に登録するか
+			bool insertAll;
+
+			/// @brief ブロック用のハフマン符号を作成するか
+			bool dynamic;
+		};
+
+		constexpr std::array<LevelParameters, 4> LevelParameterTable =
+		{{
+			{ 1, 258, 0, 0, false, false },			// Fastest
+			{ 8, 32, 0, 0, true, true },			// Fast
+			{ 128, 128, 8, 16, true, true },		// Default
+			{ 1024, 258, 32, 258, true, true },		// Best
+		}};
+
+		/// @brief 一致の長さ（3-258）から、長さの符号（0-28）への表
+		constexpr std::array<uint8, (MaxMatchLength + 1)> LengthCodes = []()
+		{
+			std::array<uint8, (MaxMatchLength + 1)> codes{};
+
+			for (size_t code = 0; code < LengthBase.size(); ++code)
+			{
+				for (size_t length = LengthBase[code]; length < (LengthBase[code] + (size_t{ 1 } << LengthExtraBits[code])); ++length)
+				{
+					if (length <= MaxMatchLength)
+					{
+						codes[length] = static_cast<uint8>(code);
+					}
+				}
+			}
+
+			// 258 は 284 番の範囲にも含まれるが、専用の 285 番を使う
+			codes[MaxMatchLength] = static_cast<uint8>(LengthBase.size() - 1);
+			return codes;
+		}();
+
+		/// @brief 一致の距離（1-32768）から、距離の符号（0-29）を返します。
+		[[nodiscard]]
+		constexpr uint32 GetDistanceCode(const uint32 distance) noexcept
+		{
+			const uint32 x = (distance - 1);
+
+			if (x < 2)
+			{
+				return x;
+			}
+
+			// 距離の符号は、(距離 - 1) の最上位ビットの位置と、その次のビットで決まる
+			const uint32 width = static_cast<uint32>(std::bit_width(x));
+			return (((width - 1) * 2) + ((x >> (width - 2)) & 1));
+		}
+
+		[[nodiscard]]
+		uint32 LoadLE32(const uint8* p) noexcept
+		{
+			uint32 value;
+			std::memcpy(&value, p, sizeof(value));
+
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				value = std::byteswap(value);
+			}
+
+			return value;
+		}
+
+		void StoreLE64(uint8* p, uint64 value) noexcept
+		{
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				value = std::byteswap(value);
+			}
+
+			std::memcpy(p, &value, sizeof(value));
+		}
+
+		/// @brief 2 つのデータが先頭から何バイト一致するかを返します。
+		/// @param a データ
+		/// @param b データ
+		/// @param maxLength 比較する最大のバイト数
+		/// @return 一致するバイト数
+		[[nodiscard]]
+		size_t GetMatchLength(const uint8* a, const uint8* b, const size_t maxLength) noexcept
+		{
+			size_t length = 0;
+
+			// 8 バイトずつ比較し、最初に異なるバイトの位置を求める
+			for (; (length + 8) <= maxLength; length += 8)
+			{
+				if (const uint64 diff = (LoadLE64(a + length) ^ LoadLE64(b + length)))
+				{
+					return (length + (std::countr_zero(diff) / 8));
+				}
+			}
+
+			while ((length < maxLength) && (a[length] == b[length]))
+			{
+				++length;
+			}
+
+			return length;
+		}
+
+		/// @brief 頻度から、長さを制限したハフマン符号の符号長を求めます。
+		/// @param frequencies 各記号の頻度
+		/// @param lengths 各記号の符号長の格納先。頻度が 0 の記号は 0 になります
+		/// @param maxLength 符号長の最大値
+		/// @remark Moffat の方法で最適な符号長を求め、長すぎる符号は短い符号を分割して長さを制限します。
+		void BuildCodeLengths(const std::span<const uint32> frequencies, const std::span<uint8> lengths, const int32 maxLength) noexcept
+		{
+			std::fill(lengths.begin(), lengths.end(), uint8{ 0 });
+
+			// 使われている記号を、頻度の昇順に並べる
+			std::array<std::pair<uint32, uint16>, NumLiteralSymbols> symbols;
+			size_t numSymbols = 0;
+
+			for (size_t i = 0; i < frequencies.size(); ++i)
+			{
+				if (frequencies[i])
+				{
+					symbols[numSymbols++] = { frequencies[i], static_cast<uint16>(i) };
+				}
+			}
+
+			if (numSymbols == 0)
+			{
+				return;
+			}
+			else if (numSymbols == 1)
+			{
+				lengths[symbols[0].second] = 1;
+				return;
+			}
+
+			std::sort(symbols.begin(), (symbols.begin() + numSymbols));
+
+			// 配列の中でハフマン木を作り、各記号の深さを求める（A. Moffat and J. Katajainen, 1995）
+			std::array<uint32, NumLiteralSymbols> a{};
+			const int32 n = static_cast<int32>(numSymbols);
+
+			for (int32 i = 0; i < n; ++i)
+			{
+				a[i] = symbols[i].first;
+			}
+
+			a[0] += a[1];
+
+			for (int32 root = 0, leaf = 2, next = 1; next < (n - 1); ++next)
+			{
+				if ((n <= leaf) || (a[root] < a[leaf]))
+				{
+					a[next] = a[root];
+					a[root++] = next;
+				}
+				else
+				{
+					a[next] = a[leaf++];
+				}
+
+				if ((n <= leaf) || ((root < next) && (a[root] < a[leaf])))
+				{
+					a[next] += a[root];
+					a[root++] = next;
+				}
+				else
+				{
+					a[next] += a[leaf++];
+				}
+			}
+
+			a[n - 2] = 0;
+
+			for (int32 next = (n - 3); 0 <= next; --next)
+			{
+				a[next] = (a[a[next]] + 1);
+			}
+
+			for (int32 available = 1, used = 0, depth = 0, root = (n - 2), next = (n - 1); 0 < available; ++depth)
+			{
+				while ((0 <= root) && (static_cast<int32>(a[root]) == depth))
+				{
+					++used;
+					--root;
+				}
+
+				while (used < available)
+				{
+					a[next--] = depth;
+					--available;
+				}
+
+				available = (2 * used);
+				used = 0;
+			}
+
+			// 各符号長の記号の数を数え、最大値を超える符号は最大値に切り詰める
+			std::array<uint32, (MaxCodeLength + 1)> counts{};
+
+			for (int32 i = 0; i < n; ++i)
+			{
+				++counts[std::min(static_cast<int32>(a[i]), maxLength)];
+			}
+
+			uint32 total = 0;
+
+			for (int32 length = 1; length <= maxLength; ++length)
+			{
+				total += (counts[length] << (maxLength - length));
+			}
+
+			// 切り詰めて符号が多すぎる状態になった分、短い符号を分割して長い符号に回す
+			while (total != (1u << maxLength))
+			{
+				--counts[maxLength];
+
+				for (int32 length = (maxLength - 1); 0 < length; --length)
+				{
+					if (counts[length])
+					{
+						--counts[length];
+						counts[length + 1] += 2;
+						break;
+					}
+				}
+
+				--total;
+			}
+
+			// 頻度の低い記号から順に、長い符号を割り当てる
+			for (int32 length = maxLength, i = 0; 0 < length; --length)
+			{
+				for (uint32 k = 0; k < counts[length]; ++k)
+				{
+					lengths[symbols[i++].second] = static_cast<uint8>(length);
+				}
+			}
+		}
+
+		/// @brief 符号長から、標準ハフマン符号を作成します。
+		/// @param lengths 各記号の符号長
+		/// @param codes 各記号の符号の格納先。出力する順にビットを反転した値
+		void BuildCodes(const std::span<const uint8> lengths, const std::span<uint16> codes) noexcept
+		{
+			std::array<uint32, (MaxCodeLength + 1)> counts{};
+
+			for (const uint8 length : lengths)
+			{
+				++counts[length];
+			}
+
+			counts[0] = 0;
+
+			std::array<uint32, (MaxCodeLength + 1)> nextCode{};
+
+			for (int32 length = 1; length <= MaxCodeLength; ++length)
+			{
+				nextCode[length] = ((nextCode[length - 1] + counts[length - 1]) << 1);
+			}
+
+			for (size_t i = 0; i < lengths.size(); ++i)
+			{
+				if (const int32 length = lengths[i])
+				{
+					codes[i] = static_cast<uint16>(ReverseBits(nextCode[length]++, length));
+				}
+			}
+		}
+
+		/// @brief ハフマン符号
+		template <size_t N>
+		struct HuffmanCode
+		{
+			std::array<uint8, N> lengths{};
+
+			std::array<uint16, N> codes{};
+		};
+
+		/// @brief 固定ハフマン符号
+		struct FixedCodes
+		{
+			HuffmanCode<NumLiteralSymbols> literal;
+
+			HuffmanCode<NumDistanceSymbols> distance;
+
+			FixedCodes() noexcept
+			{
+				std::fill_n(literal.lengths.begin(), 144, uint8{ 8 });
+				std::fill_n((literal.lengths.begin() + 144), 112, uint8{ 9 });
+				std::fill_n((literal.lengths.begin() + 256), 24, uint8{ 7 });
+				std::fill_n((literal.lengths.begin() + 280), 8, uint8{ 8 });
+				distance.lengths.fill(5);
+
+				BuildCodes(literal.lengths, literal.codes);
+				BuildCodes(distance.lengths, distance.codes);
+			}
+		};
+
+		/// @brief ビット単位でデータを書き込むクラス
+		class BitWriter
+		{
+		public:
+
+			explicit BitWriter(std::vector<uint8>& dst) noexcept
+				: m_dst{ dst }
+				, m_pos{ dst.size() } {}
+
+			/// @brief size バイトを書き込めるように、バッファを拡張します。
+			void reserve(const size_t size)
+			{
+				// 書き込みは 8 バイト単位で行うので、その分の余裕を持たせる
+				const size_t required = (m_pos + size + 16);
+
+				if (m_dst.size() < required)
+				{
+					m_dst.resize(std::max(required, (m_dst.size() * 2)));
+				}
+			}
+
+			/// @brief 下位のビットから順に書き込みます。
+			/// @param value 書き込む値。n ビットより上位のビットは 0 であること
+			/// @param n ビット数（32 以下）
+			void writeBits(const uint32 value, const int32 n) noexcept
+			{
+				m_bits |= (uint64{ value } << m_numBits);
+				m_numBits += n;
+
+				if (32 <= m_numBits)
+				{
+					flushBytes();
+				}
+			}
+
+			/// @brief 次のバイト境界まで 0 を書き込みます。
+			void alignToByte() noexcept
+			{
+				m_numBits = ((m_numBits + 7) & ~7);
+				flushBytes();
+			}
+
+			/// @brief バイト列をそのまま書き込みます。
+			/// @remark バイト境界にそろえてから呼ぶ必要があります。
+			void writeBytes(const uint8* data, const size_t size) noexcept
+			{
+				if (size)
+				{
+					std::memcpy((m_dst.data() + m_pos), data, size);
+					m_pos += size;
+				}
+			}
+
+			/// @brief 書き込みを終了し、バッファを書き込んだ大きさに縮めます。
+			void finish()
+			{
+				alignToByte();
+				m_dst.resize(m_pos);
+			}
+
+		private:
+
+			std::vector<uint8>& m_dst;
+
+			size_t m_pos;
+
+			uint64 m_bits = 0;
+
+			int32 m_numBits = 0;
+
+			/// @brief 完成したバイトを出力します。
+			void flushBytes() noexcept
+			{
+				StoreLE64((m_dst.data() + m_pos), m_bits);
+
+				const int32 numBytes = (m_numBits >> 3);
+				m_pos += numBytes;
+				m_bits = ((numBytes == 8) ? 0 : (m_bits >> (numBytes * 8)));
+				m_numBits &= 7;
+			}
+		};
+
+		/// @brief データを Deflate 形式で圧縮するクラス
+		class Deflater
+		{
+		public:
+
+			Deflater(const std::span<const uint8> src, const size_t dictionarySize, const CompressionLevel level, std::vector<uint8>& dst)
+				: m_data{ src.data() }
+				, m_begin{ std::min(dictionarySize, src.size()) }
+				, m_end{ src.size() }
+				, m_parameters{ LevelParameterTable[static_cast<size_t>(level)] }
+				, m_writer{ dst }
+				, m_head(size_t{ 1 } << HashBits)
+				, m_prev(WindowSize)
+			{
+				m_symbols.reserve(MaxBlockSymbols);
+			}
+
+			void run(const bool isFinal)
+			{
+				// 辞書の最後の 32 KiB をハッシュ表に登録する
+				insertRange(((WindowSize < m_begin) ? (m_begin - WindowSize) : 0), m_begin);
+
+				m_blockBegin = m_begin;
+
+				const size_t lazyLength = m_parameters.lazyLength;
+				size_t pos = m_begin;
+
+				// 遅延一致で、次の位置の一致をすでに見つけている場合の長さと距離
+				size_t pendingLength = 0;
+				uint32 pendingDistance = 0;
+
+				while (pos < m_end)
+				{
+					if (MaxBlockSymbols <= m_symbols.size())
+					{
+						writeBlock(pos, false);
+					}
+
+					uint32 distance = pendingDistance;
+					size_t length = pendingLength;
+					pendingLength = 0;
+
+					if (length == 0)
+					{
+						length = findMatch(pos, (MinMatchLength - 1), distance);
+						insert(pos);
+					}
+
+					if (length == 0)
+					{
+						addLiteral(m_data[pos++]);
+						continue;
+					}
+
+					size_t insertBegin = (pos + 1);
+
+					// 次の位置でより長い一致が見つかる場合は、この位置をリテラルとして出力する
+					if (length < lazyLength)
+					{
+						uint32 nextDistance = 0;
+
+						if (const size_t nextLength = findMatch((pos + 1), length, nextDistance))
+						{
+							insert(pos + 1);
+							addLiteral(m_data[pos++]);
+							pendingLength = nextLength;
+							pendingDistance = nextDistance;
+							continue;
+						}
+
+						insert(pos + 1);
+						insertBegin = (pos + 2);
+					}
+
+					addMatch(length, distance);
+
+					if (m_parameters.insertAll)
+					{
+						insertRange(insertBegin, (pos + length));
+					}
+
+					pos += length;
+				}
+
+				writeBlock(m_end, isFinal);
+
+				if (not isFinal)
+				{
+					// 空の非圧縮ブロックでバイト境界にそろえ、後ろに別のデータをつなげられるようにする
+					m_writer.reserve(8);
+					m_writer.writeBits(0, 3);
+					m_writer.alignToByte();
+					m_writer.writeBits(0xFFFF0000, 32);
+				}
+
+				m_writer.finish();
+			}
+
+		private:
+
+			const uint8* m_data;
+
+			// 出力する範囲の先頭（それより前は辞書）
+			size_t m_begin;
+
+			size_t m_end;
+
+			LevelParameters m_parameters;
+
+			BitWriter m_writer;
+
+			// ハッシュ値ごとの、最後に登録した位置
+			std::vector<uint32> m_head;
+
+			// 同じハッシュ値で、1 つ前に登録した位置（位置の下位 15 ビットで引く）
+			std::vector<uint32> m_prev;
+
+			// 現在のブロックの記号。リテラルは値、一致は (距離 << 9) | 長さ
+			std::vector<uint32> m_symbols;
+
+			std::array<uint32, NumLiteralSymbols> m_literalFrequencies{};
+
+			std::array<uint32, NumDistanceSymbols> m_distanceFrequencies{};
+
+			// 現在のブロックの、入力データ上の先頭
+			size_t m_blockBegin = 0;
+
+			[[nodiscard]]
+			uint32 hash(const size_t pos) const noexcept
+			{
+				return ((LoadLE32(m_data + pos) * 0x9E3779B1u) >> (32 - HashBits));
+			}
+
+			/// @brief 位置をハッシュ表に登録します。
+			void insert(const size_t pos) noexcept
+			{
+				if ((pos + MinMatchLength) <= m_end)
+				{
+					uint32& head = m_head[hash(pos)];
+					m_prev[pos & WindowMask] = head;
+					head = static_cast<uint32>(pos);
+				}
+			}
+
+			void insertRange(size_t begin, const size_t end) noexcept
+			{
+				for (; begin < end; ++begin)
+				{
+					insert(begin);
+				}
+			}
+
+			/// @brief 指定した位置から始まる、最も長い一致を探します。
+			/// @param pos 位置
+			/// @param minLength この長さより長い一致だけを探す
+			/// @param distance 見つかった一致の距離の格納先
+			/// @return 見つかった一致の長さ。見つからなかった場合は 0
+			/// @remark 登録される位置は下位 32 ビットだけを保存するので、古い候補が誤った位置を指すことがありますが、
+			/// 候補は必ずデータを比較して確かめるので、出力は常に正しくなります。
+			[[nodiscard]]
+			size_t findMatch(const size_t pos, const size_t minLength, uint32& distance) const noexcept
+			{
+				const size_t maxLength = std::min(MaxMatchLength, (m_end - pos));
+
+				if ((maxLength < MinMatchLength) || (maxLength <= minLength))
+				{
+					return 0;
+				}
+
+				const uint8* pCurrent = (m_data + pos);
+				const uint32 first = LoadLE32(pCurrent);
+				const uint32 niceLength = m_parameters.niceLength;
+				size_t bestLength = minLength;
+				uint32 candidate = m_head[hash(pos)];
+				uint32 lastDistance = 0;
+
+				// すでに十分長い一致がある場合は、候補を調べる数を減らす
+				uint32 chainLength = m_parameters.maxChainLength;
+
+				if ((MinMatchLength <= minLength) && (m_parameters.goodLength <= minLength))
+				{
+					chainLength = std::max<uint32>(1, (chainLength / 4));
+				}
+
+				for (uint32 chain = chainLength; chain; --chain)
+				{
+					// 候補の距離は単調に増えるので、ウィンドウの外に出るか、距離が戻ったら打ち切る
+					const uint32 candidateDistance = (static_cast<uint32>(pos) - candidate);
+
+					if ((candidateDistance <= lastDistance) || (WindowSize < candidateDistance) || (pos < candidateDistance))
+					{
+						break;
+					}
+
+					lastDistance = candidateDistance;
+
+					const uint8* pCandidate = (pCurrent - candidateDistance);
+
+					// 今までの最長の一致より長くなりうる候補だけを、最後まで比較する
+					if ((pCandidate[bestLength] == pCurrent[bestLength]) && (LoadLE32(pCandidate) == first))
+					{
+						const size_t length = GetMatchLength(pCurrent, pCandidate, maxLength);
+
+						if (bestLength < length)
+						{
+							bestLength = length;
+							distance = candidateDistance;
+
+							if ((niceLength <= length) || (length == maxLength))
+							{
+								break;
+							}
+						}
+					}
+
+					candidate = m_prev[candidate & WindowMask];
+				}
+
+				return ((minLength < bestLength) ? bestLength : 0);
+			}
+
+			void addLiteral(const uint8 value) noexcept
+			{
+				m_symbols.push_back(value);
+				++m_literalFrequencies[value];
+			}
+
+			void addMatch(const size_t length, const uint32 distance) noexcept
+			{
+				m_symbols.push_back((distance << 9) | static_cast<uint32>(length));
+				++m_literalFrequencies[257 + LengthCodes[length]];
+				++m_distanceFrequencies[GetDistanceCode(distance)];
+			}
+
+			/// @brief 記号を指定した符号で出力したときのビット数を返します（ブロックの種類と符号の表を除く）。
+			[[nodiscard]]
+			uint64 getDataBits(const std::span<const uint8> literalLengths, const std::span<const uint8> distanceLengths) const noexcept
+			{
+				uint64 bits = 0;
+
+				for (size_t i = 0; i < NumLiteralSymbols; ++i)
+				{
+					bits += (uint64{ m_literalFrequencies[i] } * literalLengths[i]);
+				}
+
+				for (size_t i = 0; i < LengthBase.size(); ++i)
+				{
+					bits += (uint64{ m_literalFrequencies[257 + i] } * LengthExtraBits[i]);
+				}
+
+				for (size_t i = 0; i < DistanceBase.size(); ++i)
+				{
+					bits += (uint64{ m_distanceFrequencies[i] } * (distanceLengths[i] + DistanceExtraBits[i]));
+				}
+
+				return bits;
+			}
+
+			/// @brief 現在のブロックを出力します。
+			/// @param blockEnd ブロックの、入力データ上の終端
+			/// @param isFinal 最後のブロックの場合 true
+			void writeBlock(const size_t blockEnd, const bool isFinal)
+			{
+				static const FixedCodes fixedCodes;
+
+				++m_literalFrequencies[256];
+
+				// 非圧縮で出力する場合の大きさ（各ブロックの先頭で、バイト境界にそろえる分を最大 7 ビットとする）
+				const size_t blockSize = (blockEnd - m_blockBegin);
+				const size_t numStoredBlocks = std::max<size_t>(1, ((blockSize + (MaxStoredBlockSize - 1)) / MaxStoredBlockSize));
+				const uint64 storedBits = ((numStoredBlocks * (3 + 7 + 32)) + (uint64{ blockSize } * 8));
+				const uint64 fixedBits = (3 + getDataBits(fixedCodes.literal.lengths, fixedCodes.distance.lengths));
+
+				m_writer.reserve(static_cast<size_t>(storedBits / 8));
+
+				HuffmanCode<NumLiteralSymbols> literalCode;
+				HuffmanCode<NumDistanceSymbols> distanceCode;
+				HuffmanCode<NumCodeLengthSymbols> codeLengthCode;
+
+				// 符号長の列を、繰り返しの記号 16-18 で圧縮したもの。下位 8 ビットが記号、上位が追加ビットの値
+				std::vector<uint16> codeLengthSymbols;
+				size_t numLiterals = 0, numDistances = 0, numCodeLengths = 0;
+				uint64 dynamicBits = std::numeric_limits<uint64>::max();
+
+				if (m_parameters.dynamic)
+				{
+					// 距離の符号が 1 つもない場合も、1 つは符号を定義する
+					if (std::ranges::all_of(m_distanceFrequencies, [](const uint32 frequency) { return (frequency == 0); }))
+					{
+						m_distanceFrequencies[0] = 1;
+					}
+
+					BuildCodeLengths(m_literalFrequencies, literalCode.lengths, MaxCodeLength);
+					BuildCodeLengths(m_distanceFrequencies, distanceCode.lengths, MaxCodeLength);
+
+					numLiterals = 286;
+					numDistances = 30;
+
+					while ((257 < numLiterals) && (literalCode.lengths[numLiterals - 1] == 0))
+					{
+						--numLiterals;
+					}
+
+					while ((1 < numDistances) && (distanceCode.lengths[numDistances - 1] == 0))
+					{
+						--numDistances;
+					}
+
+					std::array<uint8, (NumLiteralSymbols + NumDistanceSymbols)> lengths;
+					std::copy_n(literalCode.lengths.begin(), numLiterals, lengths.begin());
+					std::copy_n(distanceCode.lengths.begin(), numDistances, (lengths.begin() + numLiterals));
+
+					codeLengthSymbols = EncodeCodeLengths({ lengths.data(), (numLiterals + numDistances) });
+
+					std::array<uint32, NumCodeLengthSymbols> codeLengthFrequencies{};
+
+					for (const uint16 symbol : codeLengthSymbols)
+					{
+						++codeLengthFrequencies[symbol & 0xFF];
+					}
+
+					BuildCodeLengths(codeLengthFrequencies, codeLengthCode.lengths, 7);
+
+					numCodeLengths = NumCodeLengthSymbols;
+
+					while ((4 < numCodeLengths) && (codeLengthCode.lengths[CodeLengthOrder[numCodeLengths - 1]] == 0))
+					{
+						--numCodeLengths;
+					}
+
+					dynamicBits = (3 + 5 + 5 + 4 + (3 * numCodeLengths) + getDataBits(literalCode.lengths, distanceCode.lengths));
+
+					for (const uint16 symbol : codeLengthSymbols)
+					{
+						dynamicBits += (codeLengthCode.lengths[symbol & 0xFF] + CodeLengthExtraBits[symbol & 0xFF]);
+					}
+				}
+
+				if ((storedBits < fixedBits) && (storedBits < dynamicBits))
+				{
+					writeStoredBlocks(blockEnd, isFinal);
+				}
+				else if (fixedBits <= dynamicBits)
+				{
+					m_writer.writeBits((isFinal ? 1 : 0), 1);
+					m_writer.writeBits(1, 2);
+					writeSymbols(fixedCodes.literal, fixedCodes.distance);
+				}
+				else
+				{
+					BuildCodes(literalCode.lengths, literalCode.codes);
+					BuildCodes(distanceCode.lengths, distanceCode.codes);
+					BuildCodes(codeLengthCode.lengths, codeLengthCode.codes);
+
+					m_writer.writeBits((isFinal ? 1 : 0), 1);
+					m_writer.writeBits(2, 2);
+					m_writer.writeBits(static_cast<uint32>(numLiterals - 257), 5);
+					m_writer.writeBits(static_cast<uint32>(numDistances - 1), 5);
+					m_writer.writeBits(static_cast<uint32>(numCodeLengths - 4), 4);
+
+					for (size_t i = 0; i < numCodeLengths; ++i)
+					{
+						m_writer.writeBits(codeLengthCode.lengths[CodeLengthOrder[i]], 3);
+					}
+
+					for (const uint16 symbol : codeLengthSymbols)
+					{
+						const size_t code = (symbol & 0xFF);
+						m_writer.writeBits(codeLengthCode.codes[code], codeLengthCode.lengths[code]);
+						m_writer.writeBits((symbol >> 8), CodeLengthExtraBits[code]);
+					}
+
+					writeSymbols(literalCode, distanceCode);
+				}
+
+				m_symbols.clear();
+				m_literalFrequencies.fill(0);
+				m_distanceFrequencies.fill(0);
+				m_blockBegin = blockEnd;
+			}
+
+			/// @brief 現在のブロックの記号とブロックの終端を、指定した符号で出力します。
+			void writeSymbols(const HuffmanCode<NumLiteralSymbols>& literalCode, const HuffmanCode<NumDistanceSymbols>& distanceCode) noexcept
+			{
+				for (const uint32 symbol : m_symbols)
+				{
+					const uint32 distance = (symbol >> 9);
+
+					if (distance == 0)
+					{
+						m_writer.writeBits(literalCode.codes[symbol], literalCode.lengths[symbol]);
+						continue;
+					}
+
+					// 符号と追加ビットを続けて書き込む
+					const uint32 length = (symbol & 0x1FF);
+					const uint32 lengthCode = LengthCodes[length];
+					const uint32 lengthSymbol = (257 + lengthCode);
+					const int32 lengthCodeBits = literalCode.lengths[lengthSymbol];
+					m_writer.writeBits((literalCode.codes[lengthSymbol] | ((length - LengthBase[lengthCode]) << lengthCodeBits)), (lengthCodeBits + LengthExtraBits[lengthCode]));
+
+					const uint32 distanceCodeValue = GetDistanceCode(distance);
+					const int32 distanceCodeBits = distanceCode.lengths[distanceCodeValue];
+					m_writer.writeBits((distanceCode.codes[distanceCodeValue] | ((distance - DistanceBase[distanceCodeValue]) << distanceCodeBits)), (distanceCodeBits + DistanceExtraBits[distanceCodeValue]));
+				}
+
+				m_writer.writeBits(literalCode.codes[256], literalCode.lengths[256]);
+			}
+
+			/// @brief 現在のブロックの入力データを、非圧縮ブロックとして出力します。
+			void writeStoredBlocks(const size_t blockEnd, const bool isFinal) noexcept
+			{
+				size_t pos = m_blockBegin;
+
+				do
+				{
+					const size_t size = std::min(MaxStoredBlockSize, (blockEnd - pos));
+					const bool isLast = ((pos + size) == blockEnd);
+
+					m_writer.writeBits(((isFinal && isLast) ? 1 : 0), 1);
+					m_writer.writeBits(0, 2);
+					m_writer.alignToByte();
+					m_writer.writeBits(static_cast<uint32>(size | ((size ^ 0xFFFF) << 16)), 32);
+					m_writer.writeBytes((m_data + pos), size);
+					pos += size;
+				} while (pos < blockEnd);
+			}
+
+			/// @brief リテラル・長さと距離の符号長の列を、繰り返しの記号を使って圧縮します。
+			/// @return 記号の列。下位 8 ビットが記号、上位 8 ビットが追加ビットの値
+			[[nodiscard]]
+			static std::vector<uint16> EncodeCodeLengths(const std::span<const uint8> lengths)
+			{
+				std::vector<uint16> symbols;
+
+				const auto Add = [&](const uint32 symbol, const uint32 extra = 0)
+				{
+					symbols.push_back(static_cast<uint16>(symbol | (extra << 8)));
+				};
+
+				for (size_t i = 0; i < lengths.size();)
+				{
+					const uint8 length = lengths[i];
+					size_t run = 1;
+
+					while (((i + run) < lengths.size()) && (lengths[i + run] == length))
+					{
+						++run;
+					}
+
+					i += run;
+
+					if (length == 0)
+					{
+						// 0 の繰り返し: 18 は 11-138 回、17 は 3-10 回
+						for (; 11 <= run; run -= std::min<size_t>(run, 138))
+						{
+							Add(18, static_cast<uint32>(std::min<size_t>(run, 138) - 11));
+						}
+
+						if (3 <= run)
+						{
+							Add(17, static_cast<uint32>(run - 3));
+							run = 0;
+						}
+					}
+					else
+					{
+						// 0 以外の繰り返し: 最初の 1 つを出力し、16 で直前の符号長を 3-6 回繰り返す
+						Add(length);
+						--run;
+
+						for (; 3 <= run; run -= std::min<size_t>(run, 6))
+						{
+							Add(16, static_cast<uint32>(std::min<size_t>(run, 6) - 3));
+						}
+					}
+
+					for (; run; --run)
+					{
+						Add(length);
+					}
+				}
+
+				return symbols;
+			}
+		};
+
+		/// @brief Adler-32 チェックサムを計算します。
+		/// @param data データ
+		/// @param size データのサイズ（バイト）
+		/// @param adler 直前までのデータのチェックサム
+		/// @return チェックサム
+		[[nodiscard]]
+		uint32 Adler32(const uint8* data, size_t size, const uint32 adler = 1) noexcept
+		{
+			constexpr uint32 Base = 65521;
+
+			// 32 ビットの和があふれずに、まとめて剰余を取れる最大のバイト数
+			constexpr size_t MaxRun = 5552;
+
+			uint32 a = (adler & 0xFFFF);
+			uint32 b = (adler >> 16);
+
+			while (size)
+			{
+				const size_t run = std::min(size, MaxRun);
+				size -= run;
+
+				for (size_t i = 0; i < run; ++i)
+				{
+					a += data[i];
+					b += a;
+				}
+
+				data += run;
+				a %= Base;
+				b %= Base;
+			}
+
+			return ((b << 16) | a);
+		}
+
+		/// @brief 連続する 2 つのデータの Adler-32 チェックサムから、つなげたデータのチェックサムを求めます。
+		/// @param adler1 前のデータのチェックサム
+		/// @param adler2 後ろのデータのチェックサム
+		/// @param size2 後ろのデータのサイズ（バイト）
+		/// @return つなげたデータのチェックサム
+		[[nodiscard]]
+		constexpr uint32 CombineAdler32(const uint32 adler1, const uint32 adler2, const size_t size2) noexcept
+		{
+			constexpr uint64 Base = 65521;
+
+			// b は各バイトまでの a の和なので、後ろのデータの各バイトの分だけ、前のデータの a が加わる
+			const uint64 a1 = (adler1 & 0xFFFF), b1 = (adler1 >> 16);
+			const uint64 a2 = (adler2 & 0xFFFF), b2 = (adler2 >> 16);
+			const uint64 a = ((a1 + a2 + Base - 1) % Base);
+			const uint64 b = ((b1 + b2 + ((size2 % Base) * a1) + Base - (size2 % Base)) % Base);
+			return static_cast<uint32>((b << 16) | a);
+		}
+	}
+
+	int64 ZlibDecompress(const std::span<const uint8> src, const std::span<uint8> dst) noexcept
+	{
+		if (src.size() < 2)
+		{
+			return -1;
+		}
+
+		// 圧縮方式が Deflate（8）で、ウィンドウが 32 KiB 以下で、プリセット辞書を使わないことを確認する
+		const uint32 cmf = src[0];
+		const uint32 flg = src[1];
+
+		if (((cmf & 0x0F) != 8) || (7 < (cmf >> 4)) || (((cmf << 8) | flg) % 31 != 0) || (flg & 0x20))
+		{
+			return -1;
+		}
+
+		return Inflate(src.subspan(2), dst);
+	}
+
+	int64 Inflate(const std::span<const uint8> src, const std::span<uint8> dst) noexcept
+	{
+		Inflater inflater{ src, dst };
+		return inflater.run();
+	}
+
+	void Deflate(const std::span<const uint8> src, std::vector<uint8>& dst, const CompressionLevel level, const size_t dictionarySize, const bool isFinal)
+	{
+		Deflater deflater{ src, dictionarySize, level, dst };
+		deflater.run(isFinal);
+	}
+
+	std::vector<uint8> ZlibCompress(const std::span<const uint8> src, const CompressionLevel level)
+	{
+		const size_t numSegments = std::max<size_t>(1, ((src.size() + (SegmentSize - 1)) / SegmentSize));
+
+		std::vector<std::vector<uint8>> segments(numSegments);
+		std::vector<uint32> checksums(numSegments);
+
+		// 各セグメントを、直前の 32 KiB を辞書として独立に圧縮する
+		ParallelFor(0, numSegments, [&](const size_t beginIndex, const size_t endIndex)
+			{
+				for (size_t i = beginIndex; i < endIndex; ++i)
+				{
+					const size_t begin = (i * SegmentSize);
+					const size_t end = std::min((begin + SegmentSize), src.size());
+					const size_t dictionaryBegin = ((WindowSize < begin) ? (begin - WindowSize) : 0);
+
+					Deflate(src.subspan(dictionaryBegin, (end - dictionaryBegin)), segments[i], level, (begin - dictionaryBegin), (i == (numSegments - 1)));
+					checksums[i] = Adler32((src.data() + begin), (end - begin));
+				}
+			});
+
+		size_t totalSize = (2 + 4);
+
+		for (const auto& segment : segments)
+		{
+			totalSize += segment.size();
+		}
+
+		std::vector<uint8> dst;
+		dst.reserve(totalSize);
+
+		// zlib のヘッダ: Deflate、32 KiB のウィンドウと、圧縮レベル
+		const uint32 cmf = 0x78;
+		uint32 flg = (static_cast<uint32>(level) << 6);
+		flg += (31 - (((cmf << 8) | flg) % 31));
+		dst.push_back(static_cast<uint8>(cmf));
+		dst.push_back(static_cast<uint8>(flg));
+
+		uint32 checksum = 1;
+
+		for (size_t i = 0; i < numSegments; ++i)
+		{
+			dst.insert(dst.end(), segments[i].begin(), segments[i].end());
+
+			const size_t segmentSize = (std::min(((i + 1) * SegmentSize), src.size()) - (i * SegmentSize));
+			checksum = ((i == 0) ? checksums[0] : CombineAdler32(checksum, checksums[i], segmentSize));
+		}
+
+		// Adler-32 チェックサム（ビッグエンディアン）
+		for (int32 shift = 24; 0 <= shift; shift -= 8)
+		{
+			dst.push_back(static_cast<uint8>(checksum >> shift));
+		}
+
+		return dst;
+	}
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <cstddef> // size_t
+#include <span> // std::span
+#include <vector> // std::vector
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief 圧縮レベル
+	enum class CompressionLevel : uint8
+	{
+		/// @brief 最も速い。一致の候補を 1 つだけ調べ、固定ハフマン符号で出力します
+		Fastest,
+
+		/// @brief 速い。短いハッシュチェーンで一致を探し、ブロックごとに作成したハフマン符号で出力します
+		Fast,
+
+		/// @brief 標準。長めのハッシュチェーンと遅延一致（lazy matching）で一致を探します
+		Default,
+
+		/// @brief 最も小さい。最長のハッシュチェーンと遅延一致で一致を探します
+		Best,
+	};
+
+	/// @brief zlib 形式（RFC 1950）で圧縮されたデータを展開します。
+	/// @param src 圧縮されたデータ
+	/// @param dst 展開したデータの書き込み先。展開後のサイズがわかっている場合は、ちょうどその大きさを指定します
+	/// @return 展開したデータのサイズ（バイト）。データが壊れている場合や、dst に収まらない場合は -1
+	/// @remark ハフマン符号は、表を引いて 1 回で復号します。ビットは 64 ビット単位でまとめて読み込みます。
+	/// @remark 処理を速くするため、Adler-32 チェックサムは検証しません。
+	[[nodiscard]]
+	int64 ZlibDecompress(std::span<const uint8> src, std::span<uint8> dst) noexcept;
+
+	/// @brief Deflate 形式（RFC 1951）で圧縮されたデータを展開します。
+	/// @param src 圧縮されたデータ（zlib のヘッダを含まない）
+	/// @param dst 展開したデータの書き込み先
+	/// @return 展開したデータのサイズ（バイト）。データが壊れている場合や、dst に収まらない場合は -1
+	[[nodiscard]]
+	int64 Inflate(std::span<const uint8> src, std::span<uint8> dst) noexcept;
+
+	/// @brief データを Deflate 形式（RFC 1951）で圧縮し、dst の末尾に追加します。
+	/// @param src 圧縮するデータ
+	/// @param dst 圧縮したデータの追加先
+	/// @param level 圧縮レベル
+	/// @param dictionarySize src の先頭の、出力せずに一致の参照先としてだけ使うバイト数（最大 32 KiB まで使われます）
+	/// @param isFinal 最後のブロックとして出力する場合 true
+	/// @remark isFinal が false の場合は、バイト境界にそろえた空の非圧縮ブロックで終わるので、続けて別に圧縮したデータをつなげられます。
+	/// @remark ブロックごとに、固定ハフマン符号、ブロック用のハフマン符号、非圧縮のうち最も小さいものを選びます（CompressionLevel::Fastest では固定ハフマン符号か非圧縮）。
+	void Deflate(std::span<const uint8> src, std::vector<uint8>& dst, CompressionLevel level = CompressionLevel::Default, size_t dictionarySize = 0, bool isFinal = true);
+
+	/// @brief データを zlib 形式（RFC 1950）で圧縮します。
+	/// @param src 圧縮するデータ
+	/// @param level 圧縮レベル
+	/// @return 圧縮したデータ
+	/// @remark データを一定の大きさのブロックに分けて並列に圧縮し、1 つの zlib ストリームにつなげます。
+	/// 各ブロックは直前の 32 KiB を辞書として使うので、ブロックの境界をまたぐ一致も見つけられます。
+	[[nodiscard]]
+	std::vector<uint8> ZlibCompress(std::span<const uint8> src, CompressionLevel level = CompressionLevel::Default);
+}
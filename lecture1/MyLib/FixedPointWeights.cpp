@@ -0,0 +1,108 @@
+﻿#include <algorithm> // std::clamp, std::ranges::sort, std::ranges::equal
+#include <cmath> // std::floor
+#include <numeric> // std::iota
+#include <ranges> // std::views::reverse
+#include <vector> // std::vector
+#include "FixedPointWeights.hpp"
+
+namespace seccamp
+{
+	void QuantizeWeights(const std::span<const double> weights, const double scale, const int32 total, const std::span<int16> result)
+	{
+		const size_t count = weights.size();
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		std::vector<int32> quantized(count);
+		std::vector<double> remainders(count);
+		int64 sum = 0;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const double x = (weights[i] * scale);
+			const double floor = std::floor(x);
+
+			quantized[i] = static_cast<int32>(floor);
+			remainders[i] = (x - floor);
+			sum += quantized[i];
+		}
+
+		const int64 residual = (total - sum);
+
+		// 足りない場合は端数の大きい重みに 1 ずつ足し、多すぎる場合は端数の小さい重みから 1 ずつ引く
+		const int32 step = ((residual < 0) ? -1 : 1);
+		size_t remaining = static_cast<size_t>((residual < 0) ? -residual : residual);
+
+		// 優先する順に並べる。優先度が等しい場合は中央に近いほうを先にする
+		std::vector<size_t> order(count);
+		std::iota(order.begin(), order.end(), size_t{ 0 });
+
+		const auto DistanceFromCenter = [count](const size_t i)
+		{
+			const int64 d = (static_cast<int64>(i * 2) - static_cast<int64>(count - 1));
+			return ((d < 0) ? -d : d);
+		};
+
+		std::ranges::sort(order, [&](const size_t a, const size_t b)
+			{
+				if (remainders[a] != remainders[b])
+				{
+					return ((0 < step) ? (remainders[b] < remainders[a]) : (remainders[a] < remainders[b]));
+				}
+
+				if (DistanceFromCenter(a) != DistanceFromCenter(b))
+				{
+					return (DistanceFromCenter(a) < DistanceFromCenter(b));
+				}
+
+				return (a < b);
+			});
+
+		// どの重みに 1 を足し引きしても理想の値との差は 1 以下に収まるので、左右対称な重みは対称な組ごとに配って対称性を保つ
+		const bool isSymmetric = std::ranges::equal(weights, (weights | std::views::reverse));
+
+		if (isSymmetric && (remaining <= count) && (((count % 2) == 1) || ((remaining % 2) == 0)))
+		{
+			if ((remaining % 2) == 1)
+			{
+				quantized[count / 2] += step;
+				--remaining;
+			}
+
+			for (const size_t i : order)
+			{
+				if (remaining == 0)
+				{
+					break;
+				}
+
+				const size_t mirror = (count - 1 - i);
+
+				// 左半分の重みとその鏡像を組にする（中央の重みは除く）
+				if (mirror <= i)
+				{
+					continue;
+				}
+
+				quantized[i] += step;
+				quantized[mirror] += step;
+				remaining -= 2;
+			}
+		}
+		else
+		{
+			for (size_t k = 0; remaining != 0; ++k, --remaining)
+			{
+				quantized[order[k % count]] += step;
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			result[i] = static_cast<int16>(std::clamp(quantized[i], -32767, 32767));
+		}
+	}
+}
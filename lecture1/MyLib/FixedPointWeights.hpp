@@ -0,0 +1,27 @@
+﻿#pragma once
+#include <span> // std::span
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief 2 つの 16 ビットの重みを、_mm_madd_epi16 などの積和命令で使う 32 ビットの組にします。
+	/// @param w0 下位 16 ビットに入れる重み
+	/// @param w1 上位 16 ビットに入れる重み
+	/// @return 重みの組
+	/// @remark ライブラリの内部で、固定小数点数の重みを使う SIMD 実装が共有する関数です。
+	[[nodiscard]]
+	constexpr int32 MakeWeightPair(const int16 w0, const int16 w1) noexcept
+	{
+		return static_cast<int32>(static_cast<uint16>(w0) | (static_cast<uint32>(static_cast<uint16>(w1)) << 16));
+	}
+
+	/// @brief 実数の重みを、合計を指定した値に保ったまま固定小数点数の重みに丸めます。
+	/// @param weights 実数の重み
+	/// @param scale 固定小数点数の 1.0 に対応する値（2^小数部のビット数）
+	/// @param total 丸めた後の重みの合計
+	/// @param result 丸めた重みの格納先。weights と同じ数の要素が必要です
+	/// @remark 各重みを切り捨ててから、合計に足りない分を端数の大きい順に 1 ずつ配ります（最大剰余法）。
+	/// そのため、各重みと理想の値（weights[i] * scale）との差は 1 以下になります。左右対称な重みは、対称な位置の組ごとに配るので対称なまま丸められます。
+	/// @remark weights[i] * scale は int16 の範囲に収まる必要があります。
+	void QuantizeWeights(std::span<const double> weights, double scale, int32 total, std::span<int16> result);
+}
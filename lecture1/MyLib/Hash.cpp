@@ -0,0 +1,170 @@
+﻿#include <algorithm> // std::min
+#include <bit> // std::rotl, std::byteswap, std::endian
+#include <cstring> // std::memcpy
+#include "Hash.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		constexpr uint64 Prime1 = 0x9E3779B185EBCA87ULL;
+		constexpr uint64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+		constexpr uint64 Prime3 = 0x165667B19E3779F9ULL;
+		constexpr uint64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+		constexpr uint64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+		/// @brief 1 回に処理するブロックのサイズ（バイト）
+		constexpr size_t StripeSize = 32;
+
+		/// @brief リトルエンディアンの整数を読み込みます。
+		template <class Type>
+		[[nodiscard]]
+		Type ReadLE(const uint8* p) noexcept
+		{
+			Type value;
+			std::memcpy(&value, p, sizeof(Type));
+
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				value = std::byteswap(value);
+			}
+
+			return value;
+		}
+
+		[[nodiscard]]
+		constexpr uint64 Round(uint64 accumulator, const uint64 input) noexcept
+		{
+			accumulator += (input * Prime2);
+			accumulator = std::rotl(accumulator, 31);
+			return (accumulator * Prime1);
+		}
+
+		[[nodiscard]]
+		constexpr uint64 MergeRound(uint64 hash, const uint64 accumulator) noexcept
+		{
+			hash ^= Round(0, accumulator);
+			return ((hash * Prime1) + Prime4);
+		}
+
+		/// @brief 32 バイトのブロックを処理します。
+		void ProcessStripe(std::array<uint64, 4>& accumulators, const uint8* p) noexcept
+		{
+			accumulators[0] = Round(accumulators[0], ReadLE<uint64>(p));
+			accumulators[1] = Round(accumulators[1], ReadLE<uint64>(p + 8));
+			accumulators[2] = Round(accumulators[2], ReadLE<uint64>(p + 16));
+			accumulators[3] = Round(accumulators[3], ReadLE<uint64>(p + 24));
+		}
+	}
+
+	uint64 Hash64(const void* data, const size_t size, const uint64 seed) noexcept
+	{
+		Hasher64 hasher{ seed };
+		hasher.update(data, size);
+		return hasher.value();
+	}
+
+	Hasher64::Hasher64(const uint64 seed) noexcept
+		: m_accumulators{ (seed + Prime1 + Prime2), (seed + Prime2), seed, (seed - Prime1) }
+		, m_seed{ seed } {}
+
+	void Hasher64::update(const void* data, size_t size) noexcept
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		const uint8* p = static_cast<const uint8*>(data);
+
+		m_totalSize += size;
+
+		// 前回の残りのデータがある場合は、32 バイトになるまで補う
+		if (m_bufferSize != 0)
+		{
+			const size_t fillSize = std::min((StripeSize - m_bufferSize), size);
+			std::memcpy((m_buffer.data() + m_bufferSize), p, fillSize);
+			m_bufferSize += fillSize;
+			p += fillSize;
+			size -= fillSize;
+
+			if (m_bufferSize < StripeSize)
+			{
+				return;
+			}
+
+			ProcessStripe(m_accumulators, m_buffer.data());
+			m_bufferSize = 0;
+		}
+
+		// 4 つの値を独立に更新するので、CPU は複数の乗算を並列に実行できる
+		std::array<uint64, 4> accumulators = m_accumulators;
+
+		for (; StripeSize <= size; size -= StripeSize, p += StripeSize)
+		{
+			ProcessStripe(accumulators, p);
+		}
+
+		m_accumulators = accumulators;
+
+		if (size != 0)
+		{
+			std::memcpy(m_buffer.data(), p, size);
+			m_bufferSize = size;
+		}
+	}
+
+	uint64 Hasher64::value() const noexcept
+	{
+		uint64 hash;
+
+		if (StripeSize <= m_totalSize)
+		{
+			const auto& v = m_accumulators;
+			hash = (std::rotl(v[0], 1) + std::rotl(v[1], 7) + std::rotl(v[2], 12) + std::rotl(v[3], 18));
+			hash = MergeRound(hash, v[0]);
+			hash = MergeRound(hash, v[1]);
+			hash = MergeRound(hash, v[2]);
+			hash = MergeRound(hash, v[3]);
+		}
+		else
+		{
+			hash = (m_seed + Prime5);
+		}
+
+		hash += m_totalSize;
+
+		// 32 バイトに満たない残りのデータを処理する
+		const uint8* p = m_buffer.data();
+		size_t size = m_bufferSize;
+
+		for (; 8 <= size; size -= 8, p += 8)
+		{
+			hash ^= Round(0, ReadLE<uint64>(p));
+			hash = ((std::rotl(hash, 27) * Prime1) + Prime4);
+		}
+
+		if (4 <= size)
+		{
+			hash ^= (ReadLE<uint32>(p) * Prime1);
+			hash = ((std::rotl(hash, 23) * Prime2) + Prime3);
+			size -= 4;
+			p += 4;
+		}
+
+		for (; size != 0; --size, ++p)
+		{
+			hash ^= (*p * Prime5);
+			hash = (std::rotl(hash, 11) * Prime1);
+		}
+
+		// 各ビットが結果の全体に影響するように混ぜる
+		hash ^= (hash >> 33);
+		hash *= Prime2;
+		hash ^= (hash >> 29);
+		hash *= Prime3;
+		hash ^= (hash >> 32);
+
+		return hash;
+	}
+}
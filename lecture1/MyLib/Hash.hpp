@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <cstddef> // size_t
+#include <array> // std::array
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief データの 64 ビットのハッシュ値を返します（暗号学的ハッシュ関数ではありません）。
+	/// @param data データの先頭ポインタ
+	/// @param size データのサイズ（バイト）
+	/// @param seed シード値
+	/// @return ハッシュ値
+	/// @remark xxHash (XXH64) と同じ値を返します。変更の検出や重複の判定に使います。
+	[[nodiscard]]
+	uint64 Hash64(const void* data, size_t size, uint64 seed = 0) noexcept;
+
+	/// @brief データを分割して渡しながら、64 ビットのハッシュ値を計算するクラス
+	/// @remark 結果は、すべてのデータを連結して Hash64() に渡した場合と一致します。
+	class Hasher64
+	{
+	public:
+
+		/// @brief ハッシュ値の計算を開始します。
+		/// @param seed シード値
+		[[nodiscard]]
+		explicit Hasher64(uint64 seed = 0) noexcept;
+
+		/// @brief データを追加します。
+		/// @param data データの先頭ポインタ
+		/// @param size データのサイズ（バイト）
+		void update(const void* data, size_t size) noexcept;
+
+		/// @brief これまでに追加したデータのハッシュ値を返します。
+		/// @return ハッシュ値
+		/// @remark 呼び出した後も、続けてデータを追加できます。
+		[[nodiscard]]
+		uint64 value() const noexcept;
+
+	private:
+
+		std::array<uint64, 4> m_accumulators;
+
+		std::array<uint8, 32> m_buffer{};
+
+		uint64 m_seed;
+
+		uint64 m_totalSize = 0;
+
+		size_t m_bufferSize = 0;
+	};
+}
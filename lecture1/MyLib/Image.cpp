@@ -1,21 +1,57 @@
-﻿#include <algorithm> // std::ranges::fill
-#include "Image.hpp"
-#include "BMP.hpp"
+﻿#include "Image.hpp"
+#include "ImageCodec.hpp"
 
 namespace seccamp
 {
+	Image::Image(const ConstImageView& view)
+		: Image{ view.size(), Uninitialized }
+	{
+		this->view().copyFrom(view);
+	}
+
 	Image::Image(const std::string_view path)
 	{
-		*this = LoadBMP(path);
+		*this = LoadImageFile(path);
+	}
+
+	void Image::fill(const Color& color)
+	{
+		// すべてのピクセルを上書きするので、共有しているメモリはコピーせずに新しく確保する
+		m_pixels.resizeUninitialized(m_pixels.size());
+
+		view().fill(color);
+	}
+
+	Image& Image::grayscale()
+	{
+		view().grayscale();
+		return *this;
+	}
+
+	std::vector<uint8> Image::grayscaleUint8() const
+	{
+		return view().grayscaleUint8();
+	}
+
+	std::vector<uint8> Image::channel(const size_t index) const
+	{
+		return view().channel(index);
+	}
+
+	Image& Image::invert()
+	{
+		view().invert();
+		return *this;
 	}
 
-	void Image::fill(const Color& color) noexcept
+	Image& Image::adjustBrightnessContrast(const int32 brightness, const double contrast)
 	{
-		std::ranges::fill(m_pixels, color);
+		view().adjustBrightnessContrast(brightness, contrast);
+		return *this;
 	}
 
 	bool Image::save(const std::string_view path) const
 	{
-		return SaveBMP(*this, path);
+		return SaveImageFile(*this, path);
 	}
 }
@@ -1,25 +1,43 @@
 ﻿#pragma once
-#include <concepts> // std::integral
+#include <concepts> // std::integral, std::invocable
+#include <cstring> // std::memcmp
 #include <vector> // std::vector
+#include <utility> // std::forward
+#include <functional> // std::hash
 #include "Common.hpp"
 #include "Color.hpp"
 #include "Point.hpp"
+#include "Rect.hpp"
+#include "PixelBuffer.hpp"
+#include "ImageView.hpp"
 
 namespace seccamp
 {
+	/// @brief 画像のピクセルを初期化しないことを表す型
+	struct UninitializedTag
+	{
+		explicit UninitializedTag() = default;
+	};
+
+	/// @brief 画像のピクセルを初期化しないことを表す値
+	/// @remark Image{ width, height, Uninitialized } のように使います。
+	inline constexpr UninitializedTag Uninitialized{};
+
 	/// @brief 画像
+	/// @remark setCopyOnWrite(true) を設定した画像のコピーは、ピクセルをコピーせずにメモリを共有します（コピーオンライト）。
+	/// 共有中の画像は、最初に書き込み可能なアクセス（operator [], data(), begin(), view(), fill() など）をしたときにピクセルをコピーします。
 	class Image
 	{
 	public:
 
 		/// @brief 使用する配列型
-		using container_type			= std::vector<Color>;
+		using container_type			= PixelBuffer;
 		
 		/// @brief 要素を指すイテレータ型
-		using iterator					= container_type::iterator;
+		using iterator					= Color*;
 
 		/// @brief 要素を指す const イテレータ型
-		using const_iterator			= container_type::const_iterator;
+		using const_iterator			= const Color*;
 
 		/// @brief デフォルトコンストラクタ
 		[[nodiscard]]
@@ -31,7 +49,18 @@ namespace seccamp
 		/// @param color 画像の初期色
 		[[nodiscard]]
 		Image(int32 width, int32 height, const Color& color = Palette::White)
-			: m_pixels{ (static_cast<size_t>(width) * static_cast<size_t>(height)), color }
+			: Image{ width, height, Uninitialized }
+		{
+			fill(color);
+		}
+
+		/// @brief ピクセルを初期化せずに画像を作成します。
+		/// @param width 画像の幅（ピクセル）
+		/// @param height 画像の高さ（ピクセル）
+		/// @remark ピクセルの値は不定です。デコーダなど、すべてのピクセルを上書きする場合に使います。
+		[[nodiscard]]
+		Image(int32 width, int32 height, UninitializedTag)
+			: m_pixels(static_cast<size_t>(width) * static_cast<size_t>(height))
 			, m_size{ width, height } {}
 
 		/// @brief 画像を作成します。
@@ -49,8 +78,22 @@ namespace seccamp
 		Image(const Size& size, const Color& color = Palette::White)
 			: Image{ size.x, size.y, color } {}
 
+		/// @brief ピクセルを初期化せずに画像を作成します。
+		/// @param size 画像の幅と高さ（ピクセル）
+		/// @remark ピクセルの値は不定です。デコーダなど、すべてのピクセルを上書きする場合に使います。
+		[[nodiscard]]
+		Image(const Size& size, UninitializedTag)
+			: Image{ size.x, size.y, Uninitialized } {}
+
+		/// @brief ビューが参照するピクセルをコピーして画像を作成します。
+		/// @param view コピー元のビュー
+		/// @remark 画像の一部の領域を切り出す場合は Image{ image.view(rect) } のように使います。
+		[[nodiscard]]
+		explicit Image(const ConstImageView& view);
+
 		/// @brief ファイルからデータを読み込んで画像を作成します。
 		/// @param path 画像ファイルのパス
+		/// @remark ファイルの形式は、ファイルの先頭のデータから判定します。読み込みに失敗した場合は空の画像になります。
 		[[nodiscard]]
 		explicit Image(std::string_view path);
 
@@ -62,7 +105,28 @@ namespace seccamp
 		friend bool operator ==(const Image& lhs, const Image& rhs) noexcept
 		{
 			// 画像の中身を比較する前に、画像のサイズを比較する
-			return ((lhs.m_size == rhs.m_size) && (lhs.m_pixels == rhs.m_pixels));
+			if (lhs.m_size != rhs.m_size)
+			{
+				return false;
+			}
+
+			// 同じピクセル配列（自分自身との比較など）や空の画像は、中身を比較しない
+			if ((lhs.data() == rhs.data()) || lhs.isEmpty())
+			{
+				return true;
+			}
+
+			// Color は隙間のない 4 バイトの型なので、ピクセル配列をまとめてバイト列として比較できる
+			return (std::memcmp(lhs.data(), rhs.data(), (lhs.numPixels() * sizeof(Color))) == 0);
+		}
+
+		/// @brief 画像の内容の 64 ビットのハッシュ値を返します（暗号学的ハッシュ関数ではありません）。
+		/// @return ハッシュ値。等しい画像は同じ値になります
+		/// @remark 変更されていないフレームの検出や、同じ画像の重複の判定に使います。値が等しい場合も、operator == で確認してください。
+		[[nodiscard]]
+		uint64 hash() const
+		{
+			return view().hash();
 		}
 
 		/// @brief 画像の幅（ピクセル）を返します。
@@ -118,7 +182,7 @@ namespace seccamp
 		/// @remark image[y][x] で指定したピクセルにアクセスします。
 		/// @return 指定した行の先頭ポインタ
 		[[nodiscard]]
-		Color* operator [](size_t y) noexcept
+		Color* operator [](size_t y)
 		{
 			return (m_pixels.data() + (y * m_size.x));
 		}
@@ -136,7 +200,7 @@ namespace seccamp
 		/// @brief 画像データの先頭ポインタを返します。
 		/// @return 画像データの先頭ポインタ
 		[[nodiscard]]
-		Color* data() noexcept
+		Color* data()
 		{
 			return m_pixels.data();
 		}
@@ -149,7 +213,57 @@ namespace seccamp
 			return m_pixels.data();
 		}
 
-		/// @brief 画像を空にします。
+		/// @brief 画像全体を参照するビューを返します。
+		/// @return 画像全体を参照するビュー
+		/// @remark 画像をリサイズするとビューは無効になります。
+		[[nodiscard]]
+		ImageView view()
+		{
+			return{ m_pixels.data(), m_size, static_cast<size_t>(m_size.x) };
+		}
+
+		/// @brief 画像全体を参照するビューを返します。
+		/// @return 画像全体を参照するビュー
+		/// @remark 画像をリサイズするとビューは無効になります。
+		[[nodiscard]]
+		ConstImageView view() const noexcept
+		{
+			return{ m_pixels.data(), m_size, static_cast<size_t>(m_size.x) };
+		}
+
+		/// @brief 画像の一部の領域を参照するビューを返します。ピクセルはコピーしません。
+		/// @param region 領域。画像の範囲外の部分は無視されます
+		/// @return 領域を参照するビュー。領域が画像と重ならない場合は空のビュー
+		[[nodiscard]]
+		ImageView view(const Rect& region)
+		{
+			return view().subView(region);
+		}
+
+		/// @brief 画像の一部の領域を参照するビューを返します。ピクセルはコピーしません。
+		/// @param region 領域。画像の範囲外の部分は無視されます
+		/// @return 領域を参照するビュー。領域が画像と重ならない場合は空のビュー
+		[[nodiscard]]
+		ConstImageView view(const Rect& region) const noexcept
+		{
+			return view().subView(region);
+		}
+
+		/// @brief 画像全体を参照するビューに変換します。
+		[[nodiscard]]
+		operator ImageView()
+		{
+			return view();
+		}
+
+		/// @brief 画像全体を参照するビューに変換します。
+		[[nodiscard]]
+		operator ConstImageView() const noexcept
+		{
+			return view();
+		}
+
+		/// @brief 画像を空にし、メモリを解放します。
 		void clear() noexcept
 		{
 			m_pixels.clear();
@@ -162,7 +276,17 @@ namespace seccamp
 		/// @param color 新しい画像の初期色
 		void resize(int32 width, int32 height, const Color& color = Palette::White)
 		{
-			m_pixels.assign(width * height, color);
+			resize(width, height, Uninitialized);
+			fill(color);
+		}
+
+		/// @brief ピクセルを初期化せずに画像をリサイズします。
+		/// @param width 新しい画像の幅（ピクセル）
+		/// @param height 新しい画像の高さ（ピクセル）
+		/// @remark ピクセルの値は不定です。ピクセル数が変わらない、または減る場合はメモリを再確保しません。
+		void resize(int32 width, int32 height, UninitializedTag)
+		{
+			m_pixels.resizeUninitialized(static_cast<size_t>(width) * static_cast<size_t>(height));
 			m_size.set(width, height);
 		}
 
@@ -174,9 +298,81 @@ namespace seccamp
 			resize(size.x, size.y, color);
 		}
 
+		/// @brief コピーオンライトの有効・無効を設定します。
+		/// @param enabled 有効にする場合 true, 無効にする場合 false
+		/// @remark 有効な画像のコピーは、参照カウント付きのメモリを共有し、コピーオンライトも有効になります。
+		/// 参照カウントの更新はスレッドセーフなので、共有している別々の画像を、異なるスレッドで同時にコピー・変更・破棄できます。
+		/// @remark 書き込み可能なビューは、取得した時点でピクセルをコピーします。取得後に作ったコピーとはメモリを共有するため、コピーした後はビューを取得し直してください。
+		void setCopyOnWrite(const bool enabled)
+		{
+			m_pixels.setCopyOnWrite(enabled);
+		}
+
+		/// @brief コピーオンライトが有効であるかを返します。
+		/// @return 有効である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isCopyOnWrite() const noexcept
+		{
+			return m_pixels.isCopyOnWrite();
+		}
+
+		/// @brief 他の画像とメモリを共有しているかを返します。
+		/// @return 共有している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isShared() const noexcept
+		{
+			return m_pixels.isShared();
+		}
+
+		/// @brief 他の画像とメモリを共有している場合は、ピクセルをコピーして単独で所有します。
+		/// @remark 書き込み可能なアクセスでも自動でコピーされますが、多くの書き込みを並列に行う前などに、明示的にコピーする場合に使います。
+		void detach()
+		{
+			m_pixels.detach();
+		}
+
+		/// @brief 画像の行を複数の範囲に分け、共有のスレッドプールで並列に関数を実行します。
+		/// @param func 各範囲に対して呼ばれる関数。引数は範囲の先頭の行と終端の行（含まない）
+		/// @param grain 1 回の呼び出しで処理する行数。0 の場合は画像の大きさとスレッド数から自動で決めます
+		/// @remark すべての呼び出しが完了してから戻ります。小さな画像では呼び出し元のスレッドだけで実行します。
+		/// @remark 異なる範囲の行に同時に書き込むことは安全ですが、範囲外の行への書き込みは呼び出し側で同期が必要です。
+		template <class Fty>
+			requires std::invocable<Fty&, int32, int32>
+		void parallelForRows(Fty&& func, const int32 grain = 0) const
+		{
+			view().parallelForRows(std::forward<Fty>(func), grain);
+		}
+
 		/// @brief 画像を指定した色で塗りつぶします。
 		/// @param color 塗りつぶしの色
-		void fill(const Color& color) noexcept;
+		void fill(const Color& color);
+
+		/// @brief 画像をグレースケールに変換します。アルファ成分は変更しません。
+		/// @return *this
+		/// @remark 結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+		Image& grayscale();
+
+		/// @brief 各ピクセルのグレースケール値を返します。
+		/// @return 各ピクセルのグレースケール値（numPixels() 個）
+		/// @remark 結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+		[[nodiscard]]
+		std::vector<uint8> grayscaleUint8() const;
+
+		/// @brief 各ピクセルの 1 つの成分を取り出します。
+		/// @param index 取り出す成分（0: R, 1: G, 2: B, 3: A）
+		/// @return 各ピクセルの成分（numPixels() 個）。index が 3 より大きい場合は空の配列
+		[[nodiscard]]
+		std::vector<uint8> channel(size_t index) const;
+
+		/// @brief 画像の色を反転します。アルファ成分は変更しません。
+		/// @return *this
+		Image& invert();
+
+		/// @brief 画像の明るさとコントラストを調整します。アルファ成分は変更しません。
+		/// @param brightness 明るさの調整量 [-255, 255]
+		/// @param contrast コントラストの倍率 [0.0, 127.0]。1.0 で変化なし
+		/// @return *this
+		Image& adjustBrightnessContrast(int32 brightness, double contrast);
 
 		/// @brief 2 つの画像をスワップします。
 		/// @param other もう一方の画像
@@ -189,7 +385,7 @@ namespace seccamp
 		/// @brief ピクセル配列の先頭位置を指すイテレータを返します。
 		/// @return ピクセル配列の先頭位置を指すイテレータ
 		[[nodiscard]]
-		iterator begin() noexcept
+		iterator begin()
 		{
 			return m_pixels.begin();
 		}
@@ -197,7 +393,7 @@ namespace seccamp
 		/// @brief ピクセル配列の終端位置を指すイテレータを返します。
 		/// @return ピクセル配列の終端位置を指すイテレータ
 		[[nodiscard]]
-		iterator end() noexcept
+		iterator end()
 		{
 			return m_pixels.end();
 		}
@@ -221,6 +417,7 @@ namespace seccamp
 		/// @brief 画像をファイルに保存します。
 		/// @param path 保存するファイルのパス
 		/// @return 保存に成功した場合 true, それ以外の場合は false
+		/// @remark ファイルの形式は拡張子から判定します。対応する形式がない拡張子の場合は BMP 形式で保存します。
 		bool save(std::string_view path) const;
 
 		/// @brief 2 つの画像をスワップします。
@@ -238,3 +435,14 @@ namespace seccamp
 		Size m_size{ 0, 0 };
 	};
 }
+
+/// @brief std::unordered_set<Image> などで画像をキーとして使うための特殊化
+template <>
+struct std::hash<seccamp::Image>
+{
+	[[nodiscard]]
+	size_t operator ()(const seccamp::Image& image) const
+	{
+		return static_cast<size_t>(image.hash());
+	}
+};
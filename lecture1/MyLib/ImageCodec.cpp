@@ -0,0 +1,233 @@
+﻿#include <algorithm> // std::ranges::find, std::ranges::equal
+#include <array> // std::array
+#include <fstream> // std::ifstream
+#include <mutex> // std::mutex, std::lock_guard
+#include <vector> // std::vector
+#include "ImageCodec.hpp"
+#include "Image.hpp"
+#include "BMP.hpp"
+#include "PNG.hpp"
+#include "FileSystem.hpp"
+#include "Utility.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		class BMPCodec final : public ImageCodec
+		{
+		public:
+
+			[[nodiscard]]
+			std::string_view name() const noexcept override
+			{
+				return "BMP";
+			}
+
+			[[nodiscard]]
+			std::span<const std::string_view> extensions() const noexcept override
+			{
+				static constexpr std::string_view Extensions[] = { ".bmp", ".dib" };
+				return Extensions;
+			}
+
+			[[nodiscard]]
+			size_t headerSize() const noexcept override
+			{
+				return 18;
+			}
+
+			[[nodiscard]]
+			bool isHeader(const std::span<const std::byte> header) const noexcept override
+			{
+				if ((header[0] != std::byte{ 'B' }) || (header[1] != std::byte{ 'M' }))
+				{
+					return false;
+				}
+
+				// "BM" だけでは誤判定しやすいので、情報ヘッダのサイズも LoadBMP() が読み込める 40 バイト以上であることを確かめる
+				const uint32 infoHeaderSize = (std::to_integer<uint32>(header[14])
+					| (std::to_integer<uint32>(header[15]) << 8)
+					| (std::to_integer<uint32>(header[16]) << 16)
+					| (std::to_integer<uint32>(header[17]) << 24));
+
+				return (40 <= infoHeaderSize);
+			}
+
+			[[nodiscard]]
+			Image load(const std::string_view path) const override
+			{
+				return LoadBMP(path);
+			}
+
+			bool save(const ConstImageView& image, const std::string_view path) const override
+			{
+				return SaveBMP(image, path);
+			}
+		};
+
+		class PNGCodec final : public ImageCodec
+		{
+		public:
+
+			[[nodiscard]]
+			std::string_view name() const noexcept override
+			{
+				return "PNG";
+			}
+
+			[[nodiscard]]
+			std::span<const std::string_view> extensions() const noexcept override
+			{
+				static constexpr std::string_view Extensions[] = { ".png" };
+				return Extensions;
+			}
+
+			[[nodiscard]]
+			size_t headerSize() const noexcept override
+			{
+				return 8;
+			}
+
+			[[nodiscard]]
+			bool isHeader(const std::span<const std::byte> header) const noexcept override
+			{
+				constexpr uint8 Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+				return std::ranges::equal(header.first(8), Signature, {}, [](const std::byte b) { return std::to_integer<uint8>(b); });
+			}
+
+			[[nodiscard]]
+			Image load(const std::string_view path) const override
+			{
+				return LoadPNG(path);
+			}
+
+			bool save(const ConstImageView& image, const std::string_view path) const override
+			{
+				return SavePNG(image, path);
+			}
+		};
+
+		/// @brief 登録されている形式の一覧
+		class CodecRegistry
+		{
+		public:
+
+			[[nodiscard]]
+			static CodecRegistry& Get()
+			{
+				static CodecRegistry registry;
+				return registry;
+			}
+
+			void add(std::shared_ptr<const ImageCodec> codec)
+			{
+				std::lock_guard lock{ m_mutex };
+				m_codecs.insert(m_codecs.begin(), std::move(codec));
+			}
+
+			/// @brief 条件を満たす形式を、後から登録したものから順に探します。
+			[[nodiscard]]
+			std::shared_ptr<const ImageCodec> find(auto predicate) const
+			{
+				std::lock_guard lock{ m_mutex };
+
+				for (const auto& codec : m_codecs)
+				{
+					if (predicate(*codec))
+					{
+						return codec;
+					}
+				}
+
+				return nullptr;
+			}
+
+		private:
+
+			CodecRegistry()
+				: m_codecs{ std::make_shared<PNGCodec>(), std::make_shared<BMPCodec>() } {}
+
+			mutable std::mutex m_mutex;
+
+			// 優先度の高い順
+			std::vector<std::shared_ptr<const ImageCodec>> m_codecs;
+		};
+	}
+
+	void ImageCodec::Register(std::shared_ptr<const ImageCodec> codec)
+	{
+		if (codec)
+		{
+			CodecRegistry::Get().add(std::move(codec));
+		}
+	}
+
+	std::shared_ptr<const ImageCodec> ImageCodec::FromHeader(const std::span<const std::byte> header)
+	{
+		return CodecRegistry::Get().find([header](const ImageCodec& codec)
+			{
+				const size_t headerSize = codec.headerSize();
+				return ((0 < headerSize) && (headerSize <= header.size()) && codec.isHeader(header.first(headerSize)));
+			});
+	}
+
+	std::shared_ptr<const ImageCodec> ImageCodec::FromFile(const std::string_view path)
+	{
+		// 先頭の数十バイトだけを読めばよいので、ファイル全体をメモリマップする BinaryFileReader は使わない
+		std::ifstream file{ std::string{ path }, std::ios::binary };
+
+		if (not file.is_open())
+		{
+			return nullptr;
+		}
+
+		std::array<std::byte, MaxHeaderSize> header;
+		file.read(reinterpret_cast<char*>(header.data()), header.size());
+		const int64 readSize = file.gcount();
+
+		if (readSize <= 0)
+		{
+			return nullptr;
+		}
+
+		return FromHeader(std::span{ header }.first(static_cast<size_t>(readSize)));
+	}
+
+	std::shared_ptr<const ImageCodec> ImageCodec::FromExtension(const std::string_view path)
+	{
+		const std::string extension = ToLower(FileSystem::Extension(path));
+
+		if (extension.empty())
+		{
+			return nullptr;
+		}
+
+		return CodecRegistry::Get().find([&extension](const ImageCodec& codec)
+			{
+				const std::span<const std::string_view> extensions = codec.extensions();
+				return (std::ranges::find(extensions, extension) != extensions.end());
+			});
+	}
+
+	Image LoadImageFile(const std::string_view path)
+	{
+		if (const auto codec = ImageCodec::FromFile(path))
+		{
+			return codec->load(path);
+		}
+
+		return{};
+	}
+
+	bool SaveImageFile(const ConstImageView& image, const std::string_view path)
+	{
+		if (const auto codec = ImageCodec::FromExtension(path))
+		{
+			return codec->save(image, path);
+		}
+
+		return SaveBMP(image, path);
+	}
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <memory> // std::shared_ptr
+#include <span> // std::span
+#include <cstddef> // std::byte
+#include <string_view> // std::string_view
+#include "Common.hpp"
+#include "ImageView.hpp"
+
+namespace seccamp
+{
+	class Image; // 前方宣言
+
+	/// @brief 画像ファイルの形式ごとに、読み込みと保存を行うクラスの基底クラス
+	/// @remark ImageCodec::Register() で登録した形式は、Image のファイルからの読み込みと Image::save() で使われるようになります。
+	class ImageCodec
+	{
+	public:
+
+		/// @brief 形式の判定に読み込むファイルの先頭のバイト数の上限
+		static constexpr size_t MaxHeaderSize = 64;
+
+		virtual ~ImageCodec() = default;
+
+		/// @brief 形式の名前を返します。（例: "BMP"）
+		/// @return 形式の名前
+		[[nodiscard]]
+		virtual std::string_view name() const noexcept = 0;
+
+		/// @brief 形式の拡張子の一覧を返します。（例: ".png"）
+		/// @return 小文字の拡張子の一覧。最初の要素が代表的な拡張子
+		[[nodiscard]]
+		virtual std::span<const std::string_view> extensions() const noexcept = 0;
+
+		/// @brief 形式の判定に必要な、ファイルの先頭のバイト数を返します。
+		/// @return 形式の判定に必要なバイト数。MaxHeaderSize 以下
+		[[nodiscard]]
+		virtual size_t headerSize() const noexcept = 0;
+
+		/// @brief ファイルの先頭のデータが、この形式のものであるかを返します。
+		/// @param header ファイルの先頭のデータ。headerSize() バイト以上
+		/// @return この形式のデータである場合 true, それ以外の場合は false
+		[[nodiscard]]
+		virtual bool isHeader(std::span<const std::byte> header) const noexcept = 0;
+
+		/// @brief 画像ファイルを読み込みます。
+		/// @param path 読み込む画像のパス
+		/// @return 読み込んだ画像。読み込みに失敗した場合は空の画像
+		[[nodiscard]]
+		virtual Image load(std::string_view path) const = 0;
+
+		/// @brief 画像をファイルに保存します。
+		/// @param image 保存する画像のビュー
+		/// @param path 保存先のパス
+		/// @return 保存に成功した場合 true, それ以外の場合は false
+		virtual bool save(const ConstImageView& image, std::string_view path) const = 0;
+
+		/// @brief 形式を登録します。
+		/// @param codec 登録する形式
+		/// @remark 後から登録した形式ほど優先して判定されるので、組み込みの形式（BMP, PNG）を置き換えることもできます。スレッドセーフです。
+		static void Register(std::shared_ptr<const ImageCodec> codec);
+
+		/// @brief ファイルの先頭のデータから形式を判定します。
+		/// @param header ファイルの先頭のデータ
+		/// @return 判定した形式。どの形式にも一致しない場合は nullptr
+		[[nodiscard]]
+		static std::shared_ptr<const ImageCodec> FromHeader(std::span<const std::byte> header);
+
+		/// @brief ファイルの先頭の MaxHeaderSize バイトまでを読み込んで形式を判定します。
+		/// @param path ファイルパス
+		/// @return 判定した形式。ファイルを開けない場合や、どの形式にも一致しない場合は nullptr
+		/// @remark ファイル全体は読み込まないので、多数のファイルの形式を調べる場合にも使えます。
+		[[nodiscard]]
+		static std::shared_ptr<const ImageCodec> FromFile(std::string_view path);
+
+		/// @brief ファイルパスの拡張子から形式を判定します。
+		/// @param path ファイルパス
+		/// @return 判定した形式。対応する形式がない場合は nullptr
+		/// @remark 拡張子の大文字と小文字は区別しません。
+		[[nodiscard]]
+		static std::shared_ptr<const ImageCodec> FromExtension(std::string_view path);
+	};
+
+	/// @brief ファイルの形式を判定して画像を読み込みます。
+	/// @param path 読み込む画像のパス
+	/// @return 読み込んだ画像。形式を判定できない場合や、読み込みに失敗した場合は空の画像
+	/// @remark 形式は拡張子ではなく、ファイルの先頭のデータから判定します。
+	[[nodiscard]]
+	Image LoadImageFile(std::string_view path);
+
+	/// @brief 拡張子に応じた形式で画像を保存します。
+	/// @param image 保存する画像のビュー
+	/// @param path 保存先のパス
+	/// @return 保存に成功した場合 true, それ以外の場合は false
+	/// @remark 対応する形式がない拡張子の場合は BMP 形式で保存します。
+	bool SaveImageFile(const ConstImageView& image, std::string_view path);
+}
@@ -0,0 +1,458 @@
+﻿#include <algorithm> // std::max, std::ranges::find_if, std::ranges::sort
+#include <atomic> // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <deque> // std::deque
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <mutex> // std::mutex, std::lock_guard, std::unique_lock
+#include <thread> // std::thread
+#include <utility> // std::move
+#include "ImagePipeline.hpp"
+#include "Image.hpp"
+#include "ImageCodec.hpp"
+#include "Timer.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief スレッド数が 0 の場合に、CPU の論理コア数の半分（最低 1）に置き換えます。
+		/// @param numThreads スレッド数
+		/// @return スレッド数
+		[[nodiscard]]
+		size_t ResolveNumThreads(const size_t numThreads) noexcept
+		{
+			if (numThreads != 0)
+			{
+				return numThreads;
+			}
+
+			return std::max<size_t>((std::thread::hardware_concurrency() / 2), 1);
+		}
+
+		/// @brief 設定の 0 の値を、実際のスレッド数や画像の数に置き換えます。
+		/// @param options パイプラインの設定
+		/// @return 置き換えた設定
+		[[nodiscard]]
+		ImagePipeline::Options ResolveOptions(ImagePipeline::Options options) noexcept
+		{
+			options.numDecodeThreads = ResolveNumThreads(options.numDecodeThreads);
+			options.numTransformThreads = ResolveNumThreads(options.numTransformThreads);
+			options.numEncodeThreads = ResolveNumThreads(options.numEncodeThreads);
+
+			if (options.maxImagesInFlight == 0)
+			{
+				options.maxImagesInFlight = ((options.numDecodeThreads + options.numTransformThreads + options.numEncodeThreads) * 2);
+			}
+
+			return options;
+		}
+
+		/// @brief パイプラインの段の間を流れる画像
+		struct PipelineItem
+		{
+			/// @brief Job のインデックス
+			size_t index = 0;
+
+			/// @brief 画像。読み込みに失敗した場合は空の画像
+			Image image;
+		};
+
+		/// @brief 段と段の間をつなぐ、上限付きのキュー
+		class ItemQueue
+		{
+		public:
+
+			/// @param capacity 保持できる画像の最大数
+			/// @param ordered Job のインデックスの順に取り出す場合 true
+			ItemQueue(const size_t capacity, const bool ordered)
+				: m_capacity{ capacity }
+				, m_ordered{ ordered } {}
+
+			/// @brief 画像を追加します。キューがいっぱいの場合は空くまで待ちます。
+			/// @return 追加した場合 true, 処理が中止された場合は false
+			bool push(PipelineItem&& item)
+			{
+				{
+					std::unique_lock lock{ m_mutex };
+
+					m_notFull.wait(lock, [this]() { return (m_cancelled || (m_items.size() < m_capacity)); });
+
+					if (m_cancelled)
+					{
+						return false;
+					}
+
+					m_items.push_back(std::move(item));
+				}
+
+				// 順序を保つ場合は、待っているスレッドのうち次の画像を取り出せるものが 1 つとは限らない
+				if (m_ordered)
+				{
+					m_notEmpty.notify_all();
+				}
+				else
+				{
+					m_notEmpty.notify_one();
+				}
+
+				return true;
+			}
+
+			/// @brief 画像を取り出します。取り出せる画像が無い場合は、追加されるまで待ちます。
+			/// @return 取り出した場合 true, すべての画像を取り出し終えた場合や、処理が中止された場合は false
+			bool pop(PipelineItem& item)
+			{
+				{
+					std::unique_lock lock{ m_mutex };
+
+					auto it = m_items.end();
+
+					m_notEmpty.wait(lock, [&]()
+						{
+							if (m_cancelled)
+							{
+								return true;
+							}
+
+							it = (m_ordered ? std::ranges::find_if(m_items, [this](const PipelineItem& i) { return (i.index == m_nextIndex); }) : m_items.begin());
+
+							return ((it != m_items.end()) || (m_closed && m_items.empty()));
+						});
+
+					if (m_cancelled || (it == m_items.end()))
+					{
+						return false;
+					}
+
+					item = std::move(*it);
+					m_items.erase(it);
+					++m_nextIndex;
+				}
+
+				m_notFull.notify_one();
+
+				return true;
+			}
+
+			/// @brief これ以上画像を追加しないことを通知します。
+			void close()
+			{
+				{
+					std::lock_guard lock{ m_mutex };
+					m_closed = true;
+				}
+
+				m_notEmpty.notify_all();
+			}
+
+			/// @brief 処理を中止し、待っているすべてのスレッドを起こします。
+			void cancel()
+			{
+				{
+					std::lock_guard lock{ m_mutex };
+					m_cancelled = true;
+				}
+
+				m_notFull.notify_all();
+				m_notEmpty.notify_all();
+			}
+
+		private:
+
+			std::mutex m_mutex;
+
+			std::condition_variable m_notFull;
+
+			std::condition_variable m_notEmpty;
+
+			std::deque<PipelineItem> m_items;
+
+			size_t m_capacity;
+
+			// 順序を保つ場合に、次に取り出す Job のインデックス
+			size_t m_nextIndex = 0;
+
+			bool m_ordered;
+
+			bool m_closed = false;
+
+			bool m_cancelled = false;
+		};
+
+		/// @brief パイプライン内に同時に存在する画像の数を制限し、読み込む Job を順に割り当てるクラス
+		class JobDispatcher
+		{
+		public:
+
+			JobDispatcher(const size_t numJobs, const size_t maxImagesInFlight)
+				: m_numJobs{ numJobs }
+				, m_maxImagesInFlight{ maxImagesInFlight } {}
+
+			/// @brief 次に読み込む Job のインデックスを取得します。画像の数が上限に達している場合は、空くまで待ちます。
+			/// @return 取得した場合 true, すべての Job を割り当て終えた場合や、処理が中止された場合は false
+			bool acquire(size_t& index)
+			{
+				std::unique_lock lock{ m_mutex };
+
+				m_condition.wait(lock, [this]() { return (m_cancelled || (m_numJobs <= m_nextIndex) || (m_numImagesInFlight < m_maxImagesInFlight)); });
+
+				if (m_cancelled || (m_numJobs <= m_nextIndex))
+				{
+					return false;
+				}
+
+				index = m_nextIndex++;
+				++m_numImagesInFlight;
+
+				return true;
+			}
+
+			/// @brief 画像の処理が終わったことを通知します。
+			void release()
+			{
+				{
+					std::lock_guard lock{ m_mutex };
+					--m_numImagesInFlight;
+				}
+
+				m_condition.notify_one();
+			}
+
+			/// @brief 処理を中止し、待っているすべてのスレッドを起こします。
+			void cancel()
+			{
+				{
+					std::lock_guard lock{ m_mutex };
+					m_cancelled = true;
+				}
+
+				m_condition.notify_all();
+			}
+
+		private:
+
+			std::mutex m_mutex;
+
+			std::condition_variable m_condition;
+
+			size_t m_numJobs;
+
+			size_t m_maxImagesInFlight;
+
+			size_t m_nextIndex = 0;
+
+			size_t m_numImagesInFlight = 0;
+
+			bool m_cancelled = false;
+		};
+	}
+
+	ImagePipeline::ImagePipeline()
+		: ImagePipeline{ Options{} } {}
+
+	ImagePipeline::ImagePipeline(const Options& options)
+		: m_options{ ResolveOptions(options) } {}
+
+	const ImagePipeline::Options& ImagePipeline::options() const noexcept
+	{
+		return m_options;
+	}
+
+	ImagePipeline::Stats ImagePipeline::run(const std::span<const Job> jobs)
+	{
+		return run(jobs, [](Image&) {});
+	}
+
+	ImagePipeline::Stats ImagePipeline::run(const std::span<const Job> jobs, const TransformFunction function, void* context)
+	{
+		const Timer timer;
+
+		const size_t numDecodeThreads = m_options.numDecodeThreads;
+		const size_t numTransformThreads = m_options.numTransformThreads;
+		const size_t numEncodeThreads = m_options.numEncodeThreads;
+		const size_t maxImagesInFlight = m_options.maxImagesInFlight;
+
+		// パイプライン内の画像の数は maxImagesInFlight 以下なので、キューがいっぱいになって処理が止まることはない
+		JobDispatcher dispatcher{ jobs.size(), maxImagesInFlight };
+		ItemQueue decodedQueue{ maxImagesInFlight, false };
+		ItemQueue transformedQueue{ maxImagesInFlight, m_options.preserveOrder };
+
+		// 段ごとの、まだ終了していないスレッドの数
+		std::atomic<size_t> numDecodersLeft = numDecodeThreads;
+		std::atomic<size_t> numTransformersLeft = numTransformThreads;
+
+		std::mutex statsMutex;
+		Stats stats;
+
+		const auto Cancel = [&]()
+		{
+			dispatcher.cancel();
+			decodedQueue.cancel();
+			transformedQueue.cancel();
+		};
+
+		const auto Decode = [&]()
+		{
+			double seconds = 0.0;
+			size_t index;
+
+			while (dispatcher.acquire(index))
+			{
+				const Timer stageTimer;
+				Image image = LoadImageFile(jobs[index].inputPath);
+				seconds += stageTimer.sF();
+
+				// 読み込みに失敗した画像も、順序を保つために後ろの段に流す
+				if (not decodedQueue.push(PipelineItem{ index, std::move(image) }))
+				{
+					break;
+				}
+			}
+
+			if (--numDecodersLeft == 0)
+			{
+				decodedQueue.close();
+			}
+
+			std::lock_guard lock{ statsMutex };
+			stats.decodeSeconds += seconds;
+		};
+
+		const auto Transform = [&]()
+		{
+			double seconds = 0.0;
+			PipelineItem item;
+
+			while (decodedQueue.pop(item))
+			{
+				if (item.image)
+				{
+					const Timer stageTimer;
+					function(context, item.image);
+					seconds += stageTimer.sF();
+				}
+
+				if (not transformedQueue.push(std::move(item)))
+				{
+					break;
+				}
+			}
+
+			if (--numTransformersLeft == 0)
+			{
+				transformedQueue.close();
+			}
+
+			std::lock_guard lock{ statsMutex };
+			stats.transformSeconds += seconds;
+		};
+
+		const auto Encode = [&]()
+		{
+			double seconds = 0.0;
+			size_t numSucceeded = 0;
+			std::vector<size_t> failedJobs;
+			PipelineItem item;
+
+			while (transformedQueue.pop(item))
+			{
+				bool succeeded = false;
+
+				if (item.image)
+				{
+					const Timer stageTimer;
+					succeeded = SaveImageFile(item.image, jobs[item.index].outputPath);
+					seconds += stageTimer.sF();
+				}
+
+				if (succeeded)
+				{
+					++numSucceeded;
+				}
+				else
+				{
+					failedJobs.push_back(item.index);
+				}
+
+				// 次の画像を読み込む前にメモリを解放する
+				item.image = Image{};
+				dispatcher.release();
+			}
+
+			std::lock_guard lock{ statsMutex };
+			stats.encodeSeconds += seconds;
+			stats.numSucceeded += numSucceeded;
+			stats.failedJobs.insert(stats.failedJobs.end(), failedJobs.begin(), failedJobs.end());
+		};
+
+		std::mutex exceptionMutex;
+		std::exception_ptr exception;
+
+		// 各段のスレッドはキューで互いを待つので、すべてのスレッドが同時に動いている必要がある。
+		// スレッドプールのスレッドは ParallelFor() の中から呼ばれた場合に使えないので、専用のスレッドを作成する
+		std::vector<std::thread> threads;
+		threads.reserve(numDecodeThreads + numTransformThreads + numEncodeThreads);
+
+		const auto Launch = [&](const auto& stage, const size_t numThreads)
+		{
+			for (size_t i = 0; i < numThreads; ++i)
+			{
+				threads.emplace_back([&, stage]()
+					{
+						try
+						{
+							stage();
+						}
+						catch (...)
+						{
+							{
+								std::lock_guard lock{ exceptionMutex };
+
+								if (not exception)
+								{
+									exception = std::current_exception();
+								}
+							}
+
+							// 他の段のスレッドが待ち続けないように、すべてのキューを中止する
+							Cancel();
+						}
+					});
+			}
+		};
+
+		const auto Join = [&]()
+		{
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+		};
+
+		try
+		{
+			Launch(Decode, numDecodeThreads);
+			Launch(Transform, numTransformThreads);
+			Launch(Encode, numEncodeThreads);
+		}
+		catch (...)
+		{
+			// スレッドを作成できなかった場合は、作成済みのスレッドを止めてから例外を伝える
+			Cancel();
+			Join();
+			throw;
+		}
+
+		Join();
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+
+		std::ranges::sort(stats.failedJobs);
+		stats.totalSeconds = timer.sF();
+
+		return stats;
+	}
+}
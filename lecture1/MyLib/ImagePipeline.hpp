@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <memory> // std::addressof
+#include <span> // std::span
+#include <string> // std::string
+#include <vector> // std::vector
+#include <concepts> // std::invocable
+#include <type_traits> // std::remove_reference_t
+#include "Common.hpp"
+
+namespace seccamp
+{
+	class Image; // 前方宣言
+
+	/// @brief 多数の画像の読み込み・変換・保存を、段ごとに別のスレッドで並行して行うパイプライン
+	/// @remark 読み込み（デコード）、変換、保存（エンコード）の 3 つの段を、上限付きのキューでつなぎます。
+	/// ファイルの入出力と変換の処理が重なるので、1 枚ずつ処理するよりも短い時間で終わります。
+	class ImagePipeline
+	{
+	public:
+
+		/// @brief 処理する 1 枚の画像の、入力と出力のパス
+		struct Job
+		{
+			/// @brief 読み込む画像のパス。形式はファイルの先頭のデータから判定します
+			std::string inputPath;
+
+			/// @brief 保存先のパス。形式は拡張子から判定します
+			std::string outputPath;
+		};
+
+		/// @brief パイプラインの設定
+		struct Options
+		{
+			/// @brief 読み込みに使うスレッド数。0 の場合は CPU の論理コア数の半分（最低 1）
+			size_t numDecodeThreads = 0;
+
+			/// @brief 変換に使うスレッド数。0 の場合は CPU の論理コア数の半分（最低 1）
+			size_t numTransformThreads = 0;
+
+			/// @brief 保存に使うスレッド数。0 の場合は CPU の論理コア数の半分（最低 1）
+			size_t numEncodeThreads = 0;
+
+			/// @brief パイプライン内に同時に存在できる画像の最大数。0 の場合は全スレッド数の 2 倍
+			/// @remark 読み込みが保存より速い場合でも、メモリの使用量はこの枚数分に抑えられます。
+			size_t maxImagesInFlight = 0;
+
+			/// @brief 保存を、入力と同じ順序で開始する場合 true
+			/// @remark numEncodeThreads が 1 の場合は、ファイルが入力と同じ順序で書き込まれます。
+			bool preserveOrder = false;
+		};
+
+		/// @brief パイプラインの処理結果
+		struct Stats
+		{
+			/// @brief 保存まで成功した画像の数
+			size_t numSucceeded = 0;
+
+			/// @brief 読み込みまたは保存に失敗した Job のインデックス（昇順）
+			std::vector<size_t> failedJobs;
+
+			/// @brief 読み込みにかかった時間の、全スレッドの合計（秒）
+			double decodeSeconds = 0.0;
+
+			/// @brief 変換にかかった時間の、全スレッドの合計（秒）
+			double transformSeconds = 0.0;
+
+			/// @brief 保存にかかった時間の、全スレッドの合計（秒）
+			double encodeSeconds = 0.0;
+
+			/// @brief 全体の経過時間（秒）
+			double totalSeconds = 0.0;
+
+			/// @brief 1 秒あたりに処理した画像の数を返します。
+			/// @return 1 秒あたりに処理した画像の数
+			[[nodiscard]]
+			double imagesPerSecond() const noexcept
+			{
+				return ((0.0 < totalSeconds) ? ((numSucceeded + failedJobs.size()) / totalSeconds) : 0.0);
+			}
+		};
+
+		/// @brief デフォルトの設定でパイプラインを作成します。
+		[[nodiscard]]
+		ImagePipeline();
+
+		/// @brief パイプラインを作成します。
+		/// @param options パイプラインの設定
+		[[nodiscard]]
+		explicit ImagePipeline(const Options& options);
+
+		/// @brief パイプラインの設定を返します。スレッド数などは、0 を実際の値に置き換えたものです。
+		/// @return パイプラインの設定
+		[[nodiscard]]
+		const Options& options() const noexcept;
+
+		/// @brief 画像を読み込み、変換せずに保存します。
+		/// @param jobs 処理する画像の一覧
+		/// @return 処理結果
+		/// @remark 形式の変換（例: BMP から PNG）に使えます。
+		/// @remark すべての画像の処理が完了してから戻ります。各段のスレッドは呼び出しごとに作成するので、ParallelFor() などの並列処理の中からも呼び出せます。
+		Stats run(std::span<const Job> jobs);
+
+		/// @brief 画像を読み込み、関数で変換してから保存します。
+		/// @param jobs 処理する画像の一覧
+		/// @param transform 読み込んだ各画像に対して呼ばれる関数。引数の画像を書き換えます
+		/// @return 処理結果
+		/// @remark 関数は複数のスレッドから同時に呼ばれます。関数の中の ParallelFor() は、グローバルなスレッドプールで順番に実行されます。
+		/// @remark 関数が例外を投げた場合は、残りの画像の処理を打ち切り、すべてのスレッドの停止後に最初の例外を再送出します。
+		template <class Fty>
+			requires std::invocable<Fty&, Image&>
+		Stats run(const std::span<const Job> jobs, Fty&& transform)
+		{
+			using FunctionType = std::remove_reference_t<Fty>;
+
+			const auto Invoke = [](void* context, Image& image)
+			{
+				(*static_cast<FunctionType*>(context))(image);
+			};
+
+			return run(jobs, Invoke, const_cast<void*>(static_cast<const void*>(std::addressof(transform))));
+		}
+
+	private:
+
+		using TransformFunction = void(*)(void*, Image&);
+
+		Stats run(std::span<const Job> jobs, TransformFunction function, void* context);
+
+		Options m_options;
+	};
+}
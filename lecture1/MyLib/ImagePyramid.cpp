@@ -0,0 +1,393 @@
+﻿#include <algorithm> // std::min, std::max, std::fill
+#include <cstring> // std::memcmp, std::memcpy
+#include <filesystem> // std::filesystem::last_write_time, std::filesystem::file_size, std::filesystem::remove
+#include "ImagePyramid.hpp"
+#include "Image.hpp"
+#include "ImageCodec.hpp"
+#include "Resize.hpp"
+#include "Hash.hpp"
+#include "FileSystem.hpp"
+#include "BinaryFileReader.hpp"
+#include "BinaryFileWriter.hpp"
+#include "ThreadPool.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 1 つの帯の中で続けて縮小する段の数。元の画像の (1 << StripLevels) 行が 1 つの帯になる
+		/// @remark 4K の画像では、元の画像の 1 つの帯が約 480 KiB になり、L2 キャッシュに収まります。
+		constexpr size_t StripLevels = 5;
+
+		/// @brief 各段の先頭の位置のアラインメント（ピクセル）
+		constexpr size_t LevelAlignment = (PixelAllocator::Alignment / sizeof(Color));
+
+		/// @brief キャッシュファイルのヘッダ
+		struct ImagePyramidHeader
+		{
+			/// @brief ファイル識別子
+			char magic[8];
+
+			/// @brief 元の画像のファイルのサイズ（バイト）
+			uint64 fileSize;
+
+			/// @brief 元の画像のファイルの最終更新日時
+			int64 lastWriteTime;
+
+			/// @brief 元の画像の絶対パスのハッシュ値
+			uint64 pathHash;
+
+			/// @brief 元の画像の幅（ピクセル）
+			int32 width;
+
+			/// @brief 元の画像の高さ（ピクセル）
+			int32 height;
+
+			/// @brief すべての段のピクセル数の合計
+			uint64 numPixels;
+		};
+
+		static_assert(sizeof(ImagePyramidHeader) == 48);
+
+		/// @brief キャッシュファイルの識別子
+		constexpr char ImagePyramidMagic[8] = { 'S', 'C', 'M', 'I', 'P', 'M', 'P', '1' };
+
+		/// @brief ファイルの最終更新日時を返します。
+		/// @param path ファイルパス
+		/// @return ファイルの最終更新日時。取得できなかった場合は 0
+		[[nodiscard]]
+		int64 GetLastWriteTime(const std::string_view path)
+		{
+			std::error_code error;
+
+			const auto time = std::filesystem::last_write_time(path, error);
+
+			return (error ? 0 : static_cast<int64>(time.time_since_epoch().count()));
+		}
+
+		/// @brief ファイルのサイズを返します。
+		/// @param path ファイルパス
+		/// @return ファイルのサイズ（バイト）。取得できなかった場合は 0
+		[[nodiscard]]
+		uint64 GetFileSize(const std::string_view path)
+		{
+			std::error_code error;
+
+			const auto size = std::filesystem::file_size(path, error);
+
+			return (error ? 0 : static_cast<uint64>(size));
+		}
+
+		/// @brief ファイルの絶対パスのハッシュ値を返します。
+		/// @param path ファイルパス
+		/// @return 絶対パスのハッシュ値
+		[[nodiscard]]
+		uint64 GetPathHash(const std::string_view path)
+		{
+			const std::string fullPath = FileSystem::FullPath(path);
+
+			return Hash64(fullPath.data(), fullPath.size());
+		}
+	}
+
+	ImagePyramid::ImagePyramid(const ConstImageView& image)
+	{
+		build(image);
+	}
+
+	bool ImagePyramid::isEmpty() const noexcept
+	{
+		return m_sizes.empty();
+	}
+
+	ImagePyramid::operator bool() const noexcept
+	{
+		return (not isEmpty());
+	}
+
+	void ImagePyramid::build(const ConstImageView& image)
+	{
+		clear();
+
+		if (image.isEmpty())
+		{
+			return;
+		}
+
+		m_pixels = PixelBuffer(layout(image.size()));
+
+		const size_t numLevels = m_sizes.size();
+
+		// 1x1 の画像は、これ以上縮小できない
+		if (numLevels == 0)
+		{
+			clear();
+			return;
+		}
+
+		// 段の間の詰め物は書き込まれないので、キャッシュファイルの内容が決まるように 0 で埋める
+		for (size_t i = 0; i < numLevels; ++i)
+		{
+			const size_t levelEnd = (m_offsets[i] + static_cast<size_t>(m_sizes[i].x) * m_sizes[i].y);
+			const size_t nextOffset = (((i + 1) < numLevels) ? m_offsets[i + 1] : m_pixels.size());
+
+			std::fill((m_pixels.data() + levelEnd), (m_pixels.data() + nextOffset), Color{ 0, 0, 0, 0 });
+		}
+
+		const size_t numStripLevels = std::min(StripLevels, numLevels);
+
+		// 帯の中の最も下の段の 1 行が、段 0 の (1 << (numStripLevels - 1)) 行に対応する
+		const int32 stripHeight = (1 << (numStripLevels - 1));
+		const size_t numStrips = static_cast<size_t>((m_sizes[0].y + (stripHeight - 1)) / stripHeight);
+
+		ParallelFor(0, numStrips, [&](const size_t beginStrip, const size_t endStrip)
+			{
+				for (size_t strip = beginStrip; strip < endStrip; ++strip)
+				{
+					ConstImageView src = image;
+
+					for (size_t i = 0; i < numStripLevels; ++i)
+					{
+						// 段 i の y 行目は、1 つ上の段の (y * 2) 行目と (y * 2 + 1) 行目から求まるので、帯の外のデータは必要ない
+						const int32 rowsPerStrip = (stripHeight >> i);
+						const int32 beginY = (static_cast<int32>(strip) * rowsPerStrip);
+						const int32 endY = std::min((beginY + rowsPerStrip), m_sizes[i].y);
+
+						if (endY <= beginY)
+						{
+							break;
+						}
+
+						const ImageView dst = levelView(i);
+
+						Downscale2x(src.subView(Rect{ 0, (beginY * 2), src.width(), ((endY - beginY) * 2) }),
+							dst.subView(Rect{ 0, beginY, dst.width(), (endY - beginY) }));
+
+						src = dst;
+					}
+				}
+			});
+
+		// 帯の高さより小さくなった段は、段ごとに縮小する
+		for (size_t i = numStripLevels; i < numLevels; ++i)
+		{
+			Downscale2x(level(i - 1), levelView(i));
+		}
+	}
+
+	bool ImagePyramid::load(const std::string_view sourcePath, std::string_view cachePath)
+	{
+		clear();
+
+		const std::string defaultCachePath = (cachePath.empty() ? DefaultCachePath(sourcePath) : std::string{});
+
+		if (cachePath.empty())
+		{
+			cachePath = defaultCachePath;
+		}
+
+		BinaryFileReader reader{ cachePath };
+
+		ImagePyramidHeader header;
+
+		if (reader.read(header) != sizeof(ImagePyramidHeader))
+		{
+			return false;
+		}
+
+		// 元の画像が同じファイルで、更新されていないかを確認する
+		if ((std::memcmp(header.magic, ImagePyramidMagic, sizeof(ImagePyramidMagic)) != 0)
+			|| (header.fileSize != GetFileSize(sourcePath))
+			|| (header.lastWriteTime != GetLastWriteTime(sourcePath))
+			|| (header.pathHash != GetPathHash(sourcePath))
+			|| (header.width <= 0) || (header.height <= 0))
+		{
+			return false;
+		}
+
+		const size_t numPixels = layout(Size{ header.width, header.height });
+		const int64 sizeBytes = static_cast<int64>(numPixels * sizeof(Color));
+
+		if ((header.numPixels != numPixels)
+			|| (static_cast<int64>(reader.size() - sizeof(ImagePyramidHeader)) != sizeBytes))
+		{
+			clear();
+			return false;
+		}
+
+		m_pixels = PixelBuffer(numPixels);
+
+		if (reader.read(m_pixels.data(), static_cast<size_t>(sizeBytes)) != sizeBytes)
+		{
+			clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ImagePyramid::loadOrBuild(const std::string_view sourcePath, const std::string_view cachePath)
+	{
+		if (load(sourcePath, cachePath))
+		{
+			return true;
+		}
+
+		// 読み込みの途中で元の画像が更新された場合に、古い内容が新しい日時で記録されないよう、読み込む前に取得する
+		const uint64 fileSize = GetFileSize(sourcePath);
+		const int64 lastWriteTime = GetLastWriteTime(sourcePath);
+
+		const Image image = LoadImageFile(sourcePath);
+
+		if (not image)
+		{
+			return false;
+		}
+
+		build(image);
+
+		// キャッシュファイルの保存に失敗しても、ミップマップは作成できている
+		save(sourcePath, cachePath, fileSize, lastWriteTime);
+
+		return (not isEmpty());
+	}
+
+	bool ImagePyramid::save(const std::string_view sourcePath, const std::string_view cachePath) const
+	{
+		return save(sourcePath, cachePath, GetFileSize(sourcePath), GetLastWriteTime(sourcePath));
+	}
+
+	bool ImagePyramid::save(const std::string_view sourcePath, std::string_view cachePath, const uint64 fileSize, const int64 lastWriteTime) const
+	{
+		if (isEmpty())
+		{
+			return false;
+		}
+
+		const std::string defaultCachePath = (cachePath.empty() ? DefaultCachePath(sourcePath) : std::string{});
+
+		if (cachePath.empty())
+		{
+			cachePath = defaultCachePath;
+		}
+
+		BinaryFileWriter writer{ cachePath };
+
+		if (not writer.isOpen())
+		{
+			return false;
+		}
+
+		ImagePyramidHeader header
+		{
+			.magic			= {},
+			.fileSize		= fileSize,
+			.lastWriteTime	= lastWriteTime,
+			.pathHash		= GetPathHash(sourcePath),
+			.width			= m_sourceSize.x,
+			.height			= m_sourceSize.y,
+			.numPixels		= m_pixels.size(),
+		};
+
+		std::memcpy(header.magic, ImagePyramidMagic, sizeof(ImagePyramidMagic));
+
+		const int64 pixelBytes = static_cast<int64>(m_pixels.size() * sizeof(Color));
+
+		// ディスクの空きが無い場合などに、途中までしか書き込めなかったキャッシュファイルを残さない
+		if ((writer.write(header) != sizeof(ImagePyramidHeader))
+			|| (writer.write(m_pixels.data(), static_cast<size_t>(pixelBytes)) != pixelBytes)
+			|| (not writer.flush()))
+		{
+			writer.close();
+
+			std::error_code error;
+			std::filesystem::remove(cachePath, error);
+
+			return false;
+		}
+
+		return true;
+	}
+
+	void ImagePyramid::clear()
+	{
+		m_pixels.clear();
+
+		m_sizes.clear();
+
+		m_offsets.clear();
+
+		m_sourceSize = Size{ 0, 0 };
+	}
+
+	Size ImagePyramid::sourceSize() const noexcept
+	{
+		return m_sourceSize;
+	}
+
+	size_t ImagePyramid::numLevels() const noexcept
+	{
+		return m_sizes.size();
+	}
+
+	ConstImageView ImagePyramid::level(const size_t index) const noexcept
+	{
+		if (m_sizes.size() <= index)
+		{
+			return{};
+		}
+
+		return{ (m_pixels.data() + m_offsets[index]), m_sizes[index], static_cast<size_t>(m_sizes[index].x) };
+	}
+
+	ConstImageView ImagePyramid::fit(const Size& maxSize) const noexcept
+	{
+		if (isEmpty())
+		{
+			return{};
+		}
+
+		for (size_t i = 0; i < m_sizes.size(); ++i)
+		{
+			if ((m_sizes[i].x <= maxSize.x) && (m_sizes[i].y <= maxSize.y))
+			{
+				return level(i);
+			}
+		}
+
+		return level(m_sizes.size() - 1);
+	}
+
+	std::string ImagePyramid::DefaultCachePath(const std::string_view sourcePath)
+	{
+		return (std::string{ sourcePath } + ".mipmap");
+	}
+
+	size_t ImagePyramid::layout(const Size& sourceSize)
+	{
+		m_sizes.clear();
+		m_offsets.clear();
+		m_sourceSize = sourceSize;
+
+		Size size = sourceSize;
+		size_t numPixels = 0;
+
+		while ((1 < size.x) || (1 < size.y))
+		{
+			size = Size{ std::max((size.x / 2), 1), std::max((size.y / 2), 1) };
+
+			m_sizes.push_back(size);
+			m_offsets.push_back(numPixels);
+
+			// SIMD 命令で読み書きしやすいように、各段の先頭をアラインメントする
+			numPixels += ((static_cast<size_t>(size.x) * size.y + (LevelAlignment - 1)) / LevelAlignment * LevelAlignment);
+		}
+
+		return numPixels;
+	}
+
+	ImageView ImagePyramid::levelView(const size_t index)
+	{
+		return{ (m_pixels.data() + m_offsets[index]), m_sizes[index], static_cast<size_t>(m_sizes[index].x) };
+	}
+}
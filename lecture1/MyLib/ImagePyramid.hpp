@@ -0,0 +1,126 @@
+﻿#pragma once
+#include <string_view> // std::string_view
+#include <string> // std::string
+#include <vector> // std::vector
+#include "Common.hpp"
+#include "Point.hpp"
+#include "ImageView.hpp"
+#include "PixelBuffer.hpp"
+
+namespace seccamp
+{
+	/// @brief 画像を 1/2, 1/4, ... と 1x1 になるまで縮小した画像（ミップマップ）の一覧
+	/// @remark すべての段の画像は、1 つの連続したメモリに格納されます。各段の画像は Downscale2x() と同じ結果になります。
+	/// @remark 元の画像は含みません。level(0) が幅と高さを半分にした画像です。
+	class ImagePyramid
+	{
+	public:
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		ImagePyramid() = default;
+
+		/// @brief 画像からミップマップを作成します。
+		/// @param image 元の画像
+		[[nodiscard]]
+		explicit ImagePyramid(const ConstImageView& image);
+
+		/// @brief ミップマップが空であるかを返します。
+		/// @return 空の場合 true, それ以外の場合は false
+		/// @remark 元の画像が空か 1x1 の場合は空になります。
+		[[nodiscard]]
+		bool isEmpty() const noexcept;
+
+		/// @brief ミップマップが空でないかを返します。
+		/// @return 空でない場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief 画像からミップマップを作成します。
+		/// @param image 元の画像
+		/// @remark 元の画像を行の帯に分けて複数のスレッドで処理し、各帯ではキャッシュに残っているうちに下の段まで続けて縮小します。
+		void build(const ConstImageView& image);
+
+		/// @brief 保存されているキャッシュファイルからミップマップを読み込みます。
+		/// @param sourcePath 元の画像のパス
+		/// @param cachePath キャッシュファイルのパス。空の場合は DefaultCachePath(sourcePath)
+		/// @return 成功した場合 true, キャッシュファイルが無いか、元の画像のパスが異なるか、元の画像が更新されている場合は false
+		bool load(std::string_view sourcePath, std::string_view cachePath = {});
+
+		/// @brief 保存されているキャッシュファイルがあれば読み込み、無ければ元の画像からミップマップを作成してキャッシュファイルを保存します。
+		/// @param sourcePath 元の画像のパス
+		/// @param cachePath キャッシュファイルのパス。空の場合は DefaultCachePath(sourcePath)
+		/// @return 成功した場合 true, それ以外の場合は false
+		/// @remark 元の画像は、ファイルの形式を判定して読み込みます。
+		bool loadOrBuild(std::string_view sourcePath, std::string_view cachePath = {});
+
+		/// @brief ミップマップをキャッシュファイルに保存します。
+		/// @param sourcePath 元の画像のパス。キャッシュファイルには、このパスとファイルの最終更新日時が記録されます
+		/// @param cachePath キャッシュファイルのパス。空の場合は DefaultCachePath(sourcePath)
+		/// @return 成功した場合 true, それ以外の場合は false
+		/// @remark ディスクの空きが無いなどで途中までしか書き込めなかった場合は、キャッシュファイルを削除して false を返します。
+		bool save(std::string_view sourcePath, std::string_view cachePath = {}) const;
+
+		/// @brief ミップマップを破棄します。
+		void clear();
+
+		/// @brief 元の画像の幅と高さ（ピクセル）を返します。
+		/// @return 元の画像の幅と高さ（ピクセル）
+		[[nodiscard]]
+		Size sourceSize() const noexcept;
+
+		/// @brief 段の数を返します。
+		/// @return 段の数
+		[[nodiscard]]
+		size_t numLevels() const noexcept;
+
+		/// @brief 指定した段の画像を返します。
+		/// @param index 段の番号。0 が幅と高さを半分にした画像で、numLevels() - 1 が 1x1 の画像
+		/// @return 段の画像のビュー。範囲外の場合は空のビュー
+		/// @remark ビューはミップマップが破棄されるか、作り直されるまで有効です。
+		[[nodiscard]]
+		ConstImageView level(size_t index) const noexcept;
+
+		/// @brief 指定した大きさに収まる、最も大きい段の画像を返します。
+		/// @param maxSize 幅と高さの上限（ピクセル）
+		/// @return 段の画像のビュー。どの段も収まらない場合は最も小さい段、ミップマップが空の場合は空のビュー
+		/// @remark サムネイルの表示に使います。
+		[[nodiscard]]
+		ConstImageView fit(const Size& maxSize) const noexcept;
+
+		/// @brief 元の画像に対応するデフォルトのキャッシュファイルのパスを返します。
+		/// @param sourcePath 元の画像のパス
+		/// @return キャッシュファイルのパス（元の画像のパス + ".mipmap"）
+		[[nodiscard]]
+		static std::string DefaultCachePath(std::string_view sourcePath);
+
+	private:
+
+		// すべての段のピクセル
+		PixelBuffer m_pixels;
+
+		// 各段の幅と高さ
+		std::vector<Size> m_sizes;
+
+		// 各段の先頭のピクセルの位置
+		std::vector<size_t> m_offsets;
+
+		Size m_sourceSize{ 0, 0 };
+
+		/// @brief 元の画像の大きさから、各段の大きさと位置を求めます。
+		/// @return すべての段のピクセル数の合計
+		size_t layout(const Size& sourceSize);
+
+		/// @brief ミップマップを、元の画像のファイルのサイズと最終更新日時を指定してキャッシュファイルに保存します。
+		/// @param sourcePath 元の画像のパス
+		/// @param cachePath キャッシュファイルのパス。空の場合は DefaultCachePath(sourcePath)
+		/// @param fileSize 元の画像のファイルのサイズ（バイト）
+		/// @param lastWriteTime 元の画像のファイルの最終更新日時
+		/// @return 成功した場合 true, それ以外の場合は false
+		bool save(std::string_view sourcePath, std::string_view cachePath, uint64 fileSize, int64 lastWriteTime) const;
+
+		/// @brief 指定した段の画像の、書き込み可能なビューを返します。
+		[[nodiscard]]
+		ImageView levelView(size_t index);
+	};
+}
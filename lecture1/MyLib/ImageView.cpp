@@ -0,0 +1,191 @@
+﻿#include <algorithm> // std::fill, std::copy_n, std::min, std::max
+#include <vector> // std::vector
+#include "ImageView.hpp"
+#include "ColorConversion.hpp"
+#include "Hash.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 1 回の呼び出しで処理する最小のピクセル数。これより小さい処理はスレッドの同期のコストが上回る
+		constexpr size_t MinPixelsPerTask = (1 << 15);
+
+		/// @brief 1 スレッドあたりの呼び出し回数の目安。処理時間のばらつきを吸収するため、スレッド数より多く分割する
+		constexpr size_t TasksPerThread = 4;
+
+		/// @brief ハッシュ値を計算するブロックのおおよそのピクセル数。ブロックの分け方は画像の幅だけで決まる
+		constexpr size_t HashBlockPixels = (1 << 16);
+	}
+
+	size_t GetImageRowsPerTask(const Size& size, const size_t numThreads) noexcept
+	{
+		if ((size.x <= 0) || (size.y <= 0))
+		{
+			return 1;
+		}
+
+		const size_t width = size.x;
+		const size_t height = size.y;
+
+		// 小さすぎる分割は避けつつ、各スレッドに複数回の呼び出しが割り当たるようにする
+		const size_t minRows = ((MinPixelsPerTask + width - 1) / width);
+		const size_t balancedRows = ((height + (numThreads * TasksPerThread) - 1) / (numThreads * TasksPerThread));
+
+		return std::max(minRows, balancedRows);
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	void BasicImageView<PixelType>::fill(const Color& color) const noexcept
+		requires (not std::is_const_v<PixelType>)
+	{
+		parallelForSpans([&](int32, Color* pDst, const size_t numPixels)
+			{
+				std::fill(pDst, (pDst + numPixels), color);
+			});
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	void BasicImageView<PixelType>::grayscale() const noexcept
+		requires (not std::is_const_v<PixelType>)
+	{
+		parallelForSpans([&](int32, Color* pDst, const size_t numPixels)
+			{
+				ConvertToGrayscale(pDst, pDst, numPixels);
+			});
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	void BasicImageView<PixelType>::invert() const noexcept
+		requires (not std::is_const_v<PixelType>)
+	{
+		parallelForSpans([&](int32, Color* pDst, const size_t numPixels)
+			{
+				InvertColor(pDst, pDst, numPixels);
+			});
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	void BasicImageView<PixelType>::adjustBrightnessContrast(const int32 brightness, const double contrast) const noexcept
+		requires (not std::is_const_v<PixelType>)
+	{
+		parallelForSpans([&](int32, Color* pDst, const size_t numPixels)
+			{
+				AdjustBrightnessContrast(pDst, pDst, numPixels, brightness, contrast);
+			});
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	void BasicImageView<PixelType>::copyFrom(const BasicImageView<const Color>& src) const noexcept
+		requires (not std::is_const_v<PixelType>)
+	{
+		const BasicImageView dst = subView(Rect{ src.width(), src.height() });
+
+		// コピー元とコピー先の両方が連続している場合は、複数の行をまとめて 1 回でコピーする
+		const bool contiguous = (dst.isContiguous() && (dst.stride() == src.stride()));
+
+		dst.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				if (contiguous)
+				{
+					std::copy_n(src[beginY], (static_cast<size_t>(endY - beginY) * dst.width()), dst[beginY]);
+					return;
+				}
+
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					std::copy_n(src[y], dst.width(), dst[y]);
+				}
+			});
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	std::vector<uint8> BasicImageView<PixelType>::grayscaleUint8() const
+	{
+		std::vector<uint8> values(numPixels());
+
+		parallelForSpans([&](const int32 y, const Color* pSrc, const size_t numPixels)
+			{
+				ConvertToGrayscaleUint8(pSrc, (values.data() + static_cast<size_t>(y) * m_size.x), numPixels);
+			});
+
+		return values;
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	std::vector<uint8> BasicImageView<PixelType>::channel(const size_t index) const
+	{
+		if (3 < index)
+		{
+			return{};
+		}
+
+		std::vector<uint8> values(numPixels());
+
+		parallelForSpans([&](const int32 y, const Color* pSrc, const size_t numPixels)
+			{
+				ExtractChannel(pSrc, (values.data() + static_cast<size_t>(y) * m_size.x), numPixels, index);
+			});
+
+		return values;
+	}
+
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	uint64 BasicImageView<PixelType>::hash() const
+	{
+		std::vector<uint64> blockHashes;
+
+		if (not isEmpty())
+		{
+			const size_t width = m_size.x;
+			const size_t rowsPerBlock = std::max<size_t>((HashBlockPixels / width), 1);
+			const size_t numBlocks = ((m_size.y + rowsPerBlock - 1) / rowsPerBlock);
+			const bool contiguous = isContiguous();
+
+			blockHashes.resize(numBlocks);
+
+			ParallelFor(0, numBlocks, [&](const size_t beginBlock, const size_t endBlock)
+				{
+					for (size_t block = beginBlock; block < endBlock; ++block)
+					{
+						const size_t beginY = (block * rowsPerBlock);
+						const size_t endY = std::min((beginY + rowsPerBlock), static_cast<size_t>(m_size.y));
+
+						// 行の間に隙間がある場合は、行ごとにデータを追加する
+						Hasher64 hasher;
+
+						if (contiguous)
+						{
+							hasher.update((*this)[beginY], ((endY - beginY) * width * sizeof(Color)));
+						}
+						else
+						{
+							for (size_t y = beginY; y < endY; ++y)
+							{
+								hasher.update((*this)[y], (width * sizeof(Color)));
+							}
+						}
+
+						blockHashes[block] = hasher.value();
+					}
+				});
+		}
+
+		// 大きさと各ブロックのハッシュ値を結合する
+		Hasher64 hasher;
+		hasher.update(&m_size, sizeof(m_size));
+		hasher.update(blockHashes.data(), (blockHashes.size() * sizeof(uint64)));
+		return hasher.value();
+	}
+
+	template class BasicImageView<Color>;
+	template class BasicImageView<const Color>;
+}
@@ -0,0 +1,270 @@
+﻿#pragma once
+#include <concepts> // std::same_as, std::invocable
+#include <type_traits> // std::is_const_v, std::remove_const_t
+#include <vector> // std::vector
+#include "Common.hpp"
+#include "Color.hpp"
+#include "Point.hpp"
+#include "Rect.hpp"
+#include "ThreadPool.hpp"
+
+namespace seccamp
+{
+	/// @brief 画像の行を並列に処理するときに、1 回の呼び出しに割り当てる行数を決めます。
+	/// @param size 画像の幅と高さ（ピクセル）
+	/// @param numThreads スレッド数
+	/// @return 1 回の呼び出しに割り当てる行数
+	[[nodiscard]]
+	size_t GetImageRowsPerTask(const Size& size, size_t numThreads) noexcept;
+
+	/// @brief 画像のピクセルを所有せずに参照するビュー
+	/// @tparam PixelType ピクセルの型（Color または const Color）
+	/// @remark 行の先頭どうしの間隔（ストライド）は幅と異なっていてもよいため、画像の一部の領域をコピーせずに表せます。
+	/// @remark ビューは参照先の画像より長く使用してはいけません。参照先の画像をリサイズした場合も無効になります。
+	template <class PixelType>
+		requires std::same_as<std::remove_const_t<PixelType>, Color>
+	class BasicImageView
+	{
+	public:
+
+		/// @brief ピクセルの型
+		using value_type = PixelType;
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		BasicImageView() = default;
+
+		/// @brief ビューを作成します。
+		/// @param data 先頭の行の先頭ピクセルへのポインタ
+		/// @param width 幅（ピクセル）
+		/// @param height 高さ（ピクセル）
+		/// @param stride 行の先頭どうしの間隔（ピクセル）。width 以上である必要があります
+		[[nodiscard]]
+		BasicImageView(PixelType* data, int32 width, int32 height, size_t stride) noexcept
+			: m_data{ data }
+			, m_size{ width, height }
+			, m_stride{ stride } {}
+
+		/// @brief ビューを作成します。
+		/// @param data 先頭の行の先頭ピクセルへのポインタ
+		/// @param size 幅と高さ（ピクセル）
+		/// @param stride 行の先頭どうしの間隔（ピクセル）。size.x 以上である必要があります
+		[[nodiscard]]
+		BasicImageView(PixelType* data, const Size& size, size_t stride) noexcept
+			: BasicImageView{ data, size.x, size.y, stride } {}
+
+		/// @brief 書き込み可能なビューから読み取り専用のビューを作成します。
+		/// @param other 書き込み可能なビュー
+		template <class OtherPixelType>
+			requires (std::is_const_v<PixelType> && std::same_as<OtherPixelType, Color>)
+		[[nodiscard]]
+		BasicImageView(const BasicImageView<OtherPixelType>& other) noexcept
+			: BasicImageView{ other.data(), other.size(), other.stride() } {}
+
+		/// @brief 幅（ピクセル）を返します。
+		/// @return 幅（ピクセル）
+		[[nodiscard]]
+		int32 width() const noexcept
+		{
+			return m_size.x;
+		}
+
+		/// @brief 高さ（ピクセル）を返します。
+		/// @return 高さ（ピクセル）
+		[[nodiscard]]
+		int32 height() const noexcept
+		{
+			return m_size.y;
+		}
+
+		/// @brief 幅と高さ（ピクセル）を返します。
+		/// @return 幅と高さ（ピクセル）
+		[[nodiscard]]
+		Size size() const noexcept
+		{
+			return m_size;
+		}
+
+		/// @brief 行の先頭どうしの間隔（ピクセル）を返します。
+		/// @return 行の先頭どうしの間隔（ピクセル）
+		[[nodiscard]]
+		size_t stride() const noexcept
+		{
+			return m_stride;
+		}
+
+		/// @brief 総ピクセル数を返します。
+		/// @return 総ピクセル数
+		[[nodiscard]]
+		size_t numPixels() const noexcept
+		{
+			return (static_cast<size_t>(m_size.x) * static_cast<size_t>(m_size.y));
+		}
+
+		/// @brief ビューが空であるかを返します。
+		/// @return ビューが空である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept
+		{
+			return ((m_size.x <= 0) || (m_size.y <= 0));
+		}
+
+		/// @brief ビューが空でないかを返します。
+		/// @return ビューが空でない場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept
+		{
+			return (not isEmpty());
+		}
+
+		/// @brief すべての行が隙間なく連続しているかを返します。
+		/// @return 連続している場合 true, それ以外の場合は false
+		/// @remark 連続している場合は、複数の行をまとめて 1 回で処理できます。
+		[[nodiscard]]
+		bool isContiguous() const noexcept
+		{
+			return ((m_stride == static_cast<size_t>(m_size.x)) || (m_size.y <= 1));
+		}
+
+		/// @brief 指定した行の先頭ポインタを返します。
+		/// @param y 位置（行）
+		/// @remark view[y][x] で指定したピクセルにアクセスします。
+		/// @return 指定した行の先頭ポインタ
+		[[nodiscard]]
+		PixelType* operator [](size_t y) const noexcept
+		{
+			return (m_data + (y * m_stride));
+		}
+
+		/// @brief 先頭の行の先頭ポインタを返します。
+		/// @return 先頭の行の先頭ポインタ
+		[[nodiscard]]
+		PixelType* data() const noexcept
+		{
+			return m_data;
+		}
+
+		/// @brief 一部の領域を参照するビューを返します。ピクセルはコピーしません。
+		/// @param region 領域。ビューの範囲外の部分は無視されます
+		/// @return 領域を参照するビュー。領域がビューと重ならない場合は空のビュー
+		[[nodiscard]]
+		BasicImageView subView(const Rect& region) const noexcept
+		{
+			const Rect clipped = Rect{ m_size.x, m_size.y }.intersection(region);
+
+			if (clipped.isEmpty())
+			{
+				return{};
+			}
+
+			return{ ((*this)[clipped.y] + clipped.x), clipped.w, clipped.h, m_stride };
+		}
+
+		/// @brief ビューの行を複数の範囲に分け、共有のスレッドプールで並列に関数を実行します。
+		/// @param func 各範囲に対して呼ばれる関数。引数は範囲の先頭の行と終端の行（含まない）
+		/// @param grain 1 回の呼び出しで処理する行数。0 の場合はビューの大きさとスレッド数から自動で決めます
+		/// @remark すべての呼び出しが完了してから戻ります。小さなビューでは呼び出し元のスレッドだけで実行します。
+		template <class Fty>
+			requires std::invocable<Fty&, int32, int32>
+		void parallelForRows(Fty&& func, const int32 grain = 0) const
+		{
+			if (isEmpty())
+			{
+				return;
+			}
+
+			ThreadPool& pool = ThreadPool::Default();
+
+			const size_t rowsPerTask = ((0 < grain) ? grain : GetImageRowsPerTask(m_size, pool.numThreads()));
+
+			pool.parallelFor(0, m_size.y, [&](const size_t beginY, const size_t endY)
+				{
+					func(static_cast<int32>(beginY), static_cast<int32>(endY));
+				}, rowsPerTask);
+		}
+
+		/// @brief ビューの範囲を指定した色で塗りつぶします。
+		/// @param color 塗りつぶしの色
+		void fill(const Color& color) const noexcept
+			requires (not std::is_const_v<PixelType>);
+
+		/// @brief ビューの範囲をグレースケールに変換します。アルファ成分は変更しません。
+		/// @remark 結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+		void grayscale() const noexcept
+			requires (not std::is_const_v<PixelType>);
+
+		/// @brief ビューの範囲の色を反転します。アルファ成分は変更しません。
+		void invert() const noexcept
+			requires (not std::is_const_v<PixelType>);
+
+		/// @brief ビューの範囲の明るさとコントラストを調整します。アルファ成分は変更しません。
+		/// @param brightness 明るさの調整量 [-255, 255]
+		/// @param contrast コントラストの倍率 [0.0, 127.0]。1.0 で変化なし
+		void adjustBrightnessContrast(int32 brightness, double contrast) const noexcept
+			requires (not std::is_const_v<PixelType>);
+
+		/// @brief 別のビューのピクセルをこのビューにコピーします。
+		/// @param src コピー元のビュー。大きさがこのビューと異なる場合は、重なる左上の部分だけをコピーします
+		/// @remark コピー元とコピー先の範囲が重なっていてはいけません。
+		void copyFrom(const BasicImageView<const Color>& src) const noexcept
+			requires (not std::is_const_v<PixelType>);
+
+		/// @brief 各ピクセルのグレースケール値を返します。
+		/// @return 各ピクセルのグレースケール値（numPixels() 個、行の間に隙間なし）
+		/// @remark 結果は Color::grayscaleUint8() と ±1 の範囲で一致します。
+		[[nodiscard]]
+		std::vector<uint8> grayscaleUint8() const;
+
+		/// @brief 各ピクセルの 1 つの成分を取り出します。
+		/// @param index 取り出す成分（0: R, 1: G, 2: B, 3: A）
+		/// @return 各ピクセルの成分（numPixels() 個、行の間に隙間なし）。index が 3 より大きい場合は空の配列
+		[[nodiscard]]
+		std::vector<uint8> channel(size_t index) const;
+
+		/// @brief ピクセルの内容の 64 ビットのハッシュ値を返します（暗号学的ハッシュ関数ではありません）。
+		/// @return ハッシュ値。大きさとピクセルが等しいビューや画像は、行の間隔によらず同じ値になります
+		/// @remark 行をまとめたブロックごとに Hash64() を並列に計算し、それらを結合します。結果はスレッド数によりません。
+		[[nodiscard]]
+		uint64 hash() const;
+
+	private:
+
+		/// @brief 行を並列に処理し、連続するピクセルの範囲ごとに関数を呼びます。
+		/// @param func 各範囲に対して呼ばれる関数。引数は範囲の先頭の行、先頭ピクセルへのポインタ、ピクセル数
+		/// @remark ビューが連続している場合は、複数の行をまとめて 1 回で呼びます。
+		template <class Fty>
+		void parallelForSpans(Fty&& func) const
+		{
+			const bool contiguous = isContiguous();
+
+			parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					if (contiguous)
+					{
+						func(beginY, (*this)[beginY], (static_cast<size_t>(endY - beginY) * m_size.x));
+						return;
+					}
+
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						func(y, (*this)[y], static_cast<size_t>(m_size.x));
+					}
+				});
+		}
+
+		PixelType* m_data = nullptr;
+
+		Size m_size{ 0, 0 };
+
+		size_t m_stride = 0;
+	};
+
+	/// @brief 書き込み可能な画像のビュー
+	using ImageView = BasicImageView<Color>;
+
+	/// @brief 読み取り専用の画像のビュー
+	using ConstImageView = BasicImageView<const Color>;
+
+	extern template class BasicImageView<Color>;
+	extern template class BasicImageView<const Color>;
+}
@@ -0,0 +1,454 @@
+﻿#include <thread> // std::thread
+#include <filesystem> // std::filesystem::last_write_time
+#include <algorithm> // std::min, std::max, std::ranges::is_sorted
+#include <cstring> // std::memcmp, std::memcpy
+#include "LineIndex.hpp"
+#include "BinaryFileReader.hpp"
+#include "BinaryFileWriter.hpp"
+#include "TextSearch.hpp"
+#include "Timer.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 1 スレッドが担当する最小のサイズ（バイト）
+		constexpr int64 MinChunkSize = (1 << 20);
+
+		/// @brief インデックスファイルのヘッダ
+		struct LineIndexHeader
+		{
+			/// @brief ファイル識別子
+			char magic[8];
+
+			/// @brief 元のファイルのサイズ（バイト）
+			uint64 fileSize;
+
+			/// @brief 元のファイルの最終更新日時
+			int64 lastWriteTime;
+
+			/// @brief 記録されている位置の個数
+			uint64 numOffsets;
+		};
+
+		static_assert(sizeof(LineIndexHeader) == 32);
+
+		/// @brief インデックスファイルの識別子
+		constexpr char LineIndexMagic[8] = { 'S', 'C', 'L', 'N', 'I', 'D', 'X', '1' };
+
+		/// @brief ファイルの最終更新日時を返します。
+		/// @param path ファイルパス
+		/// @return ファイルの最終更新日時。取得できなかった場合は 0
+		[[nodiscard]]
+		int64 GetLastWriteTime(const std::string_view path)
+		{
+			std::error_code error;
+
+			const auto time = std::filesystem::last_write_time(path, error);
+
+			return (error ? 0 : static_cast<int64>(time.time_since_epoch().count()));
+		}
+
+		/// @brief 範囲 [begin, end) にあるすべての LF を探し、その次の位置を追加します。
+		/// @param data ファイルの先頭
+		/// @param begin 範囲の先頭位置（バイト）
+		/// @param end 範囲の終端位置（バイト）
+		/// @param offsets 見つかった行の先頭位置の追加先
+		void CollectLineStarts(const char* data, const int64 begin, const int64 end, std::vector<uint64>& offsets)
+		{
+			const char* const last = (data + end);
+
+			for (const char* p = FindLF((data + begin), last); p != last; p = FindLF((p + 1), last))
+			{
+				offsets.push_back(static_cast<uint64>((p - data) + 1));
+			}
+		}
+	}
+
+	class LineIndex::Impl
+	{
+	public:
+
+		Impl() = default;
+
+		~Impl()
+		{
+			close();
+		}
+
+		[[nodiscard]]
+		bool isOpen() const noexcept
+		{
+			return m_reader.isOpen();
+		}
+
+		bool build(const std::string_view path, size_t numThreads)
+		{
+			close();
+
+			// ファイル全体を参照するため、メモリマップされている必要がある
+			if ((not m_reader.open(path)) || (not m_reader.isMapped()))
+			{
+				close();
+				return false;
+			}
+
+			const Timer timer;
+
+			const char* data = reinterpret_cast<const char*>(m_reader.view().data());
+			const int64 fileSize = m_reader.size();
+
+			if (numThreads == 0)
+			{
+				numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+			}
+
+			// 小さなファイルではスレッドを作るコストのほうが大きいので、チャンクの数を制限する
+			const int64 numChunks = std::max<int64>(std::min<int64>(static_cast<int64>(numThreads), (fileSize / MinChunkSize)), 1);
+
+			// 各チャンクで見つかった行の先頭位置
+			std::vector<std::vector<uint64>> chunkOffsets(numChunks);
+
+			{
+				std::vector<std::thread> threads;
+
+				for (int64 i = 1; i < numChunks; ++i)
+				{
+					threads.emplace_back([&, i]()
+					{
+						CollectLineStarts(data, (fileSize * i / numChunks), (fileSize * (i + 1) / numChunks), chunkOffsets[i]);
+					});
+				}
+
+				// 最初のチャンクは呼び出し元のスレッドで処理する
+				CollectLineStarts(data, 0, (fileSize / numChunks), chunkOffsets[0]);
+
+				for (auto& thread : threads)
+				{
+					thread.join();
+				}
+			}
+
+			// 各チャンクの結果を連結する
+			{
+				size_t numOffsets = 2;
+
+				for (const auto& offsets : chunkOffsets)
+				{
+					numOffsets += offsets.size();
+				}
+
+				m_offsets.reserve(numOffsets);
+
+				if (fileSize != 0)
+				{
+					m_offsets.push_back(0);
+				}
+
+				for (const auto& offsets : chunkOffsets)
+				{
+					m_offsets.insert(m_offsets.end(), offsets.begin(), offsets.end());
+				}
+
+				// 最後の行が LF で終わらない場合は、ファイルの終端を番兵として追加する
+				if ((fileSize != 0) && (m_offsets.back() != static_cast<uint64>(fileSize)))
+				{
+					m_offsets.push_back(fileSize);
+				}
+			}
+
+			const double sec = timer.sF();
+
+			m_throughputGBps = ((0.0 < sec) ? (fileSize / sec / 1e9) : 0.0);
+
+			return true;
+		}
+
+		bool load(const std::string_view path, std::string_view indexPath)
+		{
+			close();
+
+			const std::string defaultIndexPath = (indexPath.empty() ? DefaultIndexPath(path) : std::string{});
+
+			if (indexPath.empty())
+			{
+				indexPath = defaultIndexPath;
+			}
+
+			if ((not m_reader.open(path)) || (not m_reader.isMapped()))
+			{
+				close();
+				return false;
+			}
+
+			BinaryFileReader indexReader{ indexPath };
+
+			LineIndexHeader header;
+
+			if (indexReader.read(header) != sizeof(LineIndexHeader))
+			{
+				close();
+				return false;
+			}
+
+			const uint64 offsetsBytes = static_cast<uint64>(indexReader.size() - sizeof(LineIndexHeader));
+
+			// 元のファイルが更新されていないかを確認する。
+			// 壊れたインデックスファイルで巨大な領域を確保しないよう、位置の個数は掛け算の前にファイルのサイズと比べる
+			if ((std::memcmp(header.magic, LineIndexMagic, sizeof(LineIndexMagic)) != 0)
+				|| (header.fileSize != static_cast<uint64>(m_reader.size()))
+				|| (header.lastWriteTime != GetLastWriteTime(path))
+				|| ((offsetsBytes / sizeof(uint64)) < header.numOffsets)
+				|| (offsetsBytes != (header.numOffsets * sizeof(uint64))))
+			{
+				close();
+				return false;
+			}
+
+			// 空のファイルには行が無いので、位置は記録されていない
+			if (header.fileSize == 0)
+			{
+				return (header.numOffsets == 0);
+			}
+
+			m_offsets.resize(header.numOffsets);
+
+			const int64 sizeBytes = static_cast<int64>(offsetsBytes);
+
+			if (indexReader.read(m_offsets.data(), sizeBytes) != sizeBytes)
+			{
+				close();
+				return false;
+			}
+
+			// 壊れたインデックスファイルで範囲外を読まないよう、行の位置が 0 からファイルの終端まで減少せずに並んでいるかを確認する
+			if (m_offsets.empty()
+				|| (m_offsets.front() != 0)
+				|| (m_offsets.back() != header.fileSize)
+				|| (not std::ranges::is_sorted(m_offsets)))
+			{
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		bool save(std::string_view indexPath) const
+		{
+			if (not isOpen())
+			{
+				return false;
+			}
+
+			const std::string defaultIndexPath = (indexPath.empty() ? DefaultIndexPath(m_reader.fullPath()) : std::string{});
+
+			if (indexPath.empty())
+			{
+				indexPath = defaultIndexPath;
+			}
+
+			BinaryFileWriter writer{ indexPath };
+
+			if (not writer.isOpen())
+			{
+				return false;
+			}
+
+			LineIndexHeader header
+			{
+				.magic			= {},
+				.fileSize		= static_cast<uint64>(m_reader.size()),
+				.lastWriteTime	= GetLastWriteTime(m_reader.fullPath()),
+				.numOffsets		= m_offsets.size(),
+			};
+
+			std::memcpy(header.magic, LineIndexMagic, sizeof(LineIndexMagic));
+
+			writer.write(header);
+
+			writer.write(m_offsets.data(), (m_offsets.size() * sizeof(uint64)));
+
+			return true;
+		}
+
+		void close()
+		{
+			m_reader.close();
+
+			m_offsets.clear();
+
+			m_offsets.shrink_to_fit();
+
+			m_throughputGBps = 0.0;
+		}
+
+		[[nodiscard]]
+		size_t numLines() const noexcept
+		{
+			return (m_offsets.empty() ? 0 : (m_offsets.size() - 1));
+		}
+
+		[[nodiscard]]
+		std::string_view line(const size_t lineIndex) const noexcept
+		{
+			if (numLines() <= lineIndex)
+			{
+				return{};
+			}
+
+			const char* data = reinterpret_cast<const char*>(m_reader.view().data());
+			const char* first = (data + m_offsets[lineIndex]);
+			const char* last = (data + m_offsets[lineIndex + 1]);
+
+			// 行末の LF と CR を取り除く
+			if ((first != last) && (*(last - 1) == '\n'))
+			{
+				--last;
+			}
+
+			if ((first != last) && (*(last - 1) == '\r'))
+			{
+				--last;
+			}
+
+			return{ first, static_cast<size_t>(last - first) };
+		}
+
+		[[nodiscard]]
+		int64 lineOffset(const size_t lineIndex) const noexcept
+		{
+			if (m_offsets.empty())
+			{
+				return 0;
+			}
+
+			return static_cast<int64>(m_offsets[std::min(lineIndex, (m_offsets.size() - 1))]);
+		}
+
+		[[nodiscard]]
+		double buildThroughputGBps() const noexcept
+		{
+			return m_throughputGBps;
+		}
+
+		[[nodiscard]]
+		const std::string& fullPath() const noexcept
+		{
+			return m_reader.fullPath();
+		}
+
+	private:
+
+		BinaryFileReader m_reader;
+
+		// 各行の先頭位置（バイト）。最後の要素はファイルのサイズ（番兵）
+		std::vector<uint64> m_offsets;
+
+		double m_throughputGBps = 0.0;
+	};
+
+	LineIndex::LineIndex()
+		: m_pImpl{ std::make_shared<Impl>() } {}
+
+	LineIndex::LineIndex(const std::string_view path, const size_t numThreads)
+		: LineIndex{} // 移譲コンストラクタ
+	{
+		m_pImpl->build(path, numThreads);
+	}
+
+	bool LineIndex::isOpen() const noexcept
+	{
+		return m_pImpl->isOpen();
+	}
+
+	LineIndex::operator bool() const noexcept
+	{
+		return m_pImpl->isOpen();
+	}
+
+	bool LineIndex::build(const std::string_view path, const size_t numThreads)
+	{
+		return m_pImpl->build(path, numThreads);
+	}
+
+	bool LineIndex::load(const std::string_view path, const std::string_view indexPath)
+	{
+		return m_pImpl->load(path, indexPath);
+	}
+
+	bool LineIndex::loadOrBuild(const std::string_view path, const size_t numThreads)
+	{
+		if (m_pImpl->load(path, {}))
+		{
+			return true;
+		}
+
+		if (not m_pImpl->build(path, numThreads))
+		{
+			return false;
+		}
+
+		// インデックスファイルの保存に失敗しても、行の位置は記録できている
+		m_pImpl->save({});
+
+		return true;
+	}
+
+	bool LineIndex::save(const std::string_view indexPath) const
+	{
+		return m_pImpl->save(indexPath);
+	}
+
+	void LineIndex::close()
+	{
+		m_pImpl->close();
+	}
+
+	size_t LineIndex::numLines() const noexcept
+	{
+		return m_pImpl->numLines();
+	}
+
+	std::string_view LineIndex::line(const size_t lineIndex) const noexcept
+	{
+		return m_pImpl->line(lineIndex);
+	}
+
+	int64 LineIndex::lineOffset(const size_t lineIndex) const noexcept
+	{
+		return m_pImpl->lineOffset(lineIndex);
+	}
+
+	std::vector<LineIndex::LineRange> LineIndex::split(size_t numParts) const
+	{
+		const size_t numLines = m_pImpl->numLines();
+
+		numParts = std::max<size_t>(std::min(numParts, numLines), 1);
+
+		std::vector<LineRange> ranges(numParts);
+
+		for (size_t i = 0; i < numParts; ++i)
+		{
+			ranges[i].beginLine = (numLines * i / numParts);
+			ranges[i].endLine = (numLines * (i + 1) / numParts);
+		}
+
+		return ranges;
+	}
+
+	double LineIndex::buildThroughputGBps() const noexcept
+	{
+		return m_pImpl->buildThroughputGBps();
+	}
+
+	const std::string& LineIndex::fullPath() const noexcept
+	{
+		return m_pImpl->fullPath();
+	}
+
+	std::string LineIndex::DefaultIndexPath(const std::string_view path)
+	{
+		return (std::string{ path } + ".lineindex");
+	}
+}
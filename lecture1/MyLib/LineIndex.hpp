@@ -0,0 +1,120 @@
+﻿#pragma once
+#include <memory> // std::shared_ptr
+#include <string_view> // std::string_view
+#include <string> // std::string
+#include <vector> // std::vector
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief テキストファイルの各行の位置を記録し、任意の行に O(1) でアクセスするためのクラス
+	/// @remark 行の区切りは TextFileReader と同じく LF です。
+	class LineIndex
+	{
+	public:
+
+		/// @brief 行の範囲 [beginLine, endLine)
+		struct LineRange
+		{
+			/// @brief 範囲の先頭の行番号
+			size_t beginLine = 0;
+
+			/// @brief 範囲の終端の行番号（この行は含まない）
+			size_t endLine = 0;
+		};
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		LineIndex();
+
+		/// @brief ファイルをオープンし、行の位置を記録します。
+		/// @param path ファイルパス
+		/// @param numThreads 使用するスレッド数。0 の場合はハードウェアのスレッド数
+		[[nodiscard]]
+		explicit LineIndex(std::string_view path, size_t numThreads = 0);
+
+		/// @brief 行の位置が記録されているかを返します。
+		/// @return 記録されている場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isOpen() const noexcept;
+
+		/// @brief 行の位置が記録されているかを返します。
+		/// @return 記録されている場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief ファイルをオープンし、複数のスレッドで改行を探して行の位置を記録します。
+		/// @param path ファイルパス
+		/// @param numThreads 使用するスレッド数。0 の場合はハードウェアのスレッド数
+		/// @return 成功した場合 true, それ以外の場合は false
+		/// @remark ファイルはメモリマップされている必要があります。
+		bool build(std::string_view path, size_t numThreads = 0);
+
+		/// @brief ファイルをオープンし、保存されているインデックスファイルから行の位置を読み込みます。
+		/// @param path ファイルパス
+		/// @param indexPath インデックスファイルのパス。空の場合は DefaultIndexPath(path)
+		/// @return 成功した場合 true, インデックスファイルが無いか、元のファイルが更新されている場合は false
+		bool load(std::string_view path, std::string_view indexPath = {});
+
+		/// @brief 保存されているインデックスファイルがあれば読み込み、無ければ行の位置を記録してインデックスファイルを保存します。
+		/// @param path ファイルパス
+		/// @param numThreads 使用するスレッド数。0 の場合はハードウェアのスレッド数
+		/// @return 成功した場合 true, それ以外の場合は false
+		bool loadOrBuild(std::string_view path, size_t numThreads = 0);
+
+		/// @brief 行の位置をインデックスファイルに保存します。
+		/// @param indexPath インデックスファイルのパス。空の場合は DefaultIndexPath(fullPath())
+		/// @return 成功した場合 true, それ以外の場合は false
+		bool save(std::string_view indexPath = {}) const;
+
+		/// @brief ファイルをクローズし、記録した行の位置を破棄します。
+		void close();
+
+		/// @brief 行数を返します。
+		/// @return 行数
+		[[nodiscard]]
+		size_t numLines() const noexcept;
+
+		/// @brief 指定した行の文字列を返します。
+		/// @param lineIndex 行番号（0 始まり）
+		/// @return 行の文字列へのビュー。行末の LF と CR は含みません。範囲外の場合は空のビュー
+		/// @remark ビューはファイルがクローズされるまで有効です。行の途中の CR は取り除かれません。
+		[[nodiscard]]
+		std::string_view line(size_t lineIndex) const noexcept;
+
+		/// @brief 指定した行の先頭位置（バイト）を返します。
+		/// @param lineIndex 行番号（0 始まり）
+		/// @return 行の先頭位置（バイト）。lineIndex が numLines() の場合はファイルのサイズ
+		[[nodiscard]]
+		int64 lineOffset(size_t lineIndex) const noexcept;
+
+		/// @brief 全ての行を、行数がほぼ等しい範囲に分割します。
+		/// @param numParts 分割数
+		/// @return 分割された行の範囲の一覧
+		/// @remark 各範囲をワーカースレッドに割り当てる用途を想定しています。
+		[[nodiscard]]
+		std::vector<LineRange> split(size_t numParts) const;
+
+		/// @brief 直前の build() のスループット（GB/s）を返します。
+		/// @return 直前の build() のスループット（GB/s）。build() していない場合は 0
+		[[nodiscard]]
+		double buildThroughputGBps() const noexcept;
+
+		/// @brief ファイルの絶対パスを返します。
+		/// @return ファイルの絶対パス。ファイルがオープンされていない場合は空文字列
+		[[nodiscard]]
+		const std::string& fullPath() const noexcept;
+
+		/// @brief ファイルに対応するデフォルトのインデックスファイルのパスを返します。
+		/// @param path ファイルパス
+		/// @return インデックスファイルのパス（ファイルパス + ".lineindex"）
+		[[nodiscard]]
+		static std::string DefaultIndexPath(std::string_view path);
+
+	private:
+
+		class Impl;
+
+		std::shared_ptr<Impl> m_pImpl;
+	};
+}
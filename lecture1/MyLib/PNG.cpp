@@ -1,6 +1,1626 @@
-﻿#include "PNG.hpp"
+﻿#include <algorithm> // std::min, std::max, std::ranges::equal
+#include <array> // std::array
+#include <bit> // std::endian, std::byteswap
+#include <cstdlib> // std::abs
+#include <cstring> // std::memcpy
+#include <limits> // std::numeric_limits
+#include <utility> // std::swap
+#include <vector> // std::vector
+#include "PNG.hpp"
+#include "Image.hpp"
+#include "BinaryFileReader.hpp"
+#include "BinaryFileWriter.hpp"
+#include "Deflate.hpp"
+#include "PixelConversion.hpp"
+#include "ThreadPool.hpp"
+#include "CPU.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <emmintrin.h> // _mm_avg_epu8, _mm_packus_epi16, _mm_min_epi16, _mm_max_epi16
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vhadd_u8, vabd_u8, vabdq_u16, vbsl_u8
+#endif
 
 namespace seccamp
 {
+	namespace
+	{
+		/// @brief PNG ファイルの先頭の 8 バイト
+		constexpr std::array<uint8, 8> Signature = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+		/// @brief 並列に変換するとき、1 回の呼び出しで変換するデータのおおよそのサイズ（バイト）
+		constexpr size_t TaskSizeBytes = (1 << 18);
+
+		/// @brief Deflate で圧縮されたデータ 1 バイトから展開されるデータの最大のサイズ（バイト）
+		/// @remark 最長の一致（258 バイト）を 2 ビットで表す場合の比率です。ヘッダが壊れたファイルで、巨大なメモリを確保しないために使います。
+		constexpr size_t MaxCompressionRatio = 1032;
+
+		/// @brief 色の種類
+		enum class PNGColorType : uint8
+		{
+			Gray		= 0,
+
+			RGB			= 2,
+
+			Palette		= 3,
+
+			GrayAlpha	= 4,
+
+			RGBA		= 6,
+		};
+
+		/// @brief 行のフィルタの種類
+		enum class PNGFilter : uint8
+		{
+			None	= 0,
+
+			Sub		= 1,
+
+			Up		= 2,
+
+			Average	= 3,
+
+			Paeth	= 4,
+		};
+
+		/// @brief インターレース（Adam7）の各パスの、最初のピクセルの位置と間隔
+		struct Adam7Pass
+		{
+			int32 x;
+
+			int32 y;
+
+			int32 dx;
+
+			int32 dy;
+		};
+
+		constexpr std::array<Adam7Pass, 7> Adam7Passes =
+		{{
+			{ 0, 0, 8, 8 },
+			{ 4, 0, 8, 8 },
+			{ 0, 4, 4, 8 },
+			{ 2, 0, 4, 4 },
+			{ 0, 2, 2, 4 },
+			{ 1, 0, 2, 2 },
+			{ 0, 1, 1, 2 },
+		}};
+
+		/// @brief PNG ファイルのヘッダと、ピクセルの変換に必要な情報
+		struct PNGInfo
+		{
+			int32 width = 0;
+
+			int32 height = 0;
+
+			/// @brief 1 サンプルあたりのビット数
+			uint32 bitDepth = 0;
+
+			PNGColorType colorType = PNGColorType::Gray;
+
+			bool interlaced = false;
+
+			/// @brief 1 ピクセルあたりのビット数
+			size_t bitsPerPixel = 0;
+
+			/// @brief パレット（tRNS チャンクのアルファ成分を含む）
+			std::array<Color, 256> palette;
+
+			/// @brief tRNS チャンクで透明色が指定されているか
+			bool hasColorKey = false;
+
+			/// @brief 透明色（グレースケールの場合は r のみを使う）
+			uint16 keyR = 0, keyG = 0, keyB = 0;
+
+			/// @brief フィルタで参照する、左隣のピクセルまでの距離（バイト）
+			[[nodiscard]]
+			size_t filterBytesPerPixel() const noexcept
+			{
+				return std::max<size_t>(1, (bitsPerPixel / 8));
+			}
+
+			/// @brief 指定した幅の行のデータのサイズ（フィルタの種類の 1 バイトを含まない）
+			[[nodiscard]]
+			size_t strideBytes(const int32 rowWidth) const noexcept
+			{
+				return (((static_cast<size_t>(rowWidth) * bitsPerPixel) + 7) / 8);
+			}
+		};
+
+		[[nodiscard]]
+		constexpr uint32 LoadBE32(const uint8* p) noexcept
+		{
+			return ((uint32{ p[0] } << 24) | (uint32{ p[1] } << 16) | (uint32{ p[2] } << 8) | uint32{ p[3] });
+		}
+
+		[[nodiscard]]
+		constexpr uint16 LoadBE16(const uint8* p) noexcept
+		{
+			return static_cast<uint16>((p[0] << 8) | p[1]);
+		}
+
+		[[nodiscard]]
+		constexpr uint32 MakeChunkType(const char (&name)[5]) noexcept
+		{
+			return ((uint32(uint8(name[0])) << 24) | (uint32(uint8(name[1])) << 16) | (uint32(uint8(name[2])) << 8) | uint32(uint8(name[3])));
+		}
+
+		/// @brief 16 ビットのサンプルを、四捨五入して 8 ビットにします。
+		[[nodiscard]]
+		constexpr uint8 To8Bit(const uint32 value) noexcept
+		{
+			return static_cast<uint8>((value + 128) / 257);
+		}
+
+		/// @brief パスの幅または高さ（ピクセル）を返します。
+		[[nodiscard]]
+		constexpr int32 GetPassLength(const int32 length, const int32 start, const int32 step) noexcept
+		{
+			return ((start < length) ? (((length - start) + (step - 1)) / step) : 0);
+		}
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	フィルタの復元
+		//
+		////////////////////////////////////////////////////////////////
+
+		using UnfilterFunction = bool(*)(uint8, uint8*, const uint8*, size_t, size_t);
+
+		[[nodiscard]]
+		constexpr uint8 PaethPredictor(const int32 a, const int32 b, const int32 c) noexcept
+		{
+			const int32 pa = std::abs(b - c);
+			const int32 pb = std::abs(a - c);
+			const int32 pc = std::abs((a + b) - (2 * c));
+
+			if ((pa <= pb) && (pa <= pc))
+			{
+				return static_cast<uint8>(a);
+			}
+			else if (pb <= pc)
+			{
+				return static_cast<uint8>(b);
+			}
+
+			return static_cast<uint8>(c);
+		}
+
+		/// @brief 行のフィルタを復元します。
+		/// @param filter フィルタの種類
+		/// @param row 復元する行。復元したデータで上書きされます
+		/// @param prior 復元済みの 1 つ上の行。最初の行の場合はすべて 0 の行
+		/// @param size 行のサイズ（バイト）
+		/// @param bpp 左隣のピクセルまでの距離（バイト）
+		/// @param begin 復元を始める位置（バイト）。それより前は復元済みであること
+		/// @return フィルタの種類が正しい場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool Unfilter_Scalar(const uint8 filter, uint8* row, const uint8* prior, const size_t size, const size_t bpp, const size_t begin = 0) noexcept
+		{
+			// 行の最初のピクセルでは、左と左上は 0 とみなす
+			const size_t head = std::min(std::max(begin, bpp), size);
+
+			switch (static_cast<PNGFilter>(filter))
+			{
+			case PNGFilter::None:
+				break;
+			case PNGFilter::Sub:
+				for (size_t i = head; i < size; ++i)
+				{
+					row[i] += row[i - bpp];
+				}
+				break;
+			case PNGFilter::Up:
+				for (size_t i = begin; i < size; ++i)
+				{
+					row[i] += prior[i];
+				}
+				break;
+			case PNGFilter::Average:
+				for (size_t i = begin; i < head; ++i)
+				{
+					row[i] += (prior[i] >> 1);
+				}
+
+				for (size_t i = head; i < size; ++i)
+				{
+					row[i] += static_cast<uint8>((row[i - bpp] + prior[i]) >> 1);
+				}
+				break;
+			case PNGFilter::Paeth:
+				for (size_t i = begin; i < head; ++i)
+				{
+					row[i] += prior[i];
+				}
+
+				for (size_t i = head; i < size; ++i)
+				{
+					row[i] += PaethPredictor(row[i - bpp], prior[i], prior[i - bpp]);
+				}
+				break;
+			default:
+				return false;
+			}
+
+			return true;
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		/// @brief 1 ピクセルを読み込みます。
+		/// @remark Bpp が 4 以下の場合は 4 バイト、それ以外の場合は 8 バイトを読み込みます。
+		template <size_t Bpp>
+		[[nodiscard]]
+		__m128i LoadPixel_SSE2(const uint8* p) noexcept
+		{
+			if constexpr (Bpp <= 4)
+			{
+				int32 value;
+				std::memcpy(&value, p, sizeof(value));
+				return _mm_cvtsi32_si128(value);
+			}
+			else
+			{
+				return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+			}
+		}
+
+		/// @brief 1 ピクセル（Bpp バイト）を書き込みます。
+		template <size_t Bpp>
+		void StorePixel_SSE2(uint8* p, const __m128i v) noexcept
+		{
+			const int64 value = _mm_cvtsi128_si64(v);
+			std::memcpy(p, &value, Bpp);
+		}
+
+		/// @brief 1 バイトあたり 3, 4, 6, 8 バイトのピクセルの行のフィルタを、1 ピクセルずつベクトル演算で復元します。
+		template <size_t Bpp>
+		[[nodiscard]]
+		bool UnfilterPixels_SSE2(const uint8 filter, uint8* row, const uint8* prior, const size_t size) noexcept
+		{
+			// LoadPixel_SSE2 が読み込むバイト数
+			constexpr size_t LoadBytes = ((Bpp <= 4) ? 4 : 8);
+
+			const __m128i zero = _mm_setzero_si128();
+
+			size_t i = 0;
+
+			switch (static_cast<PNGFilter>(filter))
+			{
+			case PNGFilter::None:
+				return true;
+			case PNGFilter::Sub:
+				{
+					__m128i a = zero;
+
+					if constexpr (Bpp == 4)
+					{
+						// 16 バイト（4 ピクセル）ずつ、左のピクセルの値を累積和で足し込む
+						for (; (i + 16) <= size; i += 16)
+						{
+							__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+							x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+							x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+							x = _mm_add_epi8(x, a);
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), x);
+							a = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+						}
+					}
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						a = _mm_add_epi8(LoadPixel_SSE2<Bpp>(row + i), a);
+						StorePixel_SSE2<Bpp>((row + i), a);
+					}
+				}
+				break;
+			case PNGFilter::Up:
+				for (; (i + 16) <= size; i += 16)
+				{
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+				}
+				break;
+			case PNGFilter::Average:
+				{
+					const __m128i one = _mm_set1_epi8(1);
+					__m128i a = zero;
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						// _mm_avg_epu8 は切り上げるので、(a + b) が奇数の場合は 1 を引いて切り捨てにする
+						const __m128i b = LoadPixel_SSE2<Bpp>(prior + i);
+						const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+						a = _mm_add_epi8(LoadPixel_SSE2<Bpp>(row + i), average);
+						StorePixel_SSE2<Bpp>((row + i), a);
+					}
+				}
+				break;
+			case PNGFilter::Paeth:
+				{
+					// 16 ビット単位で計算する。a: 左, b: 上, c: 左上
+					__m128i a = zero;
+					__m128i c = zero;
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						const __m128i b = _mm_unpacklo_epi8(LoadPixel_SSE2<Bpp>(prior + i), zero);
+
+						// p = a + b - c のとき、pa = |p - a| = |b - c|, pb = |p - b| = |a - c|, pc = |p - c| = |(b - c) + (a - c)|
+						const __m128i bc = _mm_sub_epi16(b, c);
+						const __m128i ac = _mm_sub_epi16(a, c);
+						const __m128i abc = _mm_add_epi16(bc, ac);
+						const __m128i pa = _mm_max_epi16(bc, _mm_sub_epi16(zero, bc));
+						const __m128i pb = _mm_max_epi16(ac, _mm_sub_epi16(zero, ac));
+						const __m128i pc = _mm_max_epi16(abc, _mm_sub_epi16(zero, abc));
+
+						// 最小のものを a, b, c の優先順で選ぶ
+						const __m128i smallest = _mm_min_epi16(pa, _mm_min_epi16(pb, pc));
+						const __m128i useA = _mm_cmpeq_epi16(pa, smallest);
+						const __m128i useB = _mm_cmpeq_epi16(pb, smallest);
+						const __m128i bOrC = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+						const __m128i predictor = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bOrC));
+
+						const __m128i x = _mm_add_epi8(LoadPixel_SSE2<Bpp>(row + i), _mm_packus_epi16(predictor, predictor));
+						StorePixel_SSE2<Bpp>((row + i), x);
+
+						a = _mm_unpacklo_epi8(x, zero);
+						c = b;
+					}
+				}
+				break;
+			default:
+				return false;
+			}
+
+			// 残りのバイト
+			return Unfilter_Scalar(filter, row, prior, size, Bpp, i);
+		}
+
+		[[nodiscard]]
+		bool Unfilter_SSE2(const uint8 filter, uint8* row, const uint8* prior, const size_t size, const size_t bpp) noexcept
+		{
+			switch (bpp)
+			{
+			case 3:
+				return UnfilterPixels_SSE2<3>(filter, row, prior, size);
+			case 4:
+				return UnfilterPixels_SSE2<4>(filter, row, prior, size);
+			case 6:
+				return UnfilterPixels_SSE2<6>(filter, row, prior, size);
+			case 8:
+				return UnfilterPixels_SSE2<8>(filter, row, prior, size);
+			default:
+				// 1, 2 バイトのピクセルは、Up だけをベクトル演算で復元する
+				if (filter == static_cast<uint8>(PNGFilter::Up))
+				{
+					return UnfilterPixels_SSE2<4>(filter, row, prior, size);
+				}
+
+				return Unfilter_Scalar(filter, row, prior, size, bpp);
+			}
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		/// @brief 1 ピクセルを読み込みます。
+		/// @remark Bpp が 4 以下の場合は 4 バイト、それ以外の場合は 8 バイトを読み込みます。
+		template <size_t Bpp>
+		[[nodiscard]]
+		uint8x8_t LoadPixel_NEON(const uint8* p) noexcept
+		{
+			uint64 value = 0;
+			std::memcpy(&value, p, ((Bpp <= 4) ? 4 : 8));
+			return vcreate_u8(value);
+		}
+
+		/// @brief 1 ピクセル（Bpp バイト）を書き込みます。
+		template <size_t Bpp>
+		void StorePixel_NEON(uint8* p, const uint8x8_t v) noexcept
+		{
+			const uint64 value = vget_lane_u64(vreinterpret_u64_u8(v), 0);
+			std::memcpy(p, &value, Bpp);
+		}
+
+		/// @brief 1 バイトあたり 3, 4, 6, 8 バイトのピクセルの行のフィルタを、1 ピクセルずつベクトル演算で復元します。
+		template <size_t Bpp>
+		[[nodiscard]]
+		bool UnfilterPixels_NEON(const uint8 filter, uint8* row, const uint8* prior, const size_t size) noexcept
+		{
+			// LoadPixel_NEON が読み込むバイト数
+			constexpr size_t LoadBytes = ((Bpp <= 4) ? 4 : 8);
+
+			size_t i = 0;
+
+			switch (static_cast<PNGFilter>(filter))
+			{
+			case PNGFilter::None:
+				return true;
+			case PNGFilter::Sub:
+				{
+					uint8x8_t a = vdup_n_u8(0);
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						a = vadd_u8(LoadPixel_NEON<Bpp>(row + i), a);
+						StorePixel_NEON<Bpp>((row + i), a);
+					}
+				}
+				break;
+			case PNGFilter::Up:
+				for (; (i + 16) <= size; i += 16)
+				{
+					vst1q_u8((row + i), vaddq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+				}
+				break;
+			case PNGFilter::Average:
+				{
+					uint8x8_t a = vdup_n_u8(0);
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						// vhadd_u8 は (a + b) / 2 を切り捨てで求める
+						a = vadd_u8(LoadPixel_NEON<Bpp>(row + i), vhadd_u8(a, LoadPixel_NEON<Bpp>(prior + i)));
+						StorePixel_NEON<Bpp>((row + i), a);
+					}
+				}
+				break;
+			case PNGFilter::Paeth:
+				{
+					// a: 左, b: 上, c: 左上
+					uint8x8_t a = vdup_n_u8(0);
+					uint8x8_t c = vdup_n_u8(0);
+
+					for (; (i + LoadBytes) <= size; i += Bpp)
+					{
+						const uint8x8_t b = LoadPixel_NEON<Bpp>(prior + i);
+
+						// pa = |b - c|, pb = |a - c|, pc = |(a + b) - 2c|
+						const uint16x8_t pa = vmovl_u8(vabd_u8(b, c));
+						const uint16x8_t pb = vmovl_u8(vabd_u8(a, c));
+						const uint16x8_t pc = vabdq_u16(vaddl_u8(a, b), vshll_n_u8(c, 1));
+
+						const uint8x8_t useA = vmovn_u16(vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+						const uint8x8_t useB = vmovn_u16(vcleq_u16(pb, pc));
+						const uint8x8_t predictor = vbsl_u8(useA, a, vbsl_u8(useB, b, c));
+
+						a = vadd_u8(LoadPixel_NEON<Bpp>(row + i), predictor);
+						StorePixel_NEON<Bpp>((row + i), a);
+						c = b;
+					}
+				}
+				break;
+			default:
+				return false;
+			}
+
+			// 残りのバイト
+			return Unfilter_Scalar(filter, row, prior, size, Bpp, i);
+		}
+
+		[[nodiscard]]
+		bool Unfilter_NEON(const uint8 filter, uint8* row, const uint8* prior, const size_t size, const size_t bpp) noexcept
+		{
+			switch (bpp)
+			{
+			case 3:
+				return UnfilterPixels_NEON<3>(filter, row, prior, size);
+			case 4:
+				return UnfilterPixels_NEON<4>(filter, row, prior, size);
+			case 6:
+				return UnfilterPixels_NEON<6>(filter, row, prior, size);
+			case 8:
+				return UnfilterPixels_NEON<8>(filter, row, prior, size);
+			default:
+				// 1, 2 バイトのピクセルは、Up だけをベクトル演算で復元する
+				if (filter == static_cast<uint8>(PNGFilter::Up))
+				{
+					return UnfilterPixels_NEON<4>(filter, row, prior, size);
+				}
+
+				return Unfilter_Scalar(filter, row, prior, size, bpp);
+			}
+		}
+
+	#endif
+
+		[[nodiscard]]
+		UnfilterFunction SelectUnfilter() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return Unfilter_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Unfilter_NEON;
+
+		#else
+
+			return [](const uint8 filter, uint8* row, const uint8* prior, const size_t size, const size_t bpp) noexcept
+				{
+					return Unfilter_Scalar(filter, row, prior, size, bpp);
+				};
+
+		#endif
+		}
+
+		/// @brief フィルタされた行の並びを、先頭の行から順に復元します。
+		/// @param data 各行の先頭にフィルタの種類の 1 バイトが付いた行の並び。復元したデータで上書きされます
+		/// @param strideBytes 1 行のデータのサイズ（フィルタの種類の 1 バイトを含まない）
+		/// @param numRows 行数
+		/// @param bpp 左隣のピクセルまでの距離（バイト）
+		/// @param zeroRow strideBytes バイト以上の、すべて 0 のバッファ
+		/// @return フィルタの種類がすべて正しい場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool UnfilterRows(uint8* data, const size_t strideBytes, const int32 numRows, const size_t bpp, const uint8* zeroRow) noexcept
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const UnfilterFunction function = SelectUnfilter();
+
+			const uint8* prior = zeroRow;
+
+			for (int32 y = 0; y < numRows; ++y)
+			{
+				uint8* row = (data + ((strideBytes + 1) * y));
+
+				if (not function(row[0], (row + 1), prior, strideBytes, bpp))
+				{
+					return false;
+				}
+
+				prior = (row + 1);
+			}
+
+			return true;
+		}
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	フィルタの選択
+		//
+		////////////////////////////////////////////////////////////////
+
+		using FilterRowFunction = void(*)(const uint8*, const uint8*, size_t, size_t, uint8*);
+
+		/// @brief フィルタの種類の数
+		constexpr size_t NumFilters = 5;
+
+		/// @brief フィルタの予測値を返します。
+		/// @param filter フィルタの種類
+		/// @param a 左のバイト
+		/// @param b 上のバイト
+		/// @param c 左上のバイト
+		/// @return 予測値
+		[[nodiscard]]
+		constexpr uint8 Predict(const PNGFilter filter, const uint8 a, const uint8 b, const uint8 c) noexcept
+		{
+			switch (filter)
+			{
+			case PNGFilter::Sub:
+				return a;
+			case PNGFilter::Up:
+				return b;
+			case PNGFilter::Average:
+				return static_cast<uint8>((a + b) >> 1);
+			case PNGFilter::Paeth:
+				return PaethPredictor(a, b, c);
+			default:
+				return 0;
+			}
+		}
+
+		/// @brief 最も小さいフィルタの評価値を持つフィルタを返します。
+		[[nodiscard]]
+		PNGFilter SelectFilter(const std::array<uint64, NumFilters>& sums) noexcept
+		{
+			size_t best = 0;
+
+			for (size_t i = 1; i < NumFilters; ++i)
+			{
+				if (sums[i] < sums[best])
+				{
+					best = i;
+				}
+			}
+
+			return static_cast<PNGFilter>(best);
+		}
+
+		/// @brief 行をフィルタしたときの評価値（差分を符号付きとみなした絶対値の和）を、範囲 [begin, size) について加算します。
+		void AddFilterSums_Scalar(const uint8* row, const uint8* prior, const size_t size, const size_t bpp, const size_t begin, std::array<uint64, NumFilters>& sums) noexcept
+		{
+			for (size_t i = begin; i < size; ++i)
+			{
+				const uint8 x = row[i], a = row[i - bpp], b = prior[i], c = prior[i - bpp];
+
+				for (size_t filter = 0; filter < NumFilters; ++filter)
+				{
+					sums[filter] += static_cast<uint64>(std::abs(static_cast<int8>(x - Predict(static_cast<PNGFilter>(filter), a, b, c))));
+				}
+			}
+		}
+
+		/// @brief 行を指定したフィルタでフィルタし、範囲 [begin, size) を書き込みます。
+		void ApplyFilter_Scalar(const PNGFilter filter, const uint8* row, const uint8* prior, const size_t size, const size_t bpp, const size_t begin, uint8* dst) noexcept
+		{
+			for (size_t i = begin; i < size; ++i)
+			{
+				dst[i] = static_cast<uint8>(row[i] - Predict(filter, row[i - bpp], prior[i], prior[i - bpp]));
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		/// @brief 16 バイト分の Paeth の予測値を求めます。
+		/// @remark pc = |a + b - 2c| だけは 16 ビットで計算し、8 ビットに飽和させて比べます。pa, pb は 255 以下なので、比較の結果は変わりません。
+		[[nodiscard]]
+		__m128i PaethPredictor_SSE2(const __m128i a, const __m128i b, const __m128i c) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i pa = _mm_or_si128(_mm_subs_epu8(b, c), _mm_subs_epu8(c, b));
+			const __m128i pb = _mm_or_si128(_mm_subs_epu8(a, c), _mm_subs_epu8(c, a));
+
+			const auto AbsDiff16 = [&](const __m128i x, const __m128i y, const __m128i z)
+			{
+				const __m128i d = _mm_sub_epi16(_mm_add_epi16(x, y), _mm_add_epi16(z, z));
+				return _mm_max_epi16(d, _mm_sub_epi16(zero, d));
+			};
+
+			const __m128i pc = _mm_packus_epi16(
+				AbsDiff16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero)),
+				AbsDiff16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero)));
+
+			// x <= y は min(x, y) == x で判定する
+			const __m128i useA = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(pa, pb), pa), _mm_cmpeq_epi8(_mm_min_epu8(pa, pc), pa));
+			const __m128i useB = _mm_cmpeq_epi8(_mm_min_epu8(pb, pc), pb);
+			const __m128i bOrC = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+			return _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bOrC));
+		}
+
+		/// @brief 16 バイト分の予測値を求めます。
+		[[nodiscard]]
+		__m128i Predict_SSE2(const PNGFilter filter, const __m128i a, const __m128i b, const __m128i c) noexcept
+		{
+			switch (filter)
+			{
+			case PNGFilter::Sub:
+				return a;
+			case PNGFilter::Up:
+				return b;
+			case PNGFilter::Average:
+				// _mm_avg_epu8 は切り上げるので、(a + b) が奇数の場合は 1 を引いて切り捨てにする
+				return _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+			case PNGFilter::Paeth:
+				return PaethPredictor_SSE2(a, b, c);
+			default:
+				return _mm_setzero_si128();
+			}
+		}
+
+		void FilterRow_SSE2(const uint8* row, const uint8* prior, const size_t size, const size_t bpp, uint8* dst) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			__m128i sums[NumFilters] = { zero, zero, zero, zero, zero };
+
+			size_t i = 0;
+
+			// 16 バイトずつ、すべてのフィルタの差分の絶対値の和を求める
+			for (; (i + 16) <= size; i += 16)
+			{
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i - bpp));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+				const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i - bpp));
+
+				for (size_t filter = 0; filter < NumFilters; ++filter)
+				{
+					// 符号付きの絶対値は、符号なしの min(d, -d) で求められる
+					const __m128i d = _mm_sub_epi8(x, Predict_SSE2(static_cast<PNGFilter>(filter), a, b, c));
+					const __m128i absolute = _mm_min_epu8(d, _mm_sub_epi8(zero, d));
+					sums[filter] = _mm_add_epi64(sums[filter], _mm_sad_epu8(absolute, zero));
+				}
+			}
+
+			std::array<uint64, NumFilters> totals;
+
+			for (size_t filter = 0; filter < NumFilters; ++filter)
+			{
+				totals[filter] = static_cast<uint64>(_mm_cvtsi128_si64(sums[filter]) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums[filter], sums[filter])));
+			}
+
+			AddFilterSums_Scalar(row, prior, size, bpp, i, totals);
+
+			const PNGFilter filter = SelectFilter(totals);
+			*dst++ = static_cast<uint8>(filter);
+
+			for (i = 0; (i + 16) <= size; i += 16)
+			{
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i - bpp));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+				const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i - bpp));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi8(x, Predict_SSE2(filter, a, b, c)));
+			}
+
+			ApplyFilter_Scalar(filter, row, prior, size, bpp, i, dst);
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		/// @brief 16 バイト分の Paeth の予測値を求めます。
+		/// @remark pc = |a + b - 2c| だけは 16 ビットで計算し、8 ビットに飽和させて比べます。pa, pb は 255 以下なので、比較の結果は変わりません。
+		[[nodiscard]]
+		uint8x16_t PaethPredictor_NEON(const uint8x16_t a, const uint8x16_t b, const uint8x16_t c) noexcept
+		{
+			const uint8x16_t pa = vabdq_u8(b, c);
+			const uint8x16_t pb = vabdq_u8(a, c);
+			const uint16x8_t pcLow = vabdq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vshll_n_u8(vget_low_u8(c), 1));
+			const uint16x8_t pcHigh = vabdq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vshll_n_u8(vget_high_u8(c), 1));
+			const uint8x16_t pc = vcombine_u8(vqmovn_u16(pcLow), vqmovn_u16(pcHigh));
+
+			const uint8x16_t useA = vandq_u8(vcleq_u8(pa, pb), vcleq_u8(pa, pc));
+			const uint8x16_t useB = vcleq_u8(pb, pc);
+			return vbslq_u8(useA, a, vbslq_u8(useB, b, c));
+		}
+
+		/// @brief 16 バイト分の予測値を求めます。
+		[[nodiscard]]
+		uint8x16_t Predict_NEON(const PNGFilter filter, const uint8x16_t a, const uint8x16_t b, const uint8x16_t c) noexcept
+		{
+			switch (filter)
+			{
+			case PNGFilter::Sub:
+				return a;
+			case PNGFilter::Up:
+				return b;
+			case PNGFilter::Average:
+				return vhaddq_u8(a, b);
+			case PNGFilter::Paeth:
+				return PaethPredictor_NEON(a, b, c);
+			default:
+				return vdupq_n_u8(0);
+			}
+		}
+
+		void FilterRow_NEON(const uint8* row, const uint8* prior, const size_t size, const size_t bpp, uint8* dst) noexcept
+		{
+			std::array<uint32x4_t, NumFilters> sums;
+			sums.fill(vdupq_n_u32(0));
+
+			size_t i = 0;
+
+			// 16 バイトずつ、すべてのフィルタの差分の絶対値の和を求める
+			for (; (i + 16) <= size; i += 16)
+			{
+				const uint8x16_t x = vld1q_u8(row + i);
+				const uint8x16_t a = vld1q_u8(row + i - bpp);
+				const uint8x16_t b = vld1q_u8(prior + i);
+				const uint8x16_t c = vld1q_u8(prior + i - bpp);
+
+				for (size_t filter = 0; filter < NumFilters; ++filter)
+				{
+					const uint8x16_t d = vsubq_u8(x, Predict_NEON(static_cast<PNGFilter>(filter), a, b, c));
+					const uint8x16_t absolute = vreinterpretq_u8_s8(vabsq_s8(vreinterpretq_s8_u8(d)));
+					sums[filter] = vpadalq_u16(sums[filter], vpaddlq_u8(absolute));
+				}
+			}
+
+			std::array<uint64, NumFilters> totals;
+
+			for (size_t filter = 0; filter < NumFilters; ++filter)
+			{
+				totals[filter] = vaddlvq_u32(sums[filter]);
+			}
+
+			AddFilterSums_Scalar(row, prior, size, bpp, i, totals);
+
+			const PNGFilter filter = SelectFilter(totals);
+			*dst++ = static_cast<uint8>(filter);
+
+			for (i = 0; (i + 16) <= size; i += 16)
+			{
+				const uint8x16_t x = vld1q_u8(row + i);
+				const uint8x16_t a = vld1q_u8(row + i - bpp);
+				const uint8x16_t b = vld1q_u8(prior + i);
+				const uint8x16_t c = vld1q_u8(prior + i - bpp);
+				vst1q_u8((dst + i), vsubq_u8(x, Predict_NEON(filter, a, b, c)));
+			}
+
+			ApplyFilter_Scalar(filter, row, prior, size, bpp, i, dst);
+		}
+
+	#else
+
+		/// @brief 行に最も適したフィルタを選び、フィルタの種類の 1 バイトに続けてフィルタした行を書き込みます。
+		/// @param row 行のデータ。直前の bpp バイトは 0 であること
+		/// @param prior 1 つ上の行のデータ。最初の行の場合はすべて 0。直前の bpp バイトは 0 であること
+		/// @param size 行のサイズ（バイト）
+		/// @param bpp 左隣のピクセルまでの距離（バイト）
+		/// @param dst 書き込み先（size + 1 バイト）
+		/// @remark 差分を符号付きとみなした絶対値の和が最も小さいフィルタを選びます。
+		void FilterRow_Scalar(const uint8* row, const uint8* prior, const size_t size, const size_t bpp, uint8* dst) noexcept
+		{
+			std::array<uint64, NumFilters> sums{};
+			AddFilterSums_Scalar(row, prior, size, bpp, 0, sums);
+
+			const PNGFilter filter = SelectFilter(sums);
+			dst[0] = static_cast<uint8>(filter);
+			ApplyFilter_Scalar(filter, row, prior, size, bpp, 0, (dst + 1));
+		}
+
+	#endif
+
+		[[nodiscard]]
+		FilterRowFunction SelectFilterRow() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return FilterRow_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return FilterRow_NEON;
+
+		#else
+
+			return FilterRow_Scalar;
+
+		#endif
+		}
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	ピクセル形式の変換
+		//
+		////////////////////////////////////////////////////////////////
+
+		/// @brief 1 行分のデータを RGBA に変換します。
+		/// @param info 画像の情報
+		/// @param src フィルタを復元した行のデータ
+		/// @param dst 変換先のピクセル列
+		/// @param numPixels ピクセル数
+		void ConvertRow(const PNGInfo& info, const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const uint32 bitDepth = info.bitDepth;
+
+			if (bitDepth < 8)
+			{
+				// 1 バイトに複数のピクセルが上位ビットから順に詰められている
+				const uint32 mask = ((1u << bitDepth) - 1);
+				const uint32 scale = (255 / mask);
+
+				for (size_t x = 0; x < numPixels; ++x)
+				{
+					const size_t bit = (x * bitDepth);
+					const uint32 value = ((src[bit / 8] >> (8 - bitDepth - (bit % 8))) & mask);
+
+					if (info.colorType == PNGColorType::Palette)
+					{
+						dst[x] = info.palette[value];
+					}
+					else
+					{
+						const uint8 alpha = ((info.hasColorKey && (value == info.keyR)) ? 0 : 255);
+						dst[x] = Color{ static_cast<uint8>(value * scale), alpha };
+					}
+				}
+
+				return;
+			}
+
+			if (bitDepth == 16)
+			{
+				for (size_t x = 0; x < numPixels; ++x)
+				{
+					switch (info.colorType)
+					{
+					case PNGColorType::Gray:
+						{
+							const uint16 value = LoadBE16(src + (x * 2));
+							const uint8 alpha = ((info.hasColorKey && (value == info.keyR)) ? 0 : 255);
+							dst[x] = Color{ To8Bit(value), alpha };
+						}
+						break;
+					case PNGColorType::RGB:
+						{
+							const uint16 r = LoadBE16(src + (x * 6));
+							const uint16 g = LoadBE16(src + (x * 6 + 2));
+							const uint16 b = LoadBE16(src + (x * 6 + 4));
+							const uint8 alpha = ((info.hasColorKey && (r == info.keyR) && (g == info.keyG) && (b == info.keyB)) ? 0 : 255);
+							dst[x] = Color{ To8Bit(r), To8Bit(g), To8Bit(b), alpha };
+						}
+						break;
+					case PNGColorType::GrayAlpha:
+						dst[x] = Color{ To8Bit(LoadBE16(src + (x * 4))), To8Bit(LoadBE16(src + (x * 4 + 2))) };
+						break;
+					default:
+						dst[x] = Color{ To8Bit(LoadBE16(src + (x * 8))), To8Bit(LoadBE16(src + (x * 8 + 2))),
+							To8Bit(LoadBE16(src + (x * 8 + 4))), To8Bit(LoadBE16(src + (x * 8 + 6))) };
+						break;
+					}
+				}
+
+				return;
+			}
+
+			switch (info.colorType)
+			{
+			case PNGColorType::Gray:
+				ConvertGrayToRGBA(src, dst, numPixels);
+				break;
+			case PNGColorType::RGB:
+				ConvertRGBToRGBA(src, dst, numPixels);
+				break;
+			case PNGColorType::Palette:
+				for (size_t x = 0; x < numPixels; ++x)
+				{
+					dst[x] = info.palette[src[x]];
+				}
+				return;
+			case PNGColorType::GrayAlpha:
+				ConvertGrayAlphaToRGBA(src, dst, numPixels);
+				return;
+			case PNGColorType::RGBA:
+				std::memcpy(dst, src, (numPixels * sizeof(Color)));
+				return;
+			}
+
+			// 透明色が指定されている場合は、一致するピクセルのアルファ成分を 0 にする
+			if (info.hasColorKey)
+			{
+				const Color key{ info.keyR, info.keyG, info.keyB };
+
+				for (size_t x = 0; x < numPixels; ++x)
+				{
+					if ((dst[x].r == key.r) && (dst[x].g == key.g) && (dst[x].b == key.b))
+					{
+						dst[x].a = 0;
+					}
+				}
+			}
+		}
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	チャンクの読み込み
+		//
+		////////////////////////////////////////////////////////////////
+
+		/// @brief IHDR チャンクを読み込みます。
+		/// @return 対応している形式の場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool ReadHeader(const uint8* data, const size_t size, PNGInfo& info) noexcept
+		{
+			if (size != 13)
+			{
+				return false;
+			}
+
+			const uint32 width = LoadBE32(data);
+			const uint32 height = LoadBE32(data + 4);
+			const uint32 bitDepth = data[8];
+			const uint32 colorType = data[9];
+			const uint32 compression = data[10];
+			const uint32 filter = data[11];
+			const uint32 interlace = data[12];
+
+			if ((width == 0) || (height == 0)
+				|| (static_cast<uint32>(std::numeric_limits<int32>::max()) < width)
+				|| (static_cast<uint32>(std::numeric_limits<int32>::max()) < height)
+				|| (compression != 0) || (filter != 0) || (1 < interlace))
+			{
+				return false;
+			}
+
+			// 色の種類ごとのサンプル数と、使用できるビット深度
+			uint32 numSamples = 0;
+			bool validDepth = false;
+
+			switch (static_cast<PNGColorType>(colorType))
+			{
+			case PNGColorType::Gray:
+				numSamples = 1;
+				validDepth = ((bitDepth == 1) || (bitDepth == 2) || (bitDepth == 4) || (bitDepth == 8) || (bitDepth == 16));
+				break;
+			case PNGColorType::RGB:
+				numSamples = 3;
+				validDepth = ((bitDepth == 8) || (bitDepth == 16));
+				break;
+			case PNGColorType::Palette:
+				numSamples = 1;
+				validDepth = ((bitDepth == 1) || (bitDepth == 2) || (bitDepth == 4) || (bitDepth == 8));
+				break;
+			case PNGColorType::GrayAlpha:
+				numSamples = 2;
+				validDepth = ((bitDepth == 8) || (bitDepth == 16));
+				break;
+			case PNGColorType::RGBA:
+				numSamples = 4;
+				validDepth = ((bitDepth == 8) || (bitDepth == 16));
+				break;
+			}
+
+			if (not validDepth)
+			{
+				return false;
+			}
+
+			info.width = static_cast<int32>(width);
+			info.height = static_cast<int32>(height);
+			info.bitDepth = bitDepth;
+			info.colorType = static_cast<PNGColorType>(colorType);
+			info.interlaced = (interlace == 1);
+			info.bitsPerPixel = (numSamples * bitDepth);
+			info.palette.fill(Color{ 0, 0, 0, 255 });
+			return true;
+		}
+
+		/// @brief tRNS チャンクを読み込みます。
+		/// @return 正しいチャンクの場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool ReadTransparency(const uint8* data, const size_t size, PNGInfo& info) noexcept
+		{
+			switch (info.colorType)
+			{
+			case PNGColorType::Gray:
+				if (size < 2)
+				{
+					return false;
+				}
+
+				info.hasColorKey = true;
+				info.keyR = info.keyG = info.keyB = LoadBE16(data);
+
+				// 8 ビットの画像で範囲外の値が指定された場合は、どのピクセルとも一致させない
+				if ((info.bitDepth == 8) && (255 < info.keyR))
+				{
+					info.hasColorKey = false;
+				}
+				return true;
+			case PNGColorType::RGB:
+				if (size < 6)
+				{
+					return false;
+				}
+
+				info.hasColorKey = true;
+				info.keyR = LoadBE16(data);
+				info.keyG = LoadBE16(data + 2);
+				info.keyB = LoadBE16(data + 4);
+
+				// 8 ビットの画像で範囲外の値が指定された場合は、どのピクセルとも一致させない
+				if ((info.bitDepth == 8) && (255 < std::max({ info.keyR, info.keyG, info.keyB })))
+				{
+					info.hasColorKey = false;
+				}
+				return true;
+			case PNGColorType::Palette:
+				for (size_t i = 0; i < std::min<size_t>(size, info.palette.size()); ++i)
+				{
+					info.palette[i].a = data[i];
+				}
+				return true;
+			default:
+				// アルファ成分を持つ画像には tRNS チャンクは使われない
+				return true;
+			}
+		}
+
+		/// @brief PNG ファイルのデータを解析し、ヘッダと圧縮されたピクセルデータを取得します。
+		/// @param data PNG ファイルのデータ
+		/// @param info 画像の情報の格納先
+		/// @param compressed 圧縮されたピクセルデータの格納先。IDAT チャンクが 1 つの場合はファイルのデータを直接参照します
+		/// @param buffer IDAT チャンクが複数ある場合に、連結したデータを格納するバッファ
+		/// @return 対応している形式の場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool ParseChunks(const std::span<const uint8> data, PNGInfo& info, std::span<const uint8>& compressed, std::vector<uint8>& buffer)
+		{
+			if ((data.size() < Signature.size()) || (not std::ranges::equal(data.first(Signature.size()), Signature)))
+			{
+				return false;
+			}
+
+			constexpr uint32 IHDR = MakeChunkType("IHDR");
+			constexpr uint32 PLTE = MakeChunkType("PLTE");
+			constexpr uint32 tRNS = MakeChunkType("tRNS");
+			constexpr uint32 IDAT = MakeChunkType("IDAT");
+			constexpr uint32 IEND = MakeChunkType("IEND");
+
+			std::vector<std::span<const uint8>> idatChunks;
+			bool hasHeader = false;
+			size_t offset = Signature.size();
+
+			for (;;)
+			{
+				// 長さ（4 バイト）、種類（4 バイト）、データ、CRC（4 バイト）
+				if ((data.size() - offset) < 12)
+				{
+					return false;
+				}
+
+				const size_t length = LoadBE32(data.data() + offset);
+				const uint32 type = LoadBE32(data.data() + offset + 4);
+
+				if ((data.size() - offset - 12) < length)
+				{
+					return false;
+				}
+
+				const uint8* pChunk = (data.data() + offset + 8);
+				offset += (length + 12);
+
+				if (not hasHeader)
+				{
+					// 最初のチャンクは IHDR でなければならない
+					if ((type != IHDR) || (not ReadHeader(pChunk, length, info)))
+					{
+						return false;
+					}
+
+					hasHeader = true;
+				}
+				else if (type == PLTE)
+				{
+					if (((length % 3) != 0) || ((256 * 3) < length))
+					{
+						return false;
+					}
+
+					for (size_t i = 0; i < (length / 3); ++i)
+					{
+						info.palette[i] = Color{ pChunk[i * 3], pChunk[i * 3 + 1], pChunk[i * 3 + 2], info.palette[i].a };
+					}
+				}
+				else if (type == tRNS)
+				{
+					if (not ReadTransparency(pChunk, length, info))
+					{
+						return false;
+					}
+				}
+				else if (type == IDAT)
+				{
+					idatChunks.emplace_back(pChunk, length);
+				}
+				else if (type == IEND)
+				{
+					break;
+				}
+				else if ((type & 0x20000000) == 0)
+				{
+					// 種類の 1 文字目が大文字のチャンクは、読み飛ばせない重要なチャンク
+					return false;
+				}
+			}
+
+			if (idatChunks.empty())
+			{
+				return false;
+			}
+
+			if (idatChunks.size() == 1)
+			{
+				compressed = idatChunks.front();
+				return true;
+			}
+
+			size_t totalSize = 0;
+
+			for (const auto& chunk : idatChunks)
+			{
+				totalSize += chunk.size();
+			}
+
+			buffer.reserve(totalSize);
+
+			for (const auto& chunk : idatChunks)
+			{
+				buffer.insert(buffer.end(), chunk.begin(), chunk.end());
+			}
+
+			compressed = buffer;
+			return true;
+		}
+
+		/// @brief フィルタを復元したデータのサイズ（フィルタの種類のバイトを含む）を返します。
+		/// @return データのサイズ（バイト）。size_t で表せない場合は 0
+		[[nodiscard]]
+		size_t GetFilteredSize(const PNGInfo& info) noexcept
+		{
+			if (not info.interlaced)
+			{
+				const size_t rowBytes = (info.strideBytes(info.width) + 1);
+
+				if ((std::numeric_limits<size_t>::max() / rowBytes) < static_cast<size_t>(info.height))
+				{
+					return 0;
+				}
+
+				return (rowBytes * info.height);
+			}
+
+			size_t totalSize = 0;
+
+			for (const Adam7Pass& pass : Adam7Passes)
+			{
+				const int32 passWidth = GetPassLength(info.width, pass.x, pass.dx);
+				const int32 passHeight = GetPassLength(info.height, pass.y, pass.dy);
+
+				if ((passWidth == 0) || (passHeight == 0))
+				{
+					continue;
+				}
+
+				const size_t rowBytes = (info.strideBytes(passWidth) + 1);
+
+				if (((std::numeric_limits<size_t>::max() - totalSize) / rowBytes) < static_cast<size_t>(passHeight))
+				{
+					return 0;
+				}
+
+				totalSize += (rowBytes * passHeight);
+			}
+
+			return totalSize;
+		}
+
+		////////////////////////////////////////////////////////////////
+		//
+		//	書き込み
+		//
+		////////////////////////////////////////////////////////////////
+
+		/// @brief 1 つの IDAT チャンクに格納する、圧縮されたデータの最大のサイズ（バイト）
+		constexpr size_t MaxIDATSize = (1 << 20);
+
+		/// @brief CRC-32 を 8 バイトずつ計算するための表
+		constexpr std::array<std::array<uint32, 256>, 8> CRCTable = []()
+		{
+			std::array<std::array<uint32, 256>, 8> table{};
+
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				uint32 crc = i;
+
+				for (int32 k = 0; k < 8; ++k)
+				{
+					crc = ((crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1));
+				}
+
+				table[0][i] = crc;
+			}
+
+			// table[k][i] は、バイト i の後ろに k バイトの 0 が続くときの値
+			for (size_t k = 1; k < table.size(); ++k)
+			{
+				for (size_t i = 0; i < 256; ++i)
+				{
+					table[k][i] = ((table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF]);
+				}
+			}
+
+			return table;
+		}();
+
+		[[nodiscard]]
+		uint32 LoadLE32(const uint8* p) noexcept
+		{
+			uint32 value;
+			std::memcpy(&value, p, sizeof(value));
+
+			if constexpr (std::endian::native == std::endian::big)
+			{
+				value = std::byteswap(value);
+			}
+
+			return value;
+		}
+
+		/// @brief CRC-32 を計算します。
+		/// @param data データ
+		/// @param size データのサイズ（バイト）
+		/// @param crc 直前までのデータの CRC
+		/// @return CRC
+		[[nodiscard]]
+		uint32 CRC32(const uint8* data, size_t size, uint32 crc = 0) noexcept
+		{
+			crc = ~crc;
+
+			// 8 バイトずつ、表を 8 回引いて計算する（slicing-by-8）
+			for (; 8 <= size; size -= 8, data += 8)
+			{
+				const uint32 lo = (LoadLE32(data) ^ crc);
+				const uint32 hi = LoadLE32(data + 4);
+
+				crc = (CRCTable[7][lo & 0xFF] ^ CRCTable[6][(lo >> 8) & 0xFF] ^ CRCTable[5][(lo >> 16) & 0xFF] ^ CRCTable[4][lo >> 24]
+					^ CRCTable[3][hi & 0xFF] ^ CRCTable[2][(hi >> 8) & 0xFF] ^ CRCTable[1][(hi >> 16) & 0xFF] ^ CRCTable[0][hi >> 24]);
+			}
+
+			for (; size; --size)
+			{
+				crc = (CRCTable[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8));
+			}
+
+			return ~crc;
+		}
+
+		void StoreBE32(std::byte* p, const uint32 value) noexcept
+		{
+			p[0] = static_cast<std::byte>(value >> 24);
+			p[1] = static_cast<std::byte>(value >> 16);
+			p[2] = static_cast<std::byte>(value >> 8);
+			p[3] = static_cast<std::byte>(value);
+		}
+
+		/// @brief チャンクを書き込みます。
+		/// @param dst 書き込み先（12 + data.size() バイト）
+		/// @param type チャンクの種類
+		/// @param data チャンクのデータ
+		void WriteChunk(std::byte* dst, const uint32 type, const std::span<const uint8> data) noexcept
+		{
+			StoreBE32(dst, static_cast<uint32>(data.size()));
+			StoreBE32((dst + 4), type);
+
+			if (not data.empty())
+			{
+				std::memcpy((dst + 8), data.data(), data.size());
+			}
+
+			// CRC はチャンクの種類とデータから計算する
+			const uint32 crc = CRC32(reinterpret_cast<const uint8*>(dst + 4), (4 + data.size()));
+			StoreBE32((dst + 8 + data.size()), crc);
+		}
+
+		/// @brief 画像の各行に最も適したフィルタを選び、フィルタした行の並びを作成します。
+		/// @param image 画像
+		/// @param format ピクセル形式
+		/// @return フィルタした行の並び。各行の先頭にフィルタの種類の 1 バイトが付く
+		[[nodiscard]]
+		std::vector<uint8> FilterRows(const ConstImageView& image, const PNGFormat format)
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const FilterRowFunction function = SelectFilterRow();
+
+			const size_t width = image.width();
+			const size_t bpp = ((format == PNGFormat::RGB24) ? 3 : 4);
+			const size_t strideBytes = (width * bpp);
+
+			std::vector<uint8> filtered((strideBytes + 1) * image.height());
+
+			// 1 行をファイルのピクセル形式に変換する
+			const auto ConvertRow = [&](const Color* pSrc, uint8* pDst)
+			{
+				if (format == PNGFormat::RGB24)
+				{
+					ConvertRGBAToRGB(pSrc, pDst, width);
+				}
+				else
+				{
+					std::memcpy(pDst, pSrc, strideBytes);
+				}
+			};
+
+			// 各行のフィルタは元の画素だけから決まるので、行のブロックごとに独立に処理できる
+			ParallelFor(0, static_cast<size_t>(image.height()), [&](const size_t beginY, const size_t endY)
+				{
+					// 左端の外側を 0 として読めるように、各行の前に 0 の余白を置く
+					constexpr size_t Padding = 16;
+					std::vector<uint8> buffer(((Padding + strideBytes) * 2), 0);
+					uint8* pCurrent = (buffer.data() + Padding);
+					uint8* pPrior = (pCurrent + strideBytes + Padding);
+
+					if (beginY != 0)
+					{
+						ConvertRow(image[static_cast<int32>(beginY - 1)], pPrior);
+					}
+
+					for (size_t y = beginY; y < endY; ++y)
+					{
+						ConvertRow(image[static_cast<int32>(y)], pCurrent);
+						function(pCurrent, pPrior, strideBytes, bpp, (filtered.data() + ((strideBytes + 1) * y)));
+						std::swap(pCurrent, pPrior);
+					}
+				}, std::max<size_t>(1, (TaskSizeBytes / (strideBytes + 1))));
+
+			return filtered;
+		}
+	}
+
+	Image LoadPNG(const std::string_view path)
+	{
+		BinaryFileReader reader{ path };
+
+		if (not reader.isOpen())
+		{
+			return{};
+		}
+
+		if (reader.isMapped())
+		{
+			// メモリマップされている場合は、ファイルのデータをコピーせずに直接展開する
+			return DecodePNG(reader.view());
+		}
+
+		std::vector<std::byte> data(static_cast<size_t>(reader.size()));
+
+		if (reader.read(data.data(), data.size()) != static_cast<int64>(data.size()))
+		{
+			return{};
+		}
+
+		return DecodePNG(data);
+	}
+
+	Image DecodePNG(const std::span<const std::byte> data)
+	{
+		PNGInfo info;
+		std::span<const uint8> compressed;
+		std::vector<uint8> idatBuffer;
+
+		if (not ParseChunks({ reinterpret_cast<const uint8*>(data.data()), data.size() }, info, compressed, idatBuffer))
+		{
+			return{};
+		}
+
+		const size_t filteredSize = GetFilteredSize(info);
+
+		if ((filteredSize == 0) || (((compressed.size() + 1) * MaxCompressionRatio) < filteredSize))
+		{
+			return{};
+		}
+
+		// 展開したデータのサイズは、ヘッダの情報から正確にわかる
+		std::vector<uint8> filtered(filteredSize);
+
+		if (ZlibDecompress(compressed, filtered) != static_cast<int64>(filteredSize))
+		{
+			return{};
+		}
+
+		idatBuffer = {};
+
+		const size_t bpp = info.filterBytesPerPixel();
+		const std::vector<uint8> zeroRow(info.strideBytes(info.width));
+
+		// すべてのピクセルを上書きするので、初期化しない
+		Image image{ info.width, info.height, Uninitialized };
+
+		if (not info.interlaced)
+		{
+			const size_t strideBytes = info.strideBytes(info.width);
+
+			// フィルタは上の行を参照するので、先頭の行から順に復元する
+			if (not UnfilterRows(filtered.data(), strideBytes, info.height, bpp, zeroRow.data()))
+			{
+				return{};
+			}
+
+			image.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						ConvertRow(info, (filtered.data() + ((strideBytes + 1) * y) + 1), image[y], info.width);
+					}
+				}, static_cast<int32>(std::max<size_t>(1, (TaskSizeBytes / (strideBytes + 1)))));
+
+			return image;
+		}
+
+		// インターレースの場合は、パスごとに復元し、各ピクセルを画像上の位置に配置する
+		uint8* pPass = filtered.data();
+
+		for (const Adam7Pass& pass : Adam7Passes)
+		{
+			const int32 passWidth = GetPassLength(info.width, pass.x, pass.dx);
+			const int32 passHeight = GetPassLength(info.height, pass.y, pass.dy);
+
+			if ((passWidth == 0) || (passHeight == 0))
+			{
+				continue;
+			}
+
+			const size_t strideBytes = info.strideBytes(passWidth);
+
+			if (not UnfilterRows(pPass, strideBytes, passHeight, bpp, zeroRow.data()))
+			{
+				return{};
+			}
+
+			ParallelFor(0, static_cast<size_t>(passHeight), [&](const size_t begin, const size_t end)
+				{
+					std::vector<Color> row(passWidth);
+
+					for (size_t i = begin; i < end; ++i)
+					{
+						ConvertRow(info, (pPass + ((strideBytes + 1) * i) + 1), row.data(), passWidth);
+
+						Color* pDst = image[static_cast<int32>(pass.y + (pass.dy * i))];
+
+						for (int32 x = 0; x < passWidth; ++x)
+						{
+							pDst[pass.x + (pass.dx * x)] = row[x];
+						}
+					}
+				}, std::max<size_t>(1, (TaskSizeBytes / (strideBytes + 1))));
+
+			pPass += ((strideBytes + 1) * passHeight);
+		}
+
+		return image;
+	}
+
+	bool SavePNG(const Image& image, const std::string_view path, const CompressionLevel level, const PNGFormat format)
+	{
+		return SavePNG(image.view(), path, level, format);
+	}
+
+	bool SavePNG(const ConstImageView& image, const std::string_view path, const CompressionLevel level, const PNGFormat format)
+	{
+		const std::vector<std::byte> data = EncodePNG(image, level, format);
+
+		if (data.empty())
+		{
+			return false;
+		}
+
+		BinaryFileWriter writer{ path };
+
+		if (not writer.isOpen())
+		{
+			return false;
+		}
+
+		writer.write(data.data(), data.size());
+		return true;
+	}
+
+	std::vector<std::byte> EncodePNG(const ConstImageView& image, const CompressionLevel level, const PNGFormat format)
+	{
+		if (image.isEmpty())
+		{
+			return{};
+		}
+
+		const std::vector<uint8> compressed = ZlibCompress(FilterRows(image, format), level);
+
+		// IHDR: 幅、高さ、ビット深度 8、色の種類、圧縮方式 0、フィルタ方式 0、インターレースなし
+		std::array<uint8, 13> header{};
+		{
+			const uint32 width = static_cast<uint32>(image.width());
+			const uint32 height = static_cast<uint32>(image.height());
+
+			for (int32 i = 0; i < 4; ++i)
+			{
+				header[i] = static_cast<uint8>(width >> (24 - (i * 8)));
+				header[4 + i] = static_cast<uint8>(height >> (24 - (i * 8)));
+			}
+
+			header[8] = 8;
+			header[9] = static_cast<uint8>((format == PNGFormat::RGB24) ? PNGColorType::RGB : PNGColorType::RGBA);
+		}
+
+		// 圧縮したデータは、複数の IDAT チャンクに分けて格納する
+		const size_t numIDATChunks = std::max<size_t>(1, ((compressed.size() + (MaxIDATSize - 1)) / MaxIDATSize));
+		const size_t idatOffset = (Signature.size() + (12 + header.size()));
+
+		std::vector<std::byte> data(idatOffset + (12 * numIDATChunks) + compressed.size() + 12);
+		std::memcpy(data.data(), Signature.data(), Signature.size());
+		WriteChunk((data.data() + Signature.size()), MakeChunkType("IHDR"), header);
+
+		// 各チャンクの CRC は独立に計算できるので、並列に書き込む
+		ParallelFor(0, numIDATChunks, [&](const size_t begin, const size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					const size_t offset = (i * MaxIDATSize);
+					const size_t size = std::min(MaxIDATSize, (compressed.size() - offset));
+					WriteChunk((data.data() + idatOffset + (i * (12 + MaxIDATSize))), MakeChunkType("IDAT"), { (compressed.data() + offset), size });
+				}
+			});
 
+		WriteChunk((data.data() + data.size() - 12), MakeChunkType("IEND"), {});
+		return data;
+	}
 }
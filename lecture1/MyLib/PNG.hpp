@@ -1,7 +1,64 @@
 ﻿#pragma once
+#include <cstddef> // std::byte
+#include <string_view> // std::string_view
+#include <span> // std::span
+#include <vector> // std::vector
 #include "Common.hpp"
+#include "ImageView.hpp"
+#include "Deflate.hpp"
 
 namespace seccamp
 {
+	class Image; // 前方宣言
 
+	/// @brief PNG ファイルのピクセル形式
+	enum class PNGFormat : uint8
+	{
+		/// @brief 24 ビット（RGB）
+		RGB24,
+
+		/// @brief 32 ビット（RGBA）
+		RGBA32,
+	};
+
+	/// @brief 画像を PNG 形式で保存します。
+	/// @param image 保存する画像
+	/// @param path 保存先のパス
+	/// @param level 圧縮レベル
+	/// @param format ピクセル形式
+	/// @return 保存に成功した場合 true、それ以外の場合は false
+	bool SavePNG(const Image& image, std::string_view path, CompressionLevel level = CompressionLevel::Default, PNGFormat format = PNGFormat::RGBA32);
+
+	/// @brief ビューが参照する画像を PNG 形式で保存します。
+	/// @param image 保存する画像のビュー
+	/// @param path 保存先のパス
+	/// @param level 圧縮レベル
+	/// @param format ピクセル形式
+	/// @return 保存に成功した場合 true、それ以外の場合は false
+	bool SavePNG(const ConstImageView& image, std::string_view path, CompressionLevel level = CompressionLevel::Default, PNGFormat format = PNGFormat::RGBA32);
+
+	/// @brief 画像を PNG 形式のデータに変換します。
+	/// @param image 変換する画像のビュー
+	/// @param level 圧縮レベル
+	/// @param format ピクセル形式
+	/// @return PNG ファイルのデータ。画像が空の場合は空のデータ
+	/// @remark 各行のフィルタは、差分の絶対値の和が最も小さいものを SIMD 命令で選びます。フィルタと圧縮は、行のブロックごとに並列に行い、1 つの zlib ストリームにつなげます。
+	[[nodiscard]]
+	std::vector<std::byte> EncodePNG(const ConstImageView& image, CompressionLevel level = CompressionLevel::Default, PNGFormat format = PNGFormat::RGBA32);
+
+	/// @brief PNG 形式の画像を読み込みます。
+	/// @param path 読み込む画像のパス
+	/// @return 読み込んだ画像。読み込みに失敗した場合は空の画像
+	/// @remark すべての色の種類（グレースケール、RGB、パレット、グレースケール + アルファ、RGBA）とビット深度、インターレース、tRNS チャンクによる透過に対応しています。
+	/// 16 ビットの画像は 8 ビットに丸めて読み込みます。
+	/// @remark 処理を速くするため、CRC は検証しません。
+	[[nodiscard]]
+	Image LoadPNG(std::string_view path);
+
+	/// @brief メモリ上の PNG 形式のデータから画像を作成します。
+	/// @param data PNG ファイルのデータ
+	/// @return 作成した画像。データが壊れている場合や、対応していない形式の場合は空の画像
+	/// @remark フィルタの復元には、実行中の CPU に応じて SSE2, NEON またはスカラー実装が使われます。ピクセル形式の変換は行ごとに並列に行います。
+	[[nodiscard]]
+	Image DecodePNG(std::span<const std::byte> data);
 }
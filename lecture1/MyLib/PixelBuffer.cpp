@@ -0,0 +1,340 @@
+﻿#include <algorithm> // std::uninitialized_fill_n
+#include <cstring> // std::memcpy
+#include <memory> // std::unique_ptr
+#include <new> // ::operator new, std::align_val_t
+#include <utility> // std::exchange, std::swap
+#include "PixelBuffer.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief ピクセル数から、確保するサイズ（バイト）を求めます。
+		/// @param size ピクセル数
+		/// @return 確保するサイズ（バイト）。PixelAllocator::Alignment の倍数
+		[[nodiscard]]
+		constexpr size_t ToAllocationBytes(const size_t size) noexcept
+		{
+			return ((size * sizeof(Color) + (PixelAllocator::Alignment - 1)) / PixelAllocator::Alignment * PixelAllocator::Alignment);
+		}
+
+		std::mutex g_defaultAllocatorMutex;
+
+		std::shared_ptr<PixelAllocator> g_defaultAllocator;
+	}
+
+	////////////////////////////////////////////////////////////////
+	//
+	//	PixelAllocator
+	//
+	////////////////////////////////////////////////////////////////
+
+	void* PixelAllocator::allocate(const size_t sizeBytes)
+	{
+		return ::operator new(sizeBytes, std::align_val_t{ Alignment });
+	}
+
+	void PixelAllocator::deallocate(void* p, const size_t) noexcept
+	{
+		::operator delete(p, std::align_val_t{ Alignment });
+	}
+
+	std::shared_ptr<PixelAllocator> PixelAllocator::GetDefault()
+	{
+		std::lock_guard lock{ g_defaultAllocatorMutex };
+
+		if (not g_defaultAllocator)
+		{
+			g_defaultAllocator = std::make_shared<PixelAllocator>();
+		}
+
+		return g_defaultAllocator;
+	}
+
+	void PixelAllocator::SetDefault(std::shared_ptr<PixelAllocator> allocator)
+	{
+		std::lock_guard lock{ g_defaultAllocatorMutex };
+
+		g_defaultAllocator = std::move(allocator);
+	}
+
+	////////////////////////////////////////////////////////////////
+	//
+	//	PixelBufferPool
+	//
+	////////////////////////////////////////////////////////////////
+
+	PixelBufferPool::PixelBufferPool(const size_t maxCachedBytes)
+		: m_maxCachedBytes{ maxCachedBytes } {}
+
+	PixelBufferPool::~PixelBufferPool()
+	{
+		release();
+	}
+
+	void* PixelBufferPool::allocate(const size_t sizeBytes)
+	{
+		{
+			std::lock_guard lock{ m_mutex };
+
+			if (auto it = m_freeBlocks.find(sizeBytes);
+				(it != m_freeBlocks.end()) && (not it->second.empty()))
+			{
+				void* p = it->second.back();
+				it->second.pop_back();
+				m_cachedBytes -= sizeBytes;
+				++m_numReused;
+				return p;
+			}
+		}
+
+		return PixelAllocator::allocate(sizeBytes);
+	}
+
+	void PixelBufferPool::deallocate(void* p, const size_t sizeBytes) noexcept
+	{
+		{
+			std::lock_guard lock{ m_mutex };
+
+			if ((m_cachedBytes + sizeBytes) <= m_maxCachedBytes)
+			{
+				try
+				{
+					m_freeBlocks[sizeBytes].push_back(p);
+					m_cachedBytes += sizeBytes;
+					return;
+				}
+				catch (...)
+				{
+					// 保持できない場合は解放する
+				}
+			}
+		}
+
+		PixelAllocator::deallocate(p, sizeBytes);
+	}
+
+	void PixelBufferPool::release() noexcept
+	{
+		std::lock_guard lock{ m_mutex };
+
+		for (auto& [sizeBytes, blocks] : m_freeBlocks)
+		{
+			for (void* p : blocks)
+			{
+				PixelAllocator::deallocate(p, sizeBytes);
+			}
+		}
+
+		m_freeBlocks.clear();
+
+		m_cachedBytes = 0;
+	}
+
+	size_t PixelBufferPool::cachedBytes() const noexcept
+	{
+		std::lock_guard lock{ m_mutex };
+
+		return m_cachedBytes;
+	}
+
+	size_t PixelBufferPool::numReused() const noexcept
+	{
+		std::lock_guard lock{ m_mutex };
+
+		return m_numReused;
+	}
+
+	////////////////////////////////////////////////////////////////
+	//
+	//	PixelBuffer
+	//
+	////////////////////////////////////////////////////////////////
+
+	PixelBuffer::PixelBuffer(const size_t size)
+	{
+		resizeUninitialized(size);
+	}
+
+	PixelBuffer::PixelBuffer(const size_t size, const Color& color)
+		: PixelBuffer(size)
+	{
+		std::uninitialized_fill_n(m_data, m_size, color);
+	}
+
+	PixelBuffer::PixelBuffer(const PixelBuffer& other)
+	{
+		if (other.m_copyOnWrite)
+		{
+			// ピクセルをコピーせず、メモリを共有する
+			m_copyOnWrite = true;
+
+			if (other.m_refCount)
+			{
+				other.m_refCount->fetch_add(1, std::memory_order_relaxed);
+				m_data = other.m_data;
+				m_size = other.m_size;
+				m_capacity = other.m_capacity;
+				m_allocator = other.m_allocator;
+				m_refCount = other.m_refCount;
+			}
+
+			return;
+		}
+
+		resizeUninitialized(other.m_size);
+
+		if (m_size)
+		{
+			std::memcpy(m_data, other.m_data, (m_size * sizeof(Color)));
+		}
+	}
+
+	PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+		: m_data{ std::exchange(other.m_data, nullptr) }
+		, m_size{ std::exchange(other.m_size, 0) }
+		, m_capacity{ std::exchange(other.m_capacity, 0) }
+		, m_allocator{ std::move(other.m_allocator) }
+		, m_refCount{ std::exchange(other.m_refCount, nullptr) }
+		, m_copyOnWrite{ other.m_copyOnWrite } {}
+
+	PixelBuffer::~PixelBuffer()
+	{
+		clear();
+	}
+
+	PixelBuffer& PixelBuffer::operator =(const PixelBuffer& other)
+	{
+		if (this != &other)
+		{
+			// コピーオンライトの場合は、コピーコンストラクタと同じくコピー元の設定に合わせる
+			if (m_copyOnWrite || other.m_copyOnWrite)
+			{
+				PixelBuffer{ other }.swap(*this);
+				return *this;
+			}
+
+			// 容量が足りる場合は再確保しない
+			resizeUninitialized(other.m_size);
+
+			if (m_size)
+			{
+				std::memcpy(m_data, other.m_data, (m_size * sizeof(Color)));
+			}
+		}
+
+		return *this;
+	}
+
+	PixelBuffer& PixelBuffer::operator =(PixelBuffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			PixelBuffer{ std::move(other) }.swap(*this);
+		}
+
+		return *this;
+	}
+
+	void PixelBuffer::resizeUninitialized(const size_t size)
+	{
+		// 共有しているメモリは変更できないので、新しく確保する
+		if ((size <= m_capacity) && (not isShared()))
+		{
+			m_size = size;
+			return;
+		}
+
+		clear();
+
+		if (size == 0)
+		{
+			return;
+		}
+
+		std::unique_ptr<std::atomic<size_t>> refCount;
+
+		if (m_copyOnWrite)
+		{
+			refCount = std::make_unique<std::atomic<size_t>>(1);
+		}
+
+		std::shared_ptr<PixelAllocator> allocator = PixelAllocator::GetDefault();
+		const size_t sizeBytes = ToAllocationBytes(size);
+
+		m_data = static_cast<Color*>(allocator->allocate(sizeBytes));
+		m_size = size;
+		m_capacity = (sizeBytes / sizeof(Color));
+		m_allocator = std::move(allocator);
+		m_refCount = refCount.release();
+	}
+
+	void PixelBuffer::clear() noexcept
+	{
+		release();
+	}
+
+	void PixelBuffer::swap(PixelBuffer& other) noexcept
+	{
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+		std::swap(m_capacity, other.m_capacity);
+		m_allocator.swap(other.m_allocator);
+		std::swap(m_refCount, other.m_refCount);
+		std::swap(m_copyOnWrite, other.m_copyOnWrite);
+	}
+
+	void PixelBuffer::setCopyOnWrite(const bool enabled)
+	{
+		if (enabled == m_copyOnWrite)
+		{
+			return;
+		}
+
+		if (enabled)
+		{
+			if (m_data)
+			{
+				m_refCount = new std::atomic<size_t>(1);
+			}
+		}
+		else
+		{
+			// 単独で所有してから、参照カウントを破棄する
+			detach();
+			delete m_refCount;
+			m_refCount = nullptr;
+		}
+
+		m_copyOnWrite = enabled;
+	}
+
+	void PixelBuffer::detachShared()
+	{
+		PixelBuffer buffer{ m_size };
+		buffer.setCopyOnWrite(true);
+
+		if (m_size)
+		{
+			std::memcpy(buffer.m_data, m_data, (m_size * sizeof(Color)));
+		}
+
+		buffer.swap(*this);
+	}
+
+	void PixelBuffer::release() noexcept
+	{
+		// 共有している場合は、最後の参照だけがメモリを解放する
+		if (m_data && ((not m_refCount) || (m_refCount->fetch_sub(1, std::memory_order_acq_rel) == 1)))
+		{
+			delete m_refCount;
+			m_allocator->deallocate(m_data, (m_capacity * sizeof(Color)));
+		}
+
+		m_data = nullptr;
+		m_size = 0;
+		m_capacity = 0;
+		m_allocator.reset();
+		m_refCount = nullptr;
+	}
+}
@@ -0,0 +1,260 @@
+﻿#pragma once
+#include <atomic> // std::atomic
+#include <memory> // std::shared_ptr
+#include <mutex> // std::mutex
+#include <unordered_map> // std::unordered_map
+#include <vector> // std::vector
+#include "Common.hpp"
+#include "Color.hpp"
+
+namespace seccamp
+{
+	/// @brief ピクセルのメモリを確保・解放するクラスの基底クラス
+	/// @remark PixelAllocator::SetDefault() で、画像が使う既定のアロケータを差し替えられます。
+	class PixelAllocator
+	{
+	public:
+
+		/// @brief 確保するメモリのアラインメント（バイト）。キャッシュラインと AVX-512 のレジスタの大きさに合わせる
+		static constexpr size_t Alignment = 64;
+
+		virtual ~PixelAllocator() = default;
+
+		/// @brief メモリを確保します。
+		/// @param sizeBytes 確保するサイズ（バイト）。Alignment の倍数
+		/// @return Alignment バイトにアラインメントされたメモリの先頭ポインタ
+		/// @throw std::bad_alloc 確保に失敗した場合
+		[[nodiscard]]
+		virtual void* allocate(size_t sizeBytes);
+
+		/// @brief allocate() で確保したメモリを解放します。
+		/// @param p 解放するメモリの先頭ポインタ
+		/// @param sizeBytes allocate() に渡したサイズ（バイト）
+		virtual void deallocate(void* p, size_t sizeBytes) noexcept;
+
+		/// @brief 画像が使う既定のアロケータを返します。
+		/// @return 既定のアロケータ
+		[[nodiscard]]
+		static std::shared_ptr<PixelAllocator> GetDefault();
+
+		/// @brief 画像が使う既定のアロケータを設定します。
+		/// @param allocator 新しい既定のアロケータ。nullptr の場合は標準のアロケータに戻します
+		/// @remark 設定前に確保されたメモリは、それを確保したアロケータに返却されます。
+		static void SetDefault(std::shared_ptr<PixelAllocator> allocator);
+	};
+
+	/// @brief 解放されたメモリを保持し、同じサイズの確保に再利用するアロケータ
+	/// @remark 同じ大きさの画像を繰り返し作成・破棄する場合に、メモリの確保とページフォルトのコストを削減します。スレッドセーフです。
+	class PixelBufferPool : public PixelAllocator
+	{
+	public:
+
+		/// @brief アロケータを作成します。
+		/// @param maxCachedBytes 再利用のために保持するメモリの合計の上限（バイト）
+		[[nodiscard]]
+		explicit PixelBufferPool(size_t maxCachedBytes = (size_t{ 256 } << 20));
+
+		~PixelBufferPool() override;
+
+		[[nodiscard]]
+		void* allocate(size_t sizeBytes) override;
+
+		void deallocate(void* p, size_t sizeBytes) noexcept override;
+
+		/// @brief 再利用のために保持しているメモリをすべて解放します。
+		void release() noexcept;
+
+		/// @brief 再利用のために保持しているメモリの合計（バイト）を返します。
+		/// @return 保持しているメモリの合計（バイト）
+		[[nodiscard]]
+		size_t cachedBytes() const noexcept;
+
+		/// @brief 保持していたメモリを再利用した回数を返します。
+		/// @return 再利用した回数
+		[[nodiscard]]
+		size_t numReused() const noexcept;
+
+	private:
+
+		mutable std::mutex m_mutex;
+
+		// サイズごとの、再利用できるメモリ
+		std::unordered_map<size_t, std::vector<void*>> m_freeBlocks;
+
+		size_t m_maxCachedBytes = 0;
+
+		size_t m_cachedBytes = 0;
+
+		size_t m_numReused = 0;
+	};
+
+	/// @brief 画像のピクセルを格納する、アラインメントされた配列
+	/// @remark 先頭は PixelAllocator::Alignment バイトにアラインメントされ、確保するサイズも Alignment バイトの倍数に切り上げられます。
+	/// そのため、SIMD 命令で末尾のピクセルを処理するときに、最後のピクセルを含む Alignment バイトの範囲を読み書きしても安全です。
+	/// @remark コピーオンライトを有効にした配列のコピーは、ピクセルをコピーせずに参照カウント付きのメモリを共有します。
+	/// 共有中の配列は、最初に書き込み可能なアクセス（data(), begin(), end() など）をしたときにピクセルをコピーします。
+	class PixelBuffer
+	{
+	public:
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		PixelBuffer() = default;
+
+		/// @brief 初期化せずに配列を作成します。
+		/// @param size ピクセル数
+		/// @remark ピクセルの値は不定です。すべてのピクセルを上書きする場合に使います。
+		[[nodiscard]]
+		explicit PixelBuffer(size_t size);
+
+		/// @brief 配列を作成します。
+		/// @param size ピクセル数
+		/// @param color ピクセルの初期値
+		[[nodiscard]]
+		PixelBuffer(size_t size, const Color& color);
+
+		[[nodiscard]]
+		PixelBuffer(const PixelBuffer& other);
+
+		[[nodiscard]]
+		PixelBuffer(PixelBuffer&& other) noexcept;
+
+		~PixelBuffer();
+
+		PixelBuffer& operator =(const PixelBuffer& other);
+
+		PixelBuffer& operator =(PixelBuffer&& other) noexcept;
+
+		/// @brief ピクセル数を返します。
+		/// @return ピクセル数
+		[[nodiscard]]
+		size_t size() const noexcept
+		{
+			return m_size;
+		}
+
+		/// @brief 再確保せずに格納できるピクセル数を返します。
+		/// @return 再確保せずに格納できるピクセル数
+		[[nodiscard]]
+		size_t capacity() const noexcept
+		{
+			return m_capacity;
+		}
+
+		/// @brief 配列が空であるかを返します。
+		/// @return 配列が空である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool empty() const noexcept
+		{
+			return (m_size == 0);
+		}
+
+		/// @brief 書き込み可能な先頭ポインタを返します。
+		/// @return 先頭ポインタ
+		/// @remark 他の配列とメモリを共有している場合は、先にピクセルをコピーします。
+		[[nodiscard]]
+		Color* data()
+		{
+			detach();
+			return m_data;
+		}
+
+		[[nodiscard]]
+		const Color* data() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]]
+		Color* begin()
+		{
+			detach();
+			return m_data;
+		}
+
+		[[nodiscard]]
+		Color* end()
+		{
+			detach();
+			return (m_data + m_size);
+		}
+
+		[[nodiscard]]
+		const Color* begin() const noexcept
+		{
+			return m_data;
+		}
+
+		[[nodiscard]]
+		const Color* end() const noexcept
+		{
+			return (m_data + m_size);
+		}
+
+		/// @brief ピクセル数を変更します。追加されたピクセルは初期化されません。
+		/// @param size 新しいピクセル数
+		/// @remark 容量が足りない場合は再確保し、既存のピクセルの値は失われます。
+		void resizeUninitialized(size_t size);
+
+		/// @brief 配列を空にし、メモリを解放します。
+		void clear() noexcept;
+
+		/// @brief 2 つの配列をスワップします。
+		/// @param other もう一方の配列
+		void swap(PixelBuffer& other) noexcept;
+
+		/// @brief コピーオンライトの有効・無効を設定します。
+		/// @param enabled 有効にする場合 true, 無効にする場合 false
+		/// @remark 有効な配列のコピーは、メモリを共有し、コピーオンライトも有効になります。無効にする場合は、先に detach() します。
+		void setCopyOnWrite(bool enabled);
+
+		/// @brief コピーオンライトが有効であるかを返します。
+		/// @return 有効である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isCopyOnWrite() const noexcept
+		{
+			return m_copyOnWrite;
+		}
+
+		/// @brief 他の配列とメモリを共有しているかを返します。
+		/// @return 共有している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isShared() const noexcept
+		{
+			// acquire により、共有をやめた他のスレッドのアクセスは、この後の書き込みより前に完了している
+			return (m_refCount && (1 < m_refCount->load(std::memory_order_acquire)));
+		}
+
+		/// @brief 他の配列とメモリを共有している場合は、ピクセルをコピーして単独で所有します。
+		/// @remark 共有していない場合は何もしません。
+		void detach()
+		{
+			if (isShared()) [[unlikely]]
+			{
+				detachShared();
+			}
+		}
+
+	private:
+
+		/// @brief 共有しているメモリのピクセルをコピーし、単独で所有します。
+		void detachShared();
+
+		/// @brief メモリの参照を手放します。最後の参照の場合はメモリを解放します。
+		void release() noexcept;
+
+		Color* m_data = nullptr;
+
+		size_t m_size = 0;
+
+		size_t m_capacity = 0;
+
+		// メモリを確保したアロケータ
+		std::shared_ptr<PixelAllocator> m_allocator;
+
+		// メモリを共有している配列の数。コピーオンライトが有効で、メモリを確保している場合だけ存在する
+		std::atomic<size_t>* m_refCount = nullptr;
+
+		bool m_copyOnWrite = false;
+	};
+}
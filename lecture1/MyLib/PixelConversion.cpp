@@ -0,0 +1,1382 @@
+﻿#include "PixelConversion.hpp"
+#include "Color.hpp"
+#include "CPU.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_shuffle_epi8, _mm_mulhi_epu16, _mm256_shuffle_epi8, _mm256_permutevar8x32_epi32
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vld3q_u8, vld4q_u8, vst3q_u8, vst4q_u8, vzipq_u8, vcvtq_f32_u32
+#endif
+
+namespace seccamp
+{
+	// Color をバイト列として扱うため、RGBA の順に 4 バイトで並んでいることを確認
+	static_assert(sizeof(Color) == 4);
+
+	namespace
+	{
+		using RGBAToBGRFunction = void(*)(const Color*, uint8*, size_t);
+
+		using RGBAToRGBFunction = void(*)(const Color*, uint8*, size_t);
+
+		using BGRToRGBAFunction = void(*)(const uint8*, Color*, size_t);
+
+		using RGBToRGBAFunction = void(*)(const uint8*, Color*, size_t);
+
+		using GrayToRGBAFunction = void(*)(const uint8*, Color*, size_t);
+
+		using GrayAlphaToRGBAFunction = void(*)(const uint8*, Color*, size_t);
+
+		using SwapRBFunction = void(*)(const uint8*, uint8*, size_t);
+
+		using DeinterleaveFunction = void(*)(const Color*, uint8*, uint8*, uint8*, uint8*, size_t);
+
+		using InterleaveFunction = void(*)(const uint8*, const uint8*, const uint8*, const uint8*, Color*, size_t);
+
+		using Uint8ToUint16Function = void(*)(const uint8*, uint16*, size_t);
+
+		using Uint16ToUint8Function = void(*)(const uint16*, uint8*, size_t);
+
+		using Uint8ToFloatFunction = void(*)(const uint8*, float*, size_t);
+
+		using FloatToUint8Function = void(*)(const float*, uint8*, size_t);
+
+		/// @brief uint8 の値を [0.0, 1.0] の float に変換するときの係数
+		constexpr float Uint8ToFloatScale = (1.0f / 255.0f);
+
+		void RGBAToBGR_Scalar(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				*dst++ = src[i].b;
+				*dst++ = src[i].g;
+				*dst++ = src[i].r;
+			}
+		}
+
+		void RGBAToRGB_Scalar(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				*dst++ = src[i].r;
+				*dst++ = src[i].g;
+				*dst++ = src[i].b;
+			}
+		}
+
+		void BGRToRGBA_Scalar(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i].b = *src++;
+				dst[i].g = *src++;
+				dst[i].r = *src++;
+				dst[i].a = 255;
+			}
+		}
+
+		void RGBToRGBA_Scalar(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i].r = *src++;
+				dst[i].g = *src++;
+				dst[i].b = *src++;
+				dst[i].a = 255;
+			}
+		}
+
+		void GrayToRGBA_Scalar(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = Color{ src[i], src[i], src[i], 255 };
+			}
+		}
+
+		void GrayAlphaToRGBA_Scalar(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const uint8 gray = *src++;
+				dst[i] = Color{ gray, gray, gray, *src++ };
+			}
+		}
+
+		void SwapRB_Scalar(const uint8* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				// src と dst が同じ場合でも正しく動くように、先に読み込む
+				const uint8 c0 = src[0];
+				const uint8 c1 = src[1];
+				const uint8 c2 = src[2];
+				const uint8 c3 = src[3];
+
+				dst[0] = c2;
+				dst[1] = c1;
+				dst[2] = c0;
+				dst[3] = c3;
+
+				src += 4;
+				dst += 4;
+			}
+		}
+
+		void Deinterleave_Scalar(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				r[i] = src[i].r;
+				g[i] = src[i].g;
+				b[i] = src[i].b;
+				a[i] = src[i].a;
+			}
+		}
+
+		void Interleave_Scalar(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = Color{ r[i], g[i], b[i], a[i] };
+			}
+		}
+
+		void Uint8ToUint16_Scalar(const uint8* src, uint16* dst, const size_t numPixels) noexcept
+		{
+			// x * 257 で [0, 255] を [0, 65535] に対応させる
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = static_cast<uint16>(src[i] * 257);
+			}
+		}
+
+		void Uint16ToUint8_Scalar(const uint16* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// x / 257 を四捨五入する。SIMD 実装と同じく 16 ビットの範囲で計算できる式を使う
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const uint32 t = ((src[i] * 0xFF01u) >> 16);
+				dst[i] = static_cast<uint8>((t + 128) >> 8);
+			}
+		}
+
+		void Uint8ToFloat_Scalar(const uint8* src, float* dst, const size_t numPixels) noexcept
+		{
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				dst[i] = (src[i] * Uint8ToFloatScale);
+			}
+		}
+
+		void FloatToUint8_Scalar(const float* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// [0.0, 1.0] の範囲外は飽和させ、NaN は 0 にする
+			for (size_t i = 0; i < numPixels; ++i)
+			{
+				const float x = (src[i] * 255.0f + 0.5f);
+				dst[i] = ((0.0f < x) ? ((x < 255.0f) ? static_cast<uint8>(x) : 255) : 0);
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		SECCAMP_TARGET_SSSE3
+		void SwapRB_SSSE3(const uint8* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 各ピクセルの 0 バイト目と 2 バイト目を入れ替える
+			const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+			size_t i = 0;
+
+			for (; (i + 4) <= numPixels; i += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (i * 4)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (i * 4)), _mm_shuffle_epi8(v, shuffle));
+			}
+
+			SwapRB_Scalar((src + (i * 4)), (dst + (i * 4)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void SwapRB_AVX2(const uint8* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			const __m256i shuffle = _mm256_setr_epi8(
+				2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+				2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (i * 4)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i * 4)), _mm256_shuffle_epi8(v, shuffle));
+			}
+
+			SwapRB_SSSE3((src + (i * 4)), (dst + (i * 4)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void RGBAToBGR_SSSE3(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 4 ピクセル（16 バイト）の RGBA を 12 バイトの BGR に並べ替える
+			const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+			size_t i = 0;
+
+			// 16 ピクセル（64 バイト）ずつ 48 バイトに変換する
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + i);
+				const __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 0), shuffle);
+				const __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 1), shuffle);
+				const __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 2), shuffle);
+				const __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 3), shuffle);
+
+				// 12 バイトずつ詰めて 16 バイト × 3 にする
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + (i * 3));
+				_mm_storeu_si128(pDst + 0, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+				_mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+				_mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+			}
+
+			RGBAToBGR_Scalar((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void RGBAToRGB_SSSE3(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 4 ピクセル（16 バイト）の RGBA からアルファ成分を除いて 12 バイトに詰める
+			const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+			size_t i = 0;
+
+			// 16 ピクセル（64 バイト）ずつ 48 バイトに変換する
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + i);
+				const __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 0), shuffle);
+				const __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 1), shuffle);
+				const __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 2), shuffle);
+				const __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 3), shuffle);
+
+				// 12 バイトずつ詰めて 16 バイト × 3 にする
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + (i * 3));
+				_mm_storeu_si128(pDst + 0, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+				_mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+				_mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+			}
+
+			RGBAToRGB_Scalar((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void BGRToRGBA_SSSE3(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			// 12 バイトの BGR を 4 ピクセル（16 バイト）の RGBA に並べ替える
+			const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+			const __m128i alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// 48 バイトずつ 16 ピクセル（64 バイト）に変換する
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + (i * 3));
+				const __m128i a = _mm_loadu_si128(pSrc + 0);
+				const __m128i b = _mm_loadu_si128(pSrc + 1);
+				const __m128i c = _mm_loadu_si128(pSrc + 2);
+
+				// 各 16 バイトの先頭 12 バイトに 4 ピクセル分の BGR が来るようにずらす
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + i);
+				_mm_storeu_si128(pDst + 0, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+				_mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+				_mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+				_mm_storeu_si128(pDst + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+			}
+
+			BGRToRGBA_Scalar((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void RGBToRGBA_SSSE3(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			// 12 バイトの RGB を 4 ピクセル（16 バイト）の RGBA に並べ替える
+			const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const __m128i alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// 48 バイトずつ 16 ピクセル（64 バイト）に変換する
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + (i * 3));
+				const __m128i a = _mm_loadu_si128(pSrc + 0);
+				const __m128i b = _mm_loadu_si128(pSrc + 1);
+				const __m128i c = _mm_loadu_si128(pSrc + 2);
+
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + i);
+				_mm_storeu_si128(pDst + 0, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+				_mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+				_mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+				_mm_storeu_si128(pDst + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+			}
+
+			RGBToRGBA_Scalar((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void RGBAToBGR_AVX2(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 各 128 ビットレーンで 4 ピクセルを 12 バイトに並べ替え、2 つのレーンの結果を下位 24 バイトに詰める
+			const __m256i shuffle = _mm256_setr_epi8(
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+			const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+			size_t i = 0;
+
+			// 32 バイト書き込んで 24 バイト進むので、書き込み先の終端を越えないように 3 ピクセル分の余裕を残す
+			for (; (i + 11) <= numPixels; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				v = _mm256_shuffle_epi8(v, shuffle);
+				v = _mm256_permutevar8x32_epi32(v, permute);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i * 3)), v);
+			}
+
+			RGBAToBGR_SSSE3((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void RGBAToRGB_AVX2(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 各 128 ビットレーンで 4 ピクセルを 12 バイトに詰め、2 つのレーンの結果を下位 24 バイトに詰める
+			const __m256i shuffle = _mm256_setr_epi8(
+				0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+				0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+			const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+			size_t i = 0;
+
+			// 32 バイト書き込んで 24 バイト進むので、書き込み先の終端を越えないように 3 ピクセル分の余裕を残す
+			for (; (i + 11) <= numPixels; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				v = _mm256_shuffle_epi8(v, shuffle);
+				v = _mm256_permutevar8x32_epi32(v, permute);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i * 3)), v);
+			}
+
+			RGBAToRGB_SSSE3((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void BGRToRGBA_AVX2(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m256i shuffle = _mm256_setr_epi8(
+				2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+				2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+			const __m256i alpha = _mm256_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// 28 バイト読み込んで 24 バイト進むので、読み込み元の終端を越えないように 2 ピクセル分の余裕を残す
+			for (; (i + 10) <= numPixels; i += 8)
+			{
+				const uint8* pSrc = (src + (i * 3));
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 12));
+
+				__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+				v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+			}
+
+			BGRToRGBA_SSSE3((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void RGBToRGBA_AVX2(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m256i shuffle = _mm256_setr_epi8(
+				0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+				0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const __m256i alpha = _mm256_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// 28 バイト読み込んで 24 バイト進むので、読み込み元の終端を越えないように 2 ピクセル分の余裕を残す
+			for (; (i + 10) <= numPixels; i += 8)
+			{
+				const uint8* pSrc = (src + (i * 3));
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 12));
+
+				__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+				v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+			}
+
+			RGBToRGBA_SSSE3((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		void GrayToRGBA_SSE2(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+
+			size_t i = 0;
+
+			// 16 ピクセルずつ、各バイトを 4 回繰り返して RGBA にする
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i lo = _mm_unpacklo_epi8(v, v);
+				const __m128i hi = _mm_unpackhi_epi8(v, v);
+
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + i);
+				_mm_storeu_si128(pDst + 0, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+				_mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+				_mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+				_mm_storeu_si128(pDst + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+			}
+
+			GrayToRGBA_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void GrayAlphaToRGBA_SSE2(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			const __m128i grayMask = _mm_set1_epi32(0x00FF00FF);
+			const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+
+			size_t i = 0;
+
+			// 8 ピクセル（16 バイト）ずつ変換する
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (i * 2)));
+
+				for (int32 k = 0; k < 2; ++k)
+				{
+					// 32 ビットの各要素を (G, A, G, A) にしてから、(G, G, G, A) に組み替える
+					const __m128i ga = ((k == 0) ? _mm_unpacklo_epi16(v, v) : _mm_unpackhi_epi16(v, v));
+					const __m128i gray = _mm_and_si128(ga, grayMask);
+					const __m128i rgb = _mm_and_si128(_mm_or_si128(gray, _mm_slli_epi32(gray, 8)), rgbMask);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + (k * 4)), _mm_or_si128(rgb, _mm_andnot_si128(rgbMask, ga)));
+				}
+			}
+
+			GrayAlphaToRGBA_Scalar((src + (i * 2)), (dst + i), (numPixels - i));
+		}
+
+		void Interleave_SSE2(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+				const __m128i vg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g + i));
+				const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+				const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+
+				// RG と BA の組を作り、16 ビット単位で交互に並べると RGBA になる
+				const __m128i rgLo = _mm_unpacklo_epi8(vr, vg);
+				const __m128i rgHi = _mm_unpackhi_epi8(vr, vg);
+				const __m128i baLo = _mm_unpacklo_epi8(vb, va);
+				const __m128i baHi = _mm_unpackhi_epi8(vb, va);
+
+				__m128i* pDst = reinterpret_cast<__m128i*>(dst + i);
+				_mm_storeu_si128(pDst + 0, _mm_unpacklo_epi16(rgLo, baLo));
+				_mm_storeu_si128(pDst + 1, _mm_unpackhi_epi16(rgLo, baLo));
+				_mm_storeu_si128(pDst + 2, _mm_unpacklo_epi16(rgHi, baHi));
+				_mm_storeu_si128(pDst + 3, _mm_unpackhi_epi16(rgHi, baHi));
+			}
+
+			Interleave_Scalar((r + i), (g + i), (b + i), (a + i), (dst + i), (numPixels - i));
+		}
+
+		void Uint8ToUint16_SSE2(const uint8* src, uint16* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				// 同じバイトを 2 つ並べると x * 257 になる
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(v, v));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(v, v));
+			}
+
+			Uint8ToUint16_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 8 個の uint16 の値 x について、x / 257 を四捨五入した値を求めます。
+		[[nodiscard]]
+		inline __m128i DivideBy257_SSE2(const __m128i v) noexcept
+		{
+			const __m128i t = _mm_mulhi_epu16(v, _mm_set1_epi16(static_cast<int16>(0xFF01)));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_set1_epi16(128)), 8);
+		}
+
+		void Uint16ToUint8_SSE2(const uint16* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i lo = DivideBy257_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+				const __m128i hi = DivideBy257_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+			}
+
+			Uint16ToUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Uint8ToFloat_SSE2(const uint8* src, float* dst, const size_t numPixels) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scale = _mm_set1_ps(Uint8ToFloatScale);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i lo = _mm_unpacklo_epi8(v, zero);
+				const __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+				_mm_storeu_ps((dst + i), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+				_mm_storeu_ps((dst + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+				_mm_storeu_ps((dst + i + 8), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+				_mm_storeu_ps((dst + i + 12), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+			}
+
+			Uint8ToFloat_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 4 個の float の値 x を、[0, 255] に飽和させた round(x * 255) の 32 ビット整数にします。
+		[[nodiscard]]
+		inline __m128i FloatToInt32_SSE2(const __m128 v) noexcept
+		{
+			const __m128 x = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+
+			// _mm_max_ps は一方が NaN の場合に第 2 引数を返すので、NaN は 0 になる
+			const __m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+			return _mm_cvttps_epi32(clamped);
+		}
+
+		void FloatToUint8_SSE2(const float* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i c0 = FloatToInt32_SSE2(_mm_loadu_ps(src + i));
+				const __m128i c1 = FloatToInt32_SSE2(_mm_loadu_ps(src + i + 4));
+				const __m128i c2 = FloatToInt32_SSE2(_mm_loadu_ps(src + i + 8));
+				const __m128i c3 = FloatToInt32_SSE2(_mm_loadu_ps(src + i + 12));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3)));
+			}
+
+			FloatToUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_SSSE3
+		void Deinterleave_SSSE3(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, const size_t numPixels) noexcept
+		{
+			// 4 ピクセルの各成分を 4 バイトずつにまとめる（RRRR GGGG BBBB AAAA）
+			const __m128i shuffle = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m128i* pSrc = reinterpret_cast<const __m128i*>(src + i);
+				const __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 0), shuffle);
+				const __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 1), shuffle);
+				const __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 2), shuffle);
+				const __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(pSrc + 3), shuffle);
+
+				// 4 バイト単位の 4x4 行列を転置する
+				const __m128i rg01 = _mm_unpacklo_epi32(s0, s1);
+				const __m128i rg23 = _mm_unpacklo_epi32(s2, s3);
+				const __m128i ba01 = _mm_unpackhi_epi32(s0, s1);
+				const __m128i ba23 = _mm_unpackhi_epi32(s2, s3);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(r + i), _mm_unpacklo_epi64(rg01, rg23));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(g + i), _mm_unpackhi_epi64(rg01, rg23));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(b + i), _mm_unpacklo_epi64(ba01, ba23));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), _mm_unpackhi_epi64(ba01, ba23));
+			}
+
+			Deinterleave_Scalar((src + i), (r + i), (g + i), (b + i), (a + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Deinterleave_AVX2(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, const size_t numPixels) noexcept
+		{
+			const __m256i shuffle = _mm256_setr_epi8(
+				0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+				0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+
+			// 転置後の 4 バイト単位の並びは、レーンをまたいで 0, 2, 4, 6, 1, 3, 5, 7 番目のピクセル群の順になっている
+			const __m256i permute = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i* pSrc = reinterpret_cast<const __m256i*>(src + i);
+				const __m256i s0 = _mm256_shuffle_epi8(_mm256_loadu_si256(pSrc + 0), shuffle);
+				const __m256i s1 = _mm256_shuffle_epi8(_mm256_loadu_si256(pSrc + 1), shuffle);
+				const __m256i s2 = _mm256_shuffle_epi8(_mm256_loadu_si256(pSrc + 2), shuffle);
+				const __m256i s3 = _mm256_shuffle_epi8(_mm256_loadu_si256(pSrc + 3), shuffle);
+
+				const __m256i rg01 = _mm256_unpacklo_epi32(s0, s1);
+				const __m256i rg23 = _mm256_unpacklo_epi32(s2, s3);
+				const __m256i ba01 = _mm256_unpackhi_epi32(s0, s1);
+				const __m256i ba23 = _mm256_unpackhi_epi32(s2, s3);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(rg01, rg23), permute));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(g + i), _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(rg01, rg23), permute));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i), _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(ba01, ba23), permute));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(ba01, ba23), permute));
+			}
+
+			Deinterleave_SSSE3((src + i), (r + i), (g + i), (b + i), (a + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Interleave_AVX2(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i vr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + i));
+				const __m256i vg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g + i));
+				const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+
+				const __m256i rgLo = _mm256_unpacklo_epi8(vr, vg);
+				const __m256i rgHi = _mm256_unpackhi_epi8(vr, vg);
+				const __m256i baLo = _mm256_unpacklo_epi8(vb, va);
+				const __m256i baHi = _mm256_unpackhi_epi8(vb, va);
+
+				// 各レーンで作った 4 ピクセルの組は、0-3 | 16-19 のように 16 ピクセル離れているので、レーンを組み替える
+				const __m256i p0 = _mm256_unpacklo_epi16(rgLo, baLo);
+				const __m256i p1 = _mm256_unpackhi_epi16(rgLo, baLo);
+				const __m256i p2 = _mm256_unpacklo_epi16(rgHi, baHi);
+				const __m256i p3 = _mm256_unpackhi_epi16(rgHi, baHi);
+
+				__m256i* pDst = reinterpret_cast<__m256i*>(dst + i);
+				_mm256_storeu_si256(pDst + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+				_mm256_storeu_si256(pDst + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+				_mm256_storeu_si256(pDst + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+				_mm256_storeu_si256(pDst + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+			}
+
+			Interleave_SSE2((r + i), (g + i), (b + i), (a + i), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Uint8ToUint16_AVX2(const uint8* src, uint16* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(v, _mm256_slli_epi16(v, 8)));
+			}
+
+			Uint8ToUint16_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 16 個の uint16 の値 x について、x / 257 を四捨五入した値を求めます。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i DivideBy257_AVX2(const __m256i v) noexcept
+		{
+			const __m256i t = _mm256_mulhi_epu16(v, _mm256_set1_epi16(static_cast<int16>(0xFF01)));
+			return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_set1_epi16(128)), 8);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Uint16ToUint8_AVX2(const uint16* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i lo = DivideBy257_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+				const __m256i hi = DivideBy257_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16)));
+
+				// _mm256_packus_epi16 はレーンごとに詰めるので、64 ビット単位で並べ直す
+				const __m256i packed = _mm256_packus_epi16(lo, hi);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+			}
+
+			Uint16ToUint8_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		SECCAMP_TARGET_AVX2
+		void Uint8ToFloat_AVX2(const uint8* src, float* dst, const size_t numPixels) noexcept
+		{
+			const __m256 scale = _mm256_set1_ps(Uint8ToFloatScale);
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+				_mm256_storeu_ps((dst + i), _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+			}
+
+			Uint8ToFloat_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+		/// @brief 8 個の float の値 x を、[0, 255] に飽和させた round(x * 255) の 32 ビット整数にします。
+		[[nodiscard]]
+		SECCAMP_TARGET_AVX2
+		inline __m256i FloatToInt32_AVX2(const __m256 v) noexcept
+		{
+			const __m256 x = _mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+			const __m256 clamped = _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+			return _mm256_cvttps_epi32(clamped);
+		}
+
+		SECCAMP_TARGET_AVX2
+		void FloatToUint8_AVX2(const float* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			const __m256i permute = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+			size_t i = 0;
+
+			for (; (i + 32) <= numPixels; i += 32)
+			{
+				const __m256i c0 = FloatToInt32_AVX2(_mm256_loadu_ps(src + i));
+				const __m256i c1 = FloatToInt32_AVX2(_mm256_loadu_ps(src + i + 8));
+				const __m256i c2 = FloatToInt32_AVX2(_mm256_loadu_ps(src + i + 16));
+				const __m256i c3 = FloatToInt32_AVX2(_mm256_loadu_ps(src + i + 24));
+
+				// レーンごとに詰めた結果を、4 バイト単位で並べ直す
+				const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(c0, c1), _mm256_packs_epi32(c2, c3));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, permute));
+			}
+
+			FloatToUint8_SSE2((src + i), (dst + i), (numPixels - i));
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		void SwapRB_NEON(const uint8* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				uint8x16x4_t v = vld4q_u8(src + (i * 4));
+				const uint8x16_t t = v.val[0];
+				v.val[0] = v.val[2];
+				v.val[2] = t;
+				vst4q_u8((dst + (i * 4)), v);
+			}
+
+			SwapRB_Scalar((src + (i * 4)), (dst + (i * 4)), (numPixels - i));
+		}
+
+		void RGBAToBGR_NEON(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			// 16 ピクセルずつチャンネルごとに分解して、並べ替えて書き込む
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				const uint8x16x3_t bgr = { rgba.val[2], rgba.val[1], rgba.val[0] };
+				vst3q_u8((dst + (i * 3)), bgr);
+			}
+
+			RGBAToBGR_Scalar((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		void RGBAToRGB_NEON(const Color* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			// 16 ピクセルずつチャンネルごとに分解して、アルファ成分を除いて書き込む
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				const uint8x16x3_t rgb = { rgba.val[0], rgba.val[1], rgba.val[2] };
+				vst3q_u8((dst + (i * 3)), rgb);
+			}
+
+			RGBAToRGB_Scalar((src + i), (dst + (i * 3)), (numPixels - i));
+		}
+
+		void BGRToRGBA_NEON(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x3_t bgr = vld3q_u8(src + (i * 3));
+				const uint8x16x4_t rgba = { bgr.val[2], bgr.val[1], bgr.val[0], vdupq_n_u8(255) };
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			BGRToRGBA_Scalar((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		void RGBToRGBA_NEON(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x3_t rgb = vld3q_u8(src + (i * 3));
+				const uint8x16x4_t rgba = { rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(255) };
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			RGBToRGBA_Scalar((src + (i * 3)), (dst + i), (numPixels - i));
+		}
+
+		void GrayToRGBA_NEON(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16_t gray = vld1q_u8(src + i);
+				const uint8x16x4_t rgba = { gray, gray, gray, vdupq_n_u8(255) };
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			GrayToRGBA_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void GrayAlphaToRGBA_NEON(const uint8* src, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x2_t ga = vld2q_u8(src + (i * 2));
+				const uint8x16x4_t rgba = { ga.val[0], ga.val[0], ga.val[0], ga.val[1] };
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			GrayAlphaToRGBA_Scalar((src + (i * 2)), (dst + i), (numPixels - i));
+		}
+
+		void Deinterleave_NEON(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = vld4q_u8(reinterpret_cast<const uint8*>(src + i));
+				vst1q_u8((r + i), rgba.val[0]);
+				vst1q_u8((g + i), rgba.val[1]);
+				vst1q_u8((b + i), rgba.val[2]);
+				vst1q_u8((a + i), rgba.val[3]);
+			}
+
+			Deinterleave_Scalar((src + i), (r + i), (g + i), (b + i), (a + i), (numPixels - i));
+		}
+
+		void Interleave_NEON(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				const uint8x16x4_t rgba = { vld1q_u8(r + i), vld1q_u8(g + i), vld1q_u8(b + i), vld1q_u8(a + i) };
+				vst4q_u8(reinterpret_cast<uint8*>(dst + i), rgba);
+			}
+
+			Interleave_Scalar((r + i), (g + i), (b + i), (a + i), (dst + i), (numPixels - i));
+		}
+
+		void Uint8ToUint16_NEON(const uint8* src, uint16* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 16) <= numPixels; i += 16)
+			{
+				// 同じバイトを 2 つ並べると x * 257 になる
+				const uint8x16_t v = vld1q_u8(src + i);
+				const uint8x16x2_t vv = vzipq_u8(v, v);
+				vst1q_u16((dst + i), vreinterpretq_u16_u8(vv.val[0]));
+				vst1q_u16((dst + i + 8), vreinterpretq_u16_u8(vv.val[1]));
+			}
+
+			Uint8ToUint16_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Uint16ToUint8_NEON(const uint16* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				// vrshrn_n_u16 は 128 を足してから 8 ビット右シフトする
+				const uint16x8_t v = vld1q_u16(src + i);
+				const uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(v), 0xFF01), 16);
+				const uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(v), 0xFF01), 16);
+				vst1_u8((dst + i), vrshrn_n_u16(vcombine_u16(lo, hi), 8));
+			}
+
+			Uint16ToUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void Uint8ToFloat_NEON(const uint8* src, float* dst, const size_t numPixels) noexcept
+		{
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+				vst1q_f32((dst + i), vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), Uint8ToFloatScale));
+				vst1q_f32((dst + i + 4), vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), Uint8ToFloatScale));
+			}
+
+			Uint8ToFloat_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+		void FloatToUint8_NEON(const float* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			const float32x4_t half = vdupq_n_f32(0.5f);
+
+			// vcvtq_u32_f32 は負の値と NaN を 0 にし、vqmovn は 255 を超える値を飽和させる
+			const auto Convert = [&](const float32x4_t v)
+			{
+				return vqmovn_u32(vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(v, 255.0f), half)));
+			};
+
+			size_t i = 0;
+
+			for (; (i + 8) <= numPixels; i += 8)
+			{
+				const uint16x8_t v = vcombine_u16(Convert(vld1q_f32(src + i)), Convert(vld1q_f32(src + i + 4)));
+				vst1_u8((dst + i), vqmovn_u16(v));
+			}
+
+			FloatToUint8_Scalar((src + i), (dst + i), (numPixels - i));
+		}
+
+	#endif
+
+		[[nodiscard]]
+		RGBAToBGRFunction SelectRGBAToBGR() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return RGBAToBGR_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return RGBAToBGR_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return RGBAToBGR_NEON;
+
+		#endif
+
+			return RGBAToBGR_Scalar;
+		}
+
+		[[nodiscard]]
+		RGBAToRGBFunction SelectRGBAToRGB() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return RGBAToRGB_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return RGBAToRGB_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return RGBAToRGB_NEON;
+
+		#endif
+
+			return RGBAToRGB_Scalar;
+		}
+
+		[[nodiscard]]
+		BGRToRGBAFunction SelectBGRToRGBA() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return BGRToRGBA_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return BGRToRGBA_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return BGRToRGBA_NEON;
+
+		#endif
+
+			return BGRToRGBA_Scalar;
+		}
+
+		[[nodiscard]]
+		RGBToRGBAFunction SelectRGBToRGBA() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return RGBToRGBA_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return RGBToRGBA_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return RGBToRGBA_NEON;
+
+		#endif
+
+			return RGBToRGBA_Scalar;
+		}
+
+		[[nodiscard]]
+		GrayToRGBAFunction SelectGrayToRGBA() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return GrayToRGBA_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return GrayToRGBA_NEON;
+
+		#else
+
+			return GrayToRGBA_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		GrayAlphaToRGBAFunction SelectGrayAlphaToRGBA() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return GrayAlphaToRGBA_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return GrayAlphaToRGBA_NEON;
+
+		#else
+
+			return GrayAlphaToRGBA_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		SwapRBFunction SelectSwapRB() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return SwapRB_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return SwapRB_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return SwapRB_NEON;
+
+		#endif
+
+			return SwapRB_Scalar;
+		}
+
+
+		[[nodiscard]]
+		DeinterleaveFunction SelectDeinterleave() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Deinterleave_AVX2;
+			}
+			else if (CPU::HasSSSE3())
+			{
+				return Deinterleave_SSSE3;
+			}
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Deinterleave_NEON;
+
+		#endif
+
+			return Deinterleave_Scalar;
+		}
+
+		[[nodiscard]]
+		InterleaveFunction SelectInterleave() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Interleave_AVX2;
+			}
+
+			return Interleave_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Interleave_NEON;
+
+		#else
+
+			return Interleave_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		Uint8ToUint16Function SelectUint8ToUint16() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Uint8ToUint16_AVX2;
+			}
+
+			return Uint8ToUint16_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Uint8ToUint16_NEON;
+
+		#else
+
+			return Uint8ToUint16_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		Uint16ToUint8Function SelectUint16ToUint8() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Uint16ToUint8_AVX2;
+			}
+
+			return Uint16ToUint8_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Uint16ToUint8_NEON;
+
+		#else
+
+			return Uint16ToUint8_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		Uint8ToFloatFunction SelectUint8ToFloat() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return Uint8ToFloat_AVX2;
+			}
+
+			return Uint8ToFloat_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Uint8ToFloat_NEON;
+
+		#else
+
+			return Uint8ToFloat_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		FloatToUint8Function SelectFloatToUint8() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			if (CPU::HasAVX2())
+			{
+				return FloatToUint8_AVX2;
+			}
+
+			return FloatToUint8_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return FloatToUint8_NEON;
+
+		#else
+
+			return FloatToUint8_Scalar;
+
+		#endif
+		}
+
+		/// @brief 各ピクセルの R 成分と B 成分を入れ替えます。
+		/// @param src 変換元のバッファ
+		/// @param dst 変換先のバッファ。src と同じ領域を指定することもできます
+		/// @param numPixels ピクセル数
+		void SwapRB(const uint8* src, uint8* dst, const size_t numPixels) noexcept
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const SwapRBFunction function = SelectSwapRB();
+
+			function(src, dst, numPixels);
+		}
+	}
+
+	void ConvertRGBAToBGR(const Color* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const RGBAToBGRFunction function = SelectRGBAToBGR();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertRGBAToRGB(const Color* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const RGBAToRGBFunction function = SelectRGBAToRGB();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertBGRToRGBA(const uint8* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const BGRToRGBAFunction function = SelectBGRToRGBA();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertRGBToRGBA(const uint8* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const RGBToRGBAFunction function = SelectRGBToRGBA();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertGrayToRGBA(const uint8* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const GrayToRGBAFunction function = SelectGrayToRGBA();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertGrayAlphaToRGBA(const uint8* src, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const GrayAlphaToRGBAFunction function = SelectGrayAlphaToRGBA();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertRGBAToBGRA(const Color* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		SwapRB(reinterpret_cast<const uint8*>(src), dst, numPixels);
+	}
+
+	void ConvertBGRAToRGBA(const uint8* src, Color* dst, const size_t numPixels) noexcept
+	{
+		SwapRB(src, reinterpret_cast<uint8*>(dst), numPixels);
+	}
+
+	void DeinterleaveRGBA(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const DeinterleaveFunction function = SelectDeinterleave();
+
+		function(src, r, g, b, a, numPixels);
+	}
+
+	void InterleaveRGBA(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const InterleaveFunction function = SelectInterleave();
+
+		function(r, g, b, a, dst, numPixels);
+	}
+
+	void ConvertUint8ToUint16(const uint8* src, uint16* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const Uint8ToUint16Function function = SelectUint8ToUint16();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertUint16ToUint8(const uint16* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const Uint16ToUint8Function function = SelectUint16ToUint8();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertUint8ToFloat(const uint8* src, float* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const Uint8ToFloatFunction function = SelectUint8ToFloat();
+
+		function(src, dst, numPixels);
+	}
+
+	void ConvertFloatToUint8(const float* src, uint8* dst, const size_t numPixels) noexcept
+	{
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const FloatToUint8Function function = SelectFloatToUint8();
+
+		function(src, dst, numPixels);
+	}
+}
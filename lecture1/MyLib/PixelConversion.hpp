@@ -0,0 +1,112 @@
+﻿#pragma once
+#include <cstddef> // size_t
+#include "Common.hpp"
+
+namespace seccamp
+{
+	struct Color; // 前方宣言
+
+	/// @brief RGBA 形式のピクセル列を BGR 形式（1 ピクセル 3 バイト）に変換します。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のバッファ（numPixels * 3 バイト以上）
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertRGBAToBGR(const Color* src, uint8* dst, size_t numPixels) noexcept;
+
+	/// @brief RGBA 形式のピクセル列を RGB 形式（1 ピクセル 3 バイト）に変換します。アルファ成分は捨てられます。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のバッファ（numPixels * 3 バイト以上）
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertRGBAToRGB(const Color* src, uint8* dst, size_t numPixels) noexcept;
+
+	/// @brief BGR 形式（1 ピクセル 3 バイト）のピクセル列を RGBA 形式に変換します。アルファ成分は 255 になります。
+	/// @param src 変換元のバッファ（numPixels * 3 バイト以上）
+	/// @param dst 変換先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertBGRToRGBA(const uint8* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief RGB 形式（1 ピクセル 3 バイト）のピクセル列を RGBA 形式に変換します。アルファ成分は 255 になります。
+	/// @param src 変換元のバッファ（numPixels * 3 バイト以上）
+	/// @param dst 変換先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertRGBToRGBA(const uint8* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief グレースケール（1 ピクセル 1 バイト）のピクセル列を RGBA 形式に変換します。アルファ成分は 255 になります。
+	/// @param src 変換元のバッファ（numPixels バイト以上）
+	/// @param dst 変換先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて SSE2, NEON またはスカラー実装が使われます。
+	void ConvertGrayToRGBA(const uint8* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief グレースケールとアルファ（1 ピクセル 2 バイト）のピクセル列を RGBA 形式に変換します。
+	/// @param src 変換元のバッファ（numPixels * 2 バイト以上）
+	/// @param dst 変換先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて SSE2, NEON またはスカラー実装が使われます。
+	void ConvertGrayAlphaToRGBA(const uint8* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief RGBA 形式のピクセル列を BGRA 形式（1 ピクセル 4 バイト）に変換します。
+	/// @param src 変換元のピクセル列
+	/// @param dst 変換先のバッファ（numPixels * 4 バイト以上）。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertRGBAToBGRA(const Color* src, uint8* dst, size_t numPixels) noexcept;
+
+	/// @brief BGRA 形式（1 ピクセル 4 バイト）のピクセル列を RGBA 形式に変換します。
+	/// @param src 変換元のバッファ（numPixels * 4 バイト以上）
+	/// @param dst 変換先のピクセル列。src と同じ領域を指定することもできます
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void ConvertBGRAToRGBA(const uint8* src, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief RGBA 形式のピクセル列を、成分ごとの 4 つの配列に分解します。
+	/// @param src 変換元のピクセル列
+	/// @param r R 成分の格納先（numPixels バイト以上）
+	/// @param g G 成分の格納先（numPixels バイト以上）
+	/// @param b B 成分の格納先（numPixels バイト以上）
+	/// @param a アルファ成分の格納先（numPixels バイト以上）
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSSE3, NEON またはスカラー実装が使われます。
+	void DeinterleaveRGBA(const Color* src, uint8* r, uint8* g, uint8* b, uint8* a, size_t numPixels) noexcept;
+
+	/// @brief 成分ごとの 4 つの配列から、RGBA 形式のピクセル列を作成します。
+	/// @param r R 成分（numPixels バイト以上）
+	/// @param g G 成分（numPixels バイト以上）
+	/// @param b B 成分（numPixels バイト以上）
+	/// @param a アルファ成分（numPixels バイト以上）
+	/// @param dst 変換先のピクセル列
+	/// @param numPixels ピクセル数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void InterleaveRGBA(const uint8* r, const uint8* g, const uint8* b, const uint8* a, Color* dst, size_t numPixels) noexcept;
+
+	/// @brief [0, 255] の値を [0, 65535] の値に変換します（x * 257）。
+	/// @param src 変換元の値
+	/// @param dst 変換先のバッファ
+	/// @param numPixels 値の個数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertUint8ToUint16(const uint8* src, uint16* dst, size_t numPixels) noexcept;
+
+	/// @brief [0, 65535] の値を [0, 255] の値に変換します（x / 257 を四捨五入）。
+	/// @param src 変換元の値
+	/// @param dst 変換先のバッファ
+	/// @param numPixels 値の個数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertUint16ToUint8(const uint16* src, uint8* dst, size_t numPixels) noexcept;
+
+	/// @brief [0, 255] の値を [0.0, 1.0] の値に変換します。
+	/// @param src 変換元の値
+	/// @param dst 変換先のバッファ
+	/// @param numPixels 値の個数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertUint8ToFloat(const uint8* src, float* dst, size_t numPixels) noexcept;
+
+	/// @brief [0.0, 1.0] の値を [0, 255] の値に変換します（x * 255 を四捨五入）。
+	/// @param src 変換元の値。範囲外の値は飽和させ、NaN は 0 にします
+	/// @param dst 変換先のバッファ
+	/// @param numPixels 値の個数
+	/// @remark 実行中の CPU に応じて AVX2, SSE2, NEON またはスカラー実装が使われます。
+	void ConvertFloatToUint8(const float* src, uint8* dst, size_t numPixels) noexcept;
+}
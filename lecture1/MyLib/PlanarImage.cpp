@@ -0,0 +1,331 @@
+﻿#include <algorithm> // std::fill_n, std::min
+#include <array> // std::array
+#include <cstring> // std::memcpy
+#include <utility> // std::swap
+#include "PlanarImage.hpp"
+#include "PixelConversion.hpp"
+#include "ColorConversion.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 成分の型を変換するときに、一度に処理するピクセル数。作業用のバッファが L1 キャッシュに収まるようにする
+		constexpr size_t ChunkPixels = 1024;
+
+		/// @brief アルファ成分が無い画像をまとめるときに使う、不透明のアルファ成分
+		constexpr std::array<uint8, ChunkPixels> OpaqueAlpha = []()
+		{
+			std::array<uint8, ChunkPixels> alpha{};
+			alpha.fill(255);
+			return alpha;
+		}();
+
+		/// @brief [0, 255] の値を成分の型に変換します。
+		template <class Type>
+		void FromUint8(const uint8* src, Type* dst, const size_t n) noexcept
+		{
+			if constexpr (std::same_as<Type, uint8>)
+			{
+				std::memcpy(dst, src, n);
+			}
+			else if constexpr (std::same_as<Type, uint16>)
+			{
+				ConvertUint8ToUint16(src, dst, n);
+			}
+			else
+			{
+				ConvertUint8ToFloat(src, dst, n);
+			}
+		}
+
+		/// @brief 成分の型の値を [0, 255] の値に変換します。
+		template <class Type>
+		void ToUint8(const Type* src, uint8* dst, const size_t n) noexcept
+		{
+			if constexpr (std::same_as<Type, uint8>)
+			{
+				std::memcpy(dst, src, n);
+			}
+			else if constexpr (std::same_as<Type, uint16>)
+			{
+				ConvertUint16ToUint8(src, dst, n);
+			}
+			else
+			{
+				ConvertFloatToUint8(src, dst, n);
+			}
+		}
+
+		/// @brief 連続するピクセルを成分ごとに分解します。
+		/// @param src 分解するピクセル
+		/// @param planes 各成分の格納先
+		/// @param numChannels 成分の数
+		/// @param numPixels ピクセル数
+		template <class Type>
+		void Deinterleave(const Color* src, const std::array<Type*, 4>& planes, const size_t numChannels, const size_t numPixels) noexcept
+		{
+			alignas(64) uint8 buffers[4][ChunkPixels];
+
+			for (size_t i = 0; i < numPixels; i += ChunkPixels)
+			{
+				const size_t n = std::min(ChunkPixels, (numPixels - i));
+
+				// uint8 の場合はプレーンに直接書き込み、それ以外の場合は作業用のバッファを経由して変換する
+				uint8* dst[4];
+
+				for (size_t c = 0; c < 4; ++c)
+				{
+					if constexpr (std::same_as<Type, uint8>)
+					{
+						dst[c] = ((c < numChannels) ? (planes[c] + i) : buffers[c]);
+					}
+					else
+					{
+						dst[c] = buffers[c];
+					}
+				}
+
+				switch (numChannels)
+				{
+				case 1:
+					ConvertToGrayscaleUint8((src + i), dst[0], n);
+					break;
+				case 2:
+					ConvertToGrayscaleUint8((src + i), dst[0], n);
+					ExtractChannel((src + i), dst[1], n, 3);
+					break;
+				default:
+					DeinterleaveRGBA((src + i), dst[0], dst[1], dst[2], dst[3], n);
+					break;
+				}
+
+				if constexpr (not std::same_as<Type, uint8>)
+				{
+					for (size_t c = 0; c < numChannels; ++c)
+					{
+						FromUint8(buffers[c], (planes[c] + i), n);
+					}
+				}
+			}
+		}
+
+		/// @brief 成分をまとめて、連続するピクセルにします。
+		/// @param planes 各成分
+		/// @param numChannels 成分の数
+		/// @param dst 書き込み先のピクセル
+		/// @param numPixels ピクセル数
+		template <class Type>
+		void Interleave(const std::array<const Type*, 4>& planes, const size_t numChannels, Color* dst, const size_t numPixels) noexcept
+		{
+			alignas(64) uint8 buffers[4][ChunkPixels];
+
+			for (size_t i = 0; i < numPixels; i += ChunkPixels)
+			{
+				const size_t n = std::min(ChunkPixels, (numPixels - i));
+
+				// uint8 の場合はプレーンから直接読み込み、それ以外の場合は作業用のバッファに変換してから読み込む
+				const uint8* src[4] = { OpaqueAlpha.data(), OpaqueAlpha.data(), OpaqueAlpha.data(), OpaqueAlpha.data() };
+
+				for (size_t c = 0; c < numChannels; ++c)
+				{
+					if constexpr (std::same_as<Type, uint8>)
+					{
+						src[c] = (planes[c] + i);
+					}
+					else
+					{
+						ToUint8((planes[c] + i), buffers[c], n);
+						src[c] = buffers[c];
+					}
+				}
+
+				switch (numChannels)
+				{
+				case 1:
+					InterleaveRGBA(src[0], src[0], src[0], OpaqueAlpha.data(), (dst + i), n);
+					break;
+				case 2:
+					InterleaveRGBA(src[0], src[0], src[0], src[1], (dst + i), n);
+					break;
+				default:
+					InterleaveRGBA(src[0], src[1], src[2], src[3], (dst + i), n);
+					break;
+				}
+			}
+		}
+	}
+
+	template <PlanarValueType Type>
+	PlanarImage<Type>::PlanarImage(const int32 width, const int32 height, const size_t numChannels, const Type value)
+	{
+		resize(width, height, numChannels, Uninitialized);
+		fill(value);
+	}
+
+	template <PlanarValueType Type>
+	PlanarImage<Type>::PlanarImage(const int32 width, const int32 height, const size_t numChannels, UninitializedTag)
+	{
+		resize(width, height, numChannels, Uninitialized);
+	}
+
+	template <PlanarValueType Type>
+	PlanarImage<Type>::PlanarImage(const ConstImageView& image, const size_t numChannels)
+	{
+		assign(image, numChannels);
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::resize(const int32 width, const int32 height, const size_t numChannels, UninitializedTag)
+	{
+		if ((width <= 0) || (height <= 0) || (numChannels == 0) || (MaxChannels < numChannels))
+		{
+			clear();
+			return;
+		}
+
+		m_size.set(width, height);
+		m_numChannels = numChannels;
+
+		// 各プレーンの先頭がアラインメントされるように、プレーンの大きさを切り上げる
+		constexpr size_t ValuesPerAlignment = (PixelAllocator::Alignment / sizeof(Type));
+		m_planeStride = ((numPixels() + (ValuesPerAlignment - 1)) / ValuesPerAlignment * ValuesPerAlignment);
+
+		const size_t sizeBytes = (m_planeStride * m_numChannels * sizeof(Type));
+		m_buffer.resizeUninitialized((sizeBytes + (sizeof(Color) - 1)) / sizeof(Color));
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::fill(const Type value) noexcept
+	{
+		for (size_t c = 0; c < m_numChannels; ++c)
+		{
+			fill(c, value);
+		}
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::fill(const size_t channel, const Type value) noexcept
+	{
+		std::fill_n(plane(channel), numPixels(), value);
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::assign(const ConstImageView& image, const size_t numChannels)
+	{
+		resize(image.width(), image.height(), numChannels, Uninitialized);
+
+		if (isEmpty())
+		{
+			return;
+		}
+
+		const size_t width = m_size.x;
+		const bool contiguous = image.isContiguous();
+
+		// 指定した行から始まる各プレーンのポインタ
+		const auto GetPlanes = [&](const size_t y)
+		{
+			std::array<Type*, 4> planes{};
+
+			for (size_t c = 0; c < m_numChannels; ++c)
+			{
+				planes[c] = row(c, y);
+			}
+
+			return planes;
+		};
+
+		image.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				if (contiguous)
+				{
+					Deinterleave(image[beginY], GetPlanes(beginY), m_numChannels, (static_cast<size_t>(endY - beginY) * width));
+					return;
+				}
+
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					Deinterleave(image[y], GetPlanes(y), m_numChannels, width);
+				}
+			});
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::copyTo(const ImageView& dst) const noexcept
+	{
+		const ImageView view = dst.subView(Rect{ m_size.x, m_size.y });
+
+		if (isEmpty() || view.isEmpty())
+		{
+			return;
+		}
+
+		const size_t width = view.width();
+
+		// 書き込み先とプレーンの行の長さが同じで、書き込み先が連続している場合は、複数の行をまとめて処理できる
+		const bool contiguous = (view.isContiguous() && (view.width() == m_size.x));
+
+		// 指定した行から始まる各プレーンのポインタ
+		const auto GetPlanes = [&](const size_t y)
+		{
+			std::array<const Type*, 4> planes{};
+
+			for (size_t c = 0; c < m_numChannels; ++c)
+			{
+				planes[c] = row(c, y);
+			}
+
+			return planes;
+		};
+
+		view.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				if (contiguous)
+				{
+					Interleave(GetPlanes(beginY), m_numChannels, view[beginY], (static_cast<size_t>(endY - beginY) * width));
+					return;
+				}
+
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					Interleave(GetPlanes(y), m_numChannels, view[y], width);
+				}
+			});
+	}
+
+	template <PlanarValueType Type>
+	Image PlanarImage<Type>::toImage() const
+	{
+		if (isEmpty())
+		{
+			return{};
+		}
+
+		Image image{ m_size, Uninitialized };
+		copyTo(image.view());
+		return image;
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::clear() noexcept
+	{
+		m_buffer.clear();
+		m_size.clear();
+		m_numChannels = 0;
+		m_planeStride = 0;
+	}
+
+	template <PlanarValueType Type>
+	void PlanarImage<Type>::swap(PlanarImage& other) noexcept
+	{
+		m_buffer.swap(other.m_buffer);
+		std::swap(m_size, other.m_size);
+		std::swap(m_numChannels, other.m_numChannels);
+		std::swap(m_planeStride, other.m_planeStride);
+	}
+
+	template class PlanarImage<uint8>;
+	template class PlanarImage<uint16>;
+	template class PlanarImage<float>;
+}
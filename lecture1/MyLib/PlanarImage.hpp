@@ -0,0 +1,228 @@
+﻿#pragma once
+#include <concepts> // std::same_as
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_floating_point_v
+#include "Common.hpp"
+#include "Point.hpp"
+#include "PixelBuffer.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+
+namespace seccamp
+{
+	/// @brief PlanarImage の成分に使える型
+	template <class Type>
+	concept PlanarValueType = (std::same_as<Type, uint8> || std::same_as<Type, uint16> || std::same_as<Type, float>);
+
+	/// @brief 成分ごとに分かれた（planar）画像
+	/// @tparam Type 成分の型（uint8, uint16 または float）
+	/// @remark 各成分の値は、uint8 では [0, 255], uint16 では [0, 65535], float では [0.0, 1.0] の範囲で Color の成分に対応します。
+	/// @remark 成分の数は 1（グレースケール）、2（グレースケールとアルファ）、3（RGB）、4（RGBA）のいずれかです。
+	/// 各成分は幅 × 高さの連続した配列（プレーン）に格納され、プレーンの先頭は PixelAllocator::Alignment バイトにアラインメントされます。
+	template <PlanarValueType Type>
+	class PlanarImage
+	{
+	public:
+
+		/// @brief 成分の型
+		using value_type = Type;
+
+		/// @brief 成分の数の最大値
+		static constexpr size_t MaxChannels = 4;
+
+		/// @brief Color の成分 255 に対応する値
+		static constexpr Type MaxValue = (std::is_floating_point_v<Type> ? Type{ 1 } : std::numeric_limits<Type>::max());
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		PlanarImage() = default;
+
+		/// @brief 画像を作成します。
+		/// @param width 画像の幅（ピクセル）
+		/// @param height 画像の高さ（ピクセル）
+		/// @param numChannels 成分の数（1 以上 4 以下）。範囲外の場合は空の画像になります
+		/// @param value すべての成分の初期値
+		[[nodiscard]]
+		PlanarImage(int32 width, int32 height, size_t numChannels, Type value = Type{ 0 });
+
+		/// @brief 成分を初期化せずに画像を作成します。
+		/// @param width 画像の幅（ピクセル）
+		/// @param height 画像の高さ（ピクセル）
+		/// @param numChannels 成分の数（1 以上 4 以下）。範囲外の場合は空の画像になります
+		/// @remark 成分の値は不定です。
+		[[nodiscard]]
+		PlanarImage(int32 width, int32 height, size_t numChannels, UninitializedTag);
+
+		/// @brief 画像を成分ごとに分解して作成します。
+		/// @param image 分解する画像
+		/// @param numChannels 成分の数。1 と 2 の場合は、RGB 成分をグレースケール値にします
+		[[nodiscard]]
+		explicit PlanarImage(const ConstImageView& image, size_t numChannels = MaxChannels);
+
+		/// @brief 画像の幅（ピクセル）を返します。
+		/// @return 画像の幅（ピクセル）
+		[[nodiscard]]
+		int32 width() const noexcept
+		{
+			return m_size.x;
+		}
+
+		/// @brief 画像の高さ（ピクセル）を返します。
+		/// @return 画像の高さ（ピクセル）
+		[[nodiscard]]
+		int32 height() const noexcept
+		{
+			return m_size.y;
+		}
+
+		/// @brief 画像の幅と高さ（ピクセル）を返します。
+		/// @return 画像の幅と高さ（ピクセル）
+		[[nodiscard]]
+		Size size() const noexcept
+		{
+			return m_size;
+		}
+
+		/// @brief 成分の数を返します。
+		/// @return 成分の数
+		[[nodiscard]]
+		size_t numChannels() const noexcept
+		{
+			return m_numChannels;
+		}
+
+		/// @brief 画像の総ピクセル数を返します。
+		/// @return 画像の総ピクセル数
+		[[nodiscard]]
+		size_t numPixels() const noexcept
+		{
+			return (static_cast<size_t>(m_size.x) * static_cast<size_t>(m_size.y));
+		}
+
+		/// @brief 画像が空であるかを返します。
+		/// @return 画像が空である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept
+		{
+			return (m_numChannels == 0);
+		}
+
+		/// @brief 画像が空でないかを返します。
+		/// @return 画像が空でない場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept
+		{
+			return (m_numChannels != 0);
+		}
+
+		/// @brief 成分のプレーンの先頭ポインタを返します。
+		/// @param channel 成分の番号（numChannels() 未満）
+		/// @return プレーンの先頭ポインタ。プレーンには numPixels() 個の値が行の間に隙間なく並びます
+		[[nodiscard]]
+		Type* plane(size_t channel) noexcept
+		{
+			return (static_cast<Type*>(static_cast<void*>(m_buffer.data())) + (channel * m_planeStride));
+		}
+
+		/// @brief 成分のプレーンの先頭ポインタを返します。
+		/// @param channel 成分の番号（numChannels() 未満）
+		/// @return プレーンの先頭ポインタ。プレーンには numPixels() 個の値が行の間に隙間なく並びます
+		[[nodiscard]]
+		const Type* plane(size_t channel) const noexcept
+		{
+			return (static_cast<const Type*>(static_cast<const void*>(m_buffer.data())) + (channel * m_planeStride));
+		}
+
+		/// @brief 成分のプレーンの指定した行の先頭ポインタを返します。
+		/// @param channel 成分の番号（numChannels() 未満）
+		/// @param y 位置（行）
+		/// @return 指定した行の先頭ポインタ
+		[[nodiscard]]
+		Type* row(size_t channel, size_t y) noexcept
+		{
+			return (plane(channel) + (y * m_size.x));
+		}
+
+		/// @brief 成分のプレーンの指定した行の先頭ポインタを返します。
+		/// @param channel 成分の番号（numChannels() 未満）
+		/// @param y 位置（行）
+		/// @return 指定した行の先頭ポインタ
+		[[nodiscard]]
+		const Type* row(size_t channel, size_t y) const noexcept
+		{
+			return (plane(channel) + (y * m_size.x));
+		}
+
+		/// @brief 成分を初期化せずに画像をリサイズします。
+		/// @param width 新しい画像の幅（ピクセル）
+		/// @param height 新しい画像の高さ（ピクセル）
+		/// @param numChannels 新しい成分の数（1 以上 4 以下）。範囲外の場合は空の画像になります
+		/// @remark 成分の値は不定です。必要なメモリが減る場合は再確保しません。
+		void resize(int32 width, int32 height, size_t numChannels, UninitializedTag);
+
+		/// @brief すべての成分を指定した値で塗りつぶします。
+		/// @param value 塗りつぶしの値
+		void fill(Type value) noexcept;
+
+		/// @brief 1 つの成分を指定した値で塗りつぶします。
+		/// @param channel 成分の番号（numChannels() 未満）
+		/// @param value 塗りつぶしの値
+		void fill(size_t channel, Type value) noexcept;
+
+		/// @brief 画像を成分ごとに分解して格納します。
+		/// @param image 分解する画像
+		/// @param numChannels 成分の数。1 と 2 の場合は、RGB 成分をグレースケール値にします
+		void assign(const ConstImageView& image, size_t numChannels = MaxChannels);
+
+		/// @brief 成分を RGBA 形式にまとめて、ビューに書き込みます。
+		/// @param dst 書き込み先のビュー。大きさが異なる場合は、重なる左上の部分だけを書き込みます
+		/// @remark 成分が 1 つまたは 2 つの場合は、RGB 成分すべてに 1 つ目の成分を書き込みます。アルファ成分が無い場合は 255 にします。
+		void copyTo(const ImageView& dst) const noexcept;
+
+		/// @brief 成分を RGBA 形式にまとめた画像を返します。
+		/// @return 成分を RGBA 形式にまとめた画像
+		/// @remark 成分が 1 つまたは 2 つの場合は、RGB 成分すべてに 1 つ目の成分を書き込みます。アルファ成分が無い場合は 255 にします。
+		[[nodiscard]]
+		Image toImage() const;
+
+		/// @brief 画像を空にし、メモリを解放します。
+		void clear() noexcept;
+
+		/// @brief 2 つの画像をスワップします。
+		/// @param other もう一方の画像
+		void swap(PlanarImage& other) noexcept;
+
+		/// @brief 2 つの画像をスワップします。
+		/// @param lhs 一方の画像
+		/// @param rhs もう一方の画像
+		friend void swap(PlanarImage& lhs, PlanarImage& rhs) noexcept
+		{
+			lhs.swap(rhs);
+		}
+
+	private:
+
+		// プレーンのメモリ。確保とアラインメントを Image と共有するため PixelBuffer を使う
+		PixelBuffer m_buffer;
+
+		Size m_size{ 0, 0 };
+
+		size_t m_numChannels = 0;
+
+		// プレーンの先頭どうしの間隔（要素数）
+		size_t m_planeStride = 0;
+	};
+
+	/// @brief 成分が uint8 の planar 画像
+	using PlanarImage8 = PlanarImage<uint8>;
+
+	/// @brief 成分が uint16 の planar 画像
+	using PlanarImage16 = PlanarImage<uint16>;
+
+	/// @brief 成分が float の planar 画像
+	using PlanarImageF = PlanarImage<float>;
+
+	extern template class PlanarImage<uint8>;
+	extern template class PlanarImage<uint16>;
+	extern template class PlanarImage<float>;
+}
@@ -1,7 +1,172 @@
 ﻿#pragma once
+#include <algorithm> // std::min, std::max
+#include <iostream> // std::ostream, std::istream
+#include <format> // std::formatter
 #include "Common.hpp"
+#include "Point.hpp"
 
 namespace seccamp
 {
+	/// @brief 長方形（整数）
+	struct Rect
+	{
+		/// @brief 左上の X 座標
+		int32 x;
 
+		/// @brief 左上の Y 座標
+		int32 y;
+
+		/// @brief 幅
+		int32 w;
+
+		/// @brief 高さ
+		int32 h;
+
+		/// @brief デフォルトコンストラクタ
+		[[nodiscard]]
+		Rect() = default;
+
+		/// @brief 左上の座標が (0, 0) の長方形を作成します。
+		/// @param _w 幅
+		/// @param _h 高さ
+		[[nodiscard]]
+		constexpr Rect(int32 _w, int32 _h) noexcept
+			: x{ 0 }
+			, y{ 0 }
+			, w{ _w }
+			, h{ _h } {}
+
+		/// @brief 長方形を作成します。
+		/// @param _x 左上の X 座標
+		/// @param _y 左上の Y 座標
+		/// @param _w 幅
+		/// @param _h 高さ
+		[[nodiscard]]
+		constexpr Rect(int32 _x, int32 _y, int32 _w, int32 _h) noexcept
+			: x{ _x }
+			, y{ _y }
+			, w{ _w }
+			, h{ _h } {}
+
+		/// @brief 長方形を作成します。
+		/// @param pos 左上の座標
+		/// @param size 幅と高さ
+		[[nodiscard]]
+		constexpr Rect(const Point& pos, const Size& size) noexcept
+			: x{ pos.x }
+			, y{ pos.y }
+			, w{ size.x }
+			, h{ size.y } {}
+
+		/// @brief 2 つの長方形が等しいかを返します。
+		/// @param lhs 一方の長方形
+		/// @param rhs もう一方の長方形
+		/// @return 2 つの長方形が等しい場合 true, それ以外の場合は false
+		[[nodiscard]]
+		friend constexpr bool operator ==(const Rect& lhs, const Rect& rhs) noexcept = default;
+
+		/// @brief 左上の座標を返します。
+		/// @return 左上の座標
+		[[nodiscard]]
+		constexpr Point pos() const noexcept
+		{
+			return{ x, y };
+		}
+
+		/// @brief 幅と高さを返します。
+		/// @return 幅と高さ
+		[[nodiscard]]
+		constexpr Size size() const noexcept
+		{
+			return{ w, h };
+		}
+
+		/// @brief 右下の座標（長方形に含まれない）を返します。
+		/// @return 右下の座標
+		[[nodiscard]]
+		constexpr Point br() const noexcept
+		{
+			return{ (x + w), (y + h) };
+		}
+
+		/// @brief 面積を返します。
+		/// @return 面積
+		[[nodiscard]]
+		constexpr int64 area() const noexcept
+		{
+			return (static_cast<int64>(w) * h);
+		}
+
+		/// @brief 長方形が空であるかを返します。
+		/// @return 幅または高さが 0 以下の場合 true, それ以外の場合は false
+		[[nodiscard]]
+		constexpr bool isEmpty() const noexcept
+		{
+			return ((w <= 0) || (h <= 0));
+		}
+
+		/// @brief 点が長方形に含まれるかを返します。
+		/// @param p 点の座標
+		/// @return 点が長方形に含まれる場合 true, それ以外の場合は false
+		[[nodiscard]]
+		constexpr bool contains(const Point& p) const noexcept
+		{
+			return ((x <= p.x) && (p.x < (x + w)) && (y <= p.y) && (p.y < (y + h)));
+		}
+
+		/// @brief 別の長方形との共通部分を返します。
+		/// @param other 別の長方形
+		/// @return 共通部分の長方形。共通部分が無い場合は幅と高さが 0 の長方形
+		[[nodiscard]]
+		constexpr Rect intersection(const Rect& other) const noexcept
+		{
+			const int32 left	= std::max(x, other.x);
+			const int32 top		= std::max(y, other.y);
+			const int32 right	= std::min((x + w), (other.x + other.w));
+			const int32 bottom	= std::min((y + h), (other.y + other.h));
+
+			if ((right <= left) || (bottom <= top))
+			{
+				return{ left, top, 0, 0 };
+			}
+
+			return{ left, top, (right - left), (bottom - top) };
+		}
+
+		/// @brief 出力ストリームに書き込みます。
+		/// @param os 出力ストリーム
+		/// @param r 書き込む値
+		/// @return 出力ストリーム
+		friend std::ostream& operator <<(std::ostream& os, const Rect& r)
+		{
+			return os << '(' << r.x << ", " << r.y << ", " << r.w << ", " << r.h << ')';
+		}
+
+		/// @brief 入力ストリームから読み込みます。
+		/// @param is 入力ストリーム
+		/// @param r 読み込んだ値の格納先
+		/// @return 入力ストリーム
+		friend std::istream& operator >>(std::istream& is, Rect& r)
+		{
+			char t;
+			return is >> t >> r.x >> t >> r.y >> t >> r.w >> t >> r.h >> t;
+		}
+	};
 }
+
+/// @brief Rect 型を std::format に対応させるための std::formatter 特殊化
+template<>
+struct std::formatter<seccamp::Rect>
+{
+	template <class ParseContext>
+	constexpr auto parse(ParseContext& ctx)
+	{
+		return ctx.begin();
+	}
+
+	template <class FormtContext>
+	auto format(const seccamp::Rect& r, FormtContext& ctx) const
+	{
+		return std::format_to(ctx.out(), "({}, {}, {}, {})", r.x, r.y, r.w, r.h);
+	}
+};
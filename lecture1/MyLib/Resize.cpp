@@ -0,0 +1,593 @@
+﻿#include <algorithm> // std::min, std::max, std::clamp
+#include <cmath> // std::abs, std::sin, std::ceil, std::floor
+#include <numbers> // std::numbers::pi
+#include <span> // std::span
+#include <vector> // std::vector
+#include "Resize.hpp"
+#include "ColorConversion.hpp"
+#include "CPU.hpp"
+#include "FixedPointWeights.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_madd_epi16
+#elif SECCAMP_CPU(ARM64)
+	#include <arm_neon.h> // vmlal_n_s16, vqshrn_n_s32, vrshrn_n_u16
+#endif
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 重みの固定小数点数の小数部のビット数。重みを int16 に収め、SIMD 命令の 16 ビット積和で計算できるようにする
+		constexpr int32 WeightBits = 14;
+
+		/// @brief 固定小数点数の 1.0
+		constexpr int32 WeightOne = (1 << WeightBits);
+
+		/// @brief 右シフトで四捨五入するために、あらかじめ足しておく値
+		constexpr int32 WeightRound = (1 << (WeightBits - 1));
+
+		/// @brief 補間に使うフィルタ
+		struct Filter
+		{
+			/// @brief フィルタの関数
+			double(*function)(double);
+
+			/// @brief フィルタの半径（拡大時）
+			double support;
+		};
+
+		[[nodiscard]]
+		double BoxFilter(const double x) noexcept
+		{
+			return (((-0.5 <= x) && (x < 0.5)) ? 1.0 : 0.0);
+		}
+
+		[[nodiscard]]
+		double TriangleFilter(double x) noexcept
+		{
+			x = std::abs(x);
+			return ((x < 1.0) ? (1.0 - x) : 0.0);
+		}
+
+		[[nodiscard]]
+		double BicubicFilter(double x) noexcept
+		{
+			constexpr double a = -0.5;
+
+			x = std::abs(x);
+
+			if (x < 1.0)
+			{
+				return ((((a + 2.0) * x - (a + 3.0)) * x * x) + 1.0);
+			}
+			else if (x < 2.0)
+			{
+				return ((((x - 5.0) * x + 8.0) * x - 4.0) * a);
+			}
+
+			return 0.0;
+		}
+
+		[[nodiscard]]
+		double Sinc(double x) noexcept
+		{
+			if (x == 0.0)
+			{
+				return 1.0;
+			}
+
+			x *= std::numbers::pi;
+			return (std::sin(x) / x);
+		}
+
+		[[nodiscard]]
+		double Lanczos3Filter(const double x) noexcept
+		{
+			return (((-3.0 < x) && (x < 3.0)) ? (Sinc(x) * Sinc(x / 3.0)) : 0.0);
+		}
+
+		[[nodiscard]]
+		Filter GetFilter(const ResizeFilter filter) noexcept
+		{
+			switch (filter)
+			{
+			case ResizeFilter::Box:
+				return{ BoxFilter, 0.5 };
+			case ResizeFilter::Bicubic:
+				return{ BicubicFilter, 2.0 };
+			case ResizeFilter::Lanczos3:
+				return{ Lanczos3Filter, 3.0 };
+			default:
+				return{ TriangleFilter, 1.0 };
+			}
+		}
+
+		/// @brief 出力の各ピクセルが参照する、入力のピクセルの範囲と重み
+		struct Coefficients
+		{
+			/// @brief 参照する範囲の先頭
+			std::vector<int32> starts;
+
+			/// @brief 参照するピクセル数
+			std::vector<int32> counts;
+
+			/// @brief 重み（出力の 1 ピクセルあたり maxTaps 個）。合計は WeightOne
+			std::vector<int16> weights;
+
+			/// @brief 参照するピクセル数の最大値
+			int32 maxTaps = 0;
+
+			/// @brief 出力のピクセルの重みの先頭ポインタを返します。
+			[[nodiscard]]
+			const int16* weightsAt(const size_t i) const noexcept
+			{
+				return (weights.data() + (i * maxTaps));
+			}
+		};
+
+		/// @brief 1 次元の拡大縮小の重みを計算します。
+		/// @param inSize 入力のピクセル数
+		/// @param outSize 出力のピクセル数
+		/// @param filter 使用するフィルタ
+		/// @return 出力の各ピクセルの重み
+		[[nodiscard]]
+		Coefficients MakeCoefficients(const int32 inSize, const int32 outSize, const Filter& filter)
+		{
+			const double scale = (static_cast<double>(inSize) / outSize);
+
+			// 縮小時はフィルタを縮小率だけ広げ、すべての入力ピクセルが出力に寄与するようにする
+			const double filterScale = std::max(scale, 1.0);
+			const double support = (filter.support * filterScale);
+
+			Coefficients result;
+			result.maxTaps = (static_cast<int32>(std::ceil(support)) * 2 + 1);
+			result.starts.resize(outSize);
+			result.counts.resize(outSize);
+			result.weights.assign((static_cast<size_t>(outSize) * result.maxTaps), 0);
+
+			std::vector<double> weights(result.maxTaps);
+
+			for (int32 i = 0; i < outSize; ++i)
+			{
+				const double center = ((i + 0.5) * scale);
+				const int32 begin = std::max(static_cast<int32>(std::floor(center - support + 0.5)), 0);
+				const int32 end = std::min(static_cast<int32>(std::floor(center + support + 0.5)), inSize);
+				int32 count = std::min((end - begin), result.maxTaps);
+
+				double total = 0.0;
+
+				for (int32 k = 0; k < count; ++k)
+				{
+					weights[k] = filter.function((begin + k - center + 0.5) / filterScale);
+					total += weights[k];
+				}
+
+				// 重みがすべて 0 の場合は、中心に最も近いピクセルだけを使う
+				if (total == 0.0)
+				{
+					std::fill_n(weights.begin(), count, 0.0);
+					weights[std::clamp(static_cast<int32>(center) - begin, 0, (count - 1))] = 1.0;
+					total = 1.0;
+				}
+
+				// 固定小数点数に変換し、丸め誤差を最大剰余法で各重みに配って合計をちょうど WeightOne にする
+				int16* pWeights = (result.weights.data() + static_cast<size_t>(i) * result.maxTaps);
+				QuantizeWeights(std::span{ weights.data(), static_cast<size_t>(count) }, (WeightOne / total), WeightOne, std::span{ pWeights, static_cast<size_t>(count) });
+
+				// 両端の重みが 0 のピクセルは参照しない
+				int32 first = 0;
+
+				while ((first < (count - 1)) && (pWeights[first] == 0))
+				{
+					++first;
+				}
+
+				while ((first < (count - 1)) && (pWeights[count - 1] == 0))
+				{
+					--count;
+				}
+
+				std::copy((pWeights + first), (pWeights + count), pWeights);
+				std::fill((pWeights + (count - first)), (pWeights + result.maxTaps), int16{ 0 });
+
+				result.starts[i] = (begin + first);
+				result.counts[i] = (count - first);
+			}
+
+			return result;
+		}
+
+		using HorizontalFunction = void(*)(const Color*, Color*, int32, const Coefficients&);
+
+		using Downscale2xFunction = void(*)(const Color*, const Color*, Color*, int32, int32);
+
+		/// @brief 固定小数点数の積和を 0 以上 255 以下の値にします。
+		[[nodiscard]]
+		constexpr uint8 ToUint8(const int32 sum) noexcept
+		{
+			return static_cast<uint8>(std::clamp((sum >> WeightBits), 0, 255));
+		}
+
+		void Downscale2x_Scalar(const Color* src0, const Color* src1, Color* dst, const int32 width, const int32 srcWidth) noexcept
+		{
+			for (int32 x = 0; x < width; ++x)
+			{
+				const int32 x0 = (x * 2);
+				const int32 x1 = std::min((x0 + 1), (srcWidth - 1));
+
+				const Color& c0 = src0[x0];
+				const Color& c1 = src0[x1];
+				const Color& c2 = src1[x0];
+				const Color& c3 = src1[x1];
+
+				dst[x] = Color{
+					static_cast<uint8>((c0.r + c1.r + c2.r + c3.r + 2) >> 2),
+					static_cast<uint8>((c0.g + c1.g + c2.g + c3.g + 2) >> 2),
+					static_cast<uint8>((c0.b + c1.b + c2.b + c3.b + 2) >> 2),
+					static_cast<uint8>((c0.a + c1.a + c2.a + c3.a + 2) >> 2) };
+			}
+		}
+
+	#if SECCAMP_CPU(X86_64)
+
+		void Horizontal_SSE2(const Color* src, Color* dst, const int32 width, const Coefficients& coefficients) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+
+			for (int32 x = 0; x < width; ++x)
+			{
+				const Color* pSrc = (src + coefficients.starts[x]);
+				const int16* pWeights = coefficients.weightsAt(x);
+				const int32 count = coefficients.counts[x];
+
+				__m128i sum = _mm_set1_epi32(WeightRound);
+
+				int32 k = 0;
+
+				// 2 ピクセルずつ、各成分を (p0, p1) の組に並べて、重みの組 (w0, w1) と積和を取る
+				for (; (k + 2) <= count; k += 2)
+				{
+					const __m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + k)), zero);
+					const __m128i pairs = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+					sum = _mm_add_epi32(sum, _mm_madd_epi16(pairs, _mm_set1_epi32(MakeWeightPair(pWeights[k], pWeights[k + 1]))));
+				}
+
+				if (k < count)
+				{
+					const __m128i p = _mm_unpacklo_epi8(_mm_loadu_si32(pSrc + k), zero);
+					const __m128i pairs = _mm_unpacklo_epi16(p, zero);
+					sum = _mm_add_epi32(sum, _mm_madd_epi16(pairs, _mm_set1_epi32(MakeWeightPair(pWeights[k], 0))));
+				}
+
+				const __m128i v = _mm_packs_epi32(_mm_srai_epi32(sum, WeightBits), zero);
+				_mm_storeu_si32((dst + x), _mm_packus_epi16(v, zero));
+			}
+		}
+
+		void Downscale2x_SSE2(const Color* src0, const Color* src1, Color* dst, const int32 width, const int32 srcWidth) noexcept
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i two = _mm_set1_epi16(2);
+
+			int32 x = 0;
+
+			// 入力の 8 ピクセル（2 行分）から、出力の 4 ピクセルを求める
+			for (; ((x + 4) <= width) && ((x + 4) * 2 <= srcWidth); x += 4)
+			{
+				const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + x * 2));
+				const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + x * 2 + 4));
+				const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + x * 2));
+				const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + x * 2 + 4));
+
+				// 縦方向の和（16 ビット、2 ピクセルずつ）
+				const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+				// 横に隣り合うピクセルの和
+				const __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+				const __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+				const __m128i r0 = _mm_srli_epi16(_mm_add_epi16(h0, two), 2);
+				const __m128i r1 = _mm_srli_epi16(_mm_add_epi16(h1, two), 2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(r0, r1));
+			}
+
+			Downscale2x_Scalar((src0 + x * 2), (src1 + x * 2), (dst + x), (width - x), (srcWidth - x * 2));
+		}
+
+	#elif SECCAMP_CPU(ARM64)
+
+		void Horizontal_NEON(const Color* src, Color* dst, const int32 width, const Coefficients& coefficients) noexcept
+		{
+			for (int32 x = 0; x < width; ++x)
+			{
+				const Color* pSrc = (src + coefficients.starts[x]);
+				const int16* pWeights = coefficients.weightsAt(x);
+				const int32 count = coefficients.counts[x];
+
+				int32x4_t sum = vdupq_n_s32(WeightRound);
+
+				int32 k = 0;
+
+				for (; (k + 2) <= count; k += 2)
+				{
+					const int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(reinterpret_cast<const uint8*>(pSrc + k))));
+					sum = vmlal_n_s16(sum, vget_low_s16(p), pWeights[k]);
+					sum = vmlal_n_s16(sum, vget_high_s16(p), pWeights[k + 1]);
+				}
+
+				if (k < count)
+				{
+					const uint32x2_t v = vld1_lane_u32(reinterpret_cast<const uint32_t*>(pSrc + k), vdup_n_u32(0), 0);
+					const int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(v)));
+					sum = vmlal_n_s16(sum, vget_low_s16(p), pWeights[k]);
+				}
+
+				const int16x4_t v = vqshrn_n_s32(sum, WeightBits);
+				const uint8x8_t packed = vqmovun_s16(vcombine_s16(v, v));
+				vst1_lane_u32(reinterpret_cast<uint32_t*>(dst + x), vreinterpret_u32_u8(packed), 0);
+			}
+		}
+
+		void Downscale2x_NEON(const Color* src0, const Color* src1, Color* dst, const int32 width, const int32 srcWidth) noexcept
+		{
+			int32 x = 0;
+
+			// 入力の 8 ピクセル（2 行分）を偶数番目と奇数番目に分けて読み込み、出力の 4 ピクセルを求める
+			for (; ((x + 4) <= width) && ((x + 4) * 2 <= srcWidth); x += 4)
+			{
+				const uint32x4x2_t a = vld2q_u32(reinterpret_cast<const uint32_t*>(src0 + x * 2));
+				const uint32x4x2_t b = vld2q_u32(reinterpret_cast<const uint32_t*>(src1 + x * 2));
+
+				const uint8x16_t a0 = vreinterpretq_u8_u32(a.val[0]);
+				const uint8x16_t a1 = vreinterpretq_u8_u32(a.val[1]);
+				const uint8x16_t b0 = vreinterpretq_u8_u32(b.val[0]);
+				const uint8x16_t b1 = vreinterpretq_u8_u32(b.val[1]);
+
+				const uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a0), vget_low_u8(a1)), vaddl_u8(vget_low_u8(b0), vget_low_u8(b1)));
+				const uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a0), vget_high_u8(a1)), vaddl_u8(vget_high_u8(b0), vget_high_u8(b1)));
+
+				// vrshrn_n_u16 は 2 を足してから 2 ビット右シフトする
+				vst1q_u8(reinterpret_cast<uint8*>(dst + x), vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+			}
+
+			Downscale2x_Scalar((src0 + x * 2), (src1 + x * 2), (dst + x), (width - x), (srcWidth - x * 2));
+		}
+
+	#else
+
+		// SSE2 と NEON の実装は端数の処理にスカラー実装を使わないので、ほかの CPU の場合だけ定義する
+		void Horizontal_Scalar(const Color* src, Color* dst, const int32 width, const Coefficients& coefficients) noexcept
+		{
+			for (int32 x = 0; x < width; ++x)
+			{
+				const Color* pSrc = (src + coefficients.starts[x]);
+				const int16* pWeights = coefficients.weightsAt(x);
+				const int32 count = coefficients.counts[x];
+
+				int32 r = WeightRound, g = WeightRound, b = WeightRound, a = WeightRound;
+
+				for (int32 k = 0; k < count; ++k)
+				{
+					r += (pSrc[k].r * pWeights[k]);
+					g += (pSrc[k].g * pWeights[k]);
+					b += (pSrc[k].b * pWeights[k]);
+					a += (pSrc[k].a * pWeights[k]);
+				}
+
+				dst[x] = Color{ ToUint8(r), ToUint8(g), ToUint8(b), ToUint8(a) };
+			}
+		}
+
+	#endif
+
+		[[nodiscard]]
+		HorizontalFunction SelectHorizontal() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return Horizontal_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Horizontal_NEON;
+
+		#else
+
+			return Horizontal_Scalar;
+
+		#endif
+		}
+
+		[[nodiscard]]
+		Downscale2xFunction SelectDownscale2x() noexcept
+		{
+		#if SECCAMP_CPU(X86_64)
+
+			return Downscale2x_SSE2;
+
+		#elif SECCAMP_CPU(ARM64)
+
+			return Downscale2x_NEON;
+
+		#else
+
+			return Downscale2x_Scalar;
+
+		#endif
+		}
+
+		/// @brief 1 行を横方向に拡大縮小します。
+		/// @param src 入力の行
+		/// @param dst 出力の行
+		/// @param width 出力の幅（ピクセル）
+		/// @param coefficients 横方向の重み
+		void ResizeHorizontal(const Color* src, Color* dst, const int32 width, const Coefficients& coefficients) noexcept
+		{
+			// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+			static const HorizontalFunction function = SelectHorizontal();
+
+			function(src, dst, width, coefficients);
+		}
+
+		/// @brief 最近傍補間で拡大縮小します。
+		void ResizeNearest(const ConstImageView& src, const ImageView& dst)
+		{
+			const double scaleX = (static_cast<double>(src.width()) / dst.width());
+			const double scaleY = (static_cast<double>(src.height()) / dst.height());
+
+			std::vector<int32> xs(dst.width());
+
+			for (int32 x = 0; x < dst.width(); ++x)
+			{
+				xs[x] = std::min(static_cast<int32>((x + 0.5) * scaleX), (src.width() - 1));
+			}
+
+			dst.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						const Color* pSrc = src[std::min(static_cast<int32>((y + 0.5) * scaleY), (src.height() - 1))];
+						Color* pDst = dst[y];
+
+						for (int32 x = 0; x < dst.width(); ++x)
+						{
+							pDst[x] = pSrc[xs[x]];
+						}
+					}
+				});
+		}
+	}
+
+	Image Resize(const ConstImageView& src, const Size& size, const ResizeFilter filter)
+	{
+		if (src.isEmpty() || (size.x <= 0) || (size.y <= 0))
+		{
+			return{};
+		}
+
+		Image image{ size, Uninitialized };
+		Resize(src, image.view(), filter);
+		return image;
+	}
+
+	void Resize(const ConstImageView& src, const ImageView& dst, const ResizeFilter filter)
+	{
+		if (src.isEmpty() || dst.isEmpty())
+		{
+			return;
+		}
+
+		if (src.size() == dst.size())
+		{
+			dst.copyFrom(src);
+			return;
+		}
+
+		if (filter == ResizeFilter::Nearest)
+		{
+			ResizeNearest(src, dst);
+			return;
+		}
+
+		const Filter f = GetFilter(filter);
+		const bool resizeX = (src.width() != dst.width());
+		const bool resizeY = (src.height() != dst.height());
+
+		if (not resizeY)
+		{
+			const Coefficients horizontal = MakeCoefficients(src.width(), dst.width(), f);
+
+			dst.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						ResizeHorizontal(src[y], dst[y], dst.width(), horizontal);
+					}
+				});
+
+			return;
+		}
+
+		const Coefficients vertical = MakeCoefficients(src.height(), dst.height(), f);
+
+		// 横方向の拡大縮小は、縦方向の補間で参照される行だけに行う
+		ConstImageView intermediate = src;
+		int32 firstRow = 0;
+		Image buffer;
+
+		if (resizeX)
+		{
+			const Coefficients horizontal = MakeCoefficients(src.width(), dst.width(), f);
+
+			firstRow = vertical.starts.front();
+			int32 lastRow = 0;
+
+			for (int32 y = 0; y < dst.height(); ++y)
+			{
+				firstRow = std::min(firstRow, vertical.starts[y]);
+				lastRow = std::max(lastRow, (vertical.starts[y] + vertical.counts[y]));
+			}
+
+			buffer.resize(dst.width(), (lastRow - firstRow), Uninitialized);
+
+			buffer.parallelForRows([&](const int32 beginY, const int32 endY)
+				{
+					for (int32 y = beginY; y < endY; ++y)
+					{
+						ResizeHorizontal(src[firstRow + y], buffer[y], dst.width(), horizontal);
+					}
+				});
+
+			intermediate = buffer.view();
+		}
+
+		dst.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					WeightedSum(intermediate[vertical.starts[y] - firstRow], intermediate.stride(), vertical.weightsAt(y), vertical.counts[y], WeightBits, dst[y], dst.width());
+				}
+			});
+	}
+
+	Image Downscale2x(const ConstImageView& src)
+	{
+		if (src.isEmpty())
+		{
+			return{};
+		}
+
+		Image image{ std::max((src.width() / 2), 1), std::max((src.height() / 2), 1), Uninitialized };
+		Downscale2x(src, image.view());
+		return image;
+	}
+
+	void Downscale2x(const ConstImageView& src, const ImageView& dst)
+	{
+		if (src.isEmpty())
+		{
+			return;
+		}
+
+		// 最初の呼び出し時に、実行中の CPU に合わせた実装を選ぶ
+		static const Downscale2xFunction function = SelectDownscale2x();
+
+		const ImageView view = dst.subView(Rect{ std::max((src.width() / 2), 1), std::max((src.height() / 2), 1) });
+
+		view.parallelForRows([&](const int32 beginY, const int32 endY)
+			{
+				for (int32 y = beginY; y < endY; ++y)
+				{
+					// 高さが 1 の場合は、同じ行を 2 回使う
+					const Color* src0 = src[y * 2];
+					const Color* src1 = src[std::min((y * 2 + 1), (src.height() - 1))];
+
+					function(src0, src1, view[y], view.width(), src.width());
+				}
+			});
+	}
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+#include "Common.hpp"
+#include "Point.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+
+namespace seccamp
+{
+	/// @brief 画像の拡大縮小に使うフィルタ
+	enum class ResizeFilter : uint8
+	{
+		/// @brief 最近傍補間。最も高速ですが、ジャギーが目立ちます
+		Nearest,
+
+		/// @brief バイリニア補間（半径 1 の三角フィルタ）
+		Bilinear,
+
+		/// @brief ボックスフィルタ（面積平均）。縮小に適しています
+		Box,
+
+		/// @brief バイキュービック補間（a = -0.5）
+		Bicubic,
+
+		/// @brief Lanczos-3 補間。最も高品質ですが、低速です
+		Lanczos3,
+	};
+
+	/// @brief 画像を拡大縮小した画像を返します。
+	/// @param src 元の画像
+	/// @param size 拡大縮小後の幅と高さ（ピクセル）
+	/// @param filter 使用するフィルタ
+	/// @return 拡大縮小した画像。src が空の場合や、size の幅か高さが 0 以下の場合は空の画像
+	/// @remark 縦と横に分けて 2 回フィルタをかけます（分離可能フィルタ）。縮小時はフィルタの幅を縮小率に合わせて広げます。
+	/// @remark アルファ成分も RGB 成分と同じように補間します。
+	[[nodiscard]]
+	Image Resize(const ConstImageView& src, const Size& size, ResizeFilter filter = ResizeFilter::Bilinear);
+
+	/// @brief 画像を拡大縮小して、ビューに書き込みます。
+	/// @param src 元の画像
+	/// @param dst 書き込み先のビュー。ビューの大きさに拡大縮小します
+	/// @param filter 使用するフィルタ
+	/// @remark src と dst の範囲が重なっていてはいけません。
+	void Resize(const ConstImageView& src, const ImageView& dst, ResizeFilter filter = ResizeFilter::Bilinear);
+
+	/// @brief 画像の幅と高さを半分に縮小した画像を返します。
+	/// @param src 元の画像
+	/// @return 2x2 ピクセルの平均を 1 ピクセルにした画像。幅と高さは 1 以上になるように切り捨てます。src が空の場合は空の画像
+	/// @remark サムネイルやミップマップの作成に使います。Resize() より高速です。
+	[[nodiscard]]
+	Image Downscale2x(const ConstImageView& src);
+
+	/// @brief 画像の幅と高さを半分に縮小して、ビューに書き込みます。
+	/// @param src 元の画像
+	/// @param dst 書き込み先のビュー。大きさが (max(1, 幅 / 2), max(1, 高さ / 2)) と異なる場合は、重なる左上の部分だけを書き込みます
+	/// @remark src と dst の範囲が重なっていてはいけません。
+	void Downscale2x(const ConstImageView& src, const ImageView& dst);
+}
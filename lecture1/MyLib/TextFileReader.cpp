@@ -1,8 +1,17 @@
-﻿#include "TextFileReader.hpp"
+﻿#include <vector> // std::vector
+#include <cstring> // std::memchr, std::memmove
+#include "TextFileReader.hpp"
 #include "BinaryFileReader.hpp"
+#include "TextSearch.hpp"
 
 namespace seccamp
 {
+	namespace
+	{
+		/// @brief ファイルから一度に読み込むサイズ（バイト）
+		constexpr size_t ReadChunkSize = (1 << 20);
+	}
+
 	class TextFileReader::Impl
 	{
 	public:
@@ -22,55 +31,82 @@ namespace seccamp
 
 		bool open(const std::string_view path)
 		{
-			return m_binaryFileReader.open(path);
+			resetBuffer();
+
+			if (not m_binaryFileReader.open(path))
+			{
+				return false;
+			}
+
+			// メモリマップされている場合はファイル全体をバッファとして扱う
+			if (m_binaryFileReader.isMapped())
+			{
+				const std::span<const std::byte> view = m_binaryFileReader.view();
+				m_pCurrent = reinterpret_cast<const char*>(view.data());
+				m_pEnd = (m_pCurrent + view.size());
+			}
+
+			return true;
 		}
 
 		void close()
 		{
 			m_binaryFileReader.close();
+
+			resetBuffer();
 		}
 
 		bool readLine(std::string& line)
 		{
-			line.clear();
+			std::string_view view;
+
+			if (not readLine(view))
+			{
+				line.clear();
+				return false;
+			}
 
-			int32 readBytes = 0;
+			line.assign(view);
+
+			return true;
+		}
+
+		bool readLine(std::string_view& line)
+		{
+			// LF を探し始める位置
+			const char* pSearch = m_pCurrent;
 
 			for (;;)
 			{
-				char c = '\0';
+				const char* pLF = FindLF(pSearch, m_pEnd);
 
-				// もし 1 バイト読み込めなかった場合
-				if (m_binaryFileReader.read(&c, 1) == 0)
+				if (pLF != m_pEnd)
 				{
-					if (readBytes == 0)
+					// LF の場合は一行読み込み完了
+					line = makeLine(m_pCurrent, pLF);
+					m_pCurrent = (pLF + 1);
+					return true;
+				}
+
+				// 探し終えた位置を覚えておき、バッファを補充する
+				const size_t searchedBytes = static_cast<size_t>(m_pEnd - m_pCurrent);
+
+				if (not refill())
+				{
+					if (m_pCurrent == m_pEnd)
 					{
 						// EOF
 						return false;
 					}
-					else
-					{
-						break;
-					}
-				}
 
-				++readBytes;
-
-				if (c == '\r')
-				{
-					// CR の場合は無視
-					continue;
-				}
-				else if (c == '\n')
-				{
-					// LF の場合は一行読み込み完了
-					break;
+					// LF で終わらない最後の行
+					line = makeLine(m_pCurrent, m_pEnd);
+					m_pCurrent = m_pEnd;
+					return true;
 				}
 
-				line.push_back(c);
+				pSearch = (m_pCurrent + searchedBytes);
 			}
-
-			return true;
 		}
 
 		const std::string& fullPath() const noexcept
@@ -80,7 +116,92 @@ namespace seccamp
 
 	private:
 
+		void resetBuffer()
+		{
+			m_buffer.clear();
+			m_pCurrent = nullptr;
+			m_pEnd = nullptr;
+		}
+
+		/// @brief 未読部分をバッファの先頭に移動し、続きのデータを読み込みます。
+		/// @return データを読み込めた場合 true, ファイルの終端に達していた場合は false
+		bool refill()
+		{
+			// メモリマップされている場合はファイル全体がすでにバッファにある
+			if (m_binaryFileReader.isMapped())
+			{
+				return false;
+			}
+
+			const size_t remainingBytes = static_cast<size_t>(m_pEnd - m_pCurrent);
+
+			if (remainingBytes != 0)
+			{
+				std::memmove(m_buffer.data(), m_pCurrent, remainingBytes);
+			}
+
+			// 1 行がバッファに収まらない場合はバッファを拡張する
+			if (m_buffer.size() < (remainingBytes + ReadChunkSize))
+			{
+				m_buffer.resize(remainingBytes + ReadChunkSize);
+			}
+
+			const int64 readBytes = m_binaryFileReader.read((m_buffer.data() + remainingBytes), ReadChunkSize);
+
+			m_pCurrent = m_buffer.data();
+			m_pEnd = (m_pCurrent + remainingBytes + static_cast<size_t>(readBytes));
+
+			return (0 < readBytes);
+		}
+
+		/// @brief 範囲 [first, last) から CR を取り除いた行を返します。
+		/// @param first 行の先頭
+		/// @param last 行の終端（LF を含まない）
+		/// @return CR を取り除いた行
+		[[nodiscard]]
+		std::string_view makeLine(const char* first, const char* last)
+		{
+			// 行末の CR は範囲を縮めるだけで取り除ける
+			if ((first != last) && (*(last - 1) == '\r'))
+			{
+				--last;
+			}
+
+			const size_t length = static_cast<size_t>(last - first);
+
+			// 行の途中に CR が無い場合はバッファをそのまま参照する
+			if ((length == 0) || (std::memchr(first, '\r', length) == nullptr))
+			{
+				return{ first, length };
+			}
+
+			// CR の場合は無視
+			m_line.clear();
+
+			for (const char* p = first; p != last; ++p)
+			{
+				if (*p != '\r')
+				{
+					m_line.push_back(*p);
+				}
+			}
+
+			return m_line;
+		}
+
 		BinaryFileReader m_binaryFileReader;
+
+		// ファイルから読み込んだデータを格納するバッファ（メモリマップされている場合は使わない）
+		std::vector<char> m_buffer;
+
+		// 内部バッファの未読部分の先頭
+		const char* m_pCurrent = nullptr;
+
+		// 内部バッファの有効なデータの終端
+		const char* m_pEnd = nullptr;
+
+		// CR を取り除いた行を格納するバッファ
+		std::string m_line;
 	};
 
 	TextFileReader::TextFileReader()
@@ -117,6 +238,11 @@ namespace seccamp
 		return m_pImpl->readLine(line);
 	}
 
+	bool TextFileReader::readLine(std::string_view& line)
+	{
+		return m_pImpl->readLine(line);
+	}
+
 	const std::string& TextFileReader::fullPath() const noexcept
 	{
 		return m_pImpl->fullPath();
@@ -43,6 +43,12 @@ namespace seccamp
 		/// @return 読み込みに成功した場合 true, それ以外の場合は false
 		bool readLine(std::string& line);
 
+		/// @brief ファイルから 1 行読み込み、メモリ確保をせずに内部バッファを参照するビューを返します。
+		/// @param line 読み込んだ文字列へのビューの格納先
+		/// @return 読み込みに成功した場合 true, それ以外の場合は false
+		/// @remark ビューは次に readLine() または close() を呼ぶまで有効です。
+		bool readLine(std::string_view& line);
+
 		/// @brief ファイルの絶対パスを返します。
 		/// @return ファイルの絶対パス。ファイルがオープンされていない場合は空文字列
 		[[nodiscard]]
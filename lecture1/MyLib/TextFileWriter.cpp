@@ -1,5 +1,4 @@
 ﻿#include "TextFileWriter.hpp"
-#include "BinaryFileWriter.hpp"
 
 namespace seccamp
 {
@@ -7,7 +6,13 @@ namespace seccamp
 	{
 	public:
 
-		Impl() = default;
+		Impl()
+		{
+			// 文字列は Impl の内部バッファでまとめてから書き出すので、BinaryFileWriter 側ではバッファリングしない
+			m_binaryFileWriter.reserve(0);
+
+			m_buffer.reserve(BufferSize);
+		}
 
 		~Impl()
 		{
@@ -20,19 +25,78 @@ namespace seccamp
 			return m_binaryFileWriter.isOpen();
 		}
 
-		bool open(const std::string_view path)
+		bool open(const std::string_view path, const WriteMode mode)
 		{
-			return m_binaryFileWriter.open(path);
+			if (isOpen())
+			{
+				close();
+			}
+
+			return m_binaryFileWriter.open(path, mode);
 		}
 
 		void close()
 		{
+			flush();
+
 			m_binaryFileWriter.close();
 		}
 
 		void write(const std::string_view s)
 		{
-			m_binaryFileWriter.write(s.data(), s.size());
+			m_buffer.append(s);
+
+			commit();
+		}
+
+		void writeln(const std::string_view s)
+		{
+			m_buffer.append(s);
+
+			m_buffer.append("\r\n");
+
+			commit();
+		}
+
+		void flush()
+		{
+			if (not m_buffer.empty())
+			{
+				m_binaryFileWriter.write(m_buffer.data(), m_buffer.size());
+
+				// 容量は保持されるので、次回以降の書き込みでメモリ確保は発生しない
+				m_buffer.clear();
+			}
+
+			m_binaryFileWriter.flush();
+		}
+
+		void waitForCompletion()
+		{
+			if (not m_buffer.empty())
+			{
+				m_binaryFileWriter.write(m_buffer.data(), m_buffer.size());
+
+				m_buffer.clear();
+			}
+
+			m_binaryFileWriter.waitForCompletion();
+		}
+
+		void commit()
+		{
+			if (BufferSize <= m_buffer.size())
+			{
+				m_binaryFileWriter.write(m_buffer.data(), m_buffer.size());
+
+				m_buffer.clear();
+			}
+		}
+
+		[[nodiscard]]
+		std::string& buffer() noexcept
+		{
+			return m_buffer;
 		}
 
 		[[nodiscard]]
@@ -43,16 +107,22 @@ namespace seccamp
 
 	private:
 
+		/// @brief 内部バッファをファイルに書き出すサイズ（バイト）
+		static constexpr size_t BufferSize = BinaryFileWriter::DefaultBufferSize;
+
 		BinaryFileWriter m_binaryFileWriter;
+
+		// 書き込み待ちの文字列を格納するバッファ
+		std::string m_buffer;
 	};
 
 	TextFileWriter::TextFileWriter()
 		: m_pImpl{ std::make_shared<Impl>() } {}
 
-	TextFileWriter::TextFileWriter(const std::string_view path)
+	TextFileWriter::TextFileWriter(const std::string_view path, const WriteMode mode)
 		: TextFileWriter{} // 移譲コンストラクタ
 	{
-		m_pImpl->open(path);
+		m_pImpl->open(path, mode);
 	}
 
 	bool TextFileWriter::isOpen() const noexcept
@@ -60,9 +130,9 @@ namespace seccamp
 		return m_pImpl->isOpen();
 	}
 
-	bool TextFileWriter::open(const std::string_view path)
+	bool TextFileWriter::open(const std::string_view path, const WriteMode mode)
 	{
-		return m_pImpl->open(path);
+		return m_pImpl->open(path, mode);
 	}
 
 	TextFileWriter::operator bool() const noexcept
@@ -82,13 +152,31 @@ namespace seccamp
 
 	void TextFileWriter::writeln(const std::string_view s)
 	{
-		m_pImpl->write(s);
+		m_pImpl->writeln(s);
+	}
 
-		m_pImpl->write("\r\n");
+	void TextFileWriter::flush()
+	{
+		m_pImpl->flush();
+	}
+
+	void TextFileWriter::waitForCompletion()
+	{
+		m_pImpl->waitForCompletion();
 	}
 
 	const std::string& TextFileWriter::fullPath() const noexcept
 	{
 		return m_pImpl->fullPath();
 	}
+
+	std::string& TextFileWriter::buffer() noexcept
+	{
+		return m_pImpl->buffer();
+	}
+
+	void TextFileWriter::commit()
+	{
+		m_pImpl->commit();
+	}
 }
@@ -1,8 +1,11 @@
 ﻿#pragma once
 #include <memory> // std::shared_ptr
 #include <string_view> // std::string_view
-#include <format> // std::format
+#include <string> // std::string
+#include <format> // std::format_to
+#include <iterator> // std::back_inserter
 #include "Common.hpp"
+#include "BinaryFileWriter.hpp"
 
 namespace seccamp
 {
@@ -17,8 +20,9 @@ namespace seccamp
 
 		/// @brief ファイルを作成してオープンします。
 		/// @param path ファイルパス
+		/// @param mode 書き込み方法
 		[[nodiscard]]
-		explicit TextFileWriter(std::string_view path);
+		explicit TextFileWriter(std::string_view path, WriteMode mode = WriteMode::Sync);
 
 		/// @brief ファイルがオープンされているかを返します。
 		/// @return オープンされている場合 true, それ以外の場合は false
@@ -32,12 +36,21 @@ namespace seccamp
 
 		/// @brief ファイルをオープンします。すでにオープンされている場合はクローズしてから再オープンします。
 		/// @param path ファイルパス
+		/// @param mode 書き込み方法
 		/// @return オープンに成功した場合 true, それ以外の場合は false
-		bool open(std::string_view path);
+		bool open(std::string_view path, WriteMode mode = WriteMode::Sync);
 
 		/// @brief ファイルをクローズします。
+		/// @remark 内部バッファに残っている文字列はクローズ前に書き出されます。
 		void close();
 
+		/// @brief 内部バッファの文字列をファイルに書き出します。
+		/// @remark WriteMode::Async の場合は、書き込みが完了するまで待機します。
+		void flush();
+
+		/// @brief それまでに書き込んだ文字列がすべてファイルに渡されるまで待機します。
+		void waitForCompletion();
+
 		/// @brief ファイルに文字列を書き込みます。
 		/// @param s 書き込む文字列
 		void write(std::string_view s);
@@ -50,20 +63,30 @@ namespace seccamp
 		/// @tparam Types 書き込むデータの型
 		/// @param fmt 書式文字列
 		/// @param args 書き込むデータ
+		/// @remark 文字列は内部バッファに直接書式化されるため、一時的な文字列は作成されません。
 		template <class... Types>
 		void write(std::format_string<Types...> fmt, Types&&... args)
 		{
-			write(std::format(fmt, std::forward<Types>(args)...));
+			std::format_to(std::back_inserter(buffer()), fmt, std::forward<Types>(args)...);
+
+			commit();
 		}
 
 		/// @brief ファイルに文字列を書き込み、CRLF（\r\n）を追加します。
 		/// @tparam Types 書き込むデータの型
 		/// @param fmt 書式文字列
 		/// @param args 書き込むデータ
+		/// @remark 文字列は内部バッファに直接書式化されるため、一時的な文字列は作成されません。
 		template <class... Types>
 		void writeln(std::format_string<Types...> fmt, Types&&... args)
 		{
-			writeln(std::format(fmt, std::forward<Types>(args)...));
+			std::string& buffer = this->buffer();
+
+			std::format_to(std::back_inserter(buffer), fmt, std::forward<Types>(args)...);
+
+			buffer.append("\r\n");
+
+			commit();
 		}
 
 		/// @brief ファイルの絶対パスを返します。
@@ -76,5 +99,13 @@ namespace seccamp
 		class Impl;
 
 		std::shared_ptr<Impl> m_pImpl;
+
+		/// @brief 書き込み待ちの文字列を格納する内部バッファを返します。
+		/// @return 内部バッファ
+		[[nodiscard]]
+		std::string& buffer() noexcept;
+
+		/// @brief 内部バッファが一定のサイズを超えていたらファイルに書き出します。
+		void commit();
 	};
 }
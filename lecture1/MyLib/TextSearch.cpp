@@ -0,0 +1,67 @@
+﻿#include <cstring> // std::memchr
+#include <bit> // std::countr_zero
+#include "TextSearch.hpp"
+
+#if SECCAMP_CPU(X86_64)
+	#include <immintrin.h> // _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8, _mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_movemask_epi8
+#endif
+
+namespace seccamp
+{
+	const char* FindLF(const char* first, const char* const last) noexcept
+	{
+	#if defined(__AVX2__)
+
+		// 32 バイトずつ比較する
+		{
+			const __m256i lf = _mm256_set1_epi8('\n');
+
+			while (32 <= (last - first))
+			{
+				const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+				const uint32 mask = static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, lf)));
+
+				if (mask)
+				{
+					return (first + std::countr_zero(mask));
+				}
+
+				first += 32;
+			}
+		}
+
+	#endif
+
+	#if SECCAMP_CPU(X86_64)
+
+		// 16 バイトずつ比較する
+		{
+			const __m128i lf = _mm_set1_epi8('\n');
+
+			while (16 <= (last - first))
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+				const uint32 mask = static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lf)));
+
+				if (mask)
+				{
+					return (first + std::countr_zero(mask));
+				}
+
+				first += 16;
+			}
+		}
+
+	#endif
+
+		// 残りを探す
+		if (first == last)
+		{
+			return last;
+		}
+
+		const void* p = std::memchr(first, '\n', static_cast<size_t>(last - first));
+
+		return (p ? static_cast<const char*>(p) : last);
+	}
+}
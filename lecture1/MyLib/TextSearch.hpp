@@ -0,0 +1,13 @@
+﻿#pragma once
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief 範囲 [first, last) から最初の LF を探します。
+	/// @param first 範囲の先頭
+	/// @param last 範囲の終端
+	/// @return 最初の LF の位置。見つからなかった場合は last
+	/// @remark ライブラリの内部で、TextFileReader と LineIndex が共有する関数です。
+	[[nodiscard]]
+	const char* FindLF(const char* first, const char* last) noexcept;
+}
@@ -0,0 +1,278 @@
+﻿#include <algorithm> // std::min, std::max
+#include <atomic> // std::atomic
+#include <thread> // std::thread
+#include <mutex> // std::mutex, std::lock_guard, std::unique_lock
+#include <condition_variable> // std::condition_variable
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <vector> // std::vector
+#include <utility> // std::exchange
+#include "ThreadPool.hpp"
+
+namespace seccamp
+{
+	namespace
+	{
+		/// @brief 現在のスレッドが並列処理を実行中であるか
+		thread_local bool t_inParallelRegion = false;
+
+		/// @brief スレッド数が 0 の場合に CPU の論理コア数に置き換えます。
+		/// @param numThreads スレッド数
+		/// @return スレッド数
+		[[nodiscard]]
+		size_t ResolveNumThreads(const size_t numThreads) noexcept
+		{
+			if (numThreads != 0)
+			{
+				return numThreads;
+			}
+
+			return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+	}
+
+	class ThreadPool::Impl
+	{
+	public:
+
+		explicit Impl(const size_t numThreads)
+		{
+			start(ResolveNumThreads(numThreads));
+		}
+
+		~Impl()
+		{
+			stop();
+		}
+
+		[[nodiscard]]
+		size_t numThreads() const noexcept
+		{
+			return (m_numWorkers + 1);
+		}
+
+		void resize(const size_t numThreads)
+		{
+			// 実行中の処理の完了を待つ
+			std::lock_guard jobLock{ m_jobMutex };
+
+			stop();
+
+			start(ResolveNumThreads(numThreads));
+		}
+
+		void run(const size_t begin, const size_t end, const size_t grain, const TaskFunction function, void* context)
+		{
+			const size_t chunkSize = std::max<size_t>(grain, 1);
+
+			// 分割できない場合、ワーカースレッドが無い場合、並列処理の中から呼ばれた場合は、このスレッドだけで実行する
+			if (((end - begin) <= chunkSize) || (m_numWorkers.load(std::memory_order_relaxed) == 0) || t_inParallelRegion)
+			{
+				for (size_t first = begin; first < end; first += chunkSize)
+				{
+					function(context, first, std::min((first + chunkSize), end));
+				}
+
+				return;
+			}
+
+			// 同時に実行できる処理は 1 つだけ
+			std::lock_guard jobLock{ m_jobMutex };
+
+			{
+				std::lock_guard lock{ m_mutex };
+
+				m_job = Job{ .end = end, .grain = chunkSize, .function = function, .context = context };
+				m_next.store(begin, std::memory_order_relaxed);
+				m_exception = nullptr;
+				m_busyWorkers = m_workers.size();
+				++m_generation;
+			}
+
+			m_workCondition.notify_all();
+
+			// 呼び出し元のスレッドも処理に参加する
+			t_inParallelRegion = true;
+			work();
+			t_inParallelRegion = false;
+
+			// すべてのワーカースレッドが処理を終えるまで待つ
+			{
+				std::unique_lock lock{ m_mutex };
+
+				m_doneCondition.wait(lock, [this]() { return (m_busyWorkers == 0); });
+			}
+
+			if (m_exception)
+			{
+				std::rethrow_exception(std::exchange(m_exception, nullptr));
+			}
+		}
+
+	private:
+
+		/// @brief 実行中の処理
+		struct Job
+		{
+			size_t end = 0;
+
+			size_t grain = 1;
+
+			TaskFunction function = nullptr;
+
+			void* context = nullptr;
+		};
+
+		// run() の呼び出しを直列化するためのミューテックス
+		std::mutex m_jobMutex;
+
+		// 以下のメンバを保護するミューテックス
+		std::mutex m_mutex;
+
+		// 新しい処理が追加されたときや停止するときに通知する
+		std::condition_variable m_workCondition;
+
+		// ワーカースレッドがすべて処理を終えたときに通知する
+		std::condition_variable m_doneCondition;
+
+		Job m_job;
+
+		// 処理を追加するたびに増える番号
+		uint64 m_generation = 0;
+
+		// 処理を終えていないワーカースレッドの数
+		size_t m_busyWorkers = 0;
+
+		bool m_stopRequested = false;
+
+		std::exception_ptr m_exception;
+
+		// 次に処理する範囲の先頭
+		std::atomic<size_t> m_next = 0;
+
+		std::vector<std::thread> m_workers;
+
+		std::atomic<size_t> m_numWorkers = 0;
+
+		void start(const size_t numThreads)
+		{
+			m_stopRequested = false;
+
+			for (size_t i = 1; i < numThreads; ++i)
+			{
+				// スレッドの起動が遅れても、起動後に追加された処理を取りこぼさないように、現在の番号を渡す
+				m_workers.emplace_back(&Impl::workerMain, this, m_generation);
+			}
+
+			m_numWorkers = m_workers.size();
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard lock{ m_mutex };
+				m_stopRequested = true;
+			}
+
+			m_workCondition.notify_all();
+
+			for (auto& worker : m_workers)
+			{
+				worker.join();
+			}
+
+			m_workers.clear();
+
+			m_numWorkers = 0;
+		}
+
+		/// @brief 範囲が無くなるまで、次の範囲を取り出して処理します。
+		void work()
+		{
+			const Job job = m_job;
+
+			for (;;)
+			{
+				const size_t first = m_next.fetch_add(job.grain, std::memory_order_relaxed);
+
+				if (job.end <= first)
+				{
+					break;
+				}
+
+				try
+				{
+					job.function(job.context, first, std::min((first + job.grain), job.end));
+				}
+				catch (...)
+				{
+					// 最初の例外を記録し、残りの範囲の処理を打ち切る
+					std::lock_guard lock{ m_mutex };
+
+					if (not m_exception)
+					{
+						m_exception = std::current_exception();
+					}
+
+					m_next.store(job.end, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// @param generation 起動時の処理の番号。これより後に追加された処理を実行する
+		void workerMain(uint64 generation)
+		{
+			t_inParallelRegion = true;
+
+			for (;;)
+			{
+				{
+					std::unique_lock lock{ m_mutex };
+
+					m_workCondition.wait(lock, [&]() { return (m_stopRequested || (m_generation != generation)); });
+
+					if (m_stopRequested)
+					{
+						return;
+					}
+
+					generation = m_generation;
+				}
+
+				work();
+
+				{
+					std::lock_guard lock{ m_mutex };
+
+					if (--m_busyWorkers == 0)
+					{
+						m_doneCondition.notify_one();
+					}
+				}
+			}
+		}
+	};
+
+	ThreadPool::ThreadPool(const size_t numThreads)
+		: m_pImpl{ std::make_shared<Impl>(numThreads) } {}
+
+	size_t ThreadPool::numThreads() const noexcept
+	{
+		return m_pImpl->numThreads();
+	}
+
+	void ThreadPool::resize(const size_t numThreads)
+	{
+		m_pImpl->resize(numThreads);
+	}
+
+	ThreadPool& ThreadPool::Default()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	void ThreadPool::run(const size_t begin, const size_t end, const size_t grain, const TaskFunction function, void* context)
+	{
+		m_pImpl->run(begin, end, grain, function, context);
+	}
+}
@@ -0,0 +1,84 @@
+﻿#pragma once
+#include <memory> // std::shared_ptr, std::addressof
+#include <concepts> // std::invocable
+#include <type_traits> // std::remove_reference_t
+#include "Common.hpp"
+
+namespace seccamp
+{
+	/// @brief 範囲を分割して複数のスレッドで並列に処理するためのスレッドプール
+	/// @remark ワーカースレッドは作成時に起動し、破棄されるまで再利用されます。
+	class ThreadPool
+	{
+	public:
+
+		/// @brief スレッドプールを作成します。
+		/// @param numThreads 処理に使うスレッド数（呼び出し元のスレッドを含む）。0 の場合は CPU の論理コア数
+		[[nodiscard]]
+		explicit ThreadPool(size_t numThreads = 0);
+
+		/// @brief 処理に使うスレッド数（呼び出し元のスレッドを含む）を返します。
+		/// @return 処理に使うスレッド数
+		[[nodiscard]]
+		size_t numThreads() const noexcept;
+
+		/// @brief 処理に使うスレッド数を変更します。
+		/// @param numThreads 処理に使うスレッド数（呼び出し元のスレッドを含む）。0 の場合は CPU の論理コア数
+		/// @remark 実行中の処理がある場合は、その完了を待ってから変更します。
+		void resize(size_t numThreads);
+
+		/// @brief 範囲 [begin, end) を grain 個ずつに分割し、複数のスレッドで並列に関数を実行します。
+		/// @param begin 範囲の先頭
+		/// @param end 範囲の終端（含まない）
+		/// @param func 分割した各範囲に対して呼ばれる関数。引数は範囲の先頭と終端（含まない）
+		/// @param grain 1 回の呼び出しで処理する個数
+		/// @remark すべての呼び出しが完了してから戻ります。呼び出し元のスレッドも処理に参加します。
+		/// @remark 並列に実行中の関数の中から呼び出した場合は、呼び出し元のスレッドだけで実行します。
+		/// @remark 関数が例外を投げた場合は、残りの範囲の処理を打ち切り、すべてのスレッドの停止後に最初の例外を再送出します。
+		template <class Fty>
+			requires std::invocable<Fty&, size_t, size_t>
+		void parallelFor(const size_t begin, const size_t end, Fty&& func, const size_t grain = 1)
+		{
+			if (end <= begin)
+			{
+				return;
+			}
+
+			using FunctionType = std::remove_reference_t<Fty>;
+
+			const auto Invoke = [](void* context, const size_t first, const size_t last)
+			{
+				(*static_cast<FunctionType*>(context))(first, last);
+			};
+
+			run(begin, end, grain, Invoke, const_cast<void*>(static_cast<const void*>(std::addressof(func))));
+		}
+
+		/// @brief ライブラリ全体で共有するスレッドプールを返します。
+		/// @return 共有のスレッドプール
+		[[nodiscard]]
+		static ThreadPool& Default();
+
+	private:
+
+		using TaskFunction = void(*)(void*, size_t, size_t);
+
+		void run(size_t begin, size_t end, size_t grain, TaskFunction function, void* context);
+
+		class Impl;
+
+		std::shared_ptr<Impl> m_pImpl;
+	};
+
+	/// @brief 共有のスレッドプールを使って、範囲 [begin, end) を grain 個ずつに分割し、並列に関数を実行します。
+	/// @param begin 範囲の先頭
+	/// @param end 範囲の終端（含まない）
+	/// @param func 分割した各範囲に対して呼ばれる関数。引数は範囲の先頭と終端（含まない）
+	/// @param grain 1 回の呼び出しで処理する個数
+	template <class Fty>
+		requires std::invocable<Fty&, size_t, size_t>
+	void ParallelFor(const size_t begin, const size_t end, Fty&& func, const size_t grain = 1)
+	{
+		ThreadPool::Default().parallelFor(begin, end, func, grain);
+	}
+}
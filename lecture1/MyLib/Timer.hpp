@@ -11,16 +11,40 @@ namespace seccamp
 
 		void print() const
 		{
-			// 終了時刻を記録
-			const auto end = std::chrono::high_resolution_clock::now();
-
 			// 経過時間をマイクロ秒で取得
-			const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - m_start).count();
+			const auto us = this->us();
 
 			// 出力
 			std::println("Time: {} us ({} ms)", us, (us / 1000));
 		}
 
+		/// @brief 経過時間（マイクロ秒）を返します。
+		/// @return 経過時間（マイクロ秒）
+		[[nodiscard]]
+		int64 us() const
+		{
+			// 終了時刻を記録
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			return std::chrono::duration_cast<std::chrono::microseconds>(end - m_start).count();
+		}
+
+		/// @brief 経過時間（ミリ秒）を返します。
+		/// @return 経過時間（ミリ秒）
+		[[nodiscard]]
+		int64 ms() const
+		{
+			return (us() / 1000);
+		}
+
+		/// @brief 経過時間（秒）を返します。
+		/// @return 経過時間（秒）
+		[[nodiscard]]
+		double sF() const
+		{
+			return (us() / 1'000'000.0);
+		}
+
 	private:
 
 		// 開始時刻を記録